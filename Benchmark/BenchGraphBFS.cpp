@@ -0,0 +1,117 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "BenchmarkUtils.h"
+#include "GraphBFS.h"
+#include "JobSystem.h"
+#include <queue>
+#include <random>
+
+using namespace Bcg;
+
+// Grid graph of side x side vertices. Every vertex additionally gets n_shortcuts edges to random vertices, which
+// turns the grid into a small world graph with few, wide levels.
+static Graph MakeGraph(size_t side, size_t n_shortcuts) {
+    Graph graph;
+    const size_t n = side * side;
+    graph.reserve(n, 2 * n + n * n_shortcuts);
+    for (size_t i = 0; i < n; ++i) {
+        graph.new_vertex();
+    }
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> random_vertex(0, n - 1);
+    for (size_t y = 0; y < side; ++y) {
+        for (size_t x = 0; x < side; ++x) {
+            const Vertex v(y * side + x);
+            if (x + 1 < side) graph.add_edge(v, Vertex(y * side + x + 1));
+            if (y + 1 < side) graph.add_edge(v, Vertex((y + 1) * side + x));
+            for (size_t k = 0; k < n_shortcuts; ++k) {
+                const Vertex u(random_vertex(rng));
+                if (u != v) graph.add_edge(v, u);
+            }
+        }
+    }
+    return graph;
+}
+
+// Serial queue based BFS over the halfedge circulators, the baseline.
+static size_t SerialBFS(const Graph &graph, const Vertex &source, std::vector<int> &distances) {
+    distances.assign(graph.vertices.size(), -1);
+    std::queue<Vertex> queue;
+    distances[source.idx()] = 0;
+    queue.push(source);
+    size_t n_visited = 0;
+    while (!queue.empty()) {
+        const Vertex v = queue.front();
+        queue.pop();
+        ++n_visited;
+        for (const auto &h: graph.get_halfedges(v)) {
+            const Vertex u = graph.get_vertex(h);
+            if (distances[u.idx()] < 0) {
+                distances[u.idx()] = distances[v.idx()] + 1;
+                queue.push(u);
+            }
+        }
+    }
+    return n_visited;
+}
+
+// Compares the serial circulator BFS with the direction optimizing BFS in top-down only and in switching mode, serial
+// and on a JobSystem. Reports traversed edges as bytes and vertices as items.
+// Usage: BenchGraphBFS [grid side, default 3163 for 10M vertices] [shortcuts per vertex] [json output file]
+int main(int argc, char **argv) {
+    const size_t side = argc > 1 ? std::stoul(argv[1]) : 3163;
+    const size_t n_shortcuts = argc > 2 ? std::stoul(argv[2]) : 1;
+    const std::string json_filename = argc > 3 ? argv[3] : "BenchGraphBFS.json";
+    const int repetitions = 3;
+
+    BenchmarkTimer timer;
+    Graph graph = MakeGraph(side, n_shortcuts);
+    std::printf("Graph: %zu vertices, %zu edges, built in %.2f s\n", graph.n_vertices(), graph.n_edges(),
+                timer.seconds());
+
+    JobSystem jobs;
+    BenchmarkJson json;
+    const Vertex source(graph.n_vertices() / 2);
+    auto record = [&](const std::string &name, double seconds, size_t bytes, size_t items) {
+        BenchmarkReport(name, seconds, bytes, items);
+        json.add("graph_bfs", seconds, bytes, items,
+                 {{"variant", name}, {"vertices", std::to_string(graph.n_vertices())},
+                  {"threads", std::to_string(jobs.num_threads())}});
+    };
+
+    std::vector<int> expected;
+    size_t n_visited = 0;
+    double seconds = BenchmarkBestOf(repetitions, [&]() { n_visited = SerialBFS(graph, source, expected); });
+    const size_t traversed_bytes = graph.n_halfedges() * sizeof(unsigned int);
+    record("serial circulator bfs", seconds, traversed_bytes, n_visited);
+
+    GraphCsr csr;
+    seconds = BenchmarkBestOf(repetitions, [&]() { csr = GraphCsr(graph); });
+    record("csr build", seconds, csr.n_entries() * sizeof(unsigned int), graph.n_vertices());
+    seconds = BenchmarkBestOf(repetitions, [&]() { csr = GraphCsr(graph, EdgeProperty<Real>(), &jobs); });
+    record("csr build parallel", seconds, csr.n_entries() * sizeof(unsigned int), graph.n_vertices());
+
+    for (JobSystem *job_system: {static_cast<JobSystem *>(nullptr), &jobs}) {
+        for (const bool switching: {false, true}) {
+            DirectionOptimizingBFS bfs(graph, job_system);
+            bfs.set_csr(&csr);
+            if (!switching) {
+                bfs.alpha = 0;
+            }
+            seconds = BenchmarkBestOf(repetitions, [&]() { bfs.compute(source); });
+            const std::string name = std::string(switching ? "direction optimizing" : "top-down") +
+                                     (job_system ? " parallel" : "");
+            record(name, seconds, traversed_bytes, n_visited);
+            std::printf("%-40s %zu levels, %zu bottom-up, %s\n", "", bfs.n_levels, bfs.n_bottom_up_levels,
+                        bfs.vertex_distances.vector() == expected ? "distances match" : "DISTANCES DIFFER");
+        }
+    }
+
+    if (!json.write(json_filename)) {
+        return 1;
+    }
+    std::printf("Results written to %s\n", json_filename.c_str());
+    return 0;
+}
@@ -0,0 +1,111 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "BenchmarkUtils.h"
+#include "GraphBoruvka.h"
+#include "GraphKruskal.h"
+#include "GraphPrim.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <cmath>
+#include <memory>
+#include <random>
+#include <thread>
+
+using namespace Bcg;
+
+// Grid graph of side x side vertices with diagonals and jittered positions, plus a few edges per vertex to random
+// vertices nearby, so the valences resemble a kNN graph. Weighted by edge lengths.
+static Graph MakeGraph(size_t side) {
+    Graph graph;
+    const size_t n = side * side;
+    graph.reserve(n, 6 * n);
+    auto positions = graph.vertex_property<Vector<Real, 3> >("v:position");
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<Real> jitter(-0.3f, 0.3f);
+    std::uniform_int_distribution<int> offset(-3, 3);
+    for (size_t i = 0; i < n; ++i) {
+        const Vertex v = graph.new_vertex();
+        positions[v] = Vector<Real, 3>(i % side + jitter(rng), i / side + jitter(rng), 0);
+    }
+    for (size_t y = 0; y < side; ++y) {
+        for (size_t x = 0; x < side; ++x) {
+            const Vertex v(y * side + x);
+            if (x + 1 < side) graph.add_edge(v, Vertex(y * side + x + 1));
+            if (y + 1 < side) graph.add_edge(v, Vertex((y + 1) * side + x));
+            if (x + 1 < side && y + 1 < side) graph.add_edge(v, Vertex((y + 1) * side + x + 1));
+            for (int k = 0; k < 3; ++k) {
+                const long nx = static_cast<long>(x) + offset(rng), ny = static_cast<long>(y) + offset(rng);
+                if (nx < 0 || ny < 0 || nx >= static_cast<long>(side) || ny >= static_cast<long>(side)) continue;
+                const Vertex u(ny * side + nx);
+                if (u != v && !graph.find_edge(v, u).is_valid()) graph.add_edge(v, u);
+            }
+        }
+    }
+    return graph;
+}
+
+// Compares Kruskal and Prim with Boruvka for an increasing number of threads.
+// Reports the edges as bytes and the vertices as items.
+// Usage: BenchGraphBoruvka [grid side, default 1000] [json output file]
+int main(int argc, char **argv) {
+    const size_t side = argc > 1 ? std::stoul(argv[1]) : 1000;
+    const std::string json_filename = argc > 2 ? argv[2] : "BenchGraphBoruvka.json";
+    const int repetitions = 3;
+
+    Graph graph = MakeGraph(side);
+    const EdgeProperty<Real> weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+    const GraphCsr csr(graph, weights);
+    const Vertex source(0);
+    const size_t bytes = graph.n_edges() * (2 * sizeof(unsigned int) + sizeof(Real));
+    const size_t items = graph.n_vertices();
+    std::printf("Graph: %zu vertices, %zu edges\n", graph.n_vertices(), graph.n_edges());
+
+    BenchmarkJson json;
+    auto record = [&](const std::string &name, double seconds, unsigned int threads) {
+        BenchmarkReport(name, seconds, bytes, items);
+        json.add("graph_mst", seconds, bytes, items,
+                 {{"variant", name}, {"vertices", std::to_string(items)}, {"threads", std::to_string(threads)}});
+    };
+    auto tree_weight = [&](const VertexProperty<Halfedge> &predecessors) {
+        double weight = 0;
+        for (const Vertex &v: graph.vertices) {
+            if (predecessors[v].is_valid()) weight += weights[graph.get_edge(predecessors[v])];
+        }
+        return weight;
+    };
+
+    Kruskal kruskal(graph);
+    kruskal.set_csr(&csr);
+    record("kruskal csr", BenchmarkBestOf(repetitions, [&]() { kruskal.compute(source); }), 1);
+    const double expected = tree_weight(kruskal.vertex_predecessors);
+
+    Prim prim(graph);
+    prim.set_csr(&csr);
+    record("prim csr", BenchmarkBestOf(repetitions, [&]() { prim.compute(source); }), 1);
+
+    std::vector<unsigned int> thread_counts = {0};
+    for (unsigned int threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    for (const unsigned int threads: thread_counts) {
+        // 0 threads runs Boruvka serially without a JobSystem.
+        std::unique_ptr<JobSystem> jobs = threads > 0 ? std::make_unique<JobSystem>(threads) : nullptr;
+        Boruvka boruvka(graph, jobs.get());
+        boruvka.set_csr(&csr);
+        const double seconds = BenchmarkBestOf(repetitions, [&]() { boruvka.compute(source); });
+        char name[64];
+        std::snprintf(name, sizeof(name), "boruvka csr threads %u", threads);
+        record(name, seconds, threads);
+        const double weight = tree_weight(boruvka.vertex_predecessors);
+        std::printf("%-40s %zu rounds, %s\n", "", boruvka.n_rounds,
+                    std::abs(weight - expected) <= 1e-6 * expected ? "weights match" : "WEIGHTS DIFFER");
+    }
+
+    if (!json.write(json_filename)) {
+        return 1;
+    }
+    std::printf("Results written to %s\n", json_filename.c_str());
+    return 0;
+}
@@ -0,0 +1,138 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "BenchmarkUtils.h"
+#include "GraphColoring.h"
+#include "MeshShapes.h"
+#include <memory>
+#include <random>
+#include <thread>
+
+using namespace Bcg;
+
+// Grid graph of side x side vertices with diagonals, plus a few edges per vertex to random vertices nearby, so the
+// valences resemble a kNN graph.
+static Graph MakeGraph(size_t side) {
+    Graph graph;
+    const size_t n = side * side;
+    graph.reserve(n, 6 * n);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> offset(-3, 3);
+    for (size_t i = 0; i < n; ++i) {
+        graph.new_vertex();
+    }
+    for (size_t y = 0; y < side; ++y) {
+        for (size_t x = 0; x < side; ++x) {
+            const Vertex v(y * side + x);
+            if (x + 1 < side) graph.add_edge(v, Vertex(y * side + x + 1));
+            if (y + 1 < side) graph.add_edge(v, Vertex((y + 1) * side + x));
+            if (x + 1 < side && y + 1 < side) graph.add_edge(v, Vertex((y + 1) * side + x + 1));
+            for (int k = 0; k < 3; ++k) {
+                const long nx = static_cast<long>(x) + offset(rng), ny = static_cast<long>(y) + offset(rng);
+                if (nx < 0 || ny < 0 || nx >= static_cast<long>(side) || ny >= static_cast<long>(side)) continue;
+                const Vertex u(ny * side + nx);
+                if (u != v && !graph.find_edge(v, u).is_valid()) graph.add_edge(v, u);
+            }
+        }
+    }
+    return graph;
+}
+
+// Sequential first fit coloring in index order, the quality baseline.
+static size_t FirstFitColors(const Graph &graph) {
+    std::vector<int> colors(graph.vertices.size(), -1);
+    std::vector<uint8_t> used;
+    int n_colors = 0;
+    for (const Vertex &v: graph.vertices) {
+        used.assign(graph.get_valence(v) + 1, 0);
+        for (const Halfedge &h: graph.get_halfedges(v)) {
+            const int color = colors[graph.get_vertex(h).idx()];
+            if (color >= 0 && static_cast<size_t>(color) < used.size()) used[color] = 1;
+        }
+        colors[v.idx()] = static_cast<int>(std::ranges::find(used, 0) - used.begin());
+        n_colors = std::max(n_colors, colors[v.idx()] + 1);
+    }
+    return n_colors;
+}
+
+// Colors the vertices of a graph and the vertices, edges and faces of an icosphere for an increasing number of
+// threads, and sweeps a Jacobi free smoothing over the color classes of the sphere vertices. Reports the adjacency as
+// bytes and the elements as items, and prints the number of colors and rounds of every run.
+// Usage: BenchGraphColoring [grid side, default 1000] [json output file]
+int main(int argc, char **argv) {
+    const size_t side = argc > 1 ? std::stoul(argv[1]) : 1000;
+    const std::string json_filename = argc > 2 ? argv[2] : "BenchGraphColoring.json";
+    const int repetitions = 3;
+
+    Graph graph = MakeGraph(side);
+    Mesh sphere = Icosphere(7);
+    std::printf("Graph: %zu vertices, %zu edges; Mesh: %zu vertices, %zu faces\n", graph.n_vertices(),
+                graph.n_edges(), sphere.n_vertices(), sphere.n_faces());
+    std::printf("First fit in index order: %zu colors on the graph\n", FirstFitColors(graph));
+
+    BenchmarkJson json;
+    auto record = [&](const std::string &name, double seconds, size_t bytes, size_t items, unsigned int threads) {
+        BenchmarkReport(name, seconds, bytes, items);
+        json.add("graph_coloring", seconds, bytes, items,
+                 {{"variant", name}, {"elements", std::to_string(items)}, {"threads", std::to_string(threads)}});
+    };
+    auto print_quality = [](const GraphColoring &coloring) {
+        std::printf("%-40s %zu colors, %zu rounds\n", "", coloring.n_colors, coloring.n_rounds);
+    };
+
+    std::vector<unsigned int> thread_counts = {0};
+    for (unsigned int threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    for (const unsigned int threads: thread_counts) {
+        // 0 threads runs the coloring serially without a JobSystem.
+        std::unique_ptr<JobSystem> jobs = threads > 0 ? std::make_unique<JobSystem>(threads) : nullptr;
+        char name[64];
+
+        GraphColoring graph_coloring(graph, jobs.get());
+        double seconds = BenchmarkBestOf(repetitions, [&]() { graph_coloring.compute(); });
+        std::snprintf(name, sizeof(name), "graph vertices threads %u", threads);
+        record(name, seconds, graph.n_edges() * 2 * sizeof(unsigned int), graph.n_vertices(), threads);
+        print_quality(graph_coloring);
+
+        GraphColoring mesh_coloring(sphere, jobs.get());
+        seconds = BenchmarkBestOf(repetitions, [&]() { mesh_coloring.compute_edges(); });
+        std::snprintf(name, sizeof(name), "sphere edges threads %u", threads);
+        record(name, seconds, sphere.n_edges() * 2 * sizeof(unsigned int), sphere.n_edges(), threads);
+        print_quality(mesh_coloring);
+
+        seconds = BenchmarkBestOf(repetitions, [&]() { mesh_coloring.compute_faces(); });
+        std::snprintf(name, sizeof(name), "sphere faces threads %u", threads);
+        record(name, seconds, sphere.n_edges() * 2 * sizeof(unsigned int), sphere.n_faces(), threads);
+        print_quality(mesh_coloring);
+
+        seconds = BenchmarkBestOf(repetitions, [&]() { mesh_coloring.compute(); });
+        std::snprintf(name, sizeof(name), "sphere vertices threads %u", threads);
+        record(name, seconds, sphere.n_edges() * 2 * sizeof(unsigned int), sphere.n_vertices(), threads);
+        print_quality(mesh_coloring);
+
+        // In place Laplacian smoothing, the vertices of one class are not adjacent and can be updated concurrently.
+        auto positions = sphere.get_vertex_property<Vector<Real, 3> >("v:position");
+        seconds = BenchmarkBestOf(repetitions, [&]() {
+            mesh_coloring.sweep(1024, [&](size_t i) {
+                const Vertex v(i);
+                Vector<Real, 3> sum = Vector<Real, 3>::Zero();
+                Real count = 0;
+                for (const Halfedge &h: sphere.get_halfedges(v)) {
+                    sum += positions[sphere.get_vertex(h)];
+                    count += 1;
+                }
+                positions[v] = 0.5f * positions[v] + 0.5f * sum / count;
+            });
+        });
+        std::snprintf(name, sizeof(name), "sphere smoothing sweep threads %u", threads);
+        record(name, seconds, sphere.n_vertices() * sizeof(Vector<Real, 3>), sphere.n_vertices(), threads);
+    }
+
+    if (!json.write(json_filename)) {
+        return 1;
+    }
+    std::printf("Results written to %s\n", json_filename.c_str());
+    return 0;
+}
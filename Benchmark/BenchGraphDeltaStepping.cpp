@@ -0,0 +1,94 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "BenchmarkUtils.h"
+#include "GraphDeltaStepping.h"
+#include "GraphDijkstra.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <memory>
+#include <random>
+#include <thread>
+
+using namespace Bcg;
+
+// Grid graph of side x side vertices with diagonals and jittered positions, weighted by edge lengths like a mesh.
+static Graph MakeGraph(size_t side) {
+    Graph graph;
+    const size_t n = side * side;
+    graph.reserve(n, 3 * n);
+    auto positions = graph.vertex_property<Vector<Real, 3> >("v:position");
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<Real> jitter(-0.3f, 0.3f);
+    for (size_t i = 0; i < n; ++i) {
+        const Vertex v = graph.new_vertex();
+        positions[v] = Vector<Real, 3>(i % side + jitter(rng), i / side + jitter(rng), 0);
+    }
+    for (size_t y = 0; y < side; ++y) {
+        for (size_t x = 0; x < side; ++x) {
+            const Vertex v(y * side + x);
+            if (x + 1 < side) graph.add_edge(v, Vertex(y * side + x + 1));
+            if (y + 1 < side) graph.add_edge(v, Vertex((y + 1) * side + x));
+            if (x + 1 < side && y + 1 < side) graph.add_edge(v, Vertex((y + 1) * side + x + 1));
+        }
+    }
+    return graph;
+}
+
+// Compares Dijkstra with delta-stepping for a few bucket widths and an increasing number of threads.
+// Reports the relaxed halfedges as bytes and the vertices as items.
+// Usage: BenchGraphDeltaStepping [grid side, default 1500] [json output file]
+int main(int argc, char **argv) {
+    const size_t side = argc > 1 ? std::stoul(argv[1]) : 1500;
+    const std::string json_filename = argc > 2 ? argv[2] : "BenchGraphDeltaStepping.json";
+    const int repetitions = 3;
+
+    Graph graph = MakeGraph(side);
+    const EdgeProperty<Real> weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+    const GraphCsr csr(graph, weights);
+    const Vertex source(side / 2 * side + side / 2);
+    const size_t bytes = graph.n_halfedges() * (sizeof(unsigned int) + sizeof(Real));
+    const size_t items = graph.n_vertices();
+    std::printf("Graph: %zu vertices, %zu edges\n", graph.n_vertices(), graph.n_edges());
+
+    BenchmarkJson json;
+    auto record = [&](const std::string &name, double seconds, unsigned int threads) {
+        BenchmarkReport(name, seconds, bytes, items);
+        json.add("graph_sssp", seconds, bytes, items,
+                 {{"variant", name}, {"vertices", std::to_string(items)}, {"threads", std::to_string(threads)}});
+    };
+
+    Dijkstra dijkstra(graph);
+    dijkstra.set_custom_edge_weights(weights);
+    record("dijkstra", BenchmarkBestOf(repetitions, [&]() { dijkstra.compute(source); }), 1);
+    dijkstra.set_csr(&csr);
+    record("dijkstra csr", BenchmarkBestOf(repetitions, [&]() { dijkstra.compute(source); }), 1);
+    const std::vector<Real> expected = dijkstra.vertex_distances.vector();
+
+    std::vector<unsigned int> thread_counts = {0};
+    for (unsigned int threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    for (const unsigned int threads: thread_counts) {
+        // 0 threads runs delta-stepping serially without a JobSystem.
+        std::unique_ptr<JobSystem> jobs = threads > 0 ? std::make_unique<JobSystem>(threads) : nullptr;
+        for (const Real delta: {0.0f, 0.5f, 2.0f, 8.0f}) {
+            DeltaStepping delta_stepping(graph, jobs.get());
+            delta_stepping.set_csr(&csr);
+            delta_stepping.delta = delta;
+            const double seconds = BenchmarkBestOf(repetitions, [&]() { delta_stepping.compute(source); });
+            char name[64];
+            std::snprintf(name, sizeof(name), "delta-stepping delta %g threads %u", delta, threads);
+            record(name, seconds, threads);
+            std::printf("%-40s %zu buckets, %s\n", "", delta_stepping.n_buckets,
+                        delta_stepping.vertex_distances.vector() == expected ? "distances match" : "DISTANCES DIFFER");
+        }
+    }
+
+    if (!json.write(json_filename)) {
+        return 1;
+    }
+    std::printf("Results written to %s\n", json_filename.c_str());
+    return 0;
+}
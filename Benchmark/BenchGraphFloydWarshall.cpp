@@ -0,0 +1,132 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "BenchmarkUtils.h"
+#include "GraphFloydWarshall.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <limits>
+#include <memory>
+#include <random>
+#include <thread>
+
+using namespace Bcg;
+
+// Grid graph of side x side vertices with diagonals and jittered positions, weighted by edge lengths like a mesh.
+static Graph MakeGraph(size_t side) {
+    Graph graph;
+    const size_t n = side * side;
+    graph.reserve(n, 3 * n);
+    auto positions = graph.vertex_property<Vector<Real, 3> >("v:position");
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<Real> jitter(-0.3f, 0.3f);
+    for (size_t i = 0; i < n; ++i) {
+        const Vertex v = graph.new_vertex();
+        positions[v] = Vector<Real, 3>(i % side + jitter(rng), i / side + jitter(rng), 0);
+    }
+    for (size_t y = 0; y < side; ++y) {
+        for (size_t x = 0; x < side; ++x) {
+            const Vertex v(y * side + x);
+            if (x + 1 < side) graph.add_edge(v, Vertex(y * side + x + 1));
+            if (y + 1 < side) graph.add_edge(v, Vertex((y + 1) * side + x));
+            if (x + 1 < side && y + 1 < side) graph.add_edge(v, Vertex((y + 1) * side + x + 1));
+        }
+    }
+    return graph;
+}
+
+// The textbook triple loop with predecessors that FloydWarshall used before the tiling, as the naive reference.
+static Matrix<Real, -1, -1> NaiveFloydWarshall(Graph &graph, const EdgeProperty<Real> &weights) {
+    const long n = graph.n_vertices();
+    const Real unreachable = std::numeric_limits<Real>::max();
+    Matrix<Real, -1, -1> distances = Matrix<Real, -1, -1>::Constant(n, n, unreachable);
+    Matrix<Halfedge, -1, -1> predecessors = Matrix<Halfedge, -1, -1>::Constant(n, n, Halfedge());
+    distances.diagonal().setConstant(0);
+    for (const Edge e: graph.edges) {
+        const Halfedge h = graph.get_halfedge(e, 0);
+        const long i = graph.get_vertex(graph.get_opposite(h)).idx();
+        const long j = graph.get_vertex(h).idx();
+        distances(i, j) = distances(j, i) = weights[e];
+        predecessors(i, j) = graph.get_opposite(h);
+        predecessors(j, i) = h;
+    }
+    for (long k = 0; k < n; k++) {
+        for (long i = 0; i < n; i++) {
+            if (distances(i, k) == unreachable) continue;
+            for (long j = 0; j < n; j++) {
+                if (distances(k, j) == unreachable) continue;
+                const Real new_distance = distances(i, k) + distances(k, j);
+                if (new_distance < distances(i, j)) {
+                    distances(i, j) = new_distance;
+                    predecessors(i, j) = predecessors(k, j);
+                }
+            }
+        }
+    }
+    return distances;
+}
+
+// Compares the naive triple loop and the untiled loop order (one tile covering the whole matrix) with tiled updates,
+// with and without predecessors and for an increasing number of threads. Reports the matrix as bytes and the n^3
+// relaxations as items. A grid side of 100 gives 10k vertices; use a single repetition there.
+// Usage: BenchGraphFloydWarshall [grid side, default 40] [json output file] [repetitions, default 3]
+int main(int argc, char **argv) {
+    const size_t side = argc > 1 ? std::stoul(argv[1]) : 40;
+    const std::string json_filename = argc > 2 ? argv[2] : "BenchGraphFloydWarshall.json";
+    const int repetitions = argc > 3 ? std::stoi(argv[3]) : 3;
+
+    Graph graph = MakeGraph(side);
+    const EdgeProperty<Real> weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+    const size_t n = graph.n_vertices();
+    const size_t bytes = n * n * sizeof(Real);
+    const size_t items = n * n * n;
+    std::printf("Graph: %zu vertices, %zu edges\n", n, graph.n_edges());
+
+    BenchmarkJson json;
+    auto record = [&](const std::string &name, double seconds, unsigned int threads) {
+        BenchmarkReport(name, seconds, bytes, items);
+        json.add("graph_all_pairs", seconds, bytes, items,
+                 {{"variant", name}, {"vertices", std::to_string(n)}, {"threads", std::to_string(threads)}});
+    };
+
+    Matrix<Real, -1, -1> expected;
+    record("naive", BenchmarkBestOf(repetitions, [&]() { expected = NaiveFloydWarshall(graph, weights); }), 1);
+    {
+        FloydWarshall floyd_warshall(graph);
+        floyd_warshall.set_custom_edge_weights(weights);
+        floyd_warshall.block_size = n;
+        record("untiled", BenchmarkBestOf(repetitions, [&]() { floyd_warshall.compute(); }), 1);
+        std::printf("%-40s %s\n", "", floyd_warshall.vertex_vertex_distances.isApprox(expected)
+                                          ? "distances match"
+                                          : "DISTANCES DIFFER");
+    }
+
+    std::vector<unsigned int> thread_counts = {0};
+    for (unsigned int threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    for (const unsigned int threads: thread_counts) {
+        // 0 threads updates the tiles serially without a JobSystem.
+        std::unique_ptr<JobSystem> jobs = threads > 0 ? std::make_unique<JobSystem>(threads) : nullptr;
+        for (const bool predecessors: {true, false}) {
+            FloydWarshall floyd_warshall(graph, jobs.get());
+            floyd_warshall.set_custom_edge_weights(weights);
+            floyd_warshall.compute_predecessors = predecessors;
+            const double seconds = BenchmarkBestOf(repetitions, [&]() { floyd_warshall.compute(); });
+            char name[64];
+            std::snprintf(name, sizeof(name), "tiled %zu%s threads %u", floyd_warshall.block_size,
+                          predecessors ? " predecessors" : "", threads);
+            record(name, seconds, threads);
+            std::printf("%-40s %s\n", "", floyd_warshall.vertex_vertex_distances.isApprox(expected)
+                                              ? "distances match"
+                                              : "DISTANCES DIFFER");
+        }
+    }
+
+    if (!json.write(json_filename)) {
+        return 1;
+    }
+    std::printf("Results written to %s\n", json_filename.c_str());
+    return 0;
+}
@@ -0,0 +1,85 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "BenchmarkUtils.h"
+#include "GraphPartitioner.h"
+#include "JobSystem.h"
+#include "MeshShapes.h"
+#include <memory>
+#include <thread>
+
+using namespace Bcg;
+
+// Grid graph of side x side vertices with diagonals, the typical adjacency of a triangulated height field.
+static Graph MakeGraph(size_t side) {
+    Graph graph;
+    const size_t n = side * side;
+    graph.reserve(n, 3 * n);
+    for (size_t i = 0; i < n; ++i) {
+        graph.new_vertex();
+    }
+    for (size_t y = 0; y < side; ++y) {
+        for (size_t x = 0; x < side; ++x) {
+            const Vertex v(y * side + x);
+            if (x + 1 < side) graph.add_edge(v, Vertex(y * side + x + 1));
+            if (y + 1 < side) graph.add_edge(v, Vertex((y + 1) * side + x));
+            if (x + 1 < side && y + 1 < side) graph.add_edge(v, Vertex((y + 1) * side + x + 1));
+        }
+    }
+    return graph;
+}
+
+// Partitions the vertices of a grid graph and the faces of an icosphere for an increasing number of threads and
+// reports the cut and the imbalance of every run. Reports the edges as bytes and the elements as items.
+// A grid side of 3163 gives 10M vertices; use a single repetition there.
+// Usage: BenchGraphPartitioner [grid side, default 1000] [number of parts, default 16] [json output file]
+//                              [repetitions, default 3]
+int main(int argc, char **argv) {
+    const size_t side = argc > 1 ? std::stoul(argv[1]) : 1000;
+    const size_t n_parts = argc > 2 ? std::stoul(argv[2]) : 16;
+    const std::string json_filename = argc > 3 ? argv[3] : "BenchGraphPartitioner.json";
+    const int repetitions = argc > 4 ? std::stoi(argv[4]) : 3;
+
+    Graph graph = MakeGraph(side);
+    Mesh sphere = Icosphere(7);
+    std::printf("Graph: %zu vertices, %zu edges; Mesh: %zu faces; %zu parts\n", graph.n_vertices(), graph.n_edges(),
+                sphere.n_faces(), n_parts);
+
+    BenchmarkJson json;
+    auto record = [&](const std::string &name, double seconds, size_t bytes, size_t items, unsigned int threads,
+                      const GraphPartitioner &partitioner) {
+        BenchmarkReport(name, seconds, bytes, items);
+        json.add("graph_partition", seconds, bytes, items,
+                 {{"variant", name}, {"elements", std::to_string(items)}, {"threads", std::to_string(threads)}});
+        std::printf("%-40s %zu cut edges, imbalance %.3f\n", "", partitioner.n_cut_edges, partitioner.imbalance);
+    };
+
+    std::vector<unsigned int> thread_counts = {0};
+    for (unsigned int threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    for (const unsigned int threads: thread_counts) {
+        // 0 threads runs the partitioner serially without a JobSystem.
+        std::unique_ptr<JobSystem> jobs = threads > 0 ? std::make_unique<JobSystem>(threads) : nullptr;
+        char name[64];
+
+        GraphPartitioner graph_partitioner(graph, jobs.get());
+        double seconds = BenchmarkBestOf(repetitions, [&]() { graph_partitioner.compute(n_parts); });
+        std::snprintf(name, sizeof(name), "grid vertices threads %u", threads);
+        record(name, seconds, graph.n_edges() * 2 * sizeof(unsigned int), graph.n_vertices(), threads,
+               graph_partitioner);
+
+        GraphPartitioner mesh_partitioner(sphere, jobs.get());
+        seconds = BenchmarkBestOf(repetitions, [&]() { mesh_partitioner.compute_faces(n_parts); });
+        std::snprintf(name, sizeof(name), "sphere faces threads %u", threads);
+        record(name, seconds, sphere.n_edges() * 2 * sizeof(unsigned int), sphere.n_faces(), threads,
+               mesh_partitioner);
+    }
+
+    if (!json.write(json_filename)) {
+        return 1;
+    }
+    std::printf("Results written to %s\n", json_filename.c_str());
+    return 0;
+}
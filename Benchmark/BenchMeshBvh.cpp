@@ -0,0 +1,128 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "BenchmarkUtils.h"
+#include "JobSystem.h"
+#include "MeshBvh.h"
+#include "MeshShapes.h"
+#include "Eigen/Geometry"
+#include <memory>
+#include <random>
+#include <thread>
+
+using namespace Bcg;
+
+// Rays from random points around the unit sphere towards random points inside it.
+static std::vector<MeshBvh::Ray> RandomRays(size_t n) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<Real> uniform(-1, 1);
+    std::vector<MeshBvh::Ray> rays(n);
+    for (MeshBvh::Ray &ray: rays) {
+        ray.origin = 3 * Vector<Real, 3>(uniform(rng), uniform(rng), uniform(rng));
+        ray.direction = Vector<Real, 3>(uniform(rng), uniform(rng), uniform(rng)) - ray.origin;
+    }
+    return rays;
+}
+
+// The closest hits of the rays by testing every face, the baseline for the queries.
+static size_t BruteForceHits(const Mesh &mesh, const std::vector<MeshBvh::Ray> &rays) {
+    const auto positions = mesh.get_vertex_property<Vector<Real, 3> >("v:position");
+    size_t n_hits = 0;
+    for (const MeshBvh::Ray &ray: rays) {
+        Real closest = ray.t_max;
+        for (const Face &f: mesh.faces) {
+            Vector<Real, 3> corners[3];
+            size_t i = 0;
+            for (const Vertex &v: mesh.get_vertices(f)) {
+                corners[i++] = positions[v];
+            }
+            const Vector<Real, 3> ab = corners[1] - corners[0], ac = corners[2] - corners[0];
+            const Vector<Real, 3> p = ray.direction.cross(ac), s = ray.origin - corners[0], q = s.cross(ab);
+            const Real determinant = ab.dot(p);
+            const Real u = s.dot(p) / determinant, v = ray.direction.dot(q) / determinant;
+            const Real t = ac.dot(q) / determinant;
+            if (u >= 0 && v >= 0 && u + v <= 1 && t >= ray.t_min && t < closest) closest = t;
+        }
+        n_hits += closest < ray.t_max;
+    }
+    return n_hits;
+}
+
+// Builds the hierarchy over an icosphere and casts closest hit and shadow rays and finds closest points, for an
+// increasing number of threads. Brute force over all faces runs on a few rays as the baseline. Reports the nodes as
+// bytes and the faces or queries as items.
+// Usage: BenchMeshBvh [icosphere subdivisions, default 7] [queries, default 1000000] [json output file]
+int main(int argc, char **argv) {
+    const size_t subdivisions = argc > 1 ? std::stoul(argv[1]) : 7;
+    const size_t n_queries = argc > 2 ? std::stoul(argv[2]) : 1000000;
+    const std::string json_filename = argc > 3 ? argv[3] : "BenchMeshBvh.json";
+    const int repetitions = 3;
+
+    Mesh sphere = Icosphere(subdivisions);
+    std::printf("Mesh: %zu vertices, %zu faces, %zu queries\n", sphere.n_vertices(), sphere.n_faces(), n_queries);
+    const std::vector<MeshBvh::Ray> rays = RandomRays(n_queries);
+    std::vector<MeshBvh::Ray> shadow_rays = rays;
+    for (MeshBvh::Ray &ray: shadow_rays) {
+        ray.t_max = 0.5f;
+    }
+    // Points near the surface, as when projecting a scan or a second mesh onto it.
+    std::vector<Vector<Real, 3> > points(n_queries);
+    for (size_t i = 0; i < n_queries; ++i) {
+        const Real scale = Real(0.9) + Real(0.2) * static_cast<Real>(i % 101) / 100;
+        points[i] = scale * rays[i].origin.normalized();
+    }
+
+    BenchmarkJson json;
+    auto record = [&](const std::string &name, double seconds, size_t bytes, size_t items, unsigned int threads) {
+        BenchmarkReport(name, seconds, bytes, items);
+        json.add("mesh_bvh", seconds, bytes, items,
+                 {{"variant", name}, {"elements", std::to_string(items)}, {"threads", std::to_string(threads)}});
+    };
+
+    // Brute force costs all faces per ray, so it only runs on a few rays and is scaled to all of them.
+    const std::vector<MeshBvh::Ray> brute_rays(rays.begin(), rays.begin() + std::min<size_t>(n_queries, 100));
+    const double brute_seconds = BenchmarkBestOf(1, [&]() { BruteForceHits(sphere, brute_rays); });
+    record("brute force rays (extrapolated)", brute_seconds * n_queries / brute_rays.size(), 0, n_queries, 0);
+
+    std::vector<unsigned int> thread_counts = {0};
+    for (unsigned int threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    for (const unsigned int threads: thread_counts) {
+        // 0 threads builds and queries serially without a JobSystem.
+        std::unique_ptr<JobSystem> jobs = threads > 0 ? std::make_unique<JobSystem>(threads) : nullptr;
+        MeshBvh bvh(sphere, jobs.get());
+        char name[64];
+        double seconds = BenchmarkBestOf(repetitions, [&]() { bvh.build(); });
+        const size_t bytes = bvh.nodes.size() * sizeof(MeshBvh::Node);
+        std::snprintf(name, sizeof(name), "build threads %u", threads);
+        record(name, seconds, bytes, sphere.n_faces(), threads);
+
+        std::vector<MeshBvh::Hit> hits;
+        seconds = BenchmarkBestOf(repetitions, [&]() { bvh.intersect(rays, hits); });
+        std::snprintf(name, sizeof(name), "closest hit threads %u", threads);
+        record(name, seconds, bytes, n_queries, threads);
+        const size_t n_hits = std::count_if(hits.begin(), hits.end(), [](const MeshBvh::Hit &hit) {
+            return hit.f.is_valid();
+        });
+
+        std::vector<uint8_t> occluded;
+        seconds = BenchmarkBestOf(repetitions, [&]() { bvh.occluded(shadow_rays, occluded); });
+        std::snprintf(name, sizeof(name), "any hit threads %u", threads);
+        record(name, seconds, bytes, n_queries, threads);
+
+        std::vector<MeshBvh::ClosestPoint> closest;
+        seconds = BenchmarkBestOf(repetitions, [&]() { bvh.closest_points(points, closest); });
+        std::snprintf(name, sizeof(name), "closest point threads %u", threads);
+        record(name, seconds, bytes, n_queries, threads);
+        std::printf("%-40s %zu nodes, %zu hits, %zu occluded\n", "", bvh.nodes.size(), n_hits,
+                    static_cast<size_t>(std::count(occluded.begin(), occluded.end(), 1)));
+    }
+
+    if (!json.write(json_filename)) {
+        return 1;
+    }
+    std::printf("Results written to %s\n", json_filename.c_str());
+    return 0;
+}
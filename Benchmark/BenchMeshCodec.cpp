@@ -0,0 +1,45 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "BenchmarkUtils.h"
+#include "MeshCodec.h"
+#include "MeshShapes.h"
+#include <filesystem>
+
+using namespace Bcg;
+
+// Encodes and decodes icospheres of increasing size and compares the decode time against re-parsing the same mesh
+// from ascii OFF, PLY and OBJ files.
+int main(int argc, char **argv) {
+    const int max_level = argc > 1 ? std::stoi(argv[1]) : 7;
+    const int repetitions = 3;
+    for (int level = 4; level <= max_level; ++level) {
+        const Mesh mesh = Icosphere(level);
+        std::printf("Icosphere(%d): %zu vertices, %zu faces\n", level, mesh.n_vertices(), mesh.n_faces());
+
+        std::vector<uint8_t> data;
+        double seconds = BenchmarkBestOf(repetitions, [&]() { data = EncodeMesh(mesh); });
+        BenchmarkReport("encode bcm", seconds, data.size(), mesh.n_faces());
+
+        Mesh decoded;
+        const double decode_seconds = BenchmarkBestOf(repetitions, [&]() {
+            DecodeMesh(data.data(), data.size(), decoded);
+        });
+        BenchmarkReport("decode bcm", decode_seconds, data.size(), mesh.n_faces());
+
+        for (const std::string filename: {"bench_codec.off", "bench_codec.ply", "bench_codec.obj"}) {
+            MeshIoManager(filename).write(mesh, MeshIo::WriteFlags());
+            const size_t bytes = std::filesystem::file_size(filename);
+            seconds = BenchmarkBestOf(repetitions, [&]() {
+                Mesh parsed;
+                MeshIoManager(filename).read(parsed);
+            });
+            BenchmarkReport("parse " + filename, seconds, bytes, mesh.n_faces());
+            std::printf("%-40s %10.1fx smaller %7.1fx faster decode\n", "", static_cast<double>(bytes) / data.size(),
+                        seconds / decode_seconds);
+            std::filesystem::remove(filename);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,85 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "BenchmarkUtils.h"
+#include "GraphDijkstra.h"
+#include "JobSystem.h"
+#include "MeshFastIterative.h"
+#include "MeshShapes.h"
+#include <memory>
+#include <thread>
+
+using namespace Bcg;
+
+// Mean relative error of the distances from the source to the great circle distances on the unit sphere.
+static double MeanRelativeError(const Mesh &sphere, const Vertex &source, const std::vector<Real> &distances) {
+    const auto positions = sphere.get_vertex_property<Vector<Real, 3> >("v:position");
+    const Vector<double, 3> s = positions[source].cast<double>().normalized();
+    double error = 0;
+    size_t count = 0;
+    for (const Vertex &v: sphere.vertices) {
+        const double exact = std::acos(std::clamp(s.dot(positions[v].cast<double>().normalized()), -1.0, 1.0));
+        if (exact < 0.1) continue;
+        error += std::abs(distances[v.idx()] - exact) / exact;
+        ++count;
+    }
+    return error / count;
+}
+
+// Compares the Fast Iterative Method with Dijkstra on edge lengths on an icosphere, in the mean relative error to the
+// exact great circle distances and in time for an increasing number of threads. The corners are built once per thread
+// count and timed separately, like the edge lengths which Dijkstra keeps across computes. The time of every thread
+// count is also printed relative to the serial Dijkstra time. Reports the vertices as items.
+// Usage: BenchMeshFastIterative [icosphere subdivisions, default 7] [json output file]
+//                               [max threads, default hardware concurrency]
+int main(int argc, char **argv) {
+    const size_t subdivisions = argc > 1 ? std::stoul(argv[1]) : 7;
+    const std::string json_filename = argc > 2 ? argv[2] : "BenchMeshFastIterative.json";
+    const unsigned int max_threads = argc > 3 ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+    const int repetitions = 3;
+
+    Mesh sphere = Icosphere(subdivisions);
+    const Vertex source(0);
+    const size_t items = sphere.n_vertices();
+    const size_t bytes = sphere.n_edges() * 2 * sizeof(unsigned int);
+    std::printf("Mesh: %zu vertices, %zu faces\n", sphere.n_vertices(), sphere.n_faces());
+
+    BenchmarkJson json;
+    auto record = [&](const std::string &name, double seconds, unsigned int threads) {
+        BenchmarkReport(name, seconds, bytes, items);
+        json.add("mesh_eikonal", seconds, bytes, items,
+                 {{"variant", name}, {"vertices", std::to_string(items)}, {"threads", std::to_string(threads)}});
+    };
+
+    Dijkstra dijkstra(sphere);
+    const double dijkstra_seconds = BenchmarkBestOf(repetitions, [&]() { dijkstra.compute(source); });
+    record("dijkstra", dijkstra_seconds, 1);
+    std::printf("%-40s mean relative error %.4f\n", "",
+                MeanRelativeError(sphere, source, dijkstra.vertex_distances.vector()));
+
+    std::vector<unsigned int> thread_counts = {0};
+    for (unsigned int threads = 1; threads <= max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    for (const unsigned int threads: thread_counts) {
+        // 0 threads runs the solver serially without a JobSystem.
+        std::unique_ptr<JobSystem> jobs = threads > 0 ? std::make_unique<JobSystem>(threads) : nullptr;
+        FastIterativeMethod fim(sphere, jobs.get());
+        char name[64];
+        std::snprintf(name, sizeof(name), "fim corners threads %u", threads);
+        record(name, BenchmarkBestOf(repetitions, [&]() { fim.build_corners(); }), threads);
+        std::snprintf(name, sizeof(name), "fim threads %u", threads);
+        const double seconds = BenchmarkBestOf(repetitions, [&]() { fim.compute(source); });
+        record(name, seconds, threads);
+        std::printf("%-40s mean relative error %.4f, %zu iterations, %.2f updates per vertex, %.2fx dijkstra time\n",
+                    "", MeanRelativeError(sphere, source, fim.vertex_distances.vector()), fim.n_iterations,
+                    static_cast<double>(fim.n_updates) / static_cast<double>(items), seconds / dijkstra_seconds);
+    }
+
+    if (!json.write(json_filename)) {
+        return 1;
+    }
+    std::printf("Results written to %s\n", json_filename.c_str());
+    return 0;
+}
@@ -0,0 +1,73 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "BenchmarkUtils.h"
+#include "GraphDijkstra.h"
+#include "JobSystem.h"
+#include "MeshHeatGeodesics.h"
+#include "MeshShapes.h"
+#include <memory>
+#include <thread>
+
+using namespace Bcg;
+
+// Compares the heat method with Dijkstra on edge lengths on an icosphere: the factorization once, a single source
+// query, and a batch of sources for an increasing number of threads. Reports the vertices as items.
+// Usage: BenchMeshHeatGeodesics [icosphere subdivisions, default 6] [number of sources, default 32] [json output file]
+int main(int argc, char **argv) {
+    const size_t subdivisions = argc > 1 ? std::stoul(argv[1]) : 6;
+    const size_t n_sources = argc > 2 ? std::stoul(argv[2]) : 32;
+    const std::string json_filename = argc > 3 ? argv[3] : "BenchMeshHeatGeodesics.json";
+    const int repetitions = 3;
+
+    Mesh sphere = Icosphere(subdivisions);
+    const size_t items = sphere.n_vertices();
+    const size_t bytes = sphere.n_edges() * 2 * sizeof(unsigned int);
+    std::vector<Vertex> sources;
+    for (size_t i = 0; i < n_sources; ++i) {
+        sources.emplace_back(i * sphere.vertices.size() / n_sources);
+    }
+    std::printf("Mesh: %zu vertices, %zu faces; %zu sources\n", sphere.n_vertices(), sphere.n_faces(), n_sources);
+
+    BenchmarkJson json;
+    auto record = [&](const std::string &name, double seconds, size_t n_items, unsigned int threads) {
+        BenchmarkReport(name, seconds, bytes, n_items);
+        json.add("mesh_geodesics", seconds, bytes, n_items,
+                 {{"variant", name}, {"vertices", std::to_string(items)}, {"threads", std::to_string(threads)}});
+    };
+
+    Dijkstra dijkstra(sphere);
+    record("dijkstra single source", BenchmarkBestOf(repetitions, [&]() { dijkstra.compute(sources[0]); }), items, 1);
+    record("dijkstra batch", BenchmarkBestOf(repetitions, [&]() {
+        for (const Vertex &source: sources) {
+            dijkstra.compute(source);
+        }
+    }), items * n_sources, 1);
+
+    std::vector<unsigned int> thread_counts = {0};
+    for (unsigned int threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    for (const unsigned int threads: thread_counts) {
+        // 0 threads runs the heat method serially without a JobSystem.
+        std::unique_ptr<JobSystem> jobs = threads > 0 ? std::make_unique<JobSystem>(threads) : nullptr;
+        HeatGeodesics geodesics(sphere, jobs.get());
+        char name[64];
+        std::snprintf(name, sizeof(name), "heat factor threads %u", threads);
+        record(name, BenchmarkBestOf(repetitions, [&]() { geodesics.factor(); }), items, threads);
+        std::snprintf(name, sizeof(name), "heat single source threads %u", threads);
+        record(name, BenchmarkBestOf(repetitions, [&]() { geodesics.compute(sources[0]); }), items, threads);
+        std::snprintf(name, sizeof(name), "heat batch threads %u", threads);
+        record(name, BenchmarkBestOf(repetitions, [&]() {
+            geodesics.compute(sources, [](const Vertex &, const std::vector<Real> &) {
+            });
+        }), items * n_sources, threads);
+    }
+
+    if (!json.write(json_filename)) {
+        return 1;
+    }
+    std::printf("Results written to %s\n", json_filename.c_str());
+    return 0;
+}
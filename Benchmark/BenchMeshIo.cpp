@@ -0,0 +1,117 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "BenchmarkUtils.h"
+#include "MeshCodec.h"
+#include "MeshShapes.h"
+#include "MeshUtils.h"
+#include "JobSystem.h"
+#include <filesystem>
+#include <functional>
+
+using namespace Bcg;
+
+struct MeshIoBenchFormat {
+    std::string extension;
+    bool as_binary;
+};
+
+// Writes and reads large procedural meshes in every supported format and reports MB/s and faces/s. Reads are timed
+// with a warm page cache (the file was just read) and with a cold one (the file is evicted before every read).
+// Usage: BenchMeshIo [icosphere level] [plane resolution] [json output file]
+int main(int argc, char **argv) {
+    const int level = argc > 1 ? std::stoi(argv[1]) : 7;
+    const size_t resolution = argc > 2 ? std::stoul(argv[2]) : 512;
+    const std::string json_filename = argc > 3 ? argv[3] : "BenchMeshIo.json";
+    const int repetitions = 3;
+
+    const std::vector<MeshIoBenchFormat> formats = {
+        {".off", false}, {".off", true}, {".obj", false}, {".ply", false}, {".ply", true},
+        {".stl", false}, {".stl", true}, {".bcm", true}
+    };
+
+    JobSystem jobs;
+    BenchmarkJson json;
+    const std::vector<std::pair<std::string, std::function<Mesh()> > > inputs = {
+        {"Icosphere(" + std::to_string(level) + ")", [level]() { return Icosphere(level); }},
+        {"Plane(" + std::to_string(resolution) + ")", [resolution]() { return Plane(resolution); }}
+    };
+
+    for (const auto &[input_name, make_input]: inputs) {
+        Mesh mesh = make_input();
+        const bool triangles = mesh.is_triangle_mesh();
+        if (triangles) {
+            auto positions = mesh.get_vertex_property<Vector<Real, 3> >("v:position");
+            auto face_normals = mesh.face_property<Vector<Real, 3> >("f:normal");
+            for (const auto &f: mesh.faces) {
+                face_normals[f] = FaceNormal(mesh, positions, f);
+            }
+        }
+        std::printf("%s: %zu vertices, %zu faces\n", input_name.c_str(), mesh.n_vertices(), mesh.n_faces());
+        const size_t n_faces = mesh.n_faces();
+
+        for (const auto &format: formats) {
+            if (format.extension == ".stl" && !triangles) {
+                continue;
+            }
+            const std::string filename = "bench_mesh_io" + format.extension;
+            const std::string label = format.extension.substr(1) + (format.as_binary ? " binary" : " ascii");
+            auto record = [&](const std::string &operation, const std::string &cache, double seconds, size_t bytes) {
+                BenchmarkReport(label + " " + operation + (cache.empty() ? "" : " (" + cache + ")"), seconds, bytes,
+                                n_faces);
+                json.add("mesh_io", seconds, bytes, n_faces,
+                         {{"input", input_name}, {"format", format.extension.substr(1)},
+                          {"encoding", format.as_binary ? "binary" : "ascii"}, {"operation", operation},
+                          {"cache", cache}});
+            };
+
+            MeshIo::WriteFlags flags;
+            flags.as_binary = format.as_binary;
+            bool ok = true;
+            double seconds = BenchmarkBestOf(repetitions, [&]() { ok &= MeshIoManager(filename).write(mesh, flags); });
+            if (!ok) {
+                std::printf("%s: write failed, skipped\n", label.c_str());
+                std::filesystem::remove(filename);
+                continue;
+            }
+            const size_t bytes = std::filesystem::file_size(filename);
+            record("write", "", seconds, bytes);
+
+            if (!format.as_binary && format.extension != ".stl") {
+                flags.jobs = &jobs;
+                seconds = BenchmarkBestOf(repetitions, [&]() { MeshIoManager(filename).write(mesh, flags); });
+                record("write parallel", "", seconds, bytes);
+            }
+
+            auto read = [&]() {
+                Mesh loaded;
+                ok &= MeshIoManager(filename).read(loaded);
+            };
+            read();
+            seconds = BenchmarkBestOf(repetitions, read);
+            record("read", "warm", seconds, bytes);
+
+            if (BenchmarkDropFromPageCache(filename)) {
+                seconds = std::numeric_limits<double>::max();
+                for (int i = 0; i < repetitions; ++i) {
+                    BenchmarkDropFromPageCache(filename);
+                    BenchmarkTimer timer;
+                    read();
+                    seconds = std::min(seconds, timer.seconds());
+                }
+                record("read", "cold", seconds, bytes);
+            }
+            if (!ok) {
+                std::printf("%s: read failed\n", label.c_str());
+            }
+            std::filesystem::remove(filename);
+        }
+    }
+
+    if (!json.write(json_filename)) {
+        return 1;
+    }
+    std::printf("Results written to %s\n", json_filename.c_str());
+    return 0;
+}
@@ -0,0 +1,144 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "BenchmarkUtils.h"
+#include "JobSystem.h"
+#include "PointCloudKdTree.h"
+#include <cmath>
+#include <memory>
+#include <random>
+#include <thread>
+
+using namespace Bcg;
+
+// Random points in the unit cube.
+static PointCloud MakeCloud(size_t n) {
+    PointCloud cloud;
+    cloud.reserve(n);
+    auto positions = cloud.vertex_property<Vector<Real, 3> >("v:position");
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<Real> uniform(0, 1);
+    for (size_t i = 0; i < n; ++i) {
+        add_vertex(cloud.vertices, positions, Vector<Real, 3>(uniform(rng), uniform(rng), uniform(rng)));
+    }
+    return cloud;
+}
+
+// The k nearest neighbors of the query points by brute force, the baseline for the kNN queries.
+static size_t BruteForceKnn(const PointCloud &cloud, const std::vector<Vector<Real, 3> > &points, size_t k) {
+    const auto positions = cloud.get_vertex_property<Vector<Real, 3> >("v:position");
+    const size_t n = cloud.vertices.size();
+    std::vector<std::pair<Real, uint32_t> > candidates(n);
+    size_t checksum = 0;
+    for (const Vector<Real, 3> &point: points) {
+        for (size_t j = 0; j < n; ++j) {
+            candidates[j] = {(positions[Vertex(j)] - point).squaredNorm(), static_cast<uint32_t>(j)};
+        }
+        std::nth_element(candidates.begin(), candidates.begin() + k - 1, candidates.end());
+        checksum += candidates[k - 1].second;
+    }
+    return checksum;
+}
+
+// The number of points within the radius of the query points by brute force, the baseline for the radius queries.
+static size_t BruteForceRadius(const PointCloud &cloud, const std::vector<Vector<Real, 3> > &points, Real radius) {
+    const auto positions = cloud.get_vertex_property<Vector<Real, 3> >("v:position");
+    size_t count = 0;
+    for (const Vector<Real, 3> &point: points) {
+        for (const Vertex &v: cloud.vertices) {
+            count += (positions[v] - point).squaredNorm() <= radius * radius;
+        }
+    }
+    return count;
+}
+
+// Builds the tree over random points in a cube and runs kNN, radius and box queries at random points, for an
+// increasing number of threads. The radius and the boxes hold about k points on average. Brute force over all points
+// runs on a few queries as the baseline. Reports the positions as bytes and the points or queries as items.
+// Usage: BenchPointCloudKdTree [points, default 1000000] [queries, default 1000000] [k, default 10] [json output file]
+int main(int argc, char **argv) {
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const size_t n_queries = argc > 2 ? std::stoul(argv[2]) : 1000000;
+    const size_t k = std::max<size_t>(1, argc > 3 ? std::stoul(argv[3]) : 10);
+    const std::string json_filename = argc > 4 ? argv[4] : "BenchPointCloudKdTree.json";
+    const int repetitions = 3;
+
+    const PointCloud cloud = MakeCloud(n);
+    std::printf("Cloud: %zu points, %zu queries, k = %zu\n", n, n_queries, k);
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<Real> uniform(0, 1);
+    std::vector<Vector<Real, 3> > points(n_queries);
+    for (Vector<Real, 3> &point: points) {
+        point = Vector<Real, 3>(uniform(rng), uniform(rng), uniform(rng));
+    }
+    // The sphere and the cube around a query point which hold k points on average.
+    const Real radius = std::cbrt(Real(3) * k / (Real(4) * Real(M_PI) * n));
+    const Real half = Real(0.5) * std::cbrt(static_cast<Real>(k) / n);
+    std::vector<AABB<Real, 3> > boxes;
+    boxes.reserve(n_queries);
+    for (const Vector<Real, 3> &point: points) {
+        boxes.emplace_back(point - Vector<Real, 3>::Constant(half), point + Vector<Real, 3>::Constant(half));
+    }
+
+    BenchmarkJson json;
+    auto record = [&](const std::string &name, double seconds, size_t items, unsigned int threads) {
+        const size_t bytes = n * sizeof(Vector<Real, 3>);
+        BenchmarkReport(name, seconds, bytes, items);
+        json.add("pointcloud_kdtree", seconds, bytes, items,
+                 {{"variant", name}, {"elements", std::to_string(items)}, {"threads", std::to_string(threads)}});
+    };
+
+    // Brute force costs all points per query, so it only runs on a few queries and is scaled to all of them.
+    const std::vector<Vector<Real, 3> > brute_points(points.begin(),
+                                                     points.begin() + std::min<size_t>(n_queries, 100));
+    double seconds = BenchmarkBestOf(1, [&]() { BruteForceKnn(cloud, brute_points, std::min(k, n)); });
+    record("brute force knn (extrapolated)", seconds * n_queries / brute_points.size(), n_queries, 0);
+    seconds = BenchmarkBestOf(1, [&]() { BruteForceRadius(cloud, brute_points, radius); });
+    record("brute force radius (extrapolated)", seconds * n_queries / brute_points.size(), n_queries, 0);
+
+    std::vector<unsigned int> thread_counts = {0};
+    for (unsigned int threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    for (const unsigned int threads: thread_counts) {
+        // 0 threads builds and queries serially without a JobSystem.
+        std::unique_ptr<JobSystem> jobs = threads > 0 ? std::make_unique<JobSystem>(threads) : nullptr;
+        KdTree tree(cloud, jobs.get());
+        char name[64];
+        seconds = BenchmarkBestOf(repetitions, [&]() { tree.build(); });
+        std::snprintf(name, sizeof(name), "build threads %u", threads);
+        record(name, seconds, n, threads);
+
+        std::vector<KdTree::Neighbor> neighbors;
+        for (const size_t count: {size_t(1), k}) {
+            seconds = BenchmarkBestOf(repetitions, [&]() { tree.knn_query(points, count, neighbors); });
+            std::snprintf(name, sizeof(name), "knn %zu threads %u", count, threads);
+            record(name, seconds, n_queries, threads);
+        }
+
+        std::vector<std::vector<KdTree::Neighbor> > in_radius;
+        seconds = BenchmarkBestOf(repetitions, [&]() { tree.radius_query(points, radius, in_radius); });
+        std::snprintf(name, sizeof(name), "radius threads %u", threads);
+        record(name, seconds, n_queries, threads);
+
+        std::vector<std::vector<Vertex> > in_box;
+        seconds = BenchmarkBestOf(repetitions, [&]() { tree.box_query(boxes, in_box); });
+        std::snprintf(name, sizeof(name), "box threads %u", threads);
+        record(name, seconds, n_queries, threads);
+
+        size_t n_radius = 0, n_box = 0;
+        for (size_t i = 0; i < n_queries; ++i) {
+            n_radius += in_radius[i].size();
+            n_box += in_box[i].size();
+        }
+        std::printf("%-40s %zu nodes, %.2f points per radius, %.2f per box\n", "", tree.nodes.size(),
+                    static_cast<double>(n_radius) / n_queries, static_cast<double>(n_box) / n_queries);
+    }
+
+    if (!json.write(json_filename)) {
+        return 1;
+    }
+    std::printf("Results written to %s\n", json_filename.c_str());
+    return 0;
+}
@@ -0,0 +1,99 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "BenchmarkUtils.h"
+#include "JobSystem.h"
+#include "PointCloudKnn.h"
+#include <memory>
+#include <random>
+#include <thread>
+
+using namespace Bcg;
+
+// Random points in the unit cube, or on a wavy surface if planar, the typical input of a scanner.
+static PointCloud MakeCloud(size_t n, bool planar) {
+    PointCloud cloud;
+    cloud.reserve(n);
+    auto positions = cloud.vertex_property<Vector<Real, 3> >("v:position");
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<Real> uniform(0, 1);
+    for (size_t i = 0; i < n; ++i) {
+        const Real x = uniform(rng), y = uniform(rng);
+        const Real z = planar ? Real(0.1) * std::sin(Real(10) * x) * std::cos(Real(10) * y) : uniform(rng);
+        add_vertex(cloud.vertices, positions, Vector<Real, 3>(x, y, z));
+    }
+    return cloud;
+}
+
+// The k nearest neighbors of the first n_queries points by brute force, the baseline for the queries.
+static size_t BruteForceKnn(const PointCloud &cloud, size_t k, size_t n_queries) {
+    const auto positions = cloud.get_vertex_property<Vector<Real, 3> >("v:position");
+    const size_t n = cloud.vertices.size();
+    std::vector<std::pair<Real, uint32_t> > candidates(n);
+    size_t checksum = 0;
+    for (size_t i = 0; i < n_queries; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            candidates[j] = {(positions[Vertex(j)] - positions[Vertex(i)]).squaredNorm(), static_cast<uint32_t>(j)};
+        }
+        std::nth_element(candidates.begin(), candidates.begin() + k, candidates.end());
+        checksum += candidates[k].second;
+    }
+    return checksum;
+}
+
+// Finds the k nearest neighbors of random points in a cube and on a surface and builds the union graph, for an
+// increasing number of threads. Reports the positions as bytes and the points as items, and compares the queries
+// with brute force on a subset of the points.
+// Usage: BenchPointCloudKnn [points, default 1000000] [k, default 10] [json output file]
+int main(int argc, char **argv) {
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const size_t k = argc > 2 ? std::stoul(argv[2]) : 10;
+    const std::string json_filename = argc > 3 ? argv[3] : "BenchPointCloudKnn.json";
+    const int repetitions = 3;
+
+    const PointCloud volume = MakeCloud(n, false);
+    const PointCloud surface = MakeCloud(n, true);
+    std::printf("Clouds: %zu points, k = %zu\n", n, k);
+
+    BenchmarkJson json;
+    auto record = [&](const std::string &name, double seconds, size_t items, unsigned int threads) {
+        const size_t bytes = items * sizeof(Vector<Real, 3>);
+        BenchmarkReport(name, seconds, bytes, items);
+        json.add("pointcloud_knn", seconds, bytes, items,
+                 {{"variant", name}, {"vertices", std::to_string(items)}, {"threads", std::to_string(threads)}});
+    };
+
+    // Brute force costs n per query, so it only runs on a few queries and is scaled to all points.
+    const size_t n_brute = std::max<size_t>(1, std::min<size_t>(n, 1000000) / 1000);
+    const double brute_seconds = BenchmarkBestOf(1, [&]() { BruteForceKnn(volume, std::min(k, n - 1), n_brute); });
+    record("brute force volume (extrapolated)", brute_seconds * static_cast<double>(n) / n_brute, n, 0);
+
+    std::vector<unsigned int> thread_counts = {0};
+    for (unsigned int threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    for (const unsigned int threads: thread_counts) {
+        // 0 threads runs the builder serially without a JobSystem.
+        std::unique_ptr<JobSystem> jobs = threads > 0 ? std::make_unique<JobSystem>(threads) : nullptr;
+        char name[64];
+        for (const bool planar: {false, true}) {
+            KnnGraphBuilder builder(planar ? surface : volume, jobs.get());
+            double seconds = BenchmarkBestOf(repetitions, [&]() { builder.compute(k); });
+            std::snprintf(name, sizeof(name), "knn %s threads %u", planar ? "surface" : "volume", threads);
+            record(name, seconds, n, threads);
+
+            Graph graph;
+            seconds = BenchmarkBestOf(repetitions, [&]() { graph = builder.build_graph(); });
+            std::snprintf(name, sizeof(name), "graph %s threads %u", planar ? "surface" : "volume", threads);
+            record(name, seconds, n, threads);
+            std::printf("%-40s cell size %g, %zu edges\n", "", builder.cell_size, graph.n_edges());
+        }
+    }
+
+    if (!json.write(json_filename)) {
+        return 1;
+    }
+    std::printf("Results written to %s\n", json_filename.c_str());
+    return 0;
+}
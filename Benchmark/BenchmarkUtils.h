@@ -0,0 +1,135 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef ENGINE25_BENCHMARKUTILS_H
+#define ENGINE25_BENCHMARKUTILS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Bcg {
+    /**
+     * @brief Wall clock stopwatch, started on construction.
+     */
+    class BenchmarkTimer {
+    public:
+        BenchmarkTimer() : m_start(std::chrono::steady_clock::now()) {
+        }
+
+        void restart() { m_start = std::chrono::steady_clock::now(); }
+
+        [[nodiscard]] double seconds() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point m_start;
+    };
+
+    /**
+     * @brief Runs func repetitions times and returns the fastest run in seconds.
+     */
+    template<typename Func>
+    double BenchmarkBestOf(int repetitions, Func &&func) {
+        double best = std::numeric_limits<double>::max();
+        for (int i = 0; i < repetitions; ++i) {
+            BenchmarkTimer timer;
+            func();
+            best = std::min(best, timer.seconds());
+        }
+        return best;
+    }
+
+    /**
+     * @brief Prints one result line as name, time, throughput in MB/s and in items/s.
+     */
+    inline void BenchmarkReport(const std::string &name, double seconds, size_t bytes, size_t items) {
+        std::printf("%-40s %10.3f ms %10.1f MB/s %14.0f items/s\n", name.c_str(), seconds * 1e3,
+                    static_cast<double>(bytes) / seconds / (1 << 20), static_cast<double>(items) / seconds);
+    }
+
+    /**
+     * @brief Collects benchmark results and writes them as a json array for trend tracking.
+     *
+     * Every result is one object with the keys "name", "seconds", "bytes", "items", "mb_per_second" and
+     * "items_per_second", plus the string valued tags it was added with.
+     */
+    class BenchmarkJson {
+    public:
+        using Tags = std::vector<std::pair<std::string, std::string> >;
+
+        void add(const std::string &name, double seconds, size_t bytes, size_t items, const Tags &tags = {}) {
+            m_results.push_back({name, seconds, bytes, items, tags});
+        }
+
+        [[nodiscard]] bool write(const std::string &filename) const {
+            std::ofstream out(filename);
+            if (!out.is_open()) {
+                std::fprintf(stderr, "Error: BenchmarkJson::write: Could not open %s\n", filename.c_str());
+                return false;
+            }
+            out << "[\n";
+            for (size_t i = 0; i < m_results.size(); ++i) {
+                const Result &result = m_results[i];
+                out << "  {\"name\": \"" << result.name << "\"";
+                for (const auto &[key, value]: result.tags) {
+                    out << ", \"" << key << "\": \"" << value << "\"";
+                }
+                out << ", \"seconds\": " << result.seconds
+                    << ", \"bytes\": " << result.bytes
+                    << ", \"items\": " << result.items
+                    << ", \"mb_per_second\": " << static_cast<double>(result.bytes) / result.seconds / (1 << 20)
+                    << ", \"items_per_second\": " << static_cast<double>(result.items) / result.seconds
+                    << "}" << (i + 1 < m_results.size() ? ",\n" : "\n");
+            }
+            out << "]\n";
+            return true;
+        }
+
+    private:
+        struct Result {
+            std::string name;
+            double seconds;
+            size_t bytes;
+            size_t items;
+            Tags tags;
+        };
+
+        std::vector<Result> m_results;
+    };
+
+    /**
+     * @brief Flushes a file and asks the operating system to evict it from the page cache, so that the next read
+     * hits the disk.
+     * @return True if the request was issued, false if the platform does not support it.
+     */
+    inline bool BenchmarkDropFromPageCache(const std::string &filename) {
+#if defined(__linux__)
+        const int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        fdatasync(fd);
+        const bool ok = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+        close(fd);
+        return ok;
+#else
+        (void) filename;
+        return false;
+#endif
+    }
+}
+
+#endif //ENGINE25_BENCHMARKUTILS_H
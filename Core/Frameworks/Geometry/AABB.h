@@ -127,7 +127,7 @@ public:
         T total = 0;
 
         // Precompute cumulative products from left and right
-        Vector<T, N> left(N, 1), right(N, 1);
+        Vector<T, N> left = Vector<T, N>::Ones(), right = Vector<T, N>::Ones();
         for (int i = 1; i < N; ++i) {
             left[i] = left[i - 1] * diag[i - 1];
         }
@@ -8,6 +8,7 @@
 #include "GeometricProperties.h"
 #include <stack>
 #include <queue>
+#include <concepts>
 
 namespace Bcg {
     //---------------------------------------------------------------------
@@ -888,6 +889,26 @@ namespace Bcg {
         //TODO: provide dfs and bfs iterators and range based for loops similar to tree class
     };
 
+    /**
+     * @brief The halfedge interface shared by Graph and Mesh, over which the graph algorithms are templated.
+     * Both store the halfedges of edge e at the indices 2e and 2e + 1, so the algorithms run on the edge graph of a
+     * Mesh without copying it into a Graph and their predecessor halfedges mean the same for both.
+     */
+    template<typename GraphType>
+    concept HalfedgeGraph = requires(GraphType &graph, const Vertex &v, const Halfedge &h, const Edge &e) {
+        graph.vertices.size();
+        graph.edges.size();
+        graph.get_halfedges(v);
+        graph.get_vertices(v);
+        { graph.get_vertex(h) } -> std::same_as<Vertex>;
+        { graph.get_vertex(e, 0) } -> std::same_as<Vertex>;
+        { graph.get_edge(h) } -> std::same_as<Edge>;
+        { graph.get_opposite(h) } -> std::same_as<Halfedge>;
+        { graph.is_deleted(v) } -> std::same_as<bool>;
+        { graph.template vertex_property<Real>("") } -> std::same_as<VertexProperty<Real> >;
+        { graph.template edge_property<Real>("") } -> std::same_as<EdgeProperty<Real> >;
+    };
+
     /**
      *  @brief Splits an edge by inserting a vertex.
      *  @param e Edge to split.
@@ -5,19 +5,40 @@
 #ifndef GRAPHASTAR_H
 #define GRAPHASTAR_H
 
-#include "Graph.h"
+#include "GraphCsr.h"
+#include <queue>
 
 namespace Bcg {
+    /**
+     * @brief Priority queue item of the A* search, ordered by f = g + h.
+     */
+    struct AStarPQItem {
+        Vertex v; /**< The queued vertex. */
+        Real f; /**< The cost so far plus the heuristic estimate. */
+        Real g; /**< The cost from the source to this vertex. */
+    };
+
+    /**
+     * @brief Comparator for the priority queue (min-heap based on f).
+     */
+    struct AStarPQCompare {
+        bool operator()(const AStarPQItem &a, const AStarPQItem &b) const {
+            return a.f > b.f;
+        }
+    };
+
     /**
      * @brief AStar: An informed search algorithm that uses a heuristic function.
+     * @tparam GraphType Graph or Mesh, the search runs on the halfedges of either.
      */
+    template<HalfedgeGraph GraphType = Graph>
     class AStar {
     public:
         /**
          * @brief Constructs an AStar object for the given graph.
          * @param graph The graph on which to perform the A* search.
          */
-        explicit AStar(Graph &graph);
+        explicit AStar(GraphType &graph);
 
         /**
          * @brief Computes the shortest path from the source vertex to the target vertex.
@@ -26,6 +47,17 @@ namespace Bcg {
          */
         void compute(const Vertex &source, const Vertex &target);
 
+        /**
+         * @brief Computes the shortest path from the source vertex to the target vertex with the given heuristic.
+         * The heuristic is called directly instead of through the std::function member, so it can be inlined into the
+         * search loop, e.g. the LandmarkHeuristic of GraphLandmarks.h.
+         * @param source The source vertex from which to start the search.
+         * @param target The target vertex to which to find the shortest path.
+         * @param heuristic A callable returning a lower bound of the distance from a vertex to the target.
+         */
+        template<typename Heuristic>
+        void compute(const Vertex &source, const Vertex &target, Heuristic &&heuristic);
+
         /**
          * @brief Sets the heuristic function for the A* search.
          * @param heuristic The heuristic function to use.
@@ -48,11 +80,24 @@ namespace Bcg {
          */
         void clear_custom_edge_weights();
 
+        /**
+         * @brief Runs the computation on an adjacency snapshot of the graph instead of circulating its halfedges.
+         * The weights stored in the snapshot are used in place of the edge weights.
+         * @param csr The snapshot. It is not owned and has to stay alive until it is cleared.
+         */
+        void set_csr(const GraphCsr *csr);
+
+        /**
+         * @brief Clears the adjacency snapshot, the graph is circulated again.
+         */
+        void clear_csr();
+
         EdgeProperty<Real> edge_weights; /**< The edge weights used in the A* search. */
         VertexProperty<Real> vertex_distances; /**< The distances from the source vertex to each vertex. */
         VertexProperty<Halfedge> vertex_predecessors;
         /**< The predecessor halfedge for each vertex in the shortest path tree. */
         std::function<Real(const Vertex &)> heuristic; /**< The heuristic function used in the A* search. */
+        size_t n_settled = 0; /**< The number of vertices settled by the last compute. */
 
     private:
         /**
@@ -60,8 +105,57 @@ namespace Bcg {
          */
         void clear();
 
-        Graph &graph; /**< The graph on which to perform the A* search. */
+        GraphType &graph; /**< The graph on which to perform the A* search. */
+        const GraphCsr *csr = nullptr; /**< The optional adjacency snapshot of the graph. */
     };
+
+    template<HalfedgeGraph GraphType>
+    template<typename Heuristic>
+    void AStar<GraphType>::compute(const Vertex &source, const Vertex &target, Heuristic &&heuristic) {
+        if (!IsCompatibleCsr(graph, csr, "AStar::compute")) return;
+        clear();
+
+        // Initialize source.
+        vertex_distances[source] = 0;
+        Real f_source = vertex_distances[source] + heuristic(source);
+
+        std::priority_queue<AStarPQItem, std::vector<AStarPQItem>, AStarPQCompare> queue;
+        queue.push({source, f_source, 0});
+
+        while (!queue.empty()) {
+            AStarPQItem current_item = queue.top();
+            queue.pop();
+
+            Vertex v_current = current_item.v;
+            Real g_current = current_item.g;
+
+            // Skip outdated queue entries.
+            if (g_current > vertex_distances[v_current])
+                continue;
+            ++n_settled;
+
+            // Early termination: if we've reached the target, stop.
+            if (v_current == target)
+                break;
+
+            // Iterate over all outgoing halfedges.
+            ForEachNeighbor(graph, csr, edge_weights, v_current, [&](const Halfedge &h, const Vertex &v_neighbor,
+                                                                     Real weight) {
+                // Skip negative weights if encountered.
+                if (weight < 0)
+                    return;
+
+                Real new_g = vertex_distances[v_current] + weight;
+                if (new_g < vertex_distances[v_neighbor]) {
+                    vertex_distances[v_neighbor] = new_g;
+                    // Store the predecessor as the opposite halfedge.
+                    vertex_predecessors[v_neighbor] = graph.get_opposite(h);
+                    Real new_f = new_g + heuristic(v_neighbor);
+                    queue.push({v_neighbor, new_f, new_g});
+                }
+            });
+        }
+    }
 }
 
 #endif //GRAPHASTAR_H
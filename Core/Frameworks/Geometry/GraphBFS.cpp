@@ -0,0 +1,171 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphBFS.h"
+#include "Mesh.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <bit>
+#include <iostream>
+#include <mutex>
+
+namespace Bcg {
+    DirectionOptimizingBFS::DirectionOptimizingBFS(Graph &graph, JobSystem *jobs) : graph(&graph),
+        vertices(graph.vertices), jobs(jobs) {
+    }
+
+    DirectionOptimizingBFS::DirectionOptimizingBFS(Mesh &mesh, JobSystem *jobs) : mesh(&mesh),
+        vertices(mesh.vertices), jobs(jobs) {
+    }
+
+    void DirectionOptimizingBFS::compute(const Vertex &source) {
+        compute(std::vector<Vertex>{source});
+    }
+
+    void DirectionOptimizingBFS::compute(const std::vector<Vertex> &sources) {
+        clear();
+        if (csr && !(graph ? IsCompatibleCsr(*graph, csr, "DirectionOptimizingBFS::compute")
+                           : IsCompatibleCsr(*mesh, csr, "DirectionOptimizingBFS::compute"))) {
+            return;
+        }
+        const GraphCsr *adjacency = csr ? csr : &owned_csr;
+
+        const size_t n = vertices.size();
+        const size_t n_words = (n + 63) / 64;
+        // Bottom-up chunks start at multiples of 64, so every chunk writes its own bitmap words.
+        const size_t grain_size = 64 * 64;
+        std::vector<int> &distances = vertex_distances.vector();
+        std::vector<Vertex> &parents = vertex_parents.vector();
+
+        std::vector<unsigned int> frontier;
+        size_t frontier_edges = 0;
+        for (const Vertex &source: sources) {
+            if (source.idx() >= n) {
+                std::cerr << "Error: DirectionOptimizingBFS::compute: Invalid source vertex." << std::endl;
+                continue;
+            }
+            if (distances[source.idx()] == 0) continue;
+            distances[source.idx()] = 0;
+            frontier.push_back(static_cast<unsigned int>(source.idx()));
+            frontier_edges += adjacency->get_valence(source);
+        }
+
+        size_t unexplored_edges = adjacency->n_entries() - frontier_edges;
+        size_t frontier_size = frontier.size();
+        std::vector<uint64_t> frontier_bits, next_bits;
+        std::vector<unsigned int> next_frontier;
+        std::mutex mutex;
+        bool bottom_up = false;
+
+        for (int level = 0; frontier_size > 0; ++level) {
+            // Switch the direction and convert the frontier representation.
+            if (!bottom_up && static_cast<Real>(frontier_edges) > static_cast<Real>(unexplored_edges) / alpha) {
+                frontier_bits.assign(n_words, 0);
+                for (const unsigned int v: frontier) {
+                    frontier_bits[v >> 6] |= uint64_t(1) << (v & 63);
+                }
+                bottom_up = true;
+            } else if (bottom_up && static_cast<Real>(frontier_size) < static_cast<Real>(n) / beta) {
+                frontier.clear();
+                for (size_t w = 0; w < n_words; ++w) {
+                    for (uint64_t bits = frontier_bits[w]; bits; bits &= bits - 1) {
+                        frontier.push_back(static_cast<unsigned int>(w * 64 + std::countr_zero(bits)));
+                    }
+                }
+                bottom_up = false;
+            }
+
+            size_t next_size = 0;
+            size_t next_edges = 0;
+            if (bottom_up) {
+                // Every unvisited vertex looks for a neighbor in the frontier.
+                next_bits.assign(n_words, 0);
+                ParallelFor(jobs, 0, n, grain_size, [&](size_t begin, size_t end) {
+                    size_t local_size = 0, local_edges = 0;
+                    for (size_t v = begin; v < end; ++v) {
+                        if (distances[v] >= 0) continue;
+                        for (size_t i = adjacency->offsets[v], i_end = adjacency->offsets[v + 1]; i < i_end; ++i) {
+                            const unsigned int u = adjacency->neighbors[i];
+                            if (frontier_bits[u >> 6] & (uint64_t(1) << (u & 63))) {
+                                distances[v] = level + 1;
+                                parents[v] = Vertex(u);
+                                next_bits[v >> 6] |= uint64_t(1) << (v & 63);
+                                ++local_size;
+                                local_edges += i_end - adjacency->offsets[v];
+                                break;
+                            }
+                        }
+                    }
+                    std::scoped_lock lock(mutex);
+                    next_size += local_size;
+                    next_edges += local_edges;
+                });
+                std::swap(frontier_bits, next_bits);
+                ++n_bottom_up_levels;
+            } else {
+                // Every frontier vertex claims its unvisited neighbors.
+                next_frontier.clear();
+                ParallelFor(jobs, 0, frontier.size(), 1024, [&](size_t begin, size_t end) {
+                    std::vector<unsigned int> local;
+                    size_t local_edges = 0;
+                    for (size_t k = begin; k < end; ++k) {
+                        const unsigned int v = frontier[k];
+                        for (size_t i = adjacency->offsets[v], i_end = adjacency->offsets[v + 1]; i < i_end; ++i) {
+                            const unsigned int u = adjacency->neighbors[i];
+                            std::atomic_ref<int> distance(distances[u]);
+                            int unvisited = -1;
+                            if (distance.load(std::memory_order_relaxed) < 0 &&
+                                distance.compare_exchange_strong(unvisited, level + 1, std::memory_order_relaxed)) {
+                                parents[u] = Vertex(v);
+                                local.push_back(u);
+                                local_edges += adjacency->offsets[u + 1] - adjacency->offsets[u];
+                            }
+                        }
+                    }
+                    std::scoped_lock lock(mutex);
+                    next_frontier.insert(next_frontier.end(), local.begin(), local.end());
+                    next_edges += local_edges;
+                });
+                std::swap(frontier, next_frontier);
+                next_size = frontier.size();
+            }
+
+            unexplored_edges -= std::min(unexplored_edges, next_edges);
+            frontier_edges = next_edges;
+            frontier_size = next_size;
+            ++n_levels;
+        }
+    }
+
+    void DirectionOptimizingBFS::set_csr(const GraphCsr *csr) {
+        this->csr = csr;
+    }
+
+    void DirectionOptimizingBFS::clear_csr() {
+        csr = nullptr;
+    }
+
+    void DirectionOptimizingBFS::clear() {
+        // The own snapshot is rebuilt every time, so edits of the graph between two computes are picked up.
+        if (!csr) {
+            owned_csr = graph ? GraphCsr(*graph, EdgeProperty<Real>(), jobs)
+                              : GraphCsr(*mesh, EdgeProperty<Real>(), jobs);
+        }
+
+        if (!vertex_distances) {
+            vertex_distances = vertices.vertex_property<int>("v:bfs:distances", -1);
+        }
+        if (!vertex_parents) {
+            vertex_parents = vertices.vertex_property<Vertex>("v:bfs:parents");
+        }
+        std::vector<int> &distances = vertex_distances.vector();
+        std::vector<Vertex> &parents = vertex_parents.vector();
+        ParallelFor(jobs, 0, distances.size(), 1 << 16, [&](size_t begin, size_t end) {
+            std::fill(distances.begin() + begin, distances.begin() + end, -1);
+            std::fill(parents.begin() + begin, parents.begin() + end, Vertex());
+        });
+        n_levels = 0;
+        n_bottom_up_levels = 0;
+    }
+}
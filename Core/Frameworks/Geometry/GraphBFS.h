@@ -0,0 +1,83 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef GRAPHBFS_H
+#define GRAPHBFS_H
+
+#include "GraphCsr.h"
+
+namespace Bcg {
+    /**
+     * @brief DirectionOptimizingBFS: Level synchronous breadth first search that switches between top-down and
+     * bottom-up steps.
+     *
+     * Top-down steps expand the frontier queue and claim unvisited neighbors. Once the frontier touches more than
+     * 1 / alpha of the unexplored edges, the search switches to bottom-up steps, in which every unvisited vertex looks
+     * for a parent in a bitmap of the frontier and stops at the first one found. When the frontier shrinks below
+     * 1 / beta of the vertices the search switches back. Both steps run in parallel if a JobSystem is given.
+     * The search runs on the vertex adjacency of a Graph or a Mesh.
+     */
+    class DirectionOptimizingBFS {
+    public:
+        /**
+         * @brief Constructs a breadth first search on the given graph.
+         * @param graph The graph to search.
+         * @param jobs If set, the levels are expanded in parallel on this JobSystem.
+         */
+        explicit DirectionOptimizingBFS(Graph &graph, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Constructs a breadth first search over the vertices of the given mesh.
+         * @param mesh The mesh to search.
+         * @param jobs If set, the levels are expanded in parallel on this JobSystem.
+         */
+        explicit DirectionOptimizingBFS(Mesh &mesh, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Computes the hop distances and a breadth first tree from the source vertex.
+         * @param source The source vertex.
+         */
+        void compute(const Vertex &source);
+
+        /**
+         * @brief Computes the hop distances to the closest of the source vertices and a breadth first forest.
+         * @param sources The source vertices.
+         */
+        void compute(const std::vector<Vertex> &sources);
+
+        /**
+         * @brief Uses an existing adjacency snapshot instead of building one on every compute.
+         * @param csr The snapshot. It is not owned and has to stay alive until it is cleared. A compute on a snapshot
+         * which does not match the graph fails.
+         */
+        void set_csr(const GraphCsr *csr);
+
+        /**
+         * @brief Clears the adjacency snapshot, every compute builds its own one again.
+         */
+        void clear_csr();
+
+        VertexProperty<int> vertex_distances; /**< The hop distance from the closest source, -1 if unreachable. */
+        VertexProperty<Vertex> vertex_parents; /**< The parent in the breadth first tree, invalid for sources. */
+        Real alpha = 15; /**< Go bottom-up once the frontier edges exceed the unexplored edges / alpha, 0 never. */
+        Real beta = 18; /**< Switch back to top-down if the frontier size drops below the vertices / beta. */
+        size_t n_levels = 0; /**< The number of levels expanded by the last compute. */
+        size_t n_bottom_up_levels = 0; /**< The number of levels of the last compute expanded bottom-up. */
+
+    private:
+        /**
+         * @brief Clears the internal state and rebuilds the own snapshot if none was set.
+         */
+        void clear();
+
+        Graph *graph = nullptr; /**< The graph to search, if constructed from a graph. */
+        Mesh *mesh = nullptr; /**< The mesh to search, if constructed from a mesh. */
+        VertexContainer &vertices; /**< The vertices of the graph or mesh. */
+        JobSystem *jobs; /**< The optional JobSystem used to expand the levels. */
+        const GraphCsr *csr = nullptr; /**< The adjacency snapshot set by the user, if any. */
+        GraphCsr owned_csr; /**< The snapshot built by every compute if none was set. */
+    };
+}
+
+#endif //GRAPHBFS_H
@@ -4,18 +4,48 @@
 
 #include "GraphBellmanFord.h"
 #include "GraphUtils.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
 
 namespace Bcg {
-    BellmanFord::BellmanFord(Graph &graph): graph(graph), negative_cycle_found(false) {
+    // A tentative distance and the predecessor halfedge packed into one word. Negative distances flip all bits and
+    // non-negative ones set the sign bit, so the upper half of a smaller label is a shorter distance.
+    using Label = uint64_t;
+    static constexpr Label Unreached = std::numeric_limits<Label>::max();
+    static constexpr uint32_t NoPredecessor = std::numeric_limits<uint32_t>::max();
+
+    static Label PackLabel(Real distance, uint32_t predecessor) {
+        return (static_cast<Label>(OrderedBits(distance)) << 32) | predecessor;
+    }
+
+    static Real LabelDistance(Label label) {
+        return FromOrderedBits(static_cast<uint32_t>(label >> 32));
+    }
+
+    BellmanFord::BellmanFord(Graph &graph, JobSystem *jobs): negative_cycle_found(false), graph(graph), jobs(jobs) {
 
     }
 
     bool BellmanFord::compute(const Vertex &source) {
-        return compute({source});
+        return compute(std::vector<Vertex>{source});
     }
 
     bool BellmanFord::compute(const std::vector<Vertex> &sources) {
+        if (!IsCompatibleCsr(graph, csr, "BellmanFord::compute")) return false;
         clear();
+        switch (mode) {
+            case BellmanFordMode::Queue:
+                return compute_queue(sources);
+            case BellmanFordMode::ParallelSweep:
+                return compute_parallel_sweep(sources);
+            default:
+                return compute_sweep(sources);
+        }
+    }
+
+    bool BellmanFord::compute_sweep(const std::vector<Vertex> &sources) {
         // Initialize all source vertices with a distance of zero.
         for (const Vertex &source: sources) {
             vertex_distances[source] = 0;
@@ -28,42 +58,153 @@ namespace Bcg {
             for (const auto &v : graph.vertices) {
                 // Only relax from reachable vertices.
                 if (vertex_distances[v] < std::numeric_limits<Real>::max()) {
-                    for (const auto &h: graph.get_halfedges(v)) {
-                        Edge e = graph.get_edge(h);
-                        Real weight = edge_weights[e];
-                        Vertex u = graph.get_vertex(h);
+                    ForEachNeighbor(graph, csr, edge_weights, v, [&](const Halfedge &h, const Vertex &u, Real weight) {
                         if (vertex_distances[v] + weight < vertex_distances[u]) {
                             vertex_distances[u] = vertex_distances[v] + weight;
                             // Save the predecessor as the opposite halfedge,
                             // so that the target of the stored halfedge gives the predecessor.
                             vertex_predecessors[u] = graph.get_opposite(h);
                             updated = true;
+                            ++n_relaxations;
                         }
-                    }
+                    });
                 }
             }
-            // Optional: if no update was made in an entire pass, we can stop early.
+            // If no update was made in an entire pass, all distances are final.
             if (!updated)
-                break;
+                return true;
         }
 
         // Check for negative cycles.
         for (const auto &v : graph.vertices) {
             if (vertex_distances[v] < std::numeric_limits<Real>::max()) {
-                for (const auto &h: graph.get_halfedges(v)) {
-                    Edge e = graph.get_edge(h);
-                    Real weight = edge_weights[e];
-                    Vertex u = graph.get_vertex(h);
+                ForEachNeighbor(graph, csr, edge_weights, v, [&](const Halfedge &, const Vertex &u, Real weight) {
                     if (vertex_distances[v] + weight < vertex_distances[u]) {
                         negative_cycle_found = true;
-                        return false; // Negative cycle detected.
                     }
+                });
+                if (negative_cycle_found) {
+                    return false; // Negative cycle detected.
+                }
+            }
+        }
+        return true;
+    }
+
+    bool BellmanFord::compute_queue(const std::vector<Vertex> &sources) {
+        const size_t n = graph.n_vertices();
+        std::deque<Vertex> queue;
+        std::vector<bool> queued(graph.vertices.size(), false);
+        // The number of edges of the path which set the distance of every vertex. A path of n edges repeats a vertex,
+        // which only shortens it if the repeated part is a negative cycle.
+        std::vector<size_t> lengths(graph.vertices.size(), 0);
+        for (const Vertex &source: sources) {
+            vertex_distances[source] = 0;
+            if (!queued[source.idx()]) {
+                queued[source.idx()] = true;
+                queue.push_back(source);
+            }
+        }
+
+        while (!queue.empty()) {
+            const Vertex v = queue.front();
+            queue.pop_front();
+            queued[v.idx()] = false;
+            const Real distance = vertex_distances[v];
+            ForEachNeighbor(graph, csr, edge_weights, v, [&](const Halfedge &h, const Vertex &u, Real weight) {
+                if (negative_cycle_found || !(distance + weight < vertex_distances[u])) return;
+                vertex_distances[u] = distance + weight;
+                vertex_predecessors[u] = graph.get_opposite(h);
+                ++n_relaxations;
+                lengths[u.idx()] = lengths[v.idx()] + 1;
+                if (lengths[u.idx()] >= n) {
+                    negative_cycle_found = true;
+                } else if (!queued[u.idx()]) {
+                    queued[u.idx()] = true;
+                    queue.push_back(u);
                 }
+            });
+            if (negative_cycle_found) {
+                return false; // Negative cycle detected.
             }
         }
         return true;
     }
 
+    bool BellmanFord::compute_parallel_sweep(const std::vector<Vertex> &sources) {
+        const size_t n = graph.vertices.size();
+        std::vector<Label> labels(n, Unreached);
+        // Stamps deduplicate the vertices collected by a pass.
+        std::vector<size_t> stamps(n, 0);
+        std::vector<unsigned int> frontier, improved;
+        for (const Vertex &source: sources) {
+            if (labels[source.idx()] == Unreached) {
+                labels[source.idx()] = PackLabel(0, NoPredecessor);
+                frontier.push_back(static_cast<unsigned int>(source.idx()));
+            }
+        }
+
+        // After pass k all shortest paths with k edges are final, so a distance decreasing in pass V lies on a
+        // negative cycle.
+        const size_t n_passes = graph.n_vertices();
+        std::mutex mutex;
+        std::atomic<size_t> relaxations = 0;
+        for (size_t pass = 1; !frontier.empty(); ++pass) {
+            if (pass > n_passes) {
+                negative_cycle_found = true;
+                break;
+            }
+            improved.clear();
+            ParallelFor(jobs, 0, frontier.size(), 256, [&](size_t begin, size_t end) {
+                std::vector<unsigned int> local;
+                size_t local_relaxations = 0;
+                for (size_t k = begin; k < end; ++k) {
+                    const Vertex v(frontier[k]);
+                    const Label label_v = std::atomic_ref(labels[v.idx()]).load(std::memory_order_relaxed);
+                    const Real distance = LabelDistance(label_v);
+                    ForEachNeighbor(graph, csr, edge_weights, v, [&](const Halfedge &h, const Vertex &u, Real weight) {
+                        // The predecessor is the opposite of h, which points from u back to v.
+                        const Label label = PackLabel(distance + weight, static_cast<uint32_t>(h.idx() ^ 1));
+                        std::atomic_ref target(labels[u.idx()]);
+                        Label current = target.load(std::memory_order_relaxed);
+                        // Only a strictly shorter distance replaces the label, like the serial modes. Taking an
+                        // equally short path over a zero weight edge could give the source a predecessor or close a
+                        // cycle of predecessors.
+                        while ((label >> 32) < (current >> 32)) {
+                            if (target.compare_exchange_weak(current, label, std::memory_order_relaxed)) {
+                                ++local_relaxations;
+                                std::atomic_ref stamp(stamps[u.idx()]);
+                                if (stamp.exchange(pass, std::memory_order_relaxed) != pass) {
+                                    local.push_back(static_cast<unsigned int>(u.idx()));
+                                }
+                                break;
+                            }
+                        }
+                    });
+                }
+                relaxations += local_relaxations;
+                std::scoped_lock lock(mutex);
+                improved.insert(improved.end(), local.begin(), local.end());
+            });
+            frontier.swap(improved);
+        }
+        n_relaxations = relaxations;
+
+        std::vector<Real> &distances = vertex_distances.vector();
+        std::vector<Halfedge> &predecessors = vertex_predecessors.vector();
+        ParallelFor(jobs, 0, n, 1 << 14, [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                if (labels[v] == Unreached) continue;
+                distances[v] = LabelDistance(labels[v]);
+                const uint32_t predecessor = static_cast<uint32_t>(labels[v]);
+                if (predecessor != NoPredecessor) {
+                    predecessors[v] = Halfedge(predecessor);
+                }
+            }
+        });
+        return !negative_cycle_found;
+    }
+
     bool BellmanFord::has_negative_cycle() const {
         return negative_cycle_found;
     }
@@ -76,8 +217,16 @@ namespace Bcg {
         edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
     }
 
+    void BellmanFord::set_csr(const GraphCsr *csr) {
+        this->csr = csr;
+    }
+
+    void BellmanFord::clear_csr() {
+        csr = nullptr;
+    }
+
     void BellmanFord::clear() {
-        if (!edge_weights) {
+        if (!edge_weights && !csr) {
             edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
         }
 
@@ -93,5 +242,6 @@ namespace Bcg {
             std::ranges::fill(vertex_predecessors.vector(), Halfedge());
         }
         negative_cycle_found = false;
+        n_relaxations = 0;
     }
 }
@@ -5,20 +5,34 @@
 #ifndef GRAPHBELLMANFORD_H
 #define GRAPHBELLMANFORD_H
 
-#include "Graph.h"
+#include "GraphCsr.h"
 
 namespace Bcg {
+    /**
+     * @brief The relaxation order of BellmanFord. All modes stop as soon as nothing improves anymore.
+     */
+    enum class BellmanFordMode {
+        Sweep, /**< Relaxes the edges of all reached vertices in every pass, at most V - 1 passes. */
+        Queue, /**< Relaxes only the vertices whose distance decreased, in FIFO order (SPFA). */
+        ParallelSweep /**< Relaxes the vertices improved by the previous pass in parallel on the JobSystem. */
+    };
+
     /**
      * @brief BellmanFord: Computes shortest paths from a source (or multiple sources)
      * for graphs with possibly negative edge weights.
+     *
+     * The queue mode detects a negative cycle once the path to a vertex counts V edges. The parallel sweep relaxes
+     * with an atomic minimum on the distance packed with the predecessor and reports a negative cycle if the V-th pass
+     * still improves a distance.
      */
     class BellmanFord {
     public:
         /**
          * @brief Constructs a BellmanFord object for the given graph.
          * @param graph The graph on which to compute the shortest paths.
+         * @param jobs If set, the passes of the parallel sweep run on this JobSystem.
          */
-        explicit BellmanFord(Graph &graph);
+        explicit BellmanFord(Graph &graph, JobSystem *jobs = nullptr);
 
         /**
          * @brief Computes the shortest path from the source vertex.
@@ -51,11 +65,25 @@ namespace Bcg {
          */
         void clear_custom_edge_weights();
 
+        /**
+         * @brief Runs the computation on an adjacency snapshot of the graph instead of circulating its halfedges.
+         * The weights stored in the snapshot are used in place of the edge weights.
+         * @param csr The snapshot. It is not owned and has to stay alive until it is cleared.
+         */
+        void set_csr(const GraphCsr *csr);
+
+        /**
+         * @brief Clears the adjacency snapshot, the graph is circulated again.
+         */
+        void clear_csr();
+
         EdgeProperty<Real> edge_weights; /**< The edge weights used in the shortest path computation. */
         VertexProperty<Real> vertex_distances; /**< The distances from the source vertex to each vertex. */
         VertexProperty<Halfedge> vertex_predecessors;
         /**< The predecessor halfedge for each vertex in the shortest path tree. */
         bool negative_cycle_found; /**< Indicates if a negative cycle was found during the computation. */
+        BellmanFordMode mode = BellmanFordMode::Sweep; /**< The relaxation order used by compute. */
+        size_t n_relaxations = 0; /**< The number of relaxations which decreased a distance in the last compute. */
 
     private:
         /**
@@ -63,7 +91,27 @@ namespace Bcg {
          */
         void clear();
 
+        /**
+         * @brief Runs the full passes of BellmanFordMode::Sweep.
+         * @return False if a negative cycle was detected.
+         */
+        bool compute_sweep(const std::vector<Vertex> &sources);
+
+        /**
+         * @brief Runs the worklist of BellmanFordMode::Queue.
+         * @return False if a negative cycle was detected.
+         */
+        bool compute_queue(const std::vector<Vertex> &sources);
+
+        /**
+         * @brief Runs the parallel passes of BellmanFordMode::ParallelSweep.
+         * @return False if a negative cycle was detected.
+         */
+        bool compute_parallel_sweep(const std::vector<Vertex> &sources);
+
         Graph &graph; /**< The graph on which to compute the shortest paths. */
+        JobSystem *jobs; /**< The optional JobSystem used for the parallel sweep. */
+        const GraphCsr *csr = nullptr; /**< The optional adjacency snapshot of the graph. */
     };
 }
 
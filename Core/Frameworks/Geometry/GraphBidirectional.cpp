@@ -0,0 +1,239 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphBidirectional.h"
+#include "GraphUtils.h"
+#include <iostream>
+#include <utility>
+
+namespace Bcg {
+    // Priority queue item of one search direction, ordered by key = distance + potential.
+    struct BidirectionalPQItem {
+        Vertex v;
+        Real key;
+        Real distance;
+    };
+
+    struct BidirectionalPQCompare {
+        bool operator()(const BidirectionalPQItem &a, const BidirectionalPQItem &b) const {
+            return a.key > b.key;
+        }
+    };
+
+    // The state of both searches, shared by BidirectionalDijkstra and BidirectionalAStar.
+    struct BidirectionalState {
+        Graph &graph;
+        const GraphCsr *csr;
+        const EdgeProperty<Real> &edge_weights;
+        VertexProperty<Real> &distances;
+        VertexProperty<Real> &sink_distances;
+        VertexProperty<Halfedge> &predecessors;
+        VertexProperty<Halfedge> &successors;
+    };
+
+    // Runs both searches with the forward potential, the backward search uses its negation.
+    // Returns the length of the shortest path and sets the meeting vertex and the number of settled vertices.
+    template<typename Potential>
+    static Real BidirectionalSearch(BidirectionalState &state, const Vertex &source, const Vertex &sink,
+                                    Potential &&potential, Vertex &meeting_vertex, size_t &n_settled) {
+        using Queue = std::priority_queue<BidirectionalPQItem, std::vector<BidirectionalPQItem>,
+            BidirectionalPQCompare>;
+        Queue queues[2];
+        VertexProperty<Real> *distances[2] = {&state.distances, &state.sink_distances};
+        VertexProperty<Halfedge> *parents[2] = {&state.predecessors, &state.successors};
+        const Real signs[2] = {1, -1};
+
+        (*distances[0])[source] = 0;
+        (*distances[1])[sink] = 0;
+        queues[0].push({source, potential(source), 0});
+        queues[1].push({sink, -potential(sink), 0});
+
+        Real mu = std::numeric_limits<Real>::max();
+        if (source == sink) {
+            mu = 0;
+            meeting_vertex = source;
+        }
+
+        while (true) {
+            // Drop outdated entries, so that the tops are the true minimal keys.
+            for (int side = 0; side < 2; ++side) {
+                Queue &queue = queues[side];
+                while (!queue.empty() && queue.top().distance > (*distances[side])[queue.top().v]) {
+                    queue.pop();
+                }
+            }
+            if (queues[0].empty() || queues[1].empty()) break;
+            // No path through an unsettled vertex can be shorter than the sum of the minimal keys.
+            if (queues[0].top().key + queues[1].top().key >= mu) break;
+
+            const int side = queues[0].top().key <= queues[1].top().key ? 0 : 1;
+            const BidirectionalPQItem current = queues[side].top();
+            queues[side].pop();
+            ++n_settled;
+
+            VertexProperty<Real> &own = *distances[side];
+            const VertexProperty<Real> &other = *distances[1 - side];
+            ForEachNeighbor(state.graph, state.csr, state.edge_weights, current.v, [&](const Halfedge &h,
+                                                                                      const Vertex &v_neighbor,
+                                                                                      Real weight) {
+                if (weight < 0)
+                    return;
+
+                const Real new_distance = current.distance + weight;
+                if (new_distance < own[v_neighbor]) {
+                    own[v_neighbor] = new_distance;
+                    // Both searches store the halfedge pointing back to the vertex they came from.
+                    (*parents[side])[v_neighbor] = state.graph.get_opposite(h);
+                    queues[side].push({v_neighbor, new_distance + signs[side] * potential(v_neighbor), new_distance});
+                }
+                // Use the own distance, so that mu always matches the trees of both searches at the meeting vertex.
+                if (other[v_neighbor] != std::numeric_limits<Real>::max() && own[v_neighbor] + other[v_neighbor] < mu) {
+                    mu = own[v_neighbor] + other[v_neighbor];
+                    meeting_vertex = v_neighbor;
+                }
+            });
+        }
+
+        if (meeting_vertex.is_valid()) {
+            // Continue the predecessors of the forward search along the backward tree up to the sink.
+            Vertex current = meeting_vertex;
+            while (state.successors[current].is_valid()) {
+                const Halfedge h = state.successors[current];
+                const Vertex next = state.graph.get_vertex(h);
+                state.predecessors[next] = state.graph.get_opposite(h);
+                current = next;
+            }
+        }
+        return mu;
+    }
+
+    BidirectionalDijkstra::BidirectionalDijkstra(Graph &graph) : graph(graph) {
+    }
+
+    Real BidirectionalDijkstra::compute(const Vertex &source, const Vertex &sink) {
+        if (!IsCompatibleCsr(graph, csr, "BidirectionalDijkstra::compute")) return std::numeric_limits<Real>::max();
+        if (!graph.is_valid(source) || !graph.is_valid(sink)) {
+            std::cerr << "Error: BidirectionalDijkstra::compute: Invalid source or sink vertex." << std::endl;
+            return std::numeric_limits<Real>::max();
+        }
+        clear();
+
+        BidirectionalState state{
+            graph, csr, edge_weights, vertex_distances, vertex_sink_distances, vertex_predecessors, vertex_successors
+        };
+        return BidirectionalSearch(state, source, sink, [](const Vertex &) -> Real { return 0; }, meeting_vertex,
+                                   n_settled);
+    }
+
+    void BidirectionalDijkstra::set_custom_edge_weights(const EdgeProperty<Real> &weights) {
+        edge_weights = weights;
+    }
+
+    void BidirectionalDijkstra::clear_custom_edge_weights() {
+        edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+    }
+
+    void BidirectionalDijkstra::set_csr(const GraphCsr *csr) {
+        this->csr = csr;
+    }
+
+    void BidirectionalDijkstra::clear_csr() {
+        csr = nullptr;
+    }
+
+    // Initializes or resets the properties of a bidirectional search.
+    static void ClearBidirectional(Graph &graph, const std::string &prefix, VertexProperty<Real> &distances,
+                                   VertexProperty<Real> &sink_distances, VertexProperty<Halfedge> &predecessors,
+                                   VertexProperty<Halfedge> &successors) {
+        const Real max = std::numeric_limits<Real>::max();
+        for (auto [property, name]: {
+                 std::pair{&distances, "distances"}, std::pair{&sink_distances, "sink_distances"}
+             }) {
+            if (!*property) {
+                *property = graph.vertex_property<Real>(prefix + name, max);
+            } else {
+                std::ranges::fill(property->vector(), max);
+            }
+        }
+        for (auto [property, name]: {
+                 std::pair{&predecessors, "predecessors"}, std::pair{&successors, "successors"}
+             }) {
+            if (!*property) {
+                *property = graph.vertex_property<Halfedge>(prefix + name);
+            } else {
+                std::ranges::fill(property->vector(), Halfedge());
+            }
+        }
+    }
+
+    void BidirectionalDijkstra::clear() {
+        if (!edge_weights && !csr) {
+            edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+        }
+        ClearBidirectional(graph, "v:bidirectional_dijkstra:", vertex_distances, vertex_sink_distances,
+                           vertex_predecessors, vertex_successors);
+        meeting_vertex = Vertex();
+        n_settled = 0;
+    }
+
+    BidirectionalAStar::BidirectionalAStar(Graph &graph) : graph(graph) {
+        heuristic = [](const Vertex &, const Vertex &) -> Real { return 0; };
+    }
+
+    Real BidirectionalAStar::compute(const Vertex &source, const Vertex &sink) {
+        if (!IsCompatibleCsr(graph, csr, "BidirectionalAStar::compute")) return std::numeric_limits<Real>::max();
+        if (!graph.is_valid(source) || !graph.is_valid(sink)) {
+            std::cerr << "Error: BidirectionalAStar::compute: Invalid source or sink vertex." << std::endl;
+            return std::numeric_limits<Real>::max();
+        }
+        clear();
+
+        if (!heuristic) {
+            heuristic = [](const Vertex &, const Vertex &) -> Real { return 0; };
+        }
+
+        BidirectionalState state{
+            graph, csr, edge_weights, vertex_distances, vertex_sink_distances, vertex_predecessors, vertex_successors
+        };
+        // The average of the forward and the reversed backward estimate, consistent for both directions.
+        auto potential = [&](const Vertex &v) -> Real {
+            return (heuristic(v, sink) - heuristic(v, source)) / 2;
+        };
+        return BidirectionalSearch(state, source, sink, potential, meeting_vertex, n_settled);
+    }
+
+    void BidirectionalAStar::set_heuristic(std::function<Real(const Vertex &, const Vertex &)> h) {
+        heuristic = std::move(h);
+    }
+
+    void BidirectionalAStar::clear_heuristic() {
+        heuristic = [](const Vertex &, const Vertex &) -> Real { return 0; };
+    }
+
+    void BidirectionalAStar::set_custom_edge_weights(const EdgeProperty<Real> &weights) {
+        edge_weights = weights;
+    }
+
+    void BidirectionalAStar::clear_custom_edge_weights() {
+        edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+    }
+
+    void BidirectionalAStar::set_csr(const GraphCsr *csr) {
+        this->csr = csr;
+    }
+
+    void BidirectionalAStar::clear_csr() {
+        csr = nullptr;
+    }
+
+    void BidirectionalAStar::clear() {
+        if (!edge_weights && !csr) {
+            edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+        }
+        ClearBidirectional(graph, "v:bidirectional_astar:", vertex_distances, vertex_sink_distances,
+                           vertex_predecessors, vertex_successors);
+        meeting_vertex = Vertex();
+        n_settled = 0;
+    }
+}
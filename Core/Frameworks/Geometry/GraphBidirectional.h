@@ -0,0 +1,158 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef GRAPHBIDIRECTIONAL_H
+#define GRAPHBIDIRECTIONAL_H
+
+#include "GraphCsr.h"
+
+namespace Bcg {
+    /**
+     * @brief BidirectionalDijkstra: Computes the shortest path between two vertices for graphs with non-negative edge
+     * weights by growing one search from the source and one from the sink.
+     *
+     * The side with the smaller queue key is expanded next. Every scanned edge which connects both searches updates
+     * the best known path length mu, and the search stops once the sum of the two smallest queue keys reaches mu.
+     * After compute, vertex_predecessors along the shortest path lead from the sink back to the source, so the path
+     * can be extracted with BacktracePathSinkToSource.
+     */
+    class BidirectionalDijkstra {
+    public:
+        /**
+         * @brief Constructs a BidirectionalDijkstra object for the given graph.
+         * @param graph The graph on which to compute the shortest paths.
+         */
+        explicit BidirectionalDijkstra(Graph &graph);
+
+        /**
+         * @brief Computes the shortest path from the source vertex to the sink vertex.
+         * @param source The source vertex.
+         * @param sink The sink vertex.
+         * @return The length of the shortest path, max if the sink is unreachable.
+         */
+        Real compute(const Vertex &source, const Vertex &sink);
+
+        /**
+         * @brief Sets custom edge weights for the shortest path computation.
+         * @param weights The custom edge weights to use.
+         */
+        void set_custom_edge_weights(const EdgeProperty<Real> &weights);
+
+        /**
+         * @brief Clears any custom edge weights set for the shortest path computation.
+         */
+        void clear_custom_edge_weights();
+
+        /**
+         * @brief Runs the computation on an adjacency snapshot of the graph instead of circulating its halfedges.
+         * The weights stored in the snapshot are used in place of the edge weights.
+         * @param csr The snapshot. It is not owned and has to stay alive until it is cleared.
+         */
+        void set_csr(const GraphCsr *csr);
+
+        /**
+         * @brief Clears the adjacency snapshot, the graph is circulated again.
+         */
+        void clear_csr();
+
+        EdgeProperty<Real> edge_weights; /**< The edge weights used in the shortest path computation. */
+        VertexProperty<Real> vertex_distances; /**< The distances from the source found by the forward search. */
+        VertexProperty<Real> vertex_sink_distances; /**< The distances to the sink found by the backward search. */
+        VertexProperty<Halfedge> vertex_predecessors;
+        /**< The predecessor halfedge of each vertex reached from the source, and along the shortest path. */
+        Vertex meeting_vertex; /**< The vertex of the shortest path at which both searches met. */
+        size_t n_settled = 0; /**< The number of vertices settled by both searches of the last compute. */
+
+    private:
+        /**
+         * @brief Clears the internal state of the BidirectionalDijkstra object.
+         */
+        void clear();
+
+        Graph &graph; /**< The graph on which to compute the shortest paths. */
+        const GraphCsr *csr = nullptr; /**< The optional adjacency snapshot of the graph. */
+        VertexProperty<Halfedge> vertex_successors; /**< The halfedge towards the sink of the backward search. */
+    };
+
+    /**
+     * @brief BidirectionalAStar: Bidirectional search guided by a heuristic.
+     *
+     * The heuristic estimates the distance between two vertices and has to be consistent, i.e. a lower bound which
+     * satisfies the triangle inequality along every edge. Both searches use the average potential
+     * p(v) = (heuristic(v, sink) - heuristic(v, source)) / 2 with opposite signs, which keeps the reduced edge weights
+     * non-negative in both directions, so the stopping criterion of BidirectionalDijkstra remains exact. With the
+     * default zero heuristic the search is a BidirectionalDijkstra.
+     */
+    class BidirectionalAStar {
+    public:
+        /**
+         * @brief Constructs a BidirectionalAStar object for the given graph.
+         * @param graph The graph on which to perform the search.
+         */
+        explicit BidirectionalAStar(Graph &graph);
+
+        /**
+         * @brief Computes the shortest path from the source vertex to the sink vertex.
+         * @param source The source vertex.
+         * @param sink The sink vertex.
+         * @return The length of the shortest path, max if the sink is unreachable.
+         */
+        Real compute(const Vertex &source, const Vertex &sink);
+
+        /**
+         * @brief Sets the heuristic function for the search.
+         * @param heuristic The consistent estimate of the distance between two vertices.
+         */
+        void set_heuristic(std::function<Real(const Vertex &, const Vertex &)> heuristic);
+
+        /**
+         * @brief Clears the heuristic function set for the search.
+         */
+        void clear_heuristic();
+
+        /**
+         * @brief Sets custom edge weights for the search.
+         * @param weights The custom edge weights to use.
+         */
+        void set_custom_edge_weights(const EdgeProperty<Real> &weights);
+
+        /**
+         * @brief Clears any custom edge weights set for the search.
+         */
+        void clear_custom_edge_weights();
+
+        /**
+         * @brief Runs the computation on an adjacency snapshot of the graph instead of circulating its halfedges.
+         * The weights stored in the snapshot are used in place of the edge weights.
+         * @param csr The snapshot. It is not owned and has to stay alive until it is cleared.
+         */
+        void set_csr(const GraphCsr *csr);
+
+        /**
+         * @brief Clears the adjacency snapshot, the graph is circulated again.
+         */
+        void clear_csr();
+
+        EdgeProperty<Real> edge_weights; /**< The edge weights used in the search. */
+        VertexProperty<Real> vertex_distances; /**< The distances from the source found by the forward search. */
+        VertexProperty<Real> vertex_sink_distances; /**< The distances to the sink found by the backward search. */
+        VertexProperty<Halfedge> vertex_predecessors;
+        /**< The predecessor halfedge of each vertex reached from the source, and along the shortest path. */
+        std::function<Real(const Vertex &, const Vertex &)> heuristic; /**< The heuristic used in the search. */
+        Vertex meeting_vertex; /**< The vertex of the shortest path at which both searches met. */
+        size_t n_settled = 0; /**< The number of vertices settled by both searches of the last compute. */
+
+    private:
+        /**
+         * @brief Clears the internal state of the BidirectionalAStar object.
+         */
+        void clear();
+
+        Graph &graph; /**< The graph on which to perform the search. */
+        const GraphCsr *csr = nullptr; /**< The optional adjacency snapshot of the graph. */
+        VertexProperty<Halfedge> vertex_successors; /**< The halfedge towards the sink of the backward search. */
+    };
+}
+
+#endif //GRAPHBIDIRECTIONAL_H
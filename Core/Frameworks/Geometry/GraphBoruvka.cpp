@@ -0,0 +1,239 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphBoruvka.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <numeric>
+#include <queue>
+
+namespace Bcg {
+    // The lightest edge of a component packs the order preserving bits of the weight above the index of the edge, so
+    // the minimum breaks ties by edge index and one atomic word holds both.
+    using BoruvkaKey = uint64_t;
+    static constexpr BoruvkaKey NoEdge = std::numeric_limits<BoruvkaKey>::max();
+
+    static BoruvkaKey PackKey(Real weight, uint32_t edge) {
+        return (static_cast<BoruvkaKey>(OrderedBits(weight)) << 32) | edge;
+    }
+
+    static void AtomicMin(std::atomic<BoruvkaKey> &target, BoruvkaKey key) {
+        BoruvkaKey current = target.load(std::memory_order_relaxed);
+        while (key < current && !target.compare_exchange_weak(current, key, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Keeps the values of items for which keep returns true, in order. Every chunk counts its kept items first, so the
+    // chunks can write to their offsets in parallel.
+    template<typename Keep>
+    static void ParallelFilter(JobSystem *jobs, std::vector<uint32_t> &items, Keep &&keep) {
+        const size_t n_chunks = jobs ? 4 * jobs->num_threads() : 1;
+        const size_t chunk_size = std::max<size_t>(1024, (items.size() + n_chunks - 1) / n_chunks);
+        const size_t n_used = (items.size() + chunk_size - 1) / chunk_size;
+        std::vector<size_t> offsets(n_used + 1, 0);
+        ParallelFor(jobs, 0, n_used, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                const size_t last = std::min(items.size(), (c + 1) * chunk_size);
+                offsets[c + 1] = std::count_if(items.begin() + c * chunk_size, items.begin() + last, keep);
+            }
+        });
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        std::vector<uint32_t> kept(offsets[n_used]);
+        ParallelFor(jobs, 0, n_used, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                const size_t last = std::min(items.size(), (c + 1) * chunk_size);
+                std::copy_if(items.begin() + c * chunk_size, items.begin() + last, kept.begin() + offsets[c], keep);
+            }
+        });
+        items = std::move(kept);
+    }
+
+    Boruvka::Boruvka(Graph &graph, JobSystem *jobs) : graph(graph), jobs(jobs) {
+    }
+
+    void Boruvka::compute(const Vertex &source) {
+        if (!IsCompatibleCsr(graph, csr, "Boruvka::compute")) return;
+        clear();
+        constexpr size_t grain_size = 4096;
+
+        // Collect all edges with their endpoints and weights.
+        std::vector<uint32_t> from, to, edges;
+        std::vector<Real> weights;
+        // The snapshot lists the edges in a different order, so the keys store edge indices and map them back.
+        std::vector<uint32_t> positions(graph.edges.size());
+        auto add_edge = [&](const Edge &e, const Vertex &v0, const Vertex &v1, Real weight) {
+            if (v0 == v1) return;
+            positions[e.idx()] = static_cast<uint32_t>(edges.size());
+            from.push_back(static_cast<uint32_t>(v0.idx()));
+            to.push_back(static_cast<uint32_t>(v1.idx()));
+            edges.push_back(static_cast<uint32_t>(e.idx()));
+            weights.push_back(weight);
+        };
+        if (csr) {
+            // Every edge is stored once per endpoint, keep the entry of its first halfedge.
+            for (const auto &v: graph.vertices) {
+                for (size_t k = csr->begin(v), end = csr->end(v); k < end; ++k) {
+                    if ((csr->halfedges[k] & 1) == 0) {
+                        add_edge(csr->get_edge(k), v, csr->get_vertex(k), csr->get_weight(k));
+                    }
+                }
+            }
+        } else {
+            for (const auto &e: graph.edges) {
+                if (graph.is_deleted(e)) continue;
+                add_edge(e, graph.get_vertex(e, 0), graph.get_vertex(e, 1), edge_weights[e]);
+            }
+        }
+
+        const size_t n = graph.vertices.size();
+        std::vector<uint32_t> components(n), parents(n), jumped(n);
+        std::iota(components.begin(), components.end(), 0);
+        std::vector<std::atomic<BoruvkaKey> > lightest(n);
+        std::vector<uint8_t> in_forest(edges.size(), 0);
+        std::vector<uint32_t> active(edges.size());
+        std::iota(active.begin(), active.end(), 0);
+        std::vector<uint32_t> alive;
+        for (const auto &v: graph.vertices) {
+            alive.push_back(static_cast<uint32_t>(v.idx()));
+        }
+
+        while (!active.empty()) {
+            ++n_rounds;
+            ParallelFor(jobs, 0, alive.size(), grain_size, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    lightest[alive[i]].store(NoEdge, std::memory_order_relaxed);
+                }
+            });
+
+            // Find the lightest edge leaving every component.
+            ParallelFor(jobs, 0, active.size(), grain_size, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const uint32_t p = active[i];
+                    const BoruvkaKey key = PackKey(weights[p], edges[p]);
+                    AtomicMin(lightest[components[from[p]]], key);
+                    AtomicMin(lightest[components[to[p]]], key);
+                }
+            });
+
+            // Hook every component to the component on the other side of its lightest edge. If two components chose
+            // the same edge, only the smaller one marks it.
+            ParallelFor(jobs, 0, alive.size(), grain_size, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const uint32_t c = alive[i];
+                    const BoruvkaKey key = lightest[c].load(std::memory_order_relaxed);
+                    if (key == NoEdge) {
+                        parents[c] = c;
+                        continue;
+                    }
+                    const uint32_t p = positions[static_cast<uint32_t>(key)];
+                    const uint32_t other = components[from[p]] == c ? components[to[p]] : components[from[p]];
+                    parents[c] = other;
+                    if (lightest[other].load(std::memory_order_relaxed) != key || c < other) {
+                        in_forest[p] = 1;
+                    }
+                }
+            });
+
+            // Components which chose the same edge point at each other, the smaller one becomes the root.
+            ParallelFor(jobs, 0, alive.size(), grain_size, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const uint32_t c = alive[i];
+                    jumped[c] = c < parents[c] && parents[parents[c]] == c ? c : parents[c];
+                }
+            });
+            std::swap(parents, jumped);
+
+            // Pointer jumping until every component points at its root.
+            std::atomic<bool> changed = true;
+            while (changed) {
+                changed = false;
+                ParallelFor(jobs, 0, alive.size(), grain_size, [&](size_t begin, size_t end) {
+                    bool local_changed = false;
+                    for (size_t i = begin; i < end; ++i) {
+                        const uint32_t c = alive[i];
+                        jumped[c] = parents[parents[c]];
+                        local_changed |= jumped[c] != parents[c];
+                    }
+                    if (local_changed) changed = true;
+                });
+                std::swap(parents, jumped);
+            }
+
+            // Relabel the vertices, drop contracted or finished components and edges inside a component.
+            ParallelFor(jobs, 0, n, grain_size, [&](size_t begin, size_t end) {
+                for (size_t v = begin; v < end; ++v) {
+                    components[v] = parents[components[v]];
+                }
+            });
+            ParallelFilter(jobs, alive, [&](uint32_t c) {
+                return parents[c] == c && lightest[c].load(std::memory_order_relaxed) != NoEdge;
+            });
+            ParallelFilter(jobs, active, [&](uint32_t p) {
+                return components[from[p]] != components[to[p]];
+            });
+        }
+
+        for (size_t p = 0; p < edges.size(); ++p) {
+            if (!in_forest[p]) continue;
+            edges_in_forest[Edge(edges[p])] = true;
+            forest_weight += weights[p];
+        }
+
+        // Root the tree of the source by a BFS on the forest edges, as in Kruskal.
+        std::vector<bool> visited(n, false);
+        std::queue<Vertex> q;
+        visited[source.idx()] = true;
+        q.push(source);
+
+        while (!q.empty()) {
+            Vertex cur = q.front();
+            q.pop();
+
+            ForEachNeighbor(graph, csr, edge_weights, cur, [&](const Halfedge &h, const Vertex &nbr, Real) {
+                if (!edges_in_forest[graph.get_edge(h)] || visited[nbr.idx()]) return;
+                visited[nbr.idx()] = true;
+                // Since h goes from cur to nbr, the opposite halfedge goes from nbr to cur.
+                vertex_predecessors[nbr] = graph.get_opposite(h);
+                q.push(nbr);
+            });
+        }
+    }
+
+    void Boruvka::set_custom_edge_weights(const EdgeProperty<Real> &weights) {
+        edge_weights = weights;
+    }
+
+    void Boruvka::clear_custom_edge_weights() {
+        edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+    }
+
+    void Boruvka::set_csr(const GraphCsr *csr) {
+        this->csr = csr;
+    }
+
+    void Boruvka::clear_csr() {
+        csr = nullptr;
+    }
+
+    void Boruvka::clear() {
+        if (!edge_weights && !csr) {
+            edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+        }
+
+        if (!vertex_predecessors) {
+            vertex_predecessors = graph.vertex_property<Halfedge>("v:boruvka:predecessors", Halfedge());
+        } else {
+            std::ranges::fill(vertex_predecessors.vector(), Halfedge());
+        }
+
+        if (!edges_in_forest) {
+            edges_in_forest = graph.edge_property<bool>("e:boruvka:in_forest", false);
+        } else {
+            std::fill(edges_in_forest.vector().begin(), edges_in_forest.vector().end(), false);
+        }
+        forest_weight = 0;
+        n_rounds = 0;
+    }
+}
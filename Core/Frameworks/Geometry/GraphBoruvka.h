@@ -0,0 +1,77 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef GRAPHBORUVKA_H
+#define GRAPHBORUVKA_H
+
+#include "GraphCsr.h"
+
+namespace Bcg {
+    /**
+     * @brief Boruvka: Computes a minimum spanning forest in parallel.
+     *
+     * Every round finds the lightest edge leaving each component with an atomic minimum over all remaining edges,
+     * adds these edges to the forest and contracts the components they connect by pointer jumping. Edges inside a
+     * component are then filtered out. The number of components at least halves in every round, so there are at most
+     * log2(n) rounds, and all steps of a round run in parallel if a JobSystem is given. Ties are broken by the edge
+     * index, so the forest is unique and matches Kruskal for distinct weights.
+     */
+    class Boruvka {
+    public:
+        /**
+         * @brief Constructs a Boruvka object for the given graph.
+         * @param graph The graph on which to compute the MST.
+         * @param jobs If set, the rounds run in parallel on this JobSystem.
+         */
+        explicit Boruvka(Graph &graph, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Computes the minimum spanning forest and roots the tree of the source vertex at it.
+         * @param source The source vertex from which the predecessors of its tree are set, as in Kruskal and Prim.
+         */
+        void compute(const Vertex &source);
+
+        /**
+         * @brief Sets custom edge weights for the MST computation.
+         * @param weights The custom edge weights to use.
+         */
+        void set_custom_edge_weights(const EdgeProperty<Real> &weights);
+
+        /**
+         * @brief Clears any custom edge weights set for the MST computation.
+         */
+        void clear_custom_edge_weights();
+
+        /**
+         * @brief Runs the computation on an adjacency snapshot of the graph instead of circulating its halfedges.
+         * The weights stored in the snapshot are used in place of the edge weights.
+         * @param csr The snapshot. It is not owned and has to stay alive until it is cleared.
+         */
+        void set_csr(const GraphCsr *csr);
+
+        /**
+         * @brief Clears the adjacency snapshot, the graph is circulated again.
+         */
+        void clear_csr();
+
+        EdgeProperty<Real> edge_weights; /**< The edge weights used in the MST computation. */
+        VertexProperty<Halfedge> vertex_predecessors;
+        /**< Predecessor halfedge for each vertex in the MST to the source. */
+        EdgeProperty<bool> edges_in_forest; /**< Marks the edges of the minimum spanning forest of all components. */
+        Real forest_weight = 0; /**< The total weight of the minimum spanning forest. */
+        size_t n_rounds = 0; /**< The number of rounds of the last compute. */
+
+    private:
+        /**
+         * @brief Clears the internal state of the Boruvka object.
+         */
+        void clear();
+
+        Graph &graph; /**< The graph on which to compute the MST. */
+        JobSystem *jobs; /**< The optional JobSystem used for the rounds. */
+        const GraphCsr *csr = nullptr; /**< The optional adjacency snapshot of the graph. */
+    };
+}
+
+#endif //GRAPHBORUVKA_H
@@ -0,0 +1,190 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphColoring.h"
+#include "GraphUtils.h"
+#include "Mesh.h"
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <numeric>
+
+namespace Bcg {
+    // Mixes the index with the seed into a random 32 bit priority.
+    static uint32_t HashPriority(uint32_t index, uint32_t seed) {
+        uint32_t x = index * 0x9e3779b9u ^ seed * 0x85ebca6bu;
+        x ^= x >> 16;
+        x *= 0x7feb352du;
+        x ^= x >> 15;
+        x *= 0x846ca68bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+    // Colors n elements with the Jones-Plassmann algorithm and groups them by color. for_each_neighbor(i, func) calls
+    // func(j) for the neighbors j of the valid element i, neighbors may be repeated.
+    template<typename IsValid, typename ForEachNeighbor>
+    static void ComputeColors(size_t n, IsValid &&is_valid, ForEachNeighbor &&for_each_neighbor, unsigned int seed,
+                              JobSystem *jobs, std::vector<int> &colors, GraphColoring &coloring) {
+        constexpr size_t grain_size = 4096;
+        // Snapshot the adjacency once, every element visits its neighbors three times below.
+        std::vector<size_t> offsets(n + 1, 0);
+        ParallelFor(jobs, 0, n, grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (!is_valid(i)) continue;
+                size_t count = 0;
+                for_each_neighbor(i, [&](size_t j) { count += j != i; });
+                offsets[i + 1] = count;
+            }
+        });
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        std::vector<uint32_t> neighbors(offsets.back());
+        // Largest logarithm of the degree first needs fewer colors than random priorities, while the rounds stay few.
+        std::vector<uint64_t> priorities(n);
+        ParallelFor(jobs, 0, n, grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                size_t entry = offsets[i];
+                if (is_valid(i)) {
+                    for_each_neighbor(i, [&](size_t j) {
+                        if (j != i) neighbors[entry++] = static_cast<uint32_t>(j);
+                    });
+                }
+                const uint64_t degree_class = std::bit_width(offsets[i + 1] - offsets[i]);
+                priorities[i] = degree_class << 32 | HashPriority(static_cast<uint32_t>(i), seed);
+            }
+        });
+        // Ties of the priorities are broken by the index, so the order is strict.
+        auto precedes = [&](uint32_t a, uint32_t b) {
+            return priorities[a] > priorities[b] || (priorities[a] == priorities[b] && a < b);
+        };
+
+        // Count the neighbors of higher priority, the elements without any form the first round.
+        colors.assign(n, -1);
+        std::vector<std::atomic<uint32_t> > waiting(n);
+        std::vector<uint32_t> frontier;
+        std::mutex mutex;
+        ParallelFor(jobs, 0, n, grain_size, [&](size_t begin, size_t end) {
+            std::vector<uint32_t> local;
+            for (size_t i = begin; i < end; ++i) {
+                if (!is_valid(i)) continue;
+                uint32_t count = 0;
+                for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+                    count += precedes(neighbors[k], static_cast<uint32_t>(i));
+                }
+                waiting[i].store(count, std::memory_order_relaxed);
+                if (count == 0) local.push_back(static_cast<uint32_t>(i));
+            }
+            std::scoped_lock lock(mutex);
+            frontier.insert(frontier.end(), local.begin(), local.end());
+        });
+
+        coloring.n_rounds = 0;
+        while (!frontier.empty()) {
+            ++coloring.n_rounds;
+            std::vector<uint32_t> next;
+            ParallelFor(jobs, 0, frontier.size(), 1024, [&](size_t begin, size_t end) {
+                std::vector<uint32_t> local;
+                std::vector<uint8_t> used;
+                for (size_t f = begin; f < end; ++f) {
+                    const uint32_t i = frontier[f];
+                    // All neighbors of higher priority were colored in earlier rounds. A color larger than the degree
+                    // is never needed, so only the colors up to the degree are marked.
+                    const size_t degree = offsets[i + 1] - offsets[i];
+                    used.assign(degree + 1, 0);
+                    for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+                        const uint32_t j = neighbors[k];
+                        if (precedes(j, i) && static_cast<size_t>(colors[j]) <= degree) used[colors[j]] = 1;
+                    }
+                    colors[i] = static_cast<int>(std::ranges::find(used, 0) - used.begin());
+                    for (size_t k = offsets[i]; k < offsets[i + 1]; ++k) {
+                        const uint32_t j = neighbors[k];
+                        if (precedes(i, j) && waiting[j].fetch_sub(1, std::memory_order_relaxed) == 1) {
+                            local.push_back(j);
+                        }
+                    }
+                }
+                std::scoped_lock lock(mutex);
+                next.insert(next.end(), local.begin(), local.end());
+            });
+            frontier = std::move(next);
+        }
+
+        // Group the elements by color in index order.
+        int max_color = -1;
+        for (const int color: colors) {
+            max_color = std::max(max_color, color);
+        }
+        coloring.n_colors = static_cast<size_t>(max_color + 1);
+        coloring.class_offsets.assign(coloring.n_colors + 1, 0);
+        for (const int color: colors) {
+            if (color >= 0) ++coloring.class_offsets[color + 1];
+        }
+        std::partial_sum(coloring.class_offsets.begin(), coloring.class_offsets.end(), coloring.class_offsets.begin());
+        coloring.class_elements.resize(coloring.class_offsets.back());
+        std::vector<size_t> positions(coloring.class_offsets.begin(), coloring.class_offsets.end() - 1);
+        for (size_t i = 0; i < n; ++i) {
+            if (colors[i] >= 0) coloring.class_elements[positions[colors[i]]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    // Calls func(j) for the edges j which share a vertex with edge i of a graph or a mesh, including i itself.
+    template<typename GraphType>
+    static auto EdgeNeighbors(const GraphType &graph) {
+        const bool skip_deleted = graph.has_garbage();
+        return [&graph, skip_deleted](size_t i, auto &&func) {
+            for (int k = 0; k < 2; ++k) {
+                for (const auto &h: graph.get_halfedges(graph.get_vertex(Edge(i), k))) {
+                    if (skip_deleted && graph.is_deleted(h)) continue;
+                    func(graph.get_edge(h).idx());
+                }
+            }
+        };
+    }
+
+    GraphColoring::GraphColoring(Graph &graph, JobSystem *jobs) : graph(&graph), jobs(jobs) {
+    }
+
+    GraphColoring::GraphColoring(Mesh &mesh, JobSystem *jobs) : mesh(&mesh), jobs(jobs) {
+    }
+
+    void GraphColoring::compute() {
+        VisitGraphOrMesh(graph, mesh, [this](auto &g) {
+            if (!vertex_colors) {
+                vertex_colors = g.template vertex_property<int>("v:colors", -1);
+            }
+            auto is_valid = [&g](size_t i) { return !g.is_deleted(Vertex(i)); };
+            ComputeColors(g.vertices.size(), is_valid, VertexNeighbors(g), seed, jobs, vertex_colors.vector(), *this);
+        });
+    }
+
+    void GraphColoring::compute_edges() {
+        VisitGraphOrMesh(graph, mesh, [this](auto &g) {
+            if (!edge_colors) {
+                edge_colors = g.template edge_property<int>("e:colors", -1);
+            }
+            auto is_valid = [&g](size_t i) { return !g.is_deleted(Edge(i)); };
+            ComputeColors(g.edges.size(), is_valid, EdgeNeighbors(g), seed, jobs, edge_colors.vector(), *this);
+        });
+    }
+
+    void GraphColoring::compute_faces() {
+        if (!HasFaces(mesh, "GraphColoring::compute_faces")) return;
+        if (!face_colors) {
+            face_colors = mesh->face_property<int>("f:colors", -1);
+        }
+        auto is_valid = [this](size_t i) { return !mesh->is_deleted(Face(i)); };
+        // Faces are neighbors if they share a vertex, every face around a vertex has one outgoing halfedge of it.
+        const bool skip_deleted = mesh->has_garbage();
+        auto for_each_neighbor = [this, skip_deleted](size_t i, auto &&func) {
+            for (const Vertex &v: mesh->get_vertices(Face(i))) {
+                for (const auto &h: mesh->get_halfedges(v)) {
+                    if (skip_deleted && mesh->is_deleted(h)) continue;
+                    const Face f = mesh->get_face(h);
+                    if (f.is_valid()) func(f.idx());
+                }
+            }
+        };
+        ComputeColors(mesh->faces.size(), is_valid, for_each_neighbor, seed, jobs, face_colors.vector(), *this);
+    }
+}
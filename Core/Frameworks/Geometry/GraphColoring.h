@@ -0,0 +1,103 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef GRAPHCOLORING_H
+#define GRAPHCOLORING_H
+
+#include "Graph.h"
+#include "JobSystem.h"
+#include <span>
+
+namespace Bcg {
+    class Mesh;
+
+    /**
+     * @brief GraphColoring: Colors the vertices or edges of a graph or mesh, or the faces of a mesh, so that adjacent
+     * elements have different colors. Every color class is an independent set, whose elements can be updated in
+     * parallel without conflicts, e.g. for Gauss-Seidel smoothing or local remeshing operations.
+     *
+     * The coloring is computed with the Jones-Plassmann algorithm. Every element has a priority, the largest logarithm
+     * of the degree first with random ties, and is colored with the smallest color not used by its neighbors of higher
+     * priority as soon as all of them are colored. The elements whose higher priority neighbors are done are colored
+     * in parallel rounds if a JobSystem is given. The result is the greedy coloring in priority order, so it only
+     * depends on the seed, not on the number of threads.
+     *
+     * After a compute, the elements are grouped by color in class_elements, and the elements of color c are
+     * class_elements[class_offsets[c]] to class_elements[class_offsets[c + 1] - 1].
+     */
+    class GraphColoring {
+    public:
+        /**
+         * @brief Constructs a GraphColoring object for the vertices or edges of a graph.
+         * @param graph The graph whose elements are colored.
+         * @param jobs If set, the coloring rounds and the sweeps run in parallel on this JobSystem.
+         */
+        explicit GraphColoring(Graph &graph, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Constructs a GraphColoring object for the vertices, edges or faces of a mesh.
+         * @param mesh The mesh whose elements are colored.
+         * @param jobs If set, the coloring rounds and the sweeps run in parallel on this JobSystem.
+         */
+        explicit GraphColoring(Mesh &mesh, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Colors the vertices into vertex_colors, vertices are adjacent if they share an edge.
+         */
+        void compute();
+
+        /**
+         * @brief Colors the edges into edge_colors, edges are adjacent if they share a vertex.
+         */
+        void compute_edges();
+
+        /**
+         * @brief Colors the faces of the mesh into face_colors, faces are adjacent if they share a vertex.
+         */
+        void compute_faces();
+
+        /**
+         * @brief Returns the indices of the elements of one color of the last compute.
+         * @param color The color, smaller than n_colors.
+         */
+        [[nodiscard]] std::span<const uint32_t> get_class(size_t color) const {
+            return {class_elements.data() + class_offsets[color], class_offsets[color + 1] - class_offsets[color]};
+        }
+
+        /**
+         * @brief Calls func(index) for all elements of the last compute, one color class after the other. The elements
+         * of a class are processed in parallel chunks if a JobSystem is given.
+         * @param grain_size The maximal number of elements per chunk.
+         * @param func The update of one element, it may write to the element and read its neighbors.
+         */
+        template<typename F>
+        void sweep(size_t grain_size, F &&func) const {
+            for (size_t color = 0; color < n_colors; ++color) {
+                ParallelFor(jobs, class_offsets[color], class_offsets[color + 1], grain_size,
+                            [&](size_t begin, size_t end) {
+                                for (size_t i = begin; i < end; ++i) {
+                                    func(static_cast<size_t>(class_elements[i]));
+                                }
+                            });
+            }
+        }
+
+        VertexProperty<int> vertex_colors; /**< The color of each vertex, -1 for deleted vertices. */
+        EdgeProperty<int> edge_colors; /**< The color of each edge, -1 for deleted edges. */
+        FaceProperty<int> face_colors; /**< The color of each face, -1 for deleted faces. */
+        std::vector<uint32_t> class_elements; /**< The indices of the colored elements, grouped by color. */
+        std::vector<size_t> class_offsets; /**< The first position of every color in class_elements, and the end. */
+        size_t n_colors = 0; /**< The number of colors of the last compute. */
+        size_t n_rounds = 0; /**< The number of parallel rounds of the last compute. */
+
+        unsigned int seed = 1; /**< The seed of the random priorities. */
+
+    private:
+        Graph *graph = nullptr; /**< The graph whose elements are colored. */
+        Mesh *mesh = nullptr; /**< The mesh whose elements are colored. */
+        JobSystem *jobs; /**< The optional JobSystem used for the rounds and the sweeps. */
+    };
+}
+
+#endif //GRAPHCOLORING_H
@@ -3,14 +3,20 @@
 //
 
 #include "GraphConnectedComponents.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include "Mesh.h"
+#include <atomic>
 
 namespace Bcg{
 
-    ConnectedComponents::ConnectedComponents(Graph &graph) : graph(graph){
+    template<HalfedgeGraph GraphType>
+    ConnectedComponents<GraphType>::ConnectedComponents(GraphType &graph) : graph(graph){
 
     }
 
-    void ConnectedComponents::compute() {
+    template<HalfedgeGraph GraphType>
+    void ConnectedComponents<GraphType>::compute() {
         clear(); // Reset all component IDs to -1.
         int comp_id = 0;
 
@@ -19,7 +25,7 @@ namespace Bcg{
             // If the vertex hasn't been assigned a component id yet.
             if (component_ids[v] == -1) {
                 // Traverse the connected component using BFS.
-                for (const Vertex &u : graph.bfs(v)) {
+                for (const Vertex &u : GraphBFSRange<GraphType>(&graph, v)) {
                     component_ids[u] = comp_id;
                 }
                 comp_id++;
@@ -27,11 +33,150 @@ namespace Bcg{
         }
     }
 
-    void ConnectedComponents::clear() {
+    template<HalfedgeGraph GraphType>
+    void ConnectedComponents<GraphType>::clear() {
         if (!component_ids) {
-            component_ids = graph.vertex_property<int>("v:component_ids", -1);
+            component_ids = graph.template vertex_property<int>("v:component_ids", -1);
         }else {
             std::ranges::fill(component_ids.vector(), -1);
         }
     }
-}
\ No newline at end of file
+
+    template class ConnectedComponents<Graph>;
+    template class ConnectedComponents<Mesh>;
+
+    // Union-find on atomic parent indices. A parent only ever moves to a smaller index, so concurrent path halving
+    // and linking keep every tree valid.
+    struct ConcurrentUnionFind {
+        explicit ConcurrentUnionFind(size_t n) : parents(n) {
+        }
+
+        unsigned int find(unsigned int x) {
+            while (true) {
+                unsigned int parent = parents[x].load(std::memory_order_relaxed);
+                if (parent == x) return x;
+                const unsigned int grandparent = parents[parent].load(std::memory_order_relaxed);
+                if (grandparent != parent) {
+                    parents[x].compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+                }
+                x = grandparent;
+            }
+        }
+
+        void link(unsigned int a, unsigned int b) {
+            while (true) {
+                unsigned int root_a = find(a), root_b = find(b);
+                if (root_a == root_b) return;
+                if (root_a < root_b) std::swap(root_a, root_b);
+                // Attach the larger root below the smaller one, retry if it got linked in the meantime.
+                if (parents[root_a].compare_exchange_strong(root_a, root_b, std::memory_order_relaxed)) return;
+            }
+        }
+
+        std::vector<std::atomic<unsigned int> > parents;
+    };
+
+    // Computes the component ids of n elements. for_each_neighbor(i, func) calls func(j) for the neighbors j of the
+    // valid element i until func returns false. Returns the number of components.
+    template<typename IsValid, typename ForEachNeighbor>
+    static size_t ComputeComponentIds(size_t n, IsValid &&is_valid, ForEachNeighbor &&for_each_neighbor,
+                                      size_t neighbor_rounds, JobSystem *jobs, std::vector<int> &ids) {
+        constexpr size_t grain_size = 1024;
+        ConcurrentUnionFind union_find(n);
+        ParallelFor(jobs, 0, n, grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                union_find.parents[i].store(static_cast<unsigned int>(i), std::memory_order_relaxed);
+            }
+        });
+
+        // Link the first neighbors of every element.
+        ParallelFor(jobs, 0, n, grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (!is_valid(i)) continue;
+                size_t count = 0;
+                for_each_neighbor(i, [&](size_t j) {
+                    if (count++ >= neighbor_rounds) return false;
+                    union_find.link(static_cast<unsigned int>(i), static_cast<unsigned int>(j));
+                    return true;
+                });
+            }
+        });
+
+        // Find the most frequent root of a sample of the elements.
+        std::vector<unsigned int> sample;
+        const size_t stride = std::max<size_t>(1, n / 1024);
+        for (size_t i = 0; i < n; i += stride) {
+            if (is_valid(i)) sample.push_back(union_find.find(static_cast<unsigned int>(i)));
+        }
+        std::ranges::sort(sample);
+        unsigned int largest = std::numeric_limits<unsigned int>::max();
+        for (size_t i = 0, best = 0; i < sample.size();) {
+            size_t j = i;
+            while (j < sample.size() && sample[j] == sample[i]) ++j;
+            if (j - i > best) {
+                best = j - i;
+                largest = sample[i];
+            }
+            i = j;
+        }
+
+        // Link the remaining neighbors of all elements outside of the largest component. An edge between that
+        // component and another one is still found from the other side, because the adjacency is symmetric.
+        ParallelFor(jobs, 0, n, grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (!is_valid(i) || union_find.find(static_cast<unsigned int>(i)) == largest) continue;
+                size_t count = 0;
+                for_each_neighbor(i, [&](size_t j) {
+                    if (count++ >= neighbor_rounds) {
+                        union_find.link(static_cast<unsigned int>(i), static_cast<unsigned int>(j));
+                    }
+                    return true;
+                });
+            }
+        });
+
+        // Every root is the smallest index of its component, so numbering the roots in index order matches the
+        // order in which the serial traversal discovers the components.
+        ids.assign(n, -1);
+        int n_components = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (is_valid(i) && union_find.find(static_cast<unsigned int>(i)) == i) {
+                ids[i] = n_components++;
+            }
+        }
+        ParallelFor(jobs, 0, n, grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (is_valid(i)) ids[i] = ids[union_find.find(static_cast<unsigned int>(i))];
+            }
+        });
+        return static_cast<size_t>(n_components);
+    }
+
+    ParallelConnectedComponents::ParallelConnectedComponents(Graph &graph, JobSystem *jobs) : graph(&graph),
+        jobs(jobs) {
+    }
+
+    ParallelConnectedComponents::ParallelConnectedComponents(Mesh &mesh, JobSystem *jobs) : mesh(&mesh), jobs(jobs) {
+    }
+
+    void ParallelConnectedComponents::compute() {
+        VisitGraphOrMesh(graph, mesh, [this](auto &g) {
+            if (!component_ids) {
+                component_ids = g.template vertex_property<int>("v:component_ids", -1);
+            }
+            auto is_valid = [&g](size_t i) { return !g.is_deleted(Vertex(i)); };
+            n_components = ComputeComponentIds(g.vertices.size(), is_valid, VertexNeighbors(g), neighbor_rounds, jobs,
+                                               component_ids.vector());
+        });
+    }
+
+    void ParallelConnectedComponents::compute_faces() {
+        if (!HasFaces(mesh, "ParallelConnectedComponents::compute_faces")) return;
+        if (!face_component_ids) {
+            face_component_ids = mesh->face_property<int>("f:component_ids", -1);
+        }
+        auto is_valid = [this](size_t i) { return !mesh->is_deleted(Face(i)); };
+        n_components = ComputeComponentIds(mesh->faces.size(), is_valid, FaceNeighbors(*mesh), neighbor_rounds, jobs,
+                                           face_component_ids.vector());
+    }
+}
@@ -8,16 +8,21 @@
 #include "Graph.h"
 
 namespace Bcg {
+    class JobSystem;
+    class Mesh;
+
     /**
      * @brief ConnectedComponents: Computes the connected components of a graph.
+     * @tparam GraphType Graph or Mesh, the components are computed on the vertices of either.
      */
+    template<HalfedgeGraph GraphType = Graph>
     class ConnectedComponents {
     public:
         /**
          * @brief Constructs a ConnectedComponents object for the given graph.
          * @param graph The graph on which to compute the connected components.
          */
-        explicit ConnectedComponents(Graph &graph);
+        explicit ConnectedComponents(GraphType &graph);
 
         /**
          * @brief Computes the connected components of the graph.
@@ -32,7 +37,55 @@ namespace Bcg {
          */
         void clear();
 
-        Graph &graph; /**< The graph on which to compute the connected components. */
+        GraphType &graph; /**< The graph on which to compute the connected components. */
+    };
+
+    /**
+     * @brief ParallelConnectedComponents: Computes the connected components with a concurrent union-find.
+     *
+     * Follows Afforest: every element is first linked to its first neighbor_rounds neighbors, which already joins
+     * most elements into one large component. A sample of the elements identifies that component, and only the
+     * elements outside of it link their remaining neighbors. Links attach the larger root to the smaller one with a
+     * compare and swap, so all elements are processed in parallel without locks and every root is the smallest index
+     * of its component. The ids are numbered in the order of these indices, which gives the same ids as
+     * ConnectedComponents.
+     */
+    class ParallelConnectedComponents {
+    public:
+        /**
+         * @brief Constructs a ParallelConnectedComponents object for the vertices of a graph.
+         * @param graph The graph on which to compute the connected components.
+         * @param jobs If set, the elements are linked in parallel on this JobSystem.
+         */
+        explicit ParallelConnectedComponents(Graph &graph, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Constructs a ParallelConnectedComponents object for the vertices or faces of a mesh.
+         * @param mesh The mesh on which to compute the connected components.
+         * @param jobs If set, the elements are linked in parallel on this JobSystem.
+         */
+        explicit ParallelConnectedComponents(Mesh &mesh, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Computes the components of the vertices connected by edges into component_ids.
+         */
+        void compute();
+
+        /**
+         * @brief Computes the components of the faces of the mesh connected by interior edges into
+         * face_component_ids.
+         */
+        void compute_faces();
+
+        VertexProperty<int> component_ids; /**< The component IDs for each vertex, -1 for deleted vertices. */
+        FaceProperty<int> face_component_ids; /**< The component IDs for each face, -1 for deleted faces. */
+        size_t n_components = 0; /**< The number of components found by the last compute. */
+        size_t neighbor_rounds = 2; /**< The number of neighbors every element links before the sampling. */
+
+    private:
+        Graph *graph = nullptr; /**< The graph on which to compute the connected components. */
+        Mesh *mesh = nullptr; /**< The mesh on which to compute the connected components. */
+        JobSystem *jobs; /**< The optional JobSystem used for the linking. */
     };
 }
 
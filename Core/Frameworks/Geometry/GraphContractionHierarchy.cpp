@@ -0,0 +1,534 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphContractionHierarchy.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <utility>
+
+namespace Bcg {
+    static constexpr unsigned int Invalid = std::numeric_limits<unsigned int>::max();
+    // Witness searches give up after settling this many vertices and keep the shortcut, which is always correct.
+    // The searches which only estimate the priority of a vertex use a tighter limit.
+    static constexpr size_t MaxWitnessSettled = 500;
+    static constexpr size_t MaxPriorityWitnessSettled = 50;
+
+    // An edge or shortcut of the graph which is being contracted.
+    struct ChArc {
+        unsigned int target;
+        Real weight;
+        unsigned int middle;
+        unsigned int halfedge;
+    };
+
+    struct ChShortcut {
+        unsigned int from;
+        unsigned int to;
+        Real weight;
+    };
+
+    using ChAdjacency = std::vector<std::vector<ChArc> >;
+
+    // Inserts the arc or lowers the weight of an existing arc to the same target. Returns true if it changed.
+    static bool AddArc(std::vector<ChArc> &arcs, const ChArc &arc) {
+        for (ChArc &existing: arcs) {
+            if (existing.target == arc.target) {
+                if (arc.weight >= existing.weight) return false;
+                existing = arc;
+                return true;
+            }
+        }
+        arcs.push_back(arc);
+        return true;
+    }
+
+    // Bounded Dijkstra search on the remaining vertices, reused across searches by generation stamps.
+    struct ChWitnessSearch {
+        std::vector<Real> distances;
+        std::vector<unsigned int> stamps;
+        std::vector<unsigned int> target_stamps;
+        unsigned int generation = 0;
+        std::priority_queue<std::pair<Real, unsigned int>, std::vector<std::pair<Real, unsigned int> >,
+            std::greater<> > queue;
+
+        explicit ChWitnessSearch(size_t n) : distances(n), stamps(n, 0), target_stamps(n, 0) {
+        }
+
+        [[nodiscard]] Real get_distance(unsigned int v) const {
+            return stamps[v] == generation ? distances[v] : std::numeric_limits<Real>::max();
+        }
+
+        // Searches from source until all targets are settled, the distance exceeds max_distance or the settled limit
+        // is reached.
+        void run(const ChAdjacency &adjacency, const std::vector<uint8_t> &contracted, unsigned int excluded,
+                 unsigned int source, const std::vector<ChArc> &targets, size_t first_target, Real max_distance,
+                 size_t max_settled) {
+            if (++generation == 0) {
+                std::ranges::fill(stamps, 0);
+                std::ranges::fill(target_stamps, 0);
+                generation = 1;
+            }
+            size_t n_targets = 0;
+            for (size_t j = first_target; j < targets.size(); ++j) {
+                n_targets += std::exchange(target_stamps[targets[j].target], generation) != generation;
+            }
+            queue = {};
+            stamps[source] = generation;
+            distances[source] = 0;
+            queue.emplace(0, source);
+            size_t n_settled = 0;
+            while (!queue.empty() && n_settled < max_settled && n_targets > 0) {
+                const auto [distance, v] = queue.top();
+                queue.pop();
+                if (distance > distances[v]) continue;
+                if (distance > max_distance) break;
+                ++n_settled;
+                n_targets -= target_stamps[v] == generation;
+                for (const ChArc &arc: adjacency[v]) {
+                    if (arc.target == excluded || contracted[arc.target]) continue;
+                    const Real new_distance = distance + arc.weight;
+                    if (new_distance <= max_distance &&
+                        (stamps[arc.target] != generation || new_distance < distances[arc.target])) {
+                        stamps[arc.target] = generation;
+                        distances[arc.target] = new_distance;
+                        queue.emplace(new_distance, arc.target);
+                    }
+                }
+            }
+        }
+    };
+
+    // Collects the shortcuts needed to contract v, i.e. the neighbor pairs without a witness path avoiding v.
+    static void FindShortcuts(const ChAdjacency &adjacency, const std::vector<uint8_t> &contracted, unsigned int v,
+                              size_t max_settled, ChWitnessSearch &search, std::vector<ChShortcut> &shortcuts) {
+        shortcuts.clear();
+        const std::vector<ChArc> &arcs = adjacency[v];
+        for (size_t i = 0; i + 1 < arcs.size(); ++i) {
+            Real max_distance = 0;
+            for (size_t j = i + 1; j < arcs.size(); ++j) {
+                max_distance = std::max(max_distance, arcs[i].weight + arcs[j].weight);
+            }
+            search.run(adjacency, contracted, v, arcs[i].target, arcs, i + 1, max_distance, max_settled);
+            for (size_t j = i + 1; j < arcs.size(); ++j) {
+                const Real via = arcs[i].weight + arcs[j].weight;
+                if (search.get_distance(arcs[j].target) > via) {
+                    shortcuts.push_back({arcs[i].target, arcs[j].target, via});
+                }
+            }
+        }
+    }
+
+    ContractionHierarchy::ContractionHierarchy(Graph &graph, JobSystem *jobs) : graph(graph), jobs(jobs),
+        meeting_vertex(Invalid) {
+    }
+
+    void ContractionHierarchy::build() {
+        if (!edge_weights) {
+            clear_custom_edge_weights();
+        }
+
+        const size_t n = graph.vertices.size();
+        ChAdjacency adjacency(n);
+        for (const Edge &e: graph.edges) {
+            if (graph.is_deleted(e)) continue;
+            const Halfedge h = graph.get_halfedge(e, 0);
+            const unsigned int to = static_cast<unsigned int>(graph.get_vertex(h).idx());
+            const unsigned int from = static_cast<unsigned int>(graph.get_vertex(graph.get_opposite(h)).idx());
+            const Real weight = edge_weights[e];
+            if (from == to || weight < 0) continue;
+            AddArc(adjacency[from], {to, weight, Invalid, static_cast<unsigned int>(h.idx())});
+            AddArc(adjacency[to], {from, weight, Invalid, static_cast<unsigned int>(graph.get_opposite(h).idx())});
+        }
+
+        std::vector<uint8_t> contracted(n, 0);
+        std::vector<int> priorities(n, 0);
+        std::vector<int> contracted_neighbors(n, 0);
+        std::vector<unsigned int> remaining;
+        for (const auto &v: graph.vertices) {
+            remaining.push_back(static_cast<unsigned int>(v.idx()));
+        }
+
+        // Every chunk takes a search from the pool, so searches are allocated once per thread and not per round.
+        std::vector<std::unique_ptr<ChWitnessSearch> > pool;
+        std::mutex mutex;
+        auto with_search = [&](auto &&func) {
+            std::unique_ptr<ChWitnessSearch> search;
+            {
+                std::scoped_lock lock(mutex);
+                if (!pool.empty()) {
+                    search = std::move(pool.back());
+                    pool.pop_back();
+                }
+            }
+            if (!search) {
+                search = std::make_unique<ChWitnessSearch>(n);
+            }
+            func(*search);
+            std::scoped_lock lock(mutex);
+            pool.push_back(std::move(search));
+        };
+
+        auto update_priorities = [&](const std::vector<unsigned int> &vertices) {
+            ParallelFor(jobs, 0, vertices.size(), 64, [&](size_t begin, size_t end) {
+                with_search([&](ChWitnessSearch &search) {
+                    std::vector<ChShortcut> shortcuts;
+                    for (size_t k = begin; k < end; ++k) {
+                        const unsigned int v = vertices[k];
+                        FindShortcuts(adjacency, contracted, v, MaxPriorityWitnessSettled, search, shortcuts);
+                        priorities[v] = static_cast<int>(shortcuts.size()) - static_cast<int>(adjacency[v].size()) +
+                                        contracted_neighbors[v];
+                    }
+                });
+            });
+        };
+        update_priorities(remaining);
+
+        ranks.assign(n, Invalid);
+        std::vector<std::vector<ChArc> > up_arcs(n);
+        std::vector<unsigned int> selected, touched;
+        std::vector<std::vector<ChShortcut> > shortcuts;
+        unsigned int next_rank = 0;
+        while (!remaining.empty()) {
+            // Select the vertices whose priority is a strict local minimum, ties are broken by the index.
+            selected.clear();
+            ParallelFor(jobs, 0, remaining.size(), 1024, [&](size_t begin, size_t end) {
+                std::vector<unsigned int> local;
+                for (size_t k = begin; k < end; ++k) {
+                    const unsigned int v = remaining[k];
+                    const bool is_minimum = std::ranges::all_of(adjacency[v], [&](const ChArc &arc) {
+                        return std::pair(priorities[v], v) < std::pair(priorities[arc.target], arc.target);
+                    });
+                    if (is_minimum) local.push_back(v);
+                }
+                std::scoped_lock lock(mutex);
+                selected.insert(selected.end(), local.begin(), local.end());
+            });
+            for (const unsigned int v: selected) {
+                contracted[v] = 1;
+            }
+
+            // The witness searches avoid all vertices of the round, so the shortcuts of independent vertices do not
+            // rely on each other.
+            shortcuts.resize(selected.size());
+            ParallelFor(jobs, 0, selected.size(), 16, [&](size_t begin, size_t end) {
+                with_search([&](ChWitnessSearch &search) {
+                    for (size_t k = begin; k < end; ++k) {
+                        FindShortcuts(adjacency, contracted, selected[k], MaxWitnessSettled, search, shortcuts[k]);
+                    }
+                });
+            });
+
+            touched.clear();
+            for (size_t k = 0; k < selected.size(); ++k) {
+                const unsigned int v = selected[k];
+                ranks[v] = next_rank++;
+                for (const ChArc &arc: adjacency[v]) {
+                    std::erase_if(adjacency[arc.target], [&](const ChArc &back) { return back.target == v; });
+                    ++contracted_neighbors[arc.target];
+                    touched.push_back(arc.target);
+                }
+                for (const ChShortcut &shortcut: shortcuts[k]) {
+                    AddArc(adjacency[shortcut.from], {shortcut.to, shortcut.weight, v, Invalid});
+                    AddArc(adjacency[shortcut.to], {shortcut.from, shortcut.weight, v, Invalid});
+                }
+                up_arcs[v] = std::move(adjacency[v]);
+                adjacency[v] = {};
+            }
+
+            std::erase_if(remaining, [&](unsigned int v) { return contracted[v] != 0; });
+            std::ranges::sort(touched);
+            touched.erase(std::ranges::unique(touched).begin(), touched.end());
+            std::erase_if(touched, [&](unsigned int v) { return contracted[v] != 0; });
+            update_priorities(touched);
+        }
+
+        up_offsets.assign(n + 1, 0);
+        for (size_t v = 0; v < n; ++v) {
+            up_offsets[v + 1] = up_offsets[v] + up_arcs[v].size();
+        }
+        up_targets.resize(up_offsets[n]);
+        up_weights.resize(up_offsets[n]);
+        up_middles.resize(up_offsets[n]);
+        up_halfedges.resize(up_offsets[n]);
+        for (size_t v = 0; v < n; ++v) {
+            size_t i = up_offsets[v];
+            for (const ChArc &arc: up_arcs[v]) {
+                up_targets[i] = arc.target;
+                up_weights[i] = arc.weight;
+                up_middles[i] = arc.middle;
+                up_halfedges[i] = arc.halfedge;
+                ++i;
+            }
+        }
+        n_shortcuts = std::ranges::count_if(up_middles, [](unsigned int middle) { return middle != Invalid; });
+    }
+
+    Real ContractionHierarchy::compute(const Vertex &source, const Vertex &sink) {
+        if (!is_built()) {
+            std::cerr << "Error: ContractionHierarchy::compute: The hierarchy is not built." << std::endl;
+            return std::numeric_limits<Real>::max();
+        }
+        if (source.idx() >= ranks.size() || sink.idx() >= ranks.size()) {
+            std::cerr << "Error: ContractionHierarchy::compute: Invalid source or sink vertex." << std::endl;
+            return std::numeric_limits<Real>::max();
+        }
+        clear();
+
+        using Queue = std::priority_queue<std::pair<Real, unsigned int>, std::vector<std::pair<Real, unsigned int> >,
+            std::greater<> >;
+        Queue queues[2];
+        const unsigned int starts[2] = {static_cast<unsigned int>(source.idx()), static_cast<unsigned int>(sink.idx())};
+        for (int side = 0; side < 2; ++side) {
+            stamps[side][starts[side]] = generation;
+            distances[side][starts[side]] = 0;
+            parents[side][starts[side]] = starts[side];
+            queues[side].emplace(0, starts[side]);
+        }
+
+        Real mu = std::numeric_limits<Real>::max();
+        while (true) {
+            // Expand the side with the smaller key, both searches are done once their keys reach mu.
+            int side = -1;
+            for (int s = 0; s < 2; ++s) {
+                if (!queues[s].empty() && queues[s].top().first < mu &&
+                    (side < 0 || queues[s].top().first < queues[side].top().first)) {
+                    side = s;
+                }
+            }
+            if (side < 0) break;
+
+            const auto [distance, v] = queues[side].top();
+            queues[side].pop();
+            if (distance > distances[side][v]) continue;
+            ++n_settled;
+
+            const int other = 1 - side;
+            if (stamps[other][v] == generation && distance + distances[other][v] < mu) {
+                mu = distance + distances[other][v];
+                meeting_vertex = v;
+            }
+
+            for (size_t i = up_offsets[v]; i < up_offsets[v + 1]; ++i) {
+                const unsigned int u = up_targets[i];
+                const Real new_distance = distance + up_weights[i];
+                if (stamps[side][u] != generation || new_distance < distances[side][u]) {
+                    stamps[side][u] = generation;
+                    distances[side][u] = new_distance;
+                    parents[side][u] = v;
+                    queues[side].emplace(new_distance, u);
+                }
+            }
+        }
+        return mu;
+    }
+
+    std::vector<Halfedge> ContractionHierarchy::get_path(bool reverse) const {
+        std::vector<Halfedge> path;
+        if (meeting_vertex == Invalid) return path;
+
+        // The upward chain of the forward search, from the meeting vertex down to the source.
+        std::vector<unsigned int> chain;
+        for (unsigned int v = meeting_vertex; parents[0][v] != v; v = parents[0][v]) {
+            chain.push_back(v);
+        }
+        unsigned int current = chain.empty() ? meeting_vertex : parents[0][chain.back()];
+        for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+            unpack(current, *it, path);
+            current = *it;
+        }
+        for (unsigned int v = meeting_vertex; parents[1][v] != v; v = parents[1][v]) {
+            unpack(v, parents[1][v], path);
+        }
+
+        // The path runs from the source to the sink, flip it into the order of BacktracePathSinkToSource.
+        for (Halfedge &h: path) {
+            h = graph.get_opposite(h);
+        }
+        if (!reverse) {
+            std::ranges::reverse(path);
+        }
+        return path;
+    }
+
+    void ContractionHierarchy::unpack(unsigned int from, unsigned int to, std::vector<Halfedge> &path) const {
+        const unsigned int lower = ranks[from] < ranks[to] ? from : to;
+        const unsigned int higher = lower == from ? to : from;
+        for (size_t i = up_offsets[lower]; i < up_offsets[lower + 1]; ++i) {
+            if (up_targets[i] != higher) continue;
+            if (up_middles[i] == Invalid) {
+                const Halfedge h(up_halfedges[i]);
+                path.push_back(lower == from ? h : graph.get_opposite(h));
+            } else {
+                unpack(from, up_middles[i], path);
+                unpack(up_middles[i], to, path);
+            }
+            return;
+        }
+    }
+
+    static constexpr char ChMagic[8] = {'B', 'C', 'G', 'C', 'H', '0', '0', '1'};
+
+    template<typename T>
+    static void WriteVector(std::ofstream &file, const std::vector<T> &values) {
+        const uint64_t size = values.size();
+        file.write(reinterpret_cast<const char *>(&size), sizeof(size));
+        file.write(reinterpret_cast<const char *>(values.data()), static_cast<std::streamsize>(size * sizeof(T)));
+    }
+
+    // Reads a vector of the expected size, which has to fit into the rest of the file before anything is allocated.
+    template<typename T>
+    static bool ReadVector(std::ifstream &file, std::vector<T> &values, uint64_t expected_size) {
+        uint64_t size = 0;
+        file.read(reinterpret_cast<char *>(&size), sizeof(size));
+        if (!file || size != expected_size) return false;
+        const std::streampos position = file.tellg();
+        file.seekg(0, std::ios::end);
+        const std::streamoff remaining = file.tellg() - position;
+        file.seekg(position);
+        if (!file || remaining < 0 || size > static_cast<uint64_t>(remaining) / sizeof(T)) return false;
+        values.resize(size);
+        file.read(reinterpret_cast<char *>(values.data()), static_cast<std::streamsize>(size * sizeof(T)));
+        return static_cast<bool>(file);
+    }
+
+    bool ContractionHierarchy::save(const std::string &filename) const {
+        if (!is_built()) {
+            std::cerr << "Error: ContractionHierarchy::save: The hierarchy is not built." << std::endl;
+            return false;
+        }
+        std::ofstream file(filename, std::ios::out | std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: ContractionHierarchy::save: Could not open file for writing." << std::endl;
+            return false;
+        }
+        const uint64_t n_halfedges = graph.halfedges.size();
+        file.write(ChMagic, sizeof(ChMagic));
+        file.write(reinterpret_cast<const char *>(&n_halfedges), sizeof(n_halfedges));
+        WriteVector(file, ranks);
+        WriteVector(file, up_offsets);
+        WriteVector(file, up_targets);
+        WriteVector(file, up_weights);
+        WriteVector(file, up_middles);
+        WriteVector(file, up_halfedges);
+        return file.good();
+    }
+
+    bool ContractionHierarchy::load(const std::string &filename) {
+        clear_hierarchy();
+        std::ifstream file(filename, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: ContractionHierarchy::load: Could not open file for reading." << std::endl;
+            return false;
+        }
+        char magic[sizeof(ChMagic)] = {};
+        uint64_t n_halfedges = 0;
+        file.read(magic, sizeof(magic));
+        file.read(reinterpret_cast<char *>(&n_halfedges), sizeof(n_halfedges));
+        if (!file || !std::equal(magic, magic + sizeof(magic), ChMagic)) {
+            std::cerr << "Error: ContractionHierarchy::load: Not a contraction hierarchy file." << std::endl;
+            return false;
+        }
+        const uint64_t n = graph.vertices.size();
+        if (n_halfedges != graph.halfedges.size() || !ReadVector(file, ranks, n) ||
+            !ReadVector(file, up_offsets, n + 1)) {
+            std::cerr << "Error: ContractionHierarchy::load: The hierarchy does not match the graph." << std::endl;
+            clear_hierarchy();
+            return false;
+        }
+        const uint64_t n_up = up_offsets.back();
+        if (!ReadVector(file, up_targets, n_up) || !ReadVector(file, up_weights, n_up) ||
+            !ReadVector(file, up_middles, n_up) || !ReadVector(file, up_halfedges, n_up)) {
+            std::cerr << "Error: ContractionHierarchy::load: Could not read file." << std::endl;
+            clear_hierarchy();
+            return false;
+        }
+        if (!is_valid_hierarchy()) {
+            std::cerr << "Error: ContractionHierarchy::load: The hierarchy is corrupt." << std::endl;
+            clear_hierarchy();
+            return false;
+        }
+        n_shortcuts = std::ranges::count_if(up_middles, [](unsigned int middle) { return middle != Invalid; });
+        return true;
+    }
+
+    void ContractionHierarchy::clear_hierarchy() {
+        ranks.clear();
+        up_offsets.clear();
+        up_targets.clear();
+        up_weights.clear();
+        up_middles.clear();
+        up_halfedges.clear();
+        n_shortcuts = 0;
+        meeting_vertex = Invalid;
+    }
+
+    bool ContractionHierarchy::is_valid_hierarchy() const {
+        const size_t n = ranks.size();
+        // Every vertex has its own rank, unranked vertices were deleted and have no upward edges.
+        std::vector<uint8_t> used(n, 0);
+        for (const unsigned int rank: ranks) {
+            if (rank == Invalid) continue;
+            if (rank >= n || used[rank]) return false;
+            used[rank] = 1;
+        }
+        if (up_offsets.size() != n + 1 || up_offsets[0] != 0 || up_offsets[n] != up_targets.size()) return false;
+        for (size_t v = 0; v < n; ++v) {
+            if (up_offsets[v] > up_offsets[v + 1]) return false;
+            if (ranks[v] == Invalid && up_offsets[v] != up_offsets[v + 1]) return false;
+            for (size_t i = up_offsets[v]; i < up_offsets[v + 1]; ++i) {
+                // Upward edges lead to higher ranks, so the searches run on a DAG. The middle vertex of a shortcut was
+                // contracted before both of its ends, so unpacking terminates.
+                const unsigned int u = up_targets[i];
+                if (u >= n || ranks[u] == Invalid || ranks[u] <= ranks[v] || !(up_weights[i] >= 0)) return false;
+                const unsigned int middle = up_middles[i];
+                if (middle == Invalid) {
+                    const unsigned int h = up_halfedges[i];
+                    if (h >= graph.halfedges.size() || graph.get_vertex(Halfedge(h)).idx() != u ||
+                        graph.get_vertex(graph.get_opposite(Halfedge(h))).idx() != v) {
+                        return false;
+                    }
+                } else if (middle >= n || ranks[middle] == Invalid || ranks[middle] >= ranks[v]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void ContractionHierarchy::set_custom_edge_weights(const EdgeProperty<Real> &weights) {
+        edge_weights = weights;
+    }
+
+    void ContractionHierarchy::clear_custom_edge_weights() {
+        edge_weights = graph.get_edge_property<Real>("e:length");
+        if (!edge_weights) {
+            edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+        }
+    }
+
+    void ContractionHierarchy::clear() {
+        const size_t n = ranks.size();
+        for (int side = 0; side < 2; ++side) {
+            if (stamps[side].size() != n) {
+                distances[side].resize(n);
+                parents[side].resize(n);
+                stamps[side].assign(n, 0);
+            }
+        }
+        if (++generation == 0) {
+            std::ranges::fill(stamps[0], 0);
+            std::ranges::fill(stamps[1], 0);
+            generation = 1;
+        }
+        meeting_vertex = Invalid;
+        n_settled = 0;
+    }
+}
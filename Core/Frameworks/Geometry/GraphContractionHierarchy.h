@@ -0,0 +1,127 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef GRAPHCONTRACTIONHIERARCHY_H
+#define GRAPHCONTRACTIONHIERARCHY_H
+
+#include "GraphCsr.h"
+
+namespace Bcg {
+    /**
+     * @brief ContractionHierarchy: Preprocessed shortest path queries on a static graph with non-negative edge weights.
+     *
+     * build contracts the vertices in rounds. Every round selects the vertices whose priority (the edge difference,
+     * i.e. the number of shortcuts needed minus the number of removed edges, plus the number of contracted neighbors)
+     * is smaller than that of all their remaining neighbors. The selected vertices are independent, so their witness
+     * searches and their priority updates run in parallel if a JobSystem is given. A shortcut between two neighbors
+     * is only inserted if no witness path of at most the same length avoids all vertices of the round.
+     *
+     * Every vertex keeps its upward edges, i.e. the original edges and shortcuts to neighbors of higher rank. A query
+     * runs a Dijkstra search from the source and one from the sink on the upward edges only and meets at the highest
+     * vertex of the shortest path. Shortcuts are unpacked recursively into the halfedges of the graph.
+     */
+    class ContractionHierarchy {
+    public:
+        /**
+         * @brief Constructs a contraction hierarchy for the given graph, call build or load before querying.
+         * @param graph The graph to preprocess.
+         * @param jobs If set, the witness searches of the preprocessing run in parallel on this JobSystem.
+         */
+        explicit ContractionHierarchy(Graph &graph, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Contracts all vertices of the graph and stores the upward edges.
+         */
+        void build();
+
+        /**
+         * @brief Computes the length of the shortest path from the source vertex to the sink vertex.
+         * @param source The source vertex.
+         * @param sink The sink vertex.
+         * @return The length of the shortest path, max if the sink is unreachable or the hierarchy is not built.
+         */
+        Real compute(const Vertex &source, const Vertex &sink);
+
+        /**
+         * @brief Retrieve the shortest path found by the last compute in halfedges of the graph.
+         * @param reverse If false the path is ordered from the sink to the source and every halfedge points towards
+         * the source, as in BacktracePathSinkToSource, otherwise the path is reversed.
+         * @return The path, empty if the sink was not reached or equals the source.
+         */
+        [[nodiscard]] std::vector<Halfedge> get_path(bool reverse = false) const;
+
+        /**
+         * @brief Writes the hierarchy to a binary file.
+         * @return True if the file was written.
+         */
+        [[nodiscard]] bool save(const std::string &filename) const;
+
+        /**
+         * @brief Reads a hierarchy written by save for the same graph.
+         * @return True if the file was read, matches the number of vertices and halfedges of the graph and is
+         * consistent with it. Otherwise the hierarchy is cleared and not built.
+         */
+        bool load(const std::string &filename);
+
+        /**
+         * @brief Checks whether the hierarchy was built or loaded.
+         */
+        [[nodiscard]] bool is_built() const { return !ranks.empty(); }
+
+        /**
+         * @brief Sets custom edge weights for the preprocessing.
+         * @param weights The custom edge weights to use.
+         */
+        void set_custom_edge_weights(const EdgeProperty<Real> &weights);
+
+        /**
+         * @brief Clears any custom edge weights, "e:length" or the edge lengths of "v:position" are used instead.
+         */
+        void clear_custom_edge_weights();
+
+        EdgeProperty<Real> edge_weights; /**< The edge weights used in the preprocessing. */
+        size_t n_shortcuts = 0; /**< The number of shortcuts inserted by the preprocessing. */
+        size_t n_settled = 0; /**< The number of vertices settled by both searches of the last compute. */
+
+    private:
+        /**
+         * @brief Clears the query state and sizes it to the hierarchy.
+         */
+        void clear();
+
+        /**
+         * @brief Clears the ranks and the upward edges, the hierarchy is not built afterwards.
+         */
+        void clear_hierarchy();
+
+        /**
+         * @brief Checks that loaded ranks and upward edges are consistent with the graph, so queries and unpacking stay
+         * in bounds and terminate.
+         */
+        [[nodiscard]] bool is_valid_hierarchy() const;
+
+        /**
+         * @brief Appends the halfedges of the edge or shortcut between from and to, oriented from from to to.
+         */
+        void unpack(unsigned int from, unsigned int to, std::vector<Halfedge> &path) const;
+
+        Graph &graph; /**< The graph to preprocess. */
+        JobSystem *jobs; /**< The optional JobSystem used for the preprocessing. */
+
+        std::vector<unsigned int> ranks; /**< The contraction order of every vertex. */
+        std::vector<size_t> up_offsets; /**< The ranges of the upward edges of every vertex. */
+        std::vector<unsigned int> up_targets; /**< The higher ranked neighbor of an upward edge. */
+        std::vector<Real> up_weights; /**< The weight of an upward edge. */
+        std::vector<unsigned int> up_middles; /**< The contracted vertex of a shortcut, invalid for edges. */
+        std::vector<unsigned int> up_halfedges; /**< The halfedge to the neighbor, invalid for shortcuts. */
+
+        std::vector<Real> distances[2]; /**< The distances of the forward and the backward search. */
+        std::vector<unsigned int> parents[2]; /**< The parent vertices of the forward and the backward search. */
+        std::vector<unsigned int> stamps[2]; /**< The query generation which last wrote a vertex. */
+        unsigned int generation = 0; /**< The generation of the current query. */
+        unsigned int meeting_vertex; /**< The highest vertex of the last shortest path, or invalid. */
+    };
+}
+
+#endif //GRAPHCONTRACTIONHIERARCHY_H
@@ -0,0 +1,99 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphCsr.h"
+#include "Mesh.h"
+#include "JobSystem.h"
+#include <iostream>
+
+namespace Bcg {
+    // Builds the snapshot of a Graph or a Mesh, both expose the same halfedge interface.
+    template<typename GraphType>
+    static void BuildCsr(GraphCsr &csr, const GraphType &graph, const EdgeProperty<Real> &edge_weights,
+                         JobSystem *jobs) {
+        auto &offsets = csr.offsets;
+        auto &neighbors = csr.neighbors;
+        auto &halfedges = csr.halfedges;
+        auto &weights = csr.weights;
+        const size_t n = graph.vertices.size();
+        const auto positions = graph.template get_vertex_property<Vector<Real, 3> >("v:position");
+        const bool skip_deleted = graph.has_garbage();
+        csr.n_halfedges = graph.n_halfedges();
+
+        auto include = [&](const Halfedge &h) {
+            return !skip_deleted || !graph.is_deleted(h);
+        };
+
+        // Count the valence of every vertex into offsets[v + 1].
+        offsets.assign(n + 1, 0);
+        ParallelFor(jobs, 0, n, 4096, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const Vertex v(i);
+                if (skip_deleted && graph.is_deleted(v)) continue;
+                size_t count = 0;
+                for (const auto &h: graph.get_halfedges(v)) {
+                    count += include(h);
+                }
+                offsets[i + 1] = count;
+            }
+        });
+        for (size_t i = 0; i < n; ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+
+        neighbors.resize(offsets[n]);
+        halfedges.resize(offsets[n]);
+        weights.resize(offsets[n]);
+        ParallelFor(jobs, 0, n, 4096, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const Vertex v(i);
+                if (offsets[i] == offsets[i + 1]) continue;
+                size_t k = offsets[i];
+                for (const auto &h: graph.get_halfedges(v)) {
+                    if (!include(h)) continue;
+                    const Vertex u = graph.get_vertex(h);
+                    neighbors[k] = static_cast<unsigned int>(u.idx());
+                    halfedges[k] = static_cast<unsigned int>(h.idx());
+                    if (edge_weights) {
+                        weights[k] = edge_weights[graph.get_edge(h)];
+                    } else {
+                        weights[k] = positions ? (positions[u] - positions[v]).norm() : 1;
+                    }
+                    ++k;
+                }
+            }
+        });
+    }
+
+    GraphCsr::GraphCsr(const Graph &graph, const EdgeProperty<Real> &weights, JobSystem *jobs) {
+        BuildCsr(*this, graph, weights, jobs);
+    }
+
+    GraphCsr::GraphCsr(const Mesh &mesh, const EdgeProperty<Real> &weights, JobSystem *jobs) {
+        BuildCsr(*this, mesh, weights, jobs);
+    }
+
+    template<typename GraphType>
+    static bool CheckCsr(const GraphType &graph, const GraphCsr *csr, const std::string &caller) {
+        if (csr && csr->n_vertices() != graph.vertices.size()) {
+            std::cerr << "Error: " << caller << ": The adjacency snapshot has " << csr->n_vertices()
+                    << " vertices, but the graph has " << graph.vertices.size() << ". Rebuild the snapshot." << std::endl;
+            return false;
+        }
+        if (csr && csr->n_halfedges != graph.n_halfedges()) {
+            std::cerr << "Error: " << caller << ": The adjacency snapshot has " << csr->n_halfedges
+                    << " halfedges, but the graph has " << graph.n_halfedges() << ". Rebuild the snapshot." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool IsCompatibleCsr(const Graph &graph, const GraphCsr *csr, const std::string &caller) {
+        return CheckCsr(graph, csr, caller);
+    }
+
+    bool IsCompatibleCsr(const Mesh &mesh, const GraphCsr *csr, const std::string &caller) {
+        return CheckCsr(mesh, csr, caller);
+    }
+}
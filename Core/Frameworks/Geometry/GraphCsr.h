@@ -0,0 +1,132 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef GRAPHCSR_H
+#define GRAPHCSR_H
+
+#include "Graph.h"
+
+namespace Bcg {
+    class JobSystem;
+    class Mesh;
+
+    /**
+     * @brief GraphCsr: Immutable compressed sparse row snapshot of the adjacency of a graph.
+     *
+     * The outgoing halfedges of vertex v are stored contiguously in the entries [offsets[v], offsets[v + 1]), in the
+     * order of the halfedge circulator of the graph. For every entry the neighbor, the halfedge pointing to the neighbor
+     * and the edge weight are stored in separate arrays, so a traversal touches only linear memory instead of chasing
+     * the halfedge connectivity. The snapshot does not follow later changes of the graph and has to be rebuilt then.
+     * It records the number of vertices and halfedges of the graph, so most stale snapshots are detected on use.
+     */
+    class GraphCsr {
+    public:
+        GraphCsr() = default;
+
+        /**
+         * @brief Builds the snapshot of the given graph.
+         * @param graph The graph to snapshot. Deleted vertices get an empty neighbor range.
+         * @param weights The edge weights to store. If not provided, the edge lengths of
+         * "v:position" are used, or 1 if the graph has no positions.
+         * @param jobs If set, the neighbor ranges are counted and filled in parallel on this JobSystem.
+         */
+        explicit GraphCsr(const Graph &graph, const EdgeProperty<Real> &weights = EdgeProperty<Real>(),
+                          JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Builds the snapshot of the vertex adjacency of a mesh.
+         * @param mesh The mesh to snapshot. Deleted vertices get an empty neighbor range.
+         * @param weights The edge weights to store. If not provided, the edge lengths of "v:position" are used.
+         * @param jobs If set, the neighbor ranges are counted and filled in parallel on this JobSystem.
+         */
+        explicit GraphCsr(const Mesh &mesh, const EdgeProperty<Real> &weights = EdgeProperty<Real>(),
+                          JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Retrieve the number of vertices of the snapshot, including deleted ones.
+         */
+        [[nodiscard]] size_t n_vertices() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+        /**
+         * @brief Retrieve the number of stored halfedges, i.e. the sum of all vertex valences.
+         */
+        [[nodiscard]] size_t n_entries() const { return neighbors.size(); }
+
+        /**
+         * @brief Retrieve the index of the first entry of a vertex.
+         */
+        [[nodiscard]] size_t begin(const Vertex &v) const { return offsets[v.idx()]; }
+
+        /**
+         * @brief Retrieve the index one past the last entry of a vertex.
+         */
+        [[nodiscard]] size_t end(const Vertex &v) const { return offsets[v.idx() + 1]; }
+
+        /**
+         * @brief Retrieve the valence of a vertex.
+         */
+        [[nodiscard]] size_t get_valence(const Vertex &v) const { return end(v) - begin(v); }
+
+        /**
+         * @brief Retrieve the neighbor of an entry.
+         */
+        [[nodiscard]] Vertex get_vertex(size_t i) const { return Vertex(neighbors[i]); }
+
+        /**
+         * @brief Retrieve the halfedge of an entry, pointing from the vertex of the range to the neighbor.
+         */
+        [[nodiscard]] Halfedge get_halfedge(size_t i) const { return Halfedge(halfedges[i]); }
+
+        /**
+         * @brief Retrieve the edge of an entry.
+         */
+        [[nodiscard]] Edge get_edge(size_t i) const { return Edge(halfedges[i] >> 1); }
+
+        /**
+         * @brief Retrieve the weight of an entry.
+         */
+        [[nodiscard]] Real get_weight(size_t i) const { return weights[i]; }
+
+        std::vector<size_t> offsets;        /**< n_vertices + 1 offsets into the entry arrays. */
+        std::vector<unsigned int> neighbors; /**< The neighbor vertex of every entry. */
+        std::vector<unsigned int> halfedges; /**< The halfedge of every entry. */
+        std::vector<Real> weights;          /**< The edge weight of every entry. */
+        size_t n_halfedges = 0;             /**< The number of halfedges of the graph which were not deleted. */
+    };
+
+    /**
+     * @brief Calls func(h, neighbor, weight) for every outgoing halfedge h of v.
+     *
+     * If a snapshot is given the neighbors are read from it, otherwise the halfedges of the graph are circulated and the
+     * weights are read from the edge property. This lets the graph algorithms share one loop for both representations,
+     * and for a Graph as well as a Mesh.
+     */
+    template<HalfedgeGraph GraphType, typename Func>
+    void ForEachNeighbor(const GraphType &graph, const GraphCsr *csr, const EdgeProperty<Real> &weights,
+                         const Vertex &v, Func &&func) {
+        if (csr) {
+            for (size_t i = csr->begin(v), end = csr->end(v); i < end; ++i) {
+                func(csr->get_halfedge(i), csr->get_vertex(i), csr->get_weight(i));
+            }
+        } else {
+            for (const auto &h: graph.get_halfedges(v)) {
+                func(h, graph.get_vertex(h), weights[graph.get_edge(h)]);
+            }
+        }
+    }
+
+    /**
+     * @brief Checks that a snapshot can be used in place of the graph and reports an error otherwise.
+     * @return True if csr is not set or matches the number of vertices and halfedges of the graph.
+     */
+    bool IsCompatibleCsr(const Graph &graph, const GraphCsr *csr, const std::string &caller);
+
+    /**
+     * @brief Checks that a snapshot can be used in place of the mesh and reports an error otherwise.
+     * @return True if csr is not set or matches the number of vertices and halfedges of the mesh.
+     */
+    bool IsCompatibleCsr(const Mesh &mesh, const GraphCsr *csr, const std::string &caller);
+}
+
+#endif //GRAPHCSR_H
@@ -0,0 +1,209 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphDeltaStepping.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+
+namespace Bcg {
+    // A tentative distance and the predecessor halfedge packed into one word. The bits of a non-negative float order
+    // like the float itself, so the upper half of a smaller label is a shorter distance.
+    using Label = uint64_t;
+    static constexpr Label Unreached = std::numeric_limits<Label>::max();
+    static constexpr uint32_t NoPredecessor = std::numeric_limits<uint32_t>::max();
+
+    static Label PackLabel(Real distance, uint32_t predecessor) {
+        return (static_cast<Label>(std::bit_cast<uint32_t>(distance)) << 32) | predecessor;
+    }
+
+    static Real LabelDistance(Label label) {
+        return std::bit_cast<Real>(static_cast<uint32_t>(label >> 32));
+    }
+
+    DeltaStepping::DeltaStepping(Graph &graph, JobSystem *jobs) : graph(graph), jobs(jobs) {
+    }
+
+    void DeltaStepping::compute(const Vertex &source) {
+        compute(std::vector<Vertex>{source});
+    }
+
+    void DeltaStepping::compute(const std::vector<Vertex> &sources) {
+        if (!IsCompatibleCsr(graph, csr, "DeltaStepping::compute")) return;
+        clear();
+
+        const size_t n = graph.vertices.size();
+        const Real width = get_bucket_width();
+        std::vector<Label> labels(n, Unreached);
+        // Stamps deduplicate the vertices collected by a round.
+        std::vector<unsigned int> stamps(n, 0);
+        unsigned int round = 0;
+
+        // While bucket i is emptied, new labels are at most the largest weight above it, so the non empty buckets span
+        // ceil(max weight / width) + 1 consecutive indices and live in a cyclic array of slots. One more slot absorbs
+        // the rounding of the bucket indices.
+        const std::vector<Real> &weights = csr ? csr->weights : edge_weights.vector();
+        Real max_weight = 0;
+        for (const Real weight: weights) {
+            if (std::isfinite(weight) && weight > max_weight) max_weight = weight;
+        }
+        n_slots = static_cast<size_t>(std::ceil(max_weight / width)) + 2;
+        std::vector<std::vector<unsigned int> > buckets(n_slots);
+        size_t n_queued = 0;
+
+        auto bucket_of = [&](unsigned int v) {
+            return static_cast<size_t>(LabelDistance(labels[v]) / width);
+        };
+        auto push = [&](unsigned int v) {
+            buckets[bucket_of(v) % n_slots].push_back(v);
+            ++n_queued;
+        };
+
+        for (const Vertex &source: sources) {
+            if (source.idx() >= n) {
+                std::cerr << "Error: DeltaStepping::compute: Invalid source vertex." << std::endl;
+                continue;
+            }
+            labels[source.idx()] = PackLabel(0, NoPredecessor);
+            push(static_cast<unsigned int>(source.idx()));
+        }
+
+        // Relaxes the light or the heavy edges of the vertices and collects the vertices whose label decreased.
+        std::vector<unsigned int> improved;
+        std::mutex mutex;
+        auto relax = [&](const std::vector<unsigned int> &vertices, bool light) {
+            ++round;
+            improved.clear();
+            ParallelFor(jobs, 0, vertices.size(), 256, [&](size_t begin, size_t end) {
+                std::vector<unsigned int> local;
+                for (size_t k = begin; k < end; ++k) {
+                    const Vertex v(vertices[k]);
+                    const Label label_v = std::atomic_ref(labels[v.idx()]).load(std::memory_order_relaxed);
+                    const Real distance = LabelDistance(label_v);
+                    ForEachNeighbor(graph, csr, edge_weights, v, [&](const Halfedge &h, const Vertex &u, Real weight) {
+                        if (weight < 0 || (weight <= width) != light) return;
+                        // The predecessor is the opposite of h, which points from u back to v.
+                        const Label label = PackLabel(distance + weight, static_cast<uint32_t>(h.idx() ^ 1));
+                        std::atomic_ref target(labels[u.idx()]);
+                        Label current = target.load(std::memory_order_relaxed);
+                        // Only a strictly shorter distance replaces the label. Taking an equally short path over a
+                        // zero weight edge could give the source a predecessor or close a cycle of predecessors.
+                        while ((label >> 32) < (current >> 32)) {
+                            if (target.compare_exchange_weak(current, label, std::memory_order_relaxed)) {
+                                std::atomic_ref stamp(stamps[u.idx()]);
+                                if (stamp.exchange(round, std::memory_order_relaxed) != round) {
+                                    local.push_back(static_cast<unsigned int>(u.idx()));
+                                }
+                                break;
+                            }
+                        }
+                    });
+                }
+                std::scoped_lock lock(mutex);
+                improved.insert(improved.end(), local.begin(), local.end());
+            });
+        };
+
+        std::vector<unsigned int> frontier, removed;
+        for (size_t i = 0; n_queued > 0; ++i) {
+            std::vector<unsigned int> &bucket = buckets[i % n_slots];
+            removed.clear();
+            while (!bucket.empty()) {
+                // Skip vertices which moved to a lower bucket or are listed twice.
+                frontier.clear();
+                ++round;
+                for (const unsigned int v: bucket) {
+                    if (bucket_of(v) == i && stamps[v] != round) {
+                        stamps[v] = round;
+                        frontier.push_back(v);
+                    }
+                }
+                n_queued -= bucket.size();
+                bucket.clear();
+                removed.insert(removed.end(), frontier.begin(), frontier.end());
+                relax(frontier, true);
+                for (const unsigned int v: improved) {
+                    push(v);
+                }
+            }
+
+            if (removed.empty()) continue;
+            ++round;
+            std::erase_if(removed, [&](unsigned int v) { return std::exchange(stamps[v], round) == round; });
+            relax(removed, false);
+            for (const unsigned int v: improved) {
+                push(v);
+            }
+            ++n_buckets;
+        }
+
+        std::vector<Real> &distances = vertex_distances.vector();
+        std::vector<Halfedge> &predecessors = vertex_predecessors.vector();
+        ParallelFor(jobs, 0, n, 1 << 14, [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v) {
+                if (labels[v] == Unreached) continue;
+                distances[v] = LabelDistance(labels[v]);
+                const uint32_t predecessor = static_cast<uint32_t>(labels[v]);
+                if (predecessor != NoPredecessor) {
+                    predecessors[v] = Halfedge(predecessor);
+                }
+            }
+        });
+    }
+
+    void DeltaStepping::set_custom_edge_weights(const EdgeProperty<Real> &weights) {
+        edge_weights = weights;
+    }
+
+    void DeltaStepping::clear_custom_edge_weights() {
+        edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+    }
+
+    void DeltaStepping::set_csr(const GraphCsr *csr) {
+        this->csr = csr;
+    }
+
+    void DeltaStepping::clear_csr() {
+        csr = nullptr;
+    }
+
+    Real DeltaStepping::get_bucket_width() const {
+        if (delta > 0) return delta;
+        const std::vector<Real> &weights = csr ? csr->weights : edge_weights.vector();
+        double sum = 0;
+        size_t count = 0;
+        for (const Real weight: weights) {
+            if (weight > 0) {
+                sum += weight;
+                ++count;
+            }
+        }
+        return count > 0 ? static_cast<Real>(sum / count) : 1;
+    }
+
+    void DeltaStepping::clear() {
+        if (!edge_weights && !csr) {
+            edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+        }
+
+        if (!vertex_distances) {
+            vertex_distances = graph.vertex_property<Real>("v:delta_stepping:distances",
+                                                           std::numeric_limits<Real>::max());
+        } else {
+            std::ranges::fill(vertex_distances.vector(), std::numeric_limits<Real>::max());
+        }
+
+        if (!vertex_predecessors) {
+            vertex_predecessors = graph.vertex_property<Halfedge>("v:delta_stepping:predecessors");
+        } else {
+            std::ranges::fill(vertex_predecessors.vector(), Halfedge());
+        }
+        n_buckets = 0;
+        n_slots = 0;
+    }
+}
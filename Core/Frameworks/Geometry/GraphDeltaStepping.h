@@ -0,0 +1,91 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef GRAPHDELTASTEPPING_H
+#define GRAPHDELTASTEPPING_H
+
+#include "GraphCsr.h"
+
+namespace Bcg {
+    /**
+     * @brief DeltaStepping: Parallel single source shortest paths for graphs with non-negative edge weights.
+     *
+     * The vertices are kept in buckets of tentative distances of width delta. The lowest non empty bucket is emptied
+     * by repeatedly relaxing the light edges (weight <= delta) of its vertices, after which the heavy edges of all
+     * vertices removed from the bucket are relaxed once. All relaxations of a step run in parallel if a JobSystem is
+     * given. The buckets are kept in a cyclic array whose size depends on the largest edge weight over delta, not on
+     * the length of the paths. The distance and the predecessor of a vertex are updated together by one atomic
+     * operation, so the results form a valid shortest path tree and match those of Dijkstra, up to the choice among
+     * equally short paths.
+     */
+    class DeltaStepping {
+    public:
+        /**
+         * @brief Constructs a DeltaStepping object for the given graph.
+         * @param graph The graph on which to compute the shortest paths.
+         * @param jobs If set, the relaxations are run in parallel on this JobSystem.
+         */
+        explicit DeltaStepping(Graph &graph, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Computes the shortest paths from the source vertex to all vertices.
+         * @param source The source vertex.
+         */
+        void compute(const Vertex &source);
+
+        /**
+         * @brief Computes the shortest paths from the closest of the source vertices to all vertices.
+         * @param sources The source vertices.
+         */
+        void compute(const std::vector<Vertex> &sources);
+
+        /**
+         * @brief Sets custom edge weights for the shortest path computation.
+         * @param weights The custom edge weights to use.
+         */
+        void set_custom_edge_weights(const EdgeProperty<Real> &weights);
+
+        /**
+         * @brief Clears any custom edge weights set for the shortest path computation.
+         */
+        void clear_custom_edge_weights();
+
+        /**
+         * @brief Runs the computation on an adjacency snapshot of the graph instead of circulating its halfedges.
+         * The weights stored in the snapshot are used in place of the edge weights.
+         * @param csr The snapshot. It is not owned and has to stay alive until it is cleared.
+         */
+        void set_csr(const GraphCsr *csr);
+
+        /**
+         * @brief Clears the adjacency snapshot, the graph is circulated again.
+         */
+        void clear_csr();
+
+        EdgeProperty<Real> edge_weights; /**< The edge weights used in the shortest path computation. */
+        VertexProperty<Real> vertex_distances; /**< The distances from the source vertex to each vertex. */
+        VertexProperty<Halfedge> vertex_predecessors;
+        /**< The predecessor halfedge for each vertex in the shortest path tree. */
+        Real delta = 0; /**< The bucket width. If not positive, the mean edge weight is used. */
+        size_t n_buckets = 0; /**< The number of buckets emptied by the last compute. */
+        size_t n_slots = 0; /**< The number of slots of the cyclic bucket array of the last compute. */
+
+    private:
+        /**
+         * @brief Clears the internal state of the DeltaStepping object.
+         */
+        void clear();
+
+        /**
+         * @brief Retrieve the bucket width used by compute.
+         */
+        [[nodiscard]] Real get_bucket_width() const;
+
+        Graph &graph; /**< The graph on which to compute the shortest paths. */
+        JobSystem *jobs; /**< The optional JobSystem used for the relaxations. */
+        const GraphCsr *csr = nullptr; /**< The optional adjacency snapshot of the graph. */
+    };
+}
+
+#endif //GRAPHDELTASTEPPING_H
@@ -3,10 +3,12 @@
 //
 
 #include "GraphDijkstra.h"
+#include "Mesh.h"
 #include "GraphUtils.h"
 
 namespace Bcg {
-    Dijkstra::Dijkstra(Graph &graph) : graph(graph) {
+    template<HalfedgeGraph GraphType>
+    Dijkstra<GraphType>::Dijkstra(GraphType &graph) : graph(graph) {
 
     }
 
@@ -21,7 +23,9 @@ namespace Bcg {
         }
     };
 
-    void Dijkstra::compute(const Vertex &source, const Vertex &sink) {
+    template<HalfedgeGraph GraphType>
+    void Dijkstra<GraphType>::compute(const Vertex &source, const Vertex &sink) {
+        if (!IsCompatibleCsr(graph, csr, "Dijkstra::compute")) return;
         clear();
 
         vertex_distances[source] = 0;
@@ -45,17 +49,12 @@ namespace Bcg {
                 break;
 
             // Iterate over all neighbors of the current vertex.
-            for (const auto &h: graph.get_halfedges(v_current)) {
-                // Retrieve the halfedge connecting current to neighbor.
-
-                Edge e = graph.get_edge(h);
-                Real weight = edge_weights[e];
-
+            ForEachNeighbor(graph, csr, edge_weights, v_current, [&](const Halfedge &h, const Vertex &v_neighbor,
+                                                                     Real weight) {
                 // Optionally, you may want to handle negative weights here.
                 if (weight < 0)
-                    continue;
+                    return;
 
-                Vertex v_neighbor = graph.get_vertex(h);
                 Real new_distance = vertex_distances[v_current] + weight;
                 // If a shorter path is found, update the distance and predecessor.
                 if (new_distance < vertex_distances[v_neighbor]) {
@@ -65,11 +64,13 @@ namespace Bcg {
                     vertex_predecessors[v_neighbor] = graph.get_opposite(h);
                     queue.push({v_neighbor, new_distance});
                 }
-            }
+            });
         }
     }
 
-    void Dijkstra::compute(const std::vector<Vertex> &sources, const Vertex &sink) {
+    template<HalfedgeGraph GraphType>
+    void Dijkstra<GraphType>::compute(const std::vector<Vertex> &sources, const Vertex &sink) {
+        if (!IsCompatibleCsr(graph, csr, "Dijkstra::compute")) return;
         clear();
 
         std::priority_queue<PQItem, std::vector<PQItem>, PQCompare> queue;
@@ -95,14 +96,11 @@ namespace Bcg {
             if (sink.is_valid() && v_current == sink)
                 break;
 
-            for (const auto &h: graph.get_halfedges(v_current)) {
-                Edge e = graph.get_edge(h);
-                Real weight = edge_weights[e];
-
+            ForEachNeighbor(graph, csr, edge_weights, v_current, [&](const Halfedge &h, const Vertex &v_neighbor,
+                                                                     Real weight) {
                 if (weight < 0)
-                    continue;
+                    return;
 
-                Vertex v_neighbor = graph.get_vertex(h);
                 Real new_distance = vertex_distances[v_current] + weight;
                 if (new_distance < vertex_distances[v_neighbor]) {
                     vertex_distances[v_neighbor] = new_distance;
@@ -111,33 +109,50 @@ namespace Bcg {
                     vertex_predecessors[v_neighbor] = graph.get_opposite(h);
                     queue.push({v_neighbor, new_distance});
                 }
-            }
+            });
         }
     }
 
-    void Dijkstra::set_custom_edge_weights(const EdgeProperty<Real> &weights) {
+    template<HalfedgeGraph GraphType>
+    void Dijkstra<GraphType>::set_custom_edge_weights(const EdgeProperty<Real> &weights) {
         edge_weights = weights;
     }
 
-    void Dijkstra::clear_custom_edge_weights() {
-        edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+    template<HalfedgeGraph GraphType>
+    void Dijkstra<GraphType>::clear_custom_edge_weights() {
+        edge_weights = EdgeLengths(graph, graph.template get_vertex_property<Vector<Real, 3> >("v:position"));
+    }
+
+    template<HalfedgeGraph GraphType>
+    void Dijkstra<GraphType>::set_csr(const GraphCsr *csr) {
+        this->csr = csr;
+    }
+
+    template<HalfedgeGraph GraphType>
+    void Dijkstra<GraphType>::clear_csr() {
+        csr = nullptr;
     }
 
-    void Dijkstra::clear() {
-        if (!edge_weights) {
-            edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+    template<HalfedgeGraph GraphType>
+    void Dijkstra<GraphType>::clear() {
+        if (!edge_weights && !csr) {
+            edge_weights = EdgeLengths(graph, graph.template get_vertex_property<Vector<Real, 3> >("v:position"));
         }
 
         if (!vertex_distances) {
-            vertex_distances = graph.vertex_property<Real>("v:dijkstra:distances", std::numeric_limits<Real>::max());
+            vertex_distances = graph.template vertex_property<Real>("v:dijkstra:distances",
+                                                                    std::numeric_limits<Real>::max());
         } else {
             std::ranges::fill(vertex_distances.vector(), std::numeric_limits<Real>::max());
         }
 
         if (!vertex_predecessors) {
-            vertex_predecessors = graph.vertex_property<Halfedge>("v:dijkstra:predecessors");
+            vertex_predecessors = graph.template vertex_property<Halfedge>("v:dijkstra:predecessors");
         } else {
             std::ranges::fill(vertex_predecessors.vector(), Halfedge());
         }
     }
+
+    template class Dijkstra<Graph>;
+    template class Dijkstra<Mesh>;
 }
@@ -5,20 +5,22 @@
 #ifndef GRAPHDIJKSTRA_H
 #define GRAPHDIJKSTRA_H
 
-#include "Graph.h"
+#include "GraphCsr.h"
 
 namespace Bcg {
     /**
      * @brief Dijkstra: Computes shortest paths from a source (or multiple sources)
      * for graphs with non-negative edge weights.
+     * @tparam GraphType Graph or Mesh, the search runs on the halfedges of either.
      */
+    template<HalfedgeGraph GraphType = Graph>
     class Dijkstra {
     public:
         /**
          * @brief Constructs a Dijkstra object for the given graph.
          * @param graph The graph on which to compute the shortest paths.
          */
-        explicit Dijkstra(Graph &graph);
+        explicit Dijkstra(GraphType &graph);
 
         /**
          * @brief Computes the shortest path from the source vertex to the sink vertex.
@@ -45,6 +47,18 @@ namespace Bcg {
          */
         void clear_custom_edge_weights();
 
+        /**
+         * @brief Runs the computation on an adjacency snapshot of the graph instead of circulating its halfedges.
+         * The weights stored in the snapshot are used in place of the edge weights.
+         * @param csr The snapshot. It is not owned and has to stay alive until it is cleared.
+         */
+        void set_csr(const GraphCsr *csr);
+
+        /**
+         * @brief Clears the adjacency snapshot, the graph is circulated again.
+         */
+        void clear_csr();
+
         EdgeProperty<Real> edge_weights; /**< The edge weights used in the shortest path computation. */
         VertexProperty<Real> vertex_distances; /**< The distances from the source vertex to each vertex. */
         VertexProperty<Halfedge> vertex_predecessors;
@@ -55,7 +69,8 @@ namespace Bcg {
          */
         void clear();
 
-        Graph &graph; /**< The graph on which to compute the shortest paths. */
+        GraphType &graph; /**< The graph on which to compute the shortest paths. */
+        const GraphCsr *csr = nullptr; /**< The optional adjacency snapshot of the graph. */
     };
 }
 #endif //GRAPHDIJKSTRA_H
@@ -0,0 +1,194 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphDijkstraQuery.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <iostream>
+
+namespace Bcg {
+    // Marks vertices which left the heap, their distances are final.
+    static constexpr unsigned int Settled = std::numeric_limits<unsigned int>::max();
+
+    std::vector<Halfedge> DijkstraWorkspace::get_path(const Vertex &sink, bool reverse) const {
+        std::vector<Halfedge> path;
+        if (!is_reached(sink)) return path;
+        for (unsigned int v = static_cast<unsigned int>(sink.idx()); parents[v] != v; v = parents[v]) {
+            path.push_back(Halfedge(predecessors[v]));
+        }
+        if (reverse) {
+            std::ranges::reverse(path);
+        }
+        return path;
+    }
+
+    void DijkstraWorkspace::begin(size_t n) {
+        if (stamps.size() != n) {
+            distances.resize(n);
+            parents.resize(n);
+            predecessors.resize(n);
+            heap_positions.resize(n);
+            stamps.assign(n, 0);
+            generation = 0;
+        }
+        // On wrap around the stamps of old queries could match again.
+        if (++generation == 0) {
+            std::ranges::fill(stamps, 0);
+            generation = 1;
+        }
+        heap.clear();
+        n_settled = 0;
+    }
+
+    // Restores the heap order upwards from position i.
+    static void SiftUp(std::vector<unsigned int> &heap, std::vector<unsigned int> &positions,
+                       const std::vector<Real> &distances, size_t i) {
+        const unsigned int v = heap[i];
+        while (i > 0) {
+            const size_t parent = (i - 1) / DijkstraQuery::arity;
+            if (distances[heap[parent]] <= distances[v]) break;
+            heap[i] = heap[parent];
+            positions[heap[i]] = static_cast<unsigned int>(i);
+            i = parent;
+        }
+        heap[i] = v;
+        positions[v] = static_cast<unsigned int>(i);
+    }
+
+    // Restores the heap order downwards from position i.
+    static void SiftDown(std::vector<unsigned int> &heap, std::vector<unsigned int> &positions,
+                         const std::vector<Real> &distances, size_t i) {
+        const unsigned int v = heap[i];
+        const size_t n = heap.size();
+        while (true) {
+            const size_t first = i * DijkstraQuery::arity + 1;
+            if (first >= n) break;
+            size_t best = first;
+            for (size_t c = first + 1, c_end = std::min(first + DijkstraQuery::arity, n); c < c_end; ++c) {
+                if (distances[heap[c]] < distances[heap[best]]) best = c;
+            }
+            if (distances[v] <= distances[heap[best]]) break;
+            heap[i] = heap[best];
+            positions[heap[i]] = static_cast<unsigned int>(i);
+            i = best;
+        }
+        heap[i] = v;
+        positions[v] = static_cast<unsigned int>(i);
+    }
+
+    DijkstraQuery::DijkstraQuery(const GraphCsr &csr) : csr(csr) {
+    }
+
+    Real DijkstraQuery::compute(DijkstraWorkspace &workspace, const Vertex &source, const Vertex &sink) const {
+        return compute(workspace, std::vector<Vertex>{source}, sink);
+    }
+
+    Real DijkstraQuery::compute(DijkstraWorkspace &workspace, const std::vector<Vertex> &sources,
+                                const Vertex &sink) const {
+        const size_t n = csr.n_vertices();
+        workspace.begin(n);
+        auto &distances = workspace.distances;
+        auto &parents = workspace.parents;
+        auto &predecessors = workspace.predecessors;
+        auto &stamps = workspace.stamps;
+        auto &positions = workspace.heap_positions;
+        auto &heap = workspace.heap;
+        const unsigned int generation = workspace.generation;
+
+        for (const Vertex &source: sources) {
+            if (source.idx() >= n) {
+                std::cerr << "Error: DijkstraQuery::compute: Invalid source vertex." << std::endl;
+                continue;
+            }
+            const unsigned int s = static_cast<unsigned int>(source.idx());
+            if (stamps[s] == generation) continue;
+            stamps[s] = generation;
+            distances[s] = 0;
+            parents[s] = s;
+            heap.push_back(s);
+            positions[s] = static_cast<unsigned int>(heap.size() - 1);
+        }
+
+        while (!heap.empty()) {
+            const unsigned int v = heap.front();
+            positions[v] = Settled;
+            ++workspace.n_settled;
+            if (heap.size() > 1) {
+                heap.front() = heap.back();
+                heap.pop_back();
+                SiftDown(heap, positions, distances, 0);
+            } else {
+                heap.pop_back();
+            }
+
+            // Early exit: the distance of a settled vertex is final.
+            if (v == sink.idx()) break;
+
+            const Real distance = distances[v];
+            for (size_t i = csr.offsets[v], end = csr.offsets[v + 1]; i < end; ++i) {
+                const Real weight = csr.weights[i];
+                if (weight < 0) continue;
+                const unsigned int u = csr.neighbors[i];
+                const Real new_distance = distance + weight;
+                size_t position;
+                if (stamps[u] != generation) {
+                    stamps[u] = generation;
+                    position = heap.size();
+                    heap.push_back(u);
+                } else if (positions[u] == Settled || new_distance >= distances[u]) {
+                    continue;
+                } else {
+                    position = positions[u];
+                }
+                distances[u] = new_distance;
+                parents[u] = v;
+                // The stored halfedge points from v to u, the predecessor points back.
+                predecessors[u] = csr.halfedges[i] ^ 1;
+                SiftUp(heap, positions, distances, position);
+            }
+        }
+
+        return sink.is_valid() ? workspace.get_distance(sink) : std::numeric_limits<Real>::max();
+    }
+
+    std::vector<Real> DijkstraQuery::compute_batch(const std::vector<std::pair<Vertex, Vertex> > &queries,
+                                                   JobSystem *jobs,
+                                                   std::vector<std::vector<Halfedge> > *paths) const {
+        std::vector<Real> results(queries.size(), std::numeric_limits<Real>::max());
+        if (paths) {
+            paths->assign(queries.size(), {});
+        }
+        // A few chunks per thread balance queries of different lengths. Every chunk borrows an idle workspace, so the
+        // workspaces are allocated once per thread and later batches only advance their generation.
+        const size_t n_chunks = jobs ? 4 * jobs->num_threads() : 1;
+        const size_t grain_size = std::max<size_t>(1, (queries.size() + n_chunks - 1) / n_chunks);
+        ParallelFor(jobs, 0, queries.size(), grain_size, [&](size_t begin, size_t end) {
+            std::unique_ptr<DijkstraWorkspace> workspace;
+            {
+                std::scoped_lock lock(mutex);
+                if (!workspaces.empty()) {
+                    workspace = std::move(workspaces.back());
+                    workspaces.pop_back();
+                }
+            }
+            if (!workspace) {
+                workspace = std::make_unique<DijkstraWorkspace>();
+            }
+            for (size_t i = begin; i < end; ++i) {
+                results[i] = compute(*workspace, queries[i].first, queries[i].second);
+                if (paths) {
+                    (*paths)[i] = workspace->get_path(queries[i].second);
+                }
+            }
+            std::scoped_lock lock(mutex);
+            workspaces.push_back(std::move(workspace));
+        });
+        return results;
+    }
+
+    size_t DijkstraQuery::n_workspaces() const {
+        std::scoped_lock lock(mutex);
+        return workspaces.size();
+    }
+}
@@ -0,0 +1,133 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef GRAPHDIJKSTRAQUERY_H
+#define GRAPHDIJKSTRAQUERY_H
+
+#include "GraphCsr.h"
+#include <memory>
+#include <mutex>
+
+namespace Bcg {
+    /**
+     * @brief DijkstraWorkspace: Reusable state of a DijkstraQuery.
+     *
+     * The per vertex arrays are allocated once and tagged with the generation of the query that wrote them. Starting a
+     * query only increments the generation, so entries of earlier queries read as unreached without clearing the
+     * arrays. A workspace must not be shared by concurrent queries, use one per thread.
+     */
+    class DijkstraWorkspace {
+    public:
+        /**
+         * @brief Checks whether the last query reached a vertex.
+         */
+        [[nodiscard]] bool is_reached(const Vertex &v) const {
+            return v.idx() < stamps.size() && stamps[v.idx()] == generation;
+        }
+
+        /**
+         * @brief Retrieve the distance of a vertex found by the last query, max if it was not reached.
+         * If the query stopped at its sink, only the distances of settled vertices are final.
+         */
+        [[nodiscard]] Real get_distance(const Vertex &v) const {
+            return is_reached(v) ? distances[v.idx()] : std::numeric_limits<Real>::max();
+        }
+
+        /**
+         * @brief Retrieve the predecessor halfedge of a vertex, pointing from the vertex back towards the source.
+         * Invalid for the sources and for vertices which were not reached.
+         */
+        [[nodiscard]] Halfedge get_predecessor(const Vertex &v) const {
+            return is_reached(v) && parents[v.idx()] != v.idx() ? Halfedge(predecessors[v.idx()]) : Halfedge();
+        }
+
+        /**
+         * @brief Retrieve the shortest path to the sink found by the last query.
+         * @param sink The end of the path.
+         * @param reverse If false the halfedges are ordered from the sink to the source, as in
+         * BacktracePathSinkToSource, otherwise the path is reversed.
+         * @return The predecessor halfedges along the path, empty if the sink was not reached or is a source.
+         */
+        [[nodiscard]] std::vector<Halfedge> get_path(const Vertex &sink, bool reverse = false) const;
+
+        size_t n_settled = 0; /**< The number of vertices settled by the last query. */
+
+    private:
+        friend class DijkstraQuery;
+
+        /**
+         * @brief Starts a new query on n vertices, invalidating the results of the previous one.
+         */
+        void begin(size_t n);
+
+        std::vector<Real> distances; /**< The tentative distances. */
+        std::vector<unsigned int> parents; /**< The parent vertices, the vertex itself for sources. */
+        std::vector<unsigned int> predecessors; /**< The halfedges from the vertices to their parents. */
+        std::vector<unsigned int> stamps; /**< The generation which last wrote the entries of a vertex. */
+        std::vector<unsigned int> heap_positions; /**< The position in the heap, or settled. */
+        std::vector<unsigned int> heap; /**< The indexed d-ary heap of queued vertices. */
+        unsigned int generation = 0; /**< The generation of the current query. */
+    };
+
+    /**
+     * @brief DijkstraQuery: Point to point shortest path queries on an adjacency snapshot.
+     *
+     * In contrast to Dijkstra, which fills full vertex properties for every call, the queries keep their state in a
+     * DijkstraWorkspace which is reused across calls, order the queued vertices in an indexed 4-ary heap with decrease
+     * key and stop as soon as the sink is settled. Batches of queries are distributed over a JobSystem, every running chunk
+     * borrows a workspace from a pool which is kept across batches. Negative weights are ignored, as in Dijkstra.
+     */
+    class DijkstraQuery {
+    public:
+        static constexpr unsigned int arity = 4; /**< The number of children of every heap node. */
+
+        /**
+         * @brief Constructs a query engine for the given snapshot.
+         * @param csr The snapshot. It is not owned and has to stay alive while queries are running.
+         */
+        explicit DijkstraQuery(const GraphCsr &csr);
+
+        /**
+         * @brief Computes the shortest path from the source to the sink.
+         * @param workspace The workspace which receives the distances and predecessors.
+         * @param source The source vertex.
+         * @param sink The sink vertex. If not provided, computes shortest paths to all vertices.
+         * @return The distance of the sink, max if it is unreachable or not provided.
+         */
+        Real compute(DijkstraWorkspace &workspace, const Vertex &source, const Vertex &sink = Vertex()) const;
+
+        /**
+         * @brief Computes the shortest path from the closest of the sources to the sink.
+         * @param workspace The workspace which receives the distances and predecessors.
+         * @param sources The source vertices.
+         * @param sink The sink vertex. If not provided, computes shortest paths to all vertices.
+         * @return The distance of the sink, max if it is unreachable or not provided.
+         */
+        Real compute(DijkstraWorkspace &workspace, const std::vector<Vertex> &sources,
+                     const Vertex &sink = Vertex()) const;
+
+        /**
+         * @brief Computes the shortest paths of a batch of (source, sink) pairs.
+         * @param queries The source and sink of every query.
+         * @param jobs If set, the queries are distributed over this JobSystem.
+         * @param paths If set, receives the path of every query as returned by DijkstraWorkspace::get_path.
+         * @return The distance of every query, max if the sink is unreachable.
+         */
+        std::vector<Real> compute_batch(const std::vector<std::pair<Vertex, Vertex> > &queries,
+                                        JobSystem *jobs = nullptr,
+                                        std::vector<std::vector<Halfedge> > *paths = nullptr) const;
+
+        /**
+         * @brief Retrieve the number of workspaces kept for the batches, at most one per chunk that ran concurrently.
+         */
+        [[nodiscard]] size_t n_workspaces() const;
+
+    private:
+        const GraphCsr &csr; /**< The snapshot to search. */
+        mutable std::vector<std::unique_ptr<DijkstraWorkspace> > workspaces; /**< The idle workspaces of the batches. */
+        mutable std::mutex mutex; /**< Guards the idle workspaces, batches may run concurrently. */
+    };
+}
+
+#endif //GRAPHDIJKSTRAQUERY_H
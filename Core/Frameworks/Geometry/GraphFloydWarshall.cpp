@@ -4,54 +4,121 @@
 
 #include "GraphFloydWarshall.h"
 #include "GraphUtils.h"
+#include "JobSystem.h"
 
 namespace Bcg {
-    FloydWarshall::FloydWarshall(Graph &graph) : graph(graph) {
+    using DistanceMatrix = Matrix<Real, -1, -1>;
+    using PredecessorMatrix = Matrix<Halfedge, -1, -1>;
+
+    // Relaxes the entry (i, j) over the intermediate vertex k for all rows i of the segment [i0, i1).
+    static void RelaxSegment(DistanceMatrix &distances, PredecessorMatrix *predecessors, long i0, long i1, long j,
+                             long k) {
+        const Real d_kj = distances(k, j);
+        if (d_kj == std::numeric_limits<Real>::infinity()) return;
+        if (!predecessors) {
+            // Unreachable entries are infinite, so the kernel needs no branches and is vectorized by Eigen.
+            distances.col(j).segment(i0, i1 - i0) = distances.col(j).segment(i0, i1 - i0).cwiseMin(
+                (distances.col(k).segment(i0, i1 - i0).array() + d_kj).matrix());
+            return;
+        }
+        Real *d_j = distances.col(j).data();
+        const Real *d_k = distances.col(k).data();
+        const Halfedge p_kj = (*predecessors)(k, j);
+        for (long i = i0; i < i1; ++i) {
+            const Real new_distance = d_k[i] + d_kj;
+            if (new_distance < d_j[i]) {
+                d_j[i] = new_distance;
+                // The new predecessor for path i->j is the predecessor on the path from k to j.
+                (*predecessors)(i, j) = p_kj;
+            }
+        }
+    }
+
+    // Relaxes the tile of rows [i0, i1) and columns [j0, j1) over the intermediate vertices [k0, k1).
+    // The matrices are column major, so the innermost loop runs over a contiguous column segment. If the column
+    // segments [k0, k1) are not part of the tile, the columns of the tile are independent and every column is
+    // relaxed over all k while it stays in the cache, otherwise k has to be the outermost loop.
+    static void RelaxTile(DistanceMatrix &distances, PredecessorMatrix *predecessors, long i0, long i1, long j0,
+                          long j1, long k0, long k1) {
+        if (j0 == k0) {
+            for (long k = k0; k < k1; ++k) {
+                for (long j = j0; j < j1; ++j) {
+                    RelaxSegment(distances, predecessors, i0, i1, j, k);
+                }
+            }
+            return;
+        }
+        for (long j = j0; j < j1; ++j) {
+            for (long k = k0; k < k1; ++k) {
+                RelaxSegment(distances, predecessors, i0, i1, j, k);
+            }
+        }
+    }
+
+    FloydWarshall::FloydWarshall(Graph &graph, JobSystem *jobs) : graph(graph), jobs(jobs) {
 
     }
 
     void FloydWarshall::compute() {
+        if (!IsCompatibleCsr(graph, csr, "FloydWarshall::compute")) return;
         clear(); // Allocates and initializes the matrices.
-        long n = graph.n_vertices();
+        const long n = static_cast<long>(graph.vertices.size());
+        PredecessorMatrix *predecessors = compute_predecessors ? &vertex_vertex_predecessors : nullptr;
 
-        // Set the distance from each vertex to itself as 0.
-        vertex_vertex_distances.diagonal().setConstant(0);
+        for (const auto &v: graph.vertices) {
+            vertex_vertex_distances(v.idx(), v.idx()) = 0;
+        }
 
         // Initialize distances based on direct edges.
-        for (long i = 0; i < n; i++) {
-            Vertex v(i);
-            for (const auto &h: graph.get_halfedges(v)) {
-                Vertex u = graph.get_vertex(h);
-                long j = u.idx();
-                Real weight = edge_weights[graph.get_edge(h)];
+        for (const auto &v: graph.vertices) {
+            const long i = v.idx();
+            ForEachNeighbor(graph, csr, edge_weights, v, [&](const Halfedge &h, const Vertex &u, Real weight) {
+                const long j = u.idx();
                 // Update if this direct edge is better.
                 if (weight < vertex_vertex_distances(i, j)) {
                     vertex_vertex_distances(i, j) = weight;
                     // Store the predecessor as the halfedge from u back to v.
-                    vertex_vertex_predecessors(i, j) = graph.get_opposite(h);
+                    if (predecessors) (*predecessors)(i, j) = graph.get_opposite(h);
                 }
-            }
+            });
         }
 
-        // Run the Floyd–Warshall triple loop.
-        for (long k = 0; k < n; k++) {
-            for (long i = 0; i < n; i++) {
-                // Only consider paths if the intermediate vertex is reachable.
-                if (vertex_vertex_distances(i, k) == std::numeric_limits<Real>::max())
-                    continue;
-                for (long j = 0; j < n; j++) {
-                    // Check that k -> j is reachable.
-                    if (vertex_vertex_distances(k, j) == std::numeric_limits<Real>::max())
-                        continue;
-                    Real new_distance = vertex_vertex_distances(i, k) + vertex_vertex_distances(k, j);
-                    if (new_distance < vertex_vertex_distances(i, j)) {
-                        vertex_vertex_distances(i, j) = new_distance;
-                        // The new predecessor for path i->j is the predecessor on the path from k to j.
-                        vertex_vertex_predecessors(i, j) = vertex_vertex_predecessors(k, j);
+        const long block = std::max<long>(1, static_cast<long>(block_size));
+        const long n_blocks = (n + block - 1) / block;
+        auto range = [&](long b) { return std::pair{b * block, std::min(n, (b + 1) * block)}; };
+        for (long kb = 0; kb < n_blocks; ++kb) {
+            const auto [k0, k1] = range(kb);
+            // Phase 1: the diagonal tile only depends on itself.
+            RelaxTile(vertex_vertex_distances, predecessors, k0, k1, k0, k1, k0, k1);
+
+            // Phase 2: the tiles of row and column kb depend on themselves and the diagonal tile.
+            ParallelFor(jobs, 0, 2 * n_blocks, 1, [&](size_t begin, size_t end) {
+                for (size_t t = begin; t < end; ++t) {
+                    const long b = static_cast<long>(t) % n_blocks;
+                    if (b == kb) continue;
+                    const auto [b0, b1] = range(b);
+                    if (static_cast<long>(t) < n_blocks) {
+                        RelaxTile(vertex_vertex_distances, predecessors, k0, k1, b0, b1, k0, k1);
+                    } else {
+                        RelaxTile(vertex_vertex_distances, predecessors, b0, b1, k0, k1, k0, k1);
                     }
                 }
-            }
+            });
+
+            // Phase 3: all other tiles only read the tiles of row and column kb, which are final now.
+            ParallelFor(jobs, 0, n_blocks * n_blocks, 1, [&](size_t begin, size_t end) {
+                for (size_t t = begin; t < end; ++t) {
+                    const long ib = static_cast<long>(t) % n_blocks, jb = static_cast<long>(t) / n_blocks;
+                    if (ib == kb || jb == kb) continue;
+                    const auto [i0, i1] = range(ib);
+                    const auto [j0, j1] = range(jb);
+                    RelaxTile(vertex_vertex_distances, predecessors, i0, i1, j0, j1, k0, k1);
+                }
+            });
         }
+
+        vertex_vertex_distances = (vertex_vertex_distances.array() == std::numeric_limits<Real>::infinity()).select(
+            std::numeric_limits<Real>::max(), vertex_vertex_distances);
     }
 
     void FloydWarshall::set_custom_edge_weights(const EdgeProperty<Real> &weights) {
@@ -63,19 +130,32 @@ namespace Bcg {
         edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
     }
 
+    void FloydWarshall::set_csr(const GraphCsr *csr) {
+        this->csr = csr;
+    }
+
+    void FloydWarshall::clear_csr() {
+        csr = nullptr;
+    }
+
     void FloydWarshall::clear() {
-        if (!edge_weights) {
+        if (!edge_weights && !csr) {
             edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
         }
 
-        long n = graph.n_vertices();
-        // Resize matrices to n x n.
+        // Resize matrices to n x n, including deleted vertices so that the vertex indices can be used directly.
+        const long n = static_cast<long>(graph.vertices.size());
         vertex_vertex_distances.resize(n, n);
-        vertex_vertex_predecessors.resize(n, n);
 
-        // Initialize all distances to infinity.
-        vertex_vertex_distances.setConstant(std::numeric_limits<Real>::max());
-        // Initialize all predecessors to an invalid halfedge.
-        vertex_vertex_predecessors.setConstant(Halfedge());
+        // Initialize all distances to infinity, which stays unreachable under addition, also of negative weights.
+        // compute replaces it by max at the end.
+        vertex_vertex_distances.setConstant(std::numeric_limits<Real>::infinity());
+        if (compute_predecessors) {
+            // Initialize all predecessors to an invalid halfedge.
+            vertex_vertex_predecessors.resize(n, n);
+            vertex_vertex_predecessors.setConstant(Halfedge());
+        } else {
+            vertex_vertex_predecessors.resize(0, 0);
+        }
     }
 }
@@ -5,19 +5,26 @@
 #ifndef GRAPHFLOYDWARSHALL_H
 #define GRAPHFLOYDWARSHALL_H
 
-#include "Graph.h"
+#include "GraphCsr.h"
 
 namespace Bcg {
     /**
      * @brief Floyd-Warshall: Computes all-pairs shortest paths.
+     *
+     * The distance matrix is processed in square tiles of block_size vertices. For every diagonal tile k, the tile
+     * itself is closed first, then the tiles of row and column k, and finally all remaining tiles with the min-plus
+     * product of their row and column tiles. The tiles of the last two phases are independent and are updated in
+     * parallel if a JobSystem is given. Every tile update runs over contiguous column segments, so the kernel without
+     * predecessors is vectorized by Eigen.
      */
     class FloydWarshall {
     public:
         /**
          * @brief Constructs a FloydWarshall object for the given graph.
          * @param graph The graph on which to compute the shortest paths.
+         * @param jobs If set, the tiles of every phase are updated in parallel on this JobSystem.
          */
-        explicit FloydWarshall(Graph &graph);
+        explicit FloydWarshall(Graph &graph, JobSystem *jobs = nullptr);
 
         /**
          * @brief Computes the all-pairs shortest paths.
@@ -35,10 +42,24 @@ namespace Bcg {
          */
         void clear_custom_edge_weights();
 
+        /**
+         * @brief Runs the computation on an adjacency snapshot of the graph instead of circulating its halfedges.
+         * The weights stored in the snapshot are used in place of the edge weights.
+         * @param csr The snapshot. It is not owned and has to stay alive until it is cleared.
+         */
+        void set_csr(const GraphCsr *csr);
+
+        /**
+         * @brief Clears the adjacency snapshot, the graph is circulated again.
+         */
+        void clear_csr();
+
         EdgeProperty<Real> edge_weights; /**< The edge weights used in the shortest path computation. */
         Matrix<Real, -1, -1> vertex_vertex_distances; /**< Matrix of distances between vertices. */
         Matrix<Halfedge, -1, -1> vertex_vertex_predecessors;
-        /**< Matrix of predecessor halfedges for each vertex pair. */
+        /**< Matrix of predecessor halfedges for each vertex pair, empty if compute_predecessors is false. */
+        size_t block_size = 256; /**< The side length of the tiles of the distance matrix. */
+        bool compute_predecessors = true; /**< If false, only the distances are computed, which is faster. */
 
     private:
         /**
@@ -47,6 +68,8 @@ namespace Bcg {
         void clear();
 
         Graph &graph; /**< The graph on which to compute the shortest paths. */
+        const GraphCsr *csr = nullptr; /**< The optional adjacency snapshot of the graph. */
+        JobSystem *jobs; /**< The optional JobSystem used for the tile updates. */
     };
 }
 
@@ -0,0 +1,141 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphJohnson.h"
+#include "GraphBellmanFord.h"
+#include "GraphDijkstraQuery.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <iostream>
+
+namespace Bcg {
+    // Runs one search per source on the reweighted snapshot and writes the shifted distances into the row returned by
+    // get_row(i), which is called once per source and chunk worker.
+    template<typename GetRow, typename OnRow>
+    static void RunSearches(const GraphCsr &reweighted, const std::vector<Real> &potentials,
+                            const std::vector<Vertex> &sources, JobSystem *jobs, GetRow &&get_row, OnRow &&on_row) {
+        const DijkstraQuery query(reweighted);
+        const size_t n = reweighted.n_vertices();
+        // A few chunks per thread balance sources with different reach, every chunk allocates one workspace.
+        const size_t n_chunks = jobs ? 4 * jobs->num_threads() : 1;
+        const size_t grain_size = std::max<size_t>(1, (sources.size() + n_chunks - 1) / n_chunks);
+        ParallelFor(jobs, 0, sources.size(), grain_size, [&](size_t begin, size_t end) {
+            DijkstraWorkspace workspace;
+            std::vector<Real> buffer;
+            for (size_t i = begin; i < end; ++i) {
+                const Vertex &source = sources[i];
+                Real *row = get_row(i, buffer);
+                query.compute(workspace, source);
+                for (size_t j = 0; j < n; ++j) {
+                    const Real distance = workspace.get_distance(Vertex(j));
+                    // d(s, v) = d'(s, v) - h(s) + h(v), the potentials are zero if nothing was reweighted.
+                    row[j] = distance == std::numeric_limits<Real>::max()
+                                 ? distance
+                                 : distance - potentials[source.idx()] + potentials[j];
+                }
+                on_row(source, buffer);
+            }
+        });
+    }
+
+    Johnson::Johnson(Graph &graph, JobSystem *jobs) : graph(graph), jobs(jobs) {
+    }
+
+    bool Johnson::compute() {
+        GraphCsr reweighted;
+        std::vector<Real> potentials;
+        if (!reweight(reweighted, potentials)) return false;
+
+        n_vertices = graph.vertices.size();
+        vertex_vertex_distances.assign(n_vertices * n_vertices, std::numeric_limits<Real>::max());
+        std::vector<Vertex> sources;
+        for (const auto &v: graph.vertices) {
+            sources.push_back(v);
+        }
+        // Every search writes straight into its row of the matrix.
+        RunSearches(reweighted, potentials, sources, jobs, [&](size_t i, std::vector<Real> &) {
+            return vertex_vertex_distances.data() + sources[i].idx() * n_vertices;
+        }, [](const Vertex &, const std::vector<Real> &) {
+        });
+        return true;
+    }
+
+    bool Johnson::compute(const std::vector<Vertex> &sources, const RowCallback &callback) {
+        for (const Vertex &source: sources) {
+            if (!graph.is_valid(source) || graph.is_deleted(source)) {
+                std::cerr << "Error: Johnson::compute: Invalid source vertex." << std::endl;
+                return false;
+            }
+        }
+        GraphCsr reweighted;
+        std::vector<Real> potentials;
+        if (!reweight(reweighted, potentials)) return false;
+
+        const size_t n = graph.vertices.size();
+        // Every chunk reuses one row buffer for all of its sources.
+        RunSearches(reweighted, potentials, sources, jobs, [&](size_t, std::vector<Real> &buffer) {
+            buffer.resize(n);
+            return buffer.data();
+        }, callback);
+        return true;
+    }
+
+    bool Johnson::reweight(GraphCsr &reweighted, std::vector<Real> &potentials) {
+        negative_cycle_found = false;
+        if (!IsCompatibleCsr(graph, csr, "Johnson::compute")) return false;
+        if (csr) {
+            reweighted = *csr;
+        } else {
+            if (!edge_weights) {
+                edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+            }
+            reweighted = GraphCsr(graph, edge_weights, jobs);
+        }
+        potentials.assign(reweighted.n_vertices(), 0);
+        if (std::ranges::none_of(reweighted.weights, [](Real weight) { return weight < 0; })) {
+            return true;
+        }
+
+        // Starting from all vertices at distance zero is equivalent to a virtual source connected to all of them.
+        BellmanFord bellman_ford(graph, jobs);
+        bellman_ford.mode = jobs ? BellmanFordMode::ParallelSweep : BellmanFordMode::Queue;
+        bellman_ford.set_csr(&reweighted);
+        std::vector<Vertex> sources;
+        for (const auto &v: graph.vertices) {
+            sources.push_back(v);
+        }
+        if (!bellman_ford.compute(sources)) {
+            std::cerr << "Error: Johnson::compute: The graph contains a negative cycle." << std::endl;
+            negative_cycle_found = true;
+            return false;
+        }
+        for (const auto &v: graph.vertices) {
+            potentials[v.idx()] = bellman_ford.vertex_distances[v];
+        }
+        for (const auto &v: graph.vertices) {
+            for (size_t i = reweighted.begin(v), end = reweighted.end(v); i < end; ++i) {
+                // Clamp rounding errors, the reweighted weights are non-negative in exact arithmetic.
+                reweighted.weights[i] = std::max<Real>(
+                    0, reweighted.weights[i] + potentials[v.idx()] - potentials[reweighted.neighbors[i]]);
+            }
+        }
+        return true;
+    }
+
+    void Johnson::set_custom_edge_weights(const EdgeProperty<Real> &weights) {
+        edge_weights = weights;
+    }
+
+    void Johnson::clear_custom_edge_weights() {
+        edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+    }
+
+    void Johnson::set_csr(const GraphCsr *csr) {
+        this->csr = csr;
+    }
+
+    void Johnson::clear_csr() {
+        csr = nullptr;
+    }
+}
@@ -0,0 +1,100 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef GRAPHJOHNSON_H
+#define GRAPHJOHNSON_H
+
+#include "GraphCsr.h"
+
+namespace Bcg {
+    /**
+     * @brief Johnson: All-pairs shortest paths for sparse graphs by one Dijkstra search per source.
+     *
+     * If any weight is negative, BellmanFord computes a potential h from a virtual source connected to all vertices
+     * and every entry u -> v is reweighted to w + h(u) - h(v) >= 0, which keeps all shortest paths. The searches then
+     * run on the reweighted snapshot with DijkstraQuery, distributed over a JobSystem with one workspace per chunk,
+     * and the distances are shifted back. This takes O(V E log V) instead of the O(V^3) of FloydWarshall.
+     *
+     * The edges of a Graph are undirected, so a negative edge weight always forms a negative cycle. Negative weights
+     * without negative cycles only occur in snapshots whose entry weights differ between both directions of an edge.
+     */
+    class Johnson {
+    public:
+        /**
+         * @brief Receives the distances from a source to all vertices, indexed by vertex, max if unreachable.
+         * It is called concurrently from the workers of the JobSystem and the row is only valid during the call.
+         */
+        using RowCallback = std::function<void(const Vertex &source, const std::vector<Real> &row)>;
+
+        /**
+         * @brief Constructs a Johnson object for the given graph.
+         * @param graph The graph on which to compute the shortest paths.
+         * @param jobs If set, the searches of the sources run in parallel on this JobSystem.
+         */
+        explicit Johnson(Graph &graph, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Computes the distances between all pairs of vertices into vertex_vertex_distances.
+         * @return True if the computation was successful, false if a negative cycle was detected.
+         */
+        bool compute();
+
+        /**
+         * @brief Computes the distances from the given sources and passes every row to the callback instead of
+         * storing the matrix, so the memory stays bounded by one row per chunk.
+         * @param sources The source vertices.
+         * @param callback The receiver of the rows.
+         * @return True if the computation was successful, false if a negative cycle was detected.
+         */
+        bool compute(const std::vector<Vertex> &sources, const RowCallback &callback);
+
+        /**
+         * @brief Retrieve the distance from the source to the sink computed by compute(), max if it is unreachable.
+         */
+        [[nodiscard]] Real get_distance(const Vertex &source, const Vertex &sink) const {
+            return vertex_vertex_distances[source.idx() * n_vertices + sink.idx()];
+        }
+
+        /**
+         * @brief Sets custom edge weights for the shortest path computation.
+         * @param weights The custom edge weights to use.
+         */
+        void set_custom_edge_weights(const EdgeProperty<Real> &weights);
+
+        /**
+         * @brief Clears any custom edge weights set for the shortest path computation.
+         */
+        void clear_custom_edge_weights();
+
+        /**
+         * @brief Runs the computation on an adjacency snapshot of the graph instead of circulating its halfedges.
+         * The weights stored in the snapshot are used in place of the edge weights.
+         * @param csr The snapshot. It is not owned and has to stay alive until it is cleared.
+         */
+        void set_csr(const GraphCsr *csr);
+
+        /**
+         * @brief Clears the adjacency snapshot, the graph is circulated again.
+         */
+        void clear_csr();
+
+        EdgeProperty<Real> edge_weights; /**< The edge weights used in the shortest path computation. */
+        std::vector<Real> vertex_vertex_distances; /**< The row major matrix of distances between vertices. */
+        size_t n_vertices = 0; /**< The number of rows and columns of the matrix, including deleted vertices. */
+        bool negative_cycle_found = false; /**< Indicates if a negative cycle was found during the computation. */
+
+    private:
+        /**
+         * @brief Builds the reweighted snapshot and the potentials.
+         * @return False if a negative cycle was detected.
+         */
+        bool reweight(GraphCsr &reweighted, std::vector<Real> &potentials);
+
+        Graph &graph; /**< The graph on which to compute the shortest paths. */
+        JobSystem *jobs; /**< The optional JobSystem used for the searches. */
+        const GraphCsr *csr = nullptr; /**< The optional adjacency snapshot of the graph. */
+    };
+}
+
+#endif //GRAPHJOHNSON_H
@@ -3,11 +3,13 @@
 //
 
 #include "GraphKruskal.h"
+#include "Mesh.h"
 #include "GraphUtils.h"
 #include <numeric>
 
 namespace Bcg {
-    Kruskal::Kruskal(Graph &graph) : graph(graph) {
+    template<HalfedgeGraph GraphType>
+    Kruskal<GraphType>::Kruskal(GraphType &graph) : graph(graph) {
     }
 
     // A simple union–find (disjoint-set) structure.
@@ -33,22 +35,42 @@ namespace Bcg {
         }
     };
 
-    void Kruskal::compute(const Vertex &source) {
+    template<HalfedgeGraph GraphType>
+    void Kruskal<GraphType>::compute(const Vertex &source) {
+        if (!IsCompatibleCsr(graph, csr, "Kruskal::compute")) return;
         clear(); // Reset predecessor property and ensure edge_weights is set.
 
         int nV = static_cast<int>(graph.n_vertices());
         int nE = static_cast<int>(graph.n_edges());
 
-        // Collect all edges.
-        std::vector<Edge> edges;
+        // Collect all edges with their endpoints and weights.
+        struct WeightedEdge {
+            Edge e;
+            Vertex v0, v1;
+            Real weight;
+        };
+        std::vector<WeightedEdge> edges;
         edges.reserve(nE);
-        for (int i = 0; i < nE; i++) {
-            edges.push_back(Edge(i));
+        if (csr) {
+            // Every edge is stored once per endpoint, keep the entry of its first halfedge.
+            for (int i = 0; i < nV; i++) {
+                for (size_t k = csr->begin(Vertex(i)), end = csr->end(Vertex(i)); k < end; ++k) {
+                    if ((csr->halfedges[k] & 1) == 0) {
+                        edges.push_back({csr->get_edge(k), Vertex(i), csr->get_vertex(k), csr->get_weight(k)});
+                    }
+                }
+            }
+        } else {
+            for (int i = 0; i < nE; i++) {
+                Edge e(i);
+                edges.push_back({e, graph.get_vertex(graph.get_halfedge(e, 0)),
+                                 graph.get_vertex(graph.get_halfedge(e, 1)), edge_weights[e]});
+            }
         }
 
         // Sort edges by increasing weight.
-        std::sort(edges.begin(), edges.end(), [&](const Edge &a, const Edge &b) {
-            return edge_weights[a] < edge_weights[b];
+        std::sort(edges.begin(), edges.end(), [](const WeightedEdge &a, const WeightedEdge &b) {
+            return a.weight < b.weight;
         });
 
         // Initialize union-find structure.
@@ -57,15 +79,10 @@ namespace Bcg {
         std::vector<bool> in_mst(nE, false);
 
         // Process edges in sorted order.
-        for (const Edge &e: edges) {
-            // For each edge, get its two endpoints.
-            Halfedge h0 = graph.get_halfedge(e, 0);
-            Halfedge h1 = graph.get_halfedge(e, 1);
-            Vertex v0 = graph.get_vertex(h0);
-            Vertex v1 = graph.get_vertex(h1);
+        for (const WeightedEdge &edge: edges) {
             // If v0 and v1 are in different components, add the edge.
-            if (uf.unionSets(v0.idx(), v1.idx())) {
-                in_mst[e.idx()] = true;
+            if (uf.unionSets(edge.v0.idx(), edge.v1.idx())) {
+                in_mst[edge.e.idx()] = true;
             }
         }
 
@@ -81,11 +98,9 @@ namespace Bcg {
             q.pop();
 
             // Explore all outgoing halfedges from cur.
-            for (const auto &h: graph.get_halfedges(cur)) {
-                Edge e = graph.get_edge(h);
+            ForEachNeighbor(graph, csr, edge_weights, cur, [&](const Halfedge &h, const Vertex &nbr, Real) {
                 // Only follow edges that were included in the MST.
-                if (!in_mst[e.idx()]) continue;
-                Vertex nbr = graph.get_vertex(h);
+                if (!in_mst[graph.get_edge(h).idx()]) return;
                 if (!visited[nbr.idx()]) {
                     visited[nbr.idx()] = true;
                     // We want the predecessor of nbr to be cur.
@@ -93,28 +108,44 @@ namespace Bcg {
                     vertex_predecessors[nbr] = graph.get_opposite(h);
                     q.push(nbr);
                 }
-            }
+            });
         }
     }
 
-    void Kruskal::set_custom_edge_weights(const EdgeProperty<Real> &weights) {
+    template<HalfedgeGraph GraphType>
+    void Kruskal<GraphType>::set_custom_edge_weights(const EdgeProperty<Real> &weights) {
         edge_weights = weights;
     }
 
-    void Kruskal::clear_custom_edge_weights() {
-        edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+    template<HalfedgeGraph GraphType>
+    void Kruskal<GraphType>::clear_custom_edge_weights() {
+        edge_weights = EdgeLengths(graph, graph.template get_vertex_property<Vector<Real, 3> >("v:position"));
     }
 
-    void Kruskal::clear() {
-        if (!edge_weights) {
-            edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+    template<HalfedgeGraph GraphType>
+    void Kruskal<GraphType>::set_csr(const GraphCsr *csr) {
+        this->csr = csr;
+    }
+
+    template<HalfedgeGraph GraphType>
+    void Kruskal<GraphType>::clear_csr() {
+        csr = nullptr;
+    }
+
+    template<HalfedgeGraph GraphType>
+    void Kruskal<GraphType>::clear() {
+        if (!edge_weights && !csr) {
+            edge_weights = EdgeLengths(graph, graph.template get_vertex_property<Vector<Real, 3> >("v:position"));
         }
 
         // Initialize or reset the predecessor property.
         if (!vertex_predecessors) {
-            vertex_predecessors = graph.vertex_property<Halfedge>("v:prim:predecessors", Halfedge());
+            vertex_predecessors = graph.template vertex_property<Halfedge>("v:prim:predecessors", Halfedge());
         } else {
             std::ranges::fill(vertex_predecessors.vector(), Halfedge());
         }
     }
+
+    template class Kruskal<Graph>;
+    template class Kruskal<Mesh>;
 }
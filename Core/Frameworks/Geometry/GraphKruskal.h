@@ -5,19 +5,21 @@
 #ifndef GRAPHKRUSKAL_H
 #define GRAPHKRUSKAL_H
 
-#include "Graph.h"
+#include "GraphCsr.h"
 
 namespace Bcg {
     /**
      * @brief Kruskal: Computes a minimum spanning tree by processing edges in sorted order.
+     * @tparam GraphType Graph or Mesh, the tree is computed on the edges of either.
      */
+    template<HalfedgeGraph GraphType = Graph>
     class Kruskal {
     public:
         /**
          * @brief Constructs a Kruskal object for the given graph.
          * @param graph The graph on which to compute the MST.
          */
-        explicit Kruskal(Graph &graph);
+        explicit Kruskal(GraphType &graph);
 
         /**
          * @brief Computes the MST starting from the given source vertex.
@@ -36,6 +38,18 @@ namespace Bcg {
          */
         void clear_custom_edge_weights();
 
+        /**
+         * @brief Runs the computation on an adjacency snapshot of the graph instead of circulating its halfedges.
+         * The weights stored in the snapshot are used in place of the edge weights.
+         * @param csr The snapshot. It is not owned and has to stay alive until it is cleared.
+         */
+        void set_csr(const GraphCsr *csr);
+
+        /**
+         * @brief Clears the adjacency snapshot, the graph is circulated again.
+         */
+        void clear_csr();
+
         EdgeProperty<Real> edge_weights; /**< The edge weights used in the MST computation. */
         VertexProperty<Halfedge> vertex_predecessors;
         /**< Predecessor halfedge for each vertex in the MST to the source. */
@@ -46,7 +60,8 @@ namespace Bcg {
          */
         void clear();
 
-        Graph &graph; /**< The graph on which to compute the MST. */
+        GraphType &graph; /**< The graph on which to compute the MST. */
+        const GraphCsr *csr = nullptr; /**< The optional adjacency snapshot of the graph. */
     };
 }
 
@@ -0,0 +1,220 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphLandmarks.h"
+#include "GraphDijkstraQuery.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <iostream>
+
+namespace Bcg {
+    Landmarks::Landmarks(Graph &graph, JobSystem *jobs) : graph(graph), jobs(jobs) {
+    }
+
+    void Landmarks::select(size_t k, LandmarkSelection selection) {
+        const size_t n = graph.vertices.size();
+        if (k > graph.n_vertices()) {
+            std::cerr << "Error: Landmarks::select: More landmarks than vertices requested." << std::endl;
+            k = graph.n_vertices();
+        }
+        GraphCsr csr;
+        snapshot(csr);
+        const DijkstraQuery query(csr);
+        DijkstraWorkspace workspace;
+
+        // The distance of every vertex to its closest landmark, -1 for landmarks and deleted vertices.
+        std::vector<Real> closest(n, -1);
+        auto update_closest = [&]() {
+            for (size_t i = 0; i < n; ++i) {
+                if (closest[i] < 0) continue;
+                closest[i] = std::min(closest[i], workspace.get_distance(Vertex(i)));
+            }
+        };
+        // Vertices which no landmark reaches have distance max and are taken first, so every component is covered.
+        auto farthest = [&]() {
+            return Vertex(std::ranges::max_element(closest) - closest.begin());
+        };
+
+        for (const auto &v: graph.vertices) {
+            closest[v.idx()] = std::numeric_limits<Real>::max();
+        }
+        // The first landmark is the vertex farthest from an arbitrary start vertex.
+        if (k > 0) {
+            query.compute(workspace, *graph.vertices.begin());
+            update_closest();
+        }
+
+        std::vector<std::vector<Real> > tables;
+        unsigned int state = seed;
+        landmarks.clear();
+        while (landmarks.size() < k) {
+            Vertex landmark;
+            if (selection == LandmarkSelection::Avoid && !landmarks.empty()) {
+                landmark = select_avoid(csr, tables, state);
+            }
+            if (!landmark.is_valid()) {
+                landmark = farthest();
+            }
+
+            query.compute(workspace, landmark);
+            tables.emplace_back(n);
+            for (size_t i = 0; i < n; ++i) {
+                tables.back()[i] = workspace.get_distance(Vertex(i));
+            }
+            landmarks.push_back(landmark);
+            closest[landmark.idx()] = -1;
+            update_closest();
+        }
+        store(tables);
+    }
+
+    Vertex Landmarks::select_avoid(const GraphCsr &csr, const std::vector<std::vector<Real> > &tables,
+                                   unsigned int &state) {
+        const size_t n = graph.vertices.size();
+        // Pick a random root among the valid vertices.
+        Vertex root;
+        for (size_t attempt = 0; attempt < 16 && !root.is_valid(); ++attempt) {
+            state = state * 1664525u + 1013904223u;
+            const Vertex v(state % n);
+            if (graph.is_valid(v) && !graph.is_deleted(v)) root = v;
+        }
+        if (!root.is_valid()) return Vertex();
+
+        DijkstraWorkspace workspace;
+        DijkstraQuery(csr).compute(workspace, root);
+
+        // The children of every vertex in the shortest path tree of the root.
+        std::vector<unsigned int> parents(n, std::numeric_limits<unsigned int>::max());
+        std::vector<size_t> offsets(n + 1, 0);
+        for (size_t i = 0; i < n; ++i) {
+            const Halfedge h = workspace.get_predecessor(Vertex(i));
+            if (!h.is_valid()) continue;
+            parents[i] = static_cast<unsigned int>(graph.get_vertex(h).idx());
+            ++offsets[parents[i] + 1];
+        }
+        for (size_t i = 0; i < n; ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+        std::vector<unsigned int> children(offsets[n]);
+        std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < n; ++i) {
+            if (parents[i] != std::numeric_limits<unsigned int>::max()) {
+                children[fill[parents[i]]++] = static_cast<unsigned int>(i);
+            }
+        }
+
+        // Breadth first order of the tree, so every vertex comes before its children.
+        std::vector<unsigned int> order{static_cast<unsigned int>(root.idx())};
+        for (size_t i = 0; i < order.size(); ++i) {
+            for (size_t j = offsets[order[i]]; j < offsets[order[i] + 1]; ++j) {
+                order.push_back(children[j]);
+            }
+        }
+
+        // The weight of a vertex is the gap between its distance to the root and the lower bound of the landmarks.
+        // The size of a subtree sums the weights, or is zero if the subtree contains a landmark.
+        const Real max = std::numeric_limits<Real>::max();
+        std::vector<double> sizes(n, 0);
+        std::vector<uint8_t> covered(n, 0);
+        for (const Vertex &landmark: landmarks) {
+            covered[landmark.idx()] = 1;
+        }
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            const unsigned int v = *it;
+            Real bound = 0;
+            for (const std::vector<Real> &table: tables) {
+                if (table[v] == max || table[root.idx()] == max) continue;
+                bound = std::max(bound, std::abs(table[root.idx()] - table[v]));
+            }
+            double size = workspace.get_distance(Vertex(v)) - bound;
+            for (size_t j = offsets[v]; j < offsets[v + 1]; ++j) {
+                covered[v] |= covered[children[j]];
+                size += sizes[children[j]];
+            }
+            sizes[v] = covered[v] ? 0 : size;
+        }
+
+        // Descend into the largest subtree until a leaf is reached, no branch is left if all sizes are zero.
+        unsigned int current = static_cast<unsigned int>(root.idx());
+        while (true) {
+            unsigned int best = std::numeric_limits<unsigned int>::max();
+            for (size_t j = offsets[current]; j < offsets[current + 1]; ++j) {
+                if (sizes[children[j]] > 0 && (best == std::numeric_limits<unsigned int>::max() ||
+                                               sizes[children[j]] > sizes[best])) {
+                    best = children[j];
+                }
+            }
+            if (best == std::numeric_limits<unsigned int>::max()) break;
+            current = best;
+        }
+        return sizes[current] > 0 ? Vertex(current) : Vertex();
+    }
+
+    void Landmarks::set_landmarks(const std::vector<Vertex> &landmarks) {
+        for (const Vertex &landmark: landmarks) {
+            if (!graph.is_valid(landmark) || graph.is_deleted(landmark)) {
+                std::cerr << "Error: Landmarks::set_landmarks: Invalid landmark vertex." << std::endl;
+                return;
+            }
+        }
+        GraphCsr csr;
+        snapshot(csr);
+        const DijkstraQuery query(csr);
+        const size_t n = graph.vertices.size();
+
+        // The tables are independent, every chunk searches from its landmarks with its own workspace.
+        std::vector<std::vector<Real> > tables(landmarks.size());
+        ParallelFor(jobs, 0, landmarks.size(), 1, [&](size_t begin, size_t end) {
+            DijkstraWorkspace workspace;
+            for (size_t i = begin; i < end; ++i) {
+                query.compute(workspace, landmarks[i]);
+                tables[i].resize(n);
+                for (size_t j = 0; j < n; ++j) {
+                    tables[i][j] = workspace.get_distance(Vertex(j));
+                }
+            }
+        });
+        this->landmarks = landmarks;
+        store(tables);
+    }
+
+    LandmarkHeuristic Landmarks::get_heuristic(const Vertex &target) const {
+        LandmarkHeuristic heuristic;
+        heuristic.distances = distances.data();
+        heuristic.target_distances.resize(landmarks.size());
+        for (size_t i = 0; i < landmarks.size(); ++i) {
+            heuristic.target_distances[i] = get_distance(i, target);
+        }
+        return heuristic;
+    }
+
+    void Landmarks::set_custom_edge_weights(const EdgeProperty<Real> &weights) {
+        edge_weights = weights;
+    }
+
+    void Landmarks::clear_custom_edge_weights() {
+        edge_weights = graph.get_edge_property<Real>("e:length");
+        if (!edge_weights) {
+            edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+        }
+    }
+
+    void Landmarks::snapshot(GraphCsr &csr) {
+        if (!edge_weights) {
+            clear_custom_edge_weights();
+        }
+        csr = GraphCsr(graph, edge_weights, jobs);
+    }
+
+    void Landmarks::store(const std::vector<std::vector<Real> > &tables) {
+        const size_t n = graph.vertices.size();
+        const size_t k = tables.size();
+        distances.assign(n * k, std::numeric_limits<Real>::max());
+        for (size_t i = 0; i < k; ++i) {
+            for (size_t v = 0; v < n; ++v) {
+                distances[v * k + i] = tables[i][v];
+            }
+        }
+    }
+}
@@ -0,0 +1,133 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef GRAPHLANDMARKS_H
+#define GRAPHLANDMARKS_H
+
+#include "GraphCsr.h"
+
+namespace Bcg {
+    /**
+     * @brief The strategy used by Landmarks::select.
+     */
+    enum class LandmarkSelection {
+        Farthest, /**< Every new landmark is the vertex farthest from all previous landmarks. */
+        Avoid /**< Every new landmark is the leaf of the shortest path tree branch covered worst by the landmarks. */
+    };
+
+    /**
+     * @brief LandmarkHeuristic: The ALT lower bound of the distance from a vertex to a fixed target.
+     *
+     * Holds the landmark distances of the target, so a call reads only the contiguous landmark distances of the vertex.
+     * Pass it to the templated AStar::compute to inline it into the search loop.
+     */
+    struct LandmarkHeuristic {
+        const Real *distances = nullptr; /**< The vertex major distance table of the landmarks. */
+        std::vector<Real> target_distances; /**< The distances between every landmark and the target. */
+
+        Real operator()(const Vertex &v) const {
+            const size_t k = target_distances.size();
+            const Real *row = distances + v.idx() * k;
+            const Real max = std::numeric_limits<Real>::max();
+            Real bound = 0;
+            for (size_t i = 0; i < k; ++i) {
+                // Landmarks which do not reach both vertices give no bound.
+                if (row[i] == max || target_distances[i] == max) continue;
+                bound = std::max(bound, std::abs(target_distances[i] - row[i]));
+            }
+            return bound;
+        }
+    };
+
+    /**
+     * @brief Landmarks: Preprocessing of the ALT (A*, landmarks and triangle inequality) heuristic.
+     *
+     * Stores the shortest path distances between k landmark vertices and all vertices. By the triangle inequality
+     * |d(L, t) - d(L, v)| is a lower bound of d(v, t) for every landmark L, so the maximum over all landmarks is a
+     * consistent A* heuristic for any non-negative edge weights, also where the Euclidean distance is no lower bound.
+     * The weights are assumed to be symmetric, as for all edges of the graph.
+     */
+    class Landmarks {
+    public:
+        /**
+         * @brief Constructs the landmarks of the given graph, call select or set_landmarks before querying.
+         * @param graph The graph to preprocess.
+         * @param jobs If set, the distance tables of set_landmarks are computed in parallel on this JobSystem.
+         */
+        explicit Landmarks(Graph &graph, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Selects k landmarks and computes their distance tables.
+         * Every landmark depends on the tables of the previous ones, so the landmarks are selected one after another.
+         * @param k The number of landmarks, at most the number of vertices.
+         * @param selection The selection strategy.
+         */
+        void select(size_t k, LandmarkSelection selection = LandmarkSelection::Farthest);
+
+        /**
+         * @brief Uses the given landmarks and computes their distance tables, one search per landmark in parallel.
+         * @param landmarks The landmark vertices.
+         */
+        void set_landmarks(const std::vector<Vertex> &landmarks);
+
+        /**
+         * @brief Retrieve the distance between the i-th landmark and a vertex, max if it is unreachable.
+         */
+        [[nodiscard]] Real get_distance(size_t i, const Vertex &v) const {
+            return distances[v.idx() * landmarks.size() + i];
+        }
+
+        /**
+         * @brief Computes the ALT lower bound of the distance between two vertices.
+         */
+        [[nodiscard]] Real lower_bound(const Vertex &v, const Vertex &target) const {
+            return get_heuristic(target)(v);
+        }
+
+        /**
+         * @brief Retrieve the heuristic for searches towards the target.
+         * @param target The target of the search. The heuristic refers to the tables and has to be discarded when
+         * the landmarks change.
+         */
+        [[nodiscard]] LandmarkHeuristic get_heuristic(const Vertex &target) const;
+
+        /**
+         * @brief Sets custom edge weights for the preprocessing.
+         * @param weights The custom edge weights to use.
+         */
+        void set_custom_edge_weights(const EdgeProperty<Real> &weights);
+
+        /**
+         * @brief Clears any custom edge weights, "e:length" or the edge lengths of "v:position" are used instead.
+         */
+        void clear_custom_edge_weights();
+
+        EdgeProperty<Real> edge_weights; /**< The edge weights used in the preprocessing. */
+        std::vector<Vertex> landmarks; /**< The selected landmark vertices. */
+        unsigned int seed = 1; /**< The seed of the random tree roots of the avoid strategy. */
+
+    private:
+        /**
+         * @brief Snapshots the graph with the edge weights, called before the searches.
+         */
+        void snapshot(GraphCsr &csr);
+
+        /**
+         * @brief Selects the next landmark by the avoid strategy, or returns an invalid vertex if every tree branch
+         * already contains a landmark.
+         */
+        Vertex select_avoid(const GraphCsr &csr, const std::vector<std::vector<Real> > &tables, unsigned int &state);
+
+        /**
+         * @brief Interleaves the per landmark tables into the vertex major distance table.
+         */
+        void store(const std::vector<std::vector<Real> > &tables);
+
+        Graph &graph; /**< The graph to preprocess. */
+        JobSystem *jobs; /**< The optional JobSystem used for the distance tables. */
+        std::vector<Real> distances; /**< The landmark distances of every vertex, vertex major. */
+    };
+}
+
+#endif //GRAPHLANDMARKS_H
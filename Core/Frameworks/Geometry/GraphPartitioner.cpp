@@ -0,0 +1,598 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphPartitioner.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include "Mesh.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <random>
+
+namespace Bcg {
+    // Weighted adjacency of the elements in compressed sparse rows, every edge is stored once per endpoint.
+    struct PartitionGraph {
+        std::vector<size_t> offsets;
+        std::vector<uint32_t> neighbors;
+        std::vector<uint32_t> edge_weights;
+        std::vector<uint32_t> vertex_weights;
+
+        [[nodiscard]] size_t size() const { return vertex_weights.size(); }
+    };
+
+    struct PartitionSettings {
+        Real tolerance; // Allowed excess of one side of a bisection over its target weight.
+        size_t coarsest_size;
+        size_t refinement_passes;
+    };
+
+    // Builds the adjacency of the valid elements. compact maps every element to its row, or to max if it is invalid.
+    // for_each_neighbor(i, func) calls func(j) for the neighbors j of the valid element i.
+    template<typename IsValid, typename ForEachNeighbor>
+    static PartitionGraph BuildPartitionGraph(size_t n, IsValid &&is_valid, ForEachNeighbor &&for_each_neighbor,
+                                              JobSystem *jobs, std::vector<uint32_t> &compact) {
+        constexpr size_t grain_size = 4096;
+        compact.assign(n, std::numeric_limits<uint32_t>::max());
+        std::vector<uint32_t> elements;
+        for (size_t i = 0; i < n; ++i) {
+            if (!is_valid(i)) continue;
+            compact[i] = static_cast<uint32_t>(elements.size());
+            elements.push_back(static_cast<uint32_t>(i));
+        }
+
+        PartitionGraph graph;
+        graph.vertex_weights.assign(elements.size(), 1);
+        graph.offsets.assign(elements.size() + 1, 0);
+        ParallelFor(jobs, 0, elements.size(), grain_size, [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                size_t count = 0;
+                for_each_neighbor(elements[k], [&](size_t j) { count += j != elements[k]; });
+                graph.offsets[k + 1] = count;
+            }
+        });
+        std::partial_sum(graph.offsets.begin(), graph.offsets.end(), graph.offsets.begin());
+        graph.neighbors.resize(graph.offsets.back());
+        graph.edge_weights.assign(graph.offsets.back(), 1);
+        ParallelFor(jobs, 0, elements.size(), grain_size, [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                size_t entry = graph.offsets[k];
+                for_each_neighbor(elements[k], [&](size_t j) {
+                    if (j != elements[k]) graph.neighbors[entry++] = compact[j];
+                });
+            }
+        });
+        return graph;
+    }
+
+    // Heavy edge matching: visits the vertices in random order and matches every unmatched vertex with the unmatched
+    // neighbor of the heaviest edge. Matched pairs become one coarse vertex, coarse[v] maps to it. The vertices are
+    // matched within fixed blocks of consecutive indices, so the blocks run in parallel and the matching does not
+    // depend on the number of threads. Consecutive indices are mostly close, so few heavy edges cross blocks.
+    static PartitionGraph Coarsen(const PartitionGraph &graph, unsigned int seed, uint64_t max_vertex_weight,
+                                  JobSystem *jobs, std::vector<uint32_t> &coarse) {
+        constexpr uint32_t Unmatched = std::numeric_limits<uint32_t>::max();
+        constexpr size_t block_size = 4096;
+        const size_t n = graph.size();
+        const size_t n_blocks = (n + block_size - 1) / block_size;
+        std::vector<uint32_t> match(n, Unmatched);
+        std::vector<size_t> first_coarse(n_blocks + 1, 0);
+        ParallelFor(jobs, 0, n_blocks, 1, [&](size_t begin, size_t end) {
+            std::vector<uint32_t> order;
+            for (size_t b = begin; b < end; ++b) {
+                const uint32_t block_begin = static_cast<uint32_t>(b * block_size);
+                const uint32_t block_end = static_cast<uint32_t>(std::min(n, (b + 1) * block_size));
+                order.resize(block_end - block_begin);
+                std::iota(order.begin(), order.end(), block_begin);
+                std::mt19937 rng(seed + static_cast<unsigned int>(b));
+                std::shuffle(order.begin(), order.end(), rng);
+                size_t n_coarse = 0;
+                for (const uint32_t v: order) {
+                    if (match[v] != Unmatched) continue;
+                    uint32_t best = v, best_weight = 0;
+                    for (size_t k = graph.offsets[v]; k < graph.offsets[v + 1]; ++k) {
+                        const uint32_t u = graph.neighbors[k];
+                        if (u < block_begin || u >= block_end || match[u] != Unmatched || u == v ||
+                            graph.edge_weights[k] <= best_weight) {
+                            continue;
+                        }
+                        // Heavy coarse vertices would make the bisection of the coarsest graph unbalanced.
+                        if (graph.vertex_weights[v] + graph.vertex_weights[u] > max_vertex_weight) continue;
+                        best = u;
+                        best_weight = graph.edge_weights[k];
+                    }
+                    match[v] = best;
+                    match[best] = v;
+                    ++n_coarse;
+                }
+                first_coarse[b + 1] = n_coarse;
+            }
+        });
+        std::partial_sum(first_coarse.begin(), first_coarse.end(), first_coarse.begin());
+
+        // Every pair becomes the coarse vertex at the position of its smaller index. The rows of a pair are merged by
+        // sorting their entries, every block collects its rows before they are copied to their final offsets.
+        PartitionGraph result;
+        const size_t n_coarse = first_coarse.back();
+        coarse.resize(n);
+        result.vertex_weights.resize(n_coarse);
+        result.offsets.assign(n_coarse + 1, 0);
+        std::vector<std::vector<uint32_t> > block_neighbors(n_blocks), block_weights(n_blocks);
+        ParallelFor(jobs, 0, n_blocks, 1, [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                const uint32_t block_begin = static_cast<uint32_t>(b * block_size);
+                const uint32_t block_end = static_cast<uint32_t>(std::min(n, (b + 1) * block_size));
+                uint32_t c = static_cast<uint32_t>(first_coarse[b]);
+                for (uint32_t v = block_begin; v < block_end; ++v) {
+                    if (match[v] < v) continue;
+                    coarse[v] = coarse[match[v]] = c;
+                    const uint32_t partner_weight = match[v] != v ? graph.vertex_weights[match[v]] : 0;
+                    result.vertex_weights[c++] = graph.vertex_weights[v] + partner_weight;
+                }
+            }
+        });
+        ParallelFor(jobs, 0, n_blocks, 1, [&](size_t begin, size_t end) {
+            std::vector<std::pair<uint32_t, uint32_t> > entries;
+            for (size_t b = begin; b < end; ++b) {
+                const uint32_t block_begin = static_cast<uint32_t>(b * block_size);
+                const uint32_t block_end = static_cast<uint32_t>(std::min(n, (b + 1) * block_size));
+                for (uint32_t v = block_begin; v < block_end; ++v) {
+                    if (match[v] < v) continue;
+                    const uint32_t c = coarse[v];
+                    entries.clear();
+                    for (const uint32_t w: {v, match[v]}) {
+                        for (size_t k = graph.offsets[w]; k < graph.offsets[w + 1]; ++k) {
+                            const uint32_t cu = coarse[graph.neighbors[k]];
+                            if (cu != c) entries.emplace_back(cu, graph.edge_weights[k]);
+                        }
+                        if (match[v] == v) break;
+                    }
+                    std::ranges::sort(entries);
+                    size_t row_size = 0;
+                    for (size_t i = 0; i < entries.size(); ++i) {
+                        if (i > 0 && entries[i].first == entries[i - 1].first) {
+                            block_weights[b].back() += entries[i].second;
+                            continue;
+                        }
+                        block_neighbors[b].push_back(entries[i].first);
+                        block_weights[b].push_back(entries[i].second);
+                        ++row_size;
+                    }
+                    result.offsets[c + 1] = row_size;
+                }
+            }
+        });
+        std::partial_sum(result.offsets.begin(), result.offsets.end(), result.offsets.begin());
+        result.neighbors.resize(result.offsets.back());
+        result.edge_weights.resize(result.offsets.back());
+        ParallelFor(jobs, 0, n_blocks, 1, [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                const size_t offset = result.offsets[first_coarse[b]];
+                std::ranges::copy(block_neighbors[b], result.neighbors.begin() + offset);
+                std::ranges::copy(block_weights[b], result.edge_weights.begin() + offset);
+                block_neighbors[b] = {};
+                block_weights[b] = {};
+            }
+        });
+        return result;
+    }
+
+    static uint64_t CutWeight(const PartitionGraph &graph, const std::vector<uint8_t> &sides) {
+        uint64_t cut = 0;
+        for (size_t v = 0; v < graph.size(); ++v) {
+            for (size_t k = graph.offsets[v]; k < graph.offsets[v + 1]; ++k) {
+                cut += sides[v] != sides[graph.neighbors[k]] ? graph.edge_weights[k] : 0;
+            }
+        }
+        return cut / 2;
+    }
+
+    // Fiduccia-Mattheyses refinement of a bisection. Every pass moves the vertex with the largest cut reduction from
+    // the side it may leave, locks it, and rolls back to the best state seen once the moves stop paying off. States
+    // within the weight limits are always preferred over states that exceed them. Only the boundary vertices start as
+    // candidates. They are found once in parallel and afterwards only change around moved vertices, and gains are
+    // computed when a vertex is first touched in a pass, so a pass does not visit the whole graph.
+    static void RefineBisection(const PartitionGraph &graph, std::vector<uint8_t> &sides,
+                                const std::array<uint64_t, 2> &limits, size_t passes, JobSystem *jobs) {
+        const size_t n = graph.size();
+        std::array<uint64_t, 2> weights = {0, 0};
+        for (size_t v = 0; v < n; ++v) {
+            weights[sides[v]] += graph.vertex_weights[v];
+        }
+        auto excess = [&]() {
+            return (weights[0] > limits[0] ? weights[0] - limits[0] : 0) +
+                   (weights[1] > limits[1] ? weights[1] - limits[1] : 0);
+        };
+        auto is_boundary = [&](uint32_t v) {
+            for (size_t k = graph.offsets[v]; k < graph.offsets[v + 1]; ++k) {
+                if (sides[graph.neighbors[k]] != sides[v]) return true;
+            }
+            return false;
+        };
+
+        std::vector<uint32_t> boundary;
+        std::mutex mutex;
+        ParallelFor(jobs, 0, n, 4096, [&](size_t begin, size_t end) {
+            std::vector<uint32_t> local;
+            for (size_t v = begin; v < end; ++v) {
+                if (is_boundary(static_cast<uint32_t>(v))) local.push_back(static_cast<uint32_t>(v));
+            }
+            std::scoped_lock lock(mutex);
+            boundary.insert(boundary.end(), local.begin(), local.end());
+        });
+        std::ranges::sort(boundary);
+
+        using Entry = std::pair<int64_t, uint32_t>;
+        std::vector<int64_t> gains(n);
+        // stamps[v] is the pass which last computed gains[v].
+        std::vector<uint32_t> stamps(n, std::numeric_limits<uint32_t>::max());
+        std::vector<uint8_t> locked(n, 0);
+        std::vector<uint32_t> moves;
+        for (size_t pass = 0; pass < passes; ++pass) {
+            const uint32_t stamp = static_cast<uint32_t>(pass);
+            auto gain = [&](uint32_t v) -> int64_t & {
+                if (stamps[v] != stamp) {
+                    int64_t sum = 0;
+                    for (size_t k = graph.offsets[v]; k < graph.offsets[v + 1]; ++k) {
+                        const int64_t weight = graph.edge_weights[k];
+                        sum += sides[graph.neighbors[k]] != sides[v] ? weight : -weight;
+                    }
+                    stamps[v] = stamp;
+                    gains[v] = sum;
+                }
+                return gains[v];
+            };
+
+            std::array<std::priority_queue<Entry>, 2> queues;
+            if (excess() > 0) {
+                // Interior vertices are candidates too while a side is too heavy.
+                for (uint32_t v = 0; v < n; ++v) {
+                    queues[sides[v]].push({gain(v), v});
+                }
+            } else {
+                // Interior vertices only become candidates once a neighbor moved.
+                for (const uint32_t v: boundary) {
+                    queues[sides[v]].push({gain(v), v});
+                }
+            }
+
+            moves.clear();
+            int64_t total = 0, best_total = 0;
+            uint64_t best_excess = excess();
+            size_t best_moves = 0;
+            const size_t patience = std::max<size_t>(64, n / 100);
+            while (moves.size() - best_moves < patience) {
+                // Pop the best unlocked vertex of a side whose entry is up to date.
+                auto top = [&](int side) -> int64_t {
+                    auto &queue = queues[side];
+                    while (!queue.empty() && (locked[queue.top().second] || queue.top().first !=
+                                              gains[queue.top().second] || sides[queue.top().second] != side)) {
+                        queue.pop();
+                    }
+                    return queue.empty() ? std::numeric_limits<int64_t>::min() : queue.top().first;
+                };
+                const int64_t top0 = top(0), top1 = top(1);
+                int from;
+                if (weights[0] > limits[0]) from = 0;
+                else if (weights[1] > limits[1]) from = 1;
+                else from = top0 >= top1 ? 0 : 1;
+                if (queues[from].empty()) break;
+                const uint32_t v = queues[from].top().second;
+                queues[from].pop();
+                const int to = 1 - from;
+                if (weights[to] + graph.vertex_weights[v] > limits[to] && weights[from] <= limits[from]) {
+                    // The move would exceed the other side, skip the vertex for this pass.
+                    locked[v] = 1;
+                    moves.push_back(v | 0x80000000u);
+                    continue;
+                }
+
+                sides[v] = static_cast<uint8_t>(to);
+                locked[v] = 1;
+                weights[from] -= graph.vertex_weights[v];
+                weights[to] += graph.vertex_weights[v];
+                total += gains[v];
+                gains[v] = -gains[v];
+                for (size_t k = graph.offsets[v]; k < graph.offsets[v + 1]; ++k) {
+                    const uint32_t u = graph.neighbors[k];
+                    const int64_t weight = graph.edge_weights[k];
+                    if (stamps[u] == stamp) {
+                        gains[u] += sides[u] == to ? -2 * weight : 2 * weight;
+                    } else {
+                        // A first computation already sees v on its new side.
+                        gain(u);
+                    }
+                    if (!locked[u]) queues[sides[u]].push({gains[u], u});
+                }
+                moves.push_back(v);
+
+                const uint64_t current_excess = excess();
+                if (current_excess < best_excess || (current_excess == best_excess && total > best_total)) {
+                    best_excess = current_excess;
+                    best_total = total;
+                    best_moves = moves.size();
+                }
+            }
+
+            // Undo the moves after the best state and unlock all vertices.
+            for (size_t i = moves.size(); i-- > 0;) {
+                const uint32_t v = moves[i] & 0x7fffffffu;
+                locked[v] = 0;
+                if (i < best_moves || moves[i] & 0x80000000u) continue;
+                const int side = sides[v];
+                sides[v] = static_cast<uint8_t>(1 - side);
+                weights[side] -= graph.vertex_weights[v];
+                weights[1 - side] += graph.vertex_weights[v];
+            }
+            if (best_moves == 0) break;
+
+            // The boundary only changed at the kept moves and their neighbors.
+            std::vector<uint32_t> candidates = std::move(boundary);
+            for (size_t i = 0; i < best_moves; ++i) {
+                const uint32_t v = moves[i] & 0x7fffffffu;
+                candidates.push_back(v);
+                for (size_t k = graph.offsets[v]; k < graph.offsets[v + 1]; ++k) {
+                    candidates.push_back(graph.neighbors[k]);
+                }
+            }
+            std::ranges::sort(candidates);
+            const auto [first, last] = std::ranges::unique(candidates);
+            candidates.erase(first, last);
+            boundary.clear();
+            for (const uint32_t v: candidates) {
+                if (is_boundary(v)) boundary.push_back(v);
+            }
+        }
+    }
+
+    // Grows side 0 from a few random seeds by breadth first search until it reaches its target weight, refines every
+    // candidate and keeps the one with the smallest cut.
+    static std::vector<uint8_t> InitialBisection(const PartitionGraph &graph, uint64_t target,
+                                                 const std::array<uint64_t, 2> &limits, size_t passes,
+                                                 std::mt19937 &rng) {
+        const size_t n = graph.size();
+        std::vector<uint8_t> best;
+        uint64_t best_cut = std::numeric_limits<uint64_t>::max();
+        std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(n - 1));
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            std::vector<uint8_t> sides(n, 1);
+            std::deque<uint32_t> queue;
+            uint64_t weight = 0;
+            uint32_t next = pick(rng);
+            for (size_t visited = 0; weight < target && visited < n;) {
+                if (queue.empty()) {
+                    // Continue in another component.
+                    while (sides[next] == 0) next = (next + 1) % n;
+                    sides[next] = 0;
+                    queue.push_back(next);
+                    weight += graph.vertex_weights[next];
+                    ++visited;
+                }
+                const uint32_t v = queue.front();
+                queue.pop_front();
+                for (size_t k = graph.offsets[v]; k < graph.offsets[v + 1] && weight < target; ++k) {
+                    const uint32_t u = graph.neighbors[k];
+                    if (sides[u] == 0) continue;
+                    sides[u] = 0;
+                    weight += graph.vertex_weights[u];
+                    queue.push_back(u);
+                    ++visited;
+                }
+            }
+            RefineBisection(graph, sides, limits, passes, nullptr);
+            const uint64_t cut = CutWeight(graph, sides);
+            if (cut < best_cut) {
+                best_cut = cut;
+                best = std::move(sides);
+            }
+        }
+        return best;
+    }
+
+    // Multilevel bisection with a share of ratio of the total weight on side 0. Coarsening, projection and the boundary
+    // search run on the JobSystem, the refinement moves of every level are sequential.
+    static std::vector<uint8_t> Bisect(const PartitionGraph &graph, double ratio, const PartitionSettings &settings,
+                                       std::mt19937 &rng, JobSystem *jobs) {
+        uint64_t total = 0;
+        for (const uint32_t weight: graph.vertex_weights) {
+            total += weight;
+        }
+        const uint64_t max_vertex_weight = std::max<uint64_t>(
+            2, static_cast<uint64_t>(1.5 * static_cast<double>(total) / static_cast<double>(settings.coarsest_size)));
+
+        std::deque<PartitionGraph> levels;
+        std::deque<std::vector<uint32_t> > maps;
+        const PartitionGraph *current = &graph;
+        while (current->size() > settings.coarsest_size) {
+            std::vector<uint32_t> map;
+            PartitionGraph coarse = Coarsen(*current, rng(), max_vertex_weight, jobs, map);
+            // Stop if the matching stalls, e.g. on star like graphs.
+            if (coarse.size() > current->size() * 9 / 10) break;
+            levels.push_back(std::move(coarse));
+            maps.push_back(std::move(map));
+            current = &levels.back();
+        }
+
+        const uint64_t target = static_cast<uint64_t>(std::llround(ratio * static_cast<double>(total)));
+        // Every side may exceed its target by the tolerance, or by the heaviest vertex on coarse levels.
+        auto limits = [&](const PartitionGraph &level) {
+            const uint64_t heaviest = *std::ranges::max_element(level.vertex_weights);
+            std::array<uint64_t, 2> result;
+            for (int side = 0; side < 2; ++side) {
+                const uint64_t side_target = side == 0 ? target : total - target;
+                result[side] = std::max(side_target + heaviest, static_cast<uint64_t>(
+                                            std::ceil(side_target * (1.0 + settings.tolerance))));
+            }
+            return result;
+        };
+
+        std::vector<uint8_t> sides = InitialBisection(*current, target, limits(*current), settings.refinement_passes,
+                                                      rng);
+        for (size_t level = levels.size(); level-- > 0;) {
+            const PartitionGraph &finer = level == 0 ? graph : levels[level - 1];
+            std::vector<uint8_t> projected(finer.size());
+            ParallelFor(jobs, 0, finer.size(), 4096, [&](size_t begin, size_t end) {
+                for (size_t v = begin; v < end; ++v) {
+                    projected[v] = sides[maps[level][v]];
+                }
+            });
+            sides = std::move(projected);
+            RefineBisection(finer, sides, limits(finer), settings.refinement_passes, jobs);
+        }
+        return sides;
+    }
+
+    // The vertices of a part of the recursion which still has to be split into n_parts parts.
+    struct PartitionTask {
+        std::vector<uint32_t> vertices;
+        size_t first_part = 0;
+        size_t n_parts = 1;
+    };
+
+    // Splits the graph into n_parts parts by recursive bisection and writes the part of every vertex.
+    static void PartitionRecursively(const PartitionGraph &graph, size_t n_parts, const PartitionSettings &settings,
+                                     unsigned int seed, JobSystem *jobs, std::vector<int> &parts) {
+        const size_t n = graph.size();
+        parts.assign(n, 0);
+        std::vector<PartitionTask> tasks(1);
+        tasks[0].vertices.resize(n);
+        std::iota(tasks[0].vertices.begin(), tasks[0].vertices.end(), 0);
+        tasks[0].n_parts = n_parts;
+        std::vector<uint32_t> task_ids(n, 0), local(n, 0);
+
+        while (!tasks.empty()) {
+            ParallelFor(jobs, 0, tasks.size(), 1, [&](size_t begin, size_t end) {
+                for (size_t t = begin; t < end; ++t) {
+                    for (const uint32_t v: tasks[t].vertices) {
+                        task_ids[v] = static_cast<uint32_t>(t);
+                    }
+                }
+            });
+
+            std::vector<std::array<PartitionTask, 2> > children(tasks.size());
+            ParallelFor(jobs, 0, tasks.size(), 1, [&](size_t begin, size_t end) {
+                for (size_t t = begin; t < end; ++t) {
+                    const PartitionTask &task = tasks[t];
+                    if (task.n_parts == 1 || task.vertices.size() < 2) {
+                        for (const uint32_t v: task.vertices) {
+                            parts[v] = static_cast<int>(task.first_part);
+                        }
+                        continue;
+                    }
+
+                    // Extract the subgraph of the task, unless it is the whole graph.
+                    PartitionGraph subgraph;
+                    const bool whole = task.vertices.size() == n;
+                    if (!whole) {
+                        for (size_t i = 0; i < task.vertices.size(); ++i) {
+                            local[task.vertices[i]] = static_cast<uint32_t>(i);
+                        }
+                        subgraph.vertex_weights.assign(task.vertices.size(), 1);
+                        subgraph.offsets.reserve(task.vertices.size() + 1);
+                        subgraph.offsets.push_back(0);
+                        for (const uint32_t v: task.vertices) {
+                            for (size_t k = graph.offsets[v]; k < graph.offsets[v + 1]; ++k) {
+                                const uint32_t u = graph.neighbors[k];
+                                if (task_ids[u] != t) continue;
+                                subgraph.neighbors.push_back(local[u]);
+                                subgraph.edge_weights.push_back(graph.edge_weights[k]);
+                            }
+                            subgraph.offsets.push_back(subgraph.neighbors.size());
+                        }
+                    }
+
+                    // Seeding by the parts keeps the result independent of the scheduling.
+                    std::mt19937 rng(seed + static_cast<unsigned int>(task.first_part * 7919 + task.n_parts));
+                    const size_t n_first = task.n_parts / 2;
+                    const std::vector<uint8_t> sides = Bisect(whole ? graph : subgraph,
+                                                              static_cast<double>(n_first) / task.n_parts, settings,
+                                                              rng, jobs);
+                    children[t][0].first_part = task.first_part;
+                    children[t][0].n_parts = n_first;
+                    children[t][1].first_part = task.first_part + n_first;
+                    children[t][1].n_parts = task.n_parts - n_first;
+                    for (size_t i = 0; i < task.vertices.size(); ++i) {
+                        children[t][sides[i]].vertices.push_back(task.vertices[i]);
+                    }
+                }
+            });
+
+            std::vector<PartitionTask> next;
+            for (auto &pair: children) {
+                for (auto &child: pair) {
+                    if (!child.vertices.empty()) next.push_back(std::move(child));
+                }
+            }
+            tasks = std::move(next);
+        }
+    }
+
+    // Partitions n elements and writes the part of every element into ids, -1 for invalid elements.
+    template<typename IsValid, typename ForEachNeighbor>
+    static void ComputePartitionIds(size_t n, IsValid &&is_valid, ForEachNeighbor &&for_each_neighbor,
+                                    size_t n_parts, const GraphPartitioner &partitioner, JobSystem *jobs,
+                                    std::vector<int> &ids, std::vector<size_t> &part_sizes, size_t &n_cut_edges) {
+        std::vector<uint32_t> compact;
+        const PartitionGraph graph = BuildPartitionGraph(n, is_valid, for_each_neighbor, jobs, compact);
+        n_parts = std::max<size_t>(1, std::min(n_parts, graph.size()));
+        // The tolerance is shared by the bisections on the way from the whole graph to a part.
+        const size_t depth = std::max<size_t>(1, static_cast<size_t>(std::ceil(std::log2(n_parts))));
+        const PartitionSettings settings = {
+            partitioner.imbalance_tolerance / static_cast<Real>(depth),
+            std::max<size_t>(partitioner.coarsest_size, 2), partitioner.refinement_passes
+        };
+        std::vector<int> parts;
+        PartitionRecursively(graph, n_parts, settings, partitioner.seed, jobs, parts);
+
+        ids.assign(n, -1);
+        part_sizes.assign(n_parts, 0);
+        for (size_t i = 0; i < n; ++i) {
+            if (compact[i] == std::numeric_limits<uint32_t>::max()) continue;
+            ids[i] = parts[compact[i]];
+            ++part_sizes[ids[i]];
+        }
+        n_cut_edges = 0;
+        for (size_t v = 0; v < graph.size(); ++v) {
+            for (size_t k = graph.offsets[v]; k < graph.offsets[v + 1]; ++k) {
+                n_cut_edges += parts[v] != parts[graph.neighbors[k]];
+            }
+        }
+        n_cut_edges /= 2;
+    }
+
+    GraphPartitioner::GraphPartitioner(Graph &graph, JobSystem *jobs) : graph(&graph), jobs(jobs) {
+    }
+
+    GraphPartitioner::GraphPartitioner(Mesh &mesh, JobSystem *jobs) : mesh(&mesh), jobs(jobs) {
+    }
+
+    void GraphPartitioner::compute(size_t n_parts) {
+        VisitGraphOrMesh(graph, mesh, [this, n_parts](auto &g) {
+            if (!partition_ids) {
+                partition_ids = g.template vertex_property<int>("v:partition_ids", -1);
+            }
+            auto is_valid = [&g](size_t i) { return !g.is_deleted(Vertex(i)); };
+            ComputePartitionIds(g.vertices.size(), is_valid, VertexNeighbors(g), n_parts, *this, jobs,
+                                partition_ids.vector(), part_sizes, n_cut_edges);
+        });
+        imbalance = part_sizes.empty() ? 0 : static_cast<Real>(*std::ranges::max_element(part_sizes)) *
+                                             part_sizes.size() / std::reduce(part_sizes.begin(), part_sizes.end());
+    }
+
+    void GraphPartitioner::compute_faces(size_t n_parts) {
+        if (!HasFaces(mesh, "GraphPartitioner::compute_faces")) return;
+        if (!face_partition_ids) {
+            face_partition_ids = mesh->face_property<int>("f:partition_ids", -1);
+        }
+        auto is_valid = [this](size_t i) { return !mesh->is_deleted(Face(i)); };
+        ComputePartitionIds(mesh->faces.size(), is_valid, FaceNeighbors(*mesh), n_parts, *this, jobs,
+                            face_partition_ids.vector(), part_sizes, n_cut_edges);
+        imbalance = part_sizes.empty() ? 0 : static_cast<Real>(*std::ranges::max_element(part_sizes)) *
+                                             part_sizes.size() / std::reduce(part_sizes.begin(), part_sizes.end());
+    }
+}
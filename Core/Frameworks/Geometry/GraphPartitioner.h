@@ -0,0 +1,71 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef GRAPHPARTITIONER_H
+#define GRAPHPARTITIONER_H
+
+#include "Graph.h"
+
+namespace Bcg {
+    class JobSystem;
+    class Mesh;
+
+    /**
+     * @brief GraphPartitioner: Splits the vertices of a graph or mesh, or the faces of a mesh, into balanced parts
+     * with few edges between them.
+     *
+     * The parts are found by recursive multilevel bisection. Every bisection coarsens the adjacency by heavy edge
+     * matching until it is small, splits the coarsest graph by growing a region from a few seeds, and projects the
+     * split back level by level, refining it with Fiduccia-Mattheyses moves at every level. The two halves of a
+     * bisection are split independently, so all bisections of a recursion level run in parallel if a JobSystem is
+     * given, and the matching is done in parallel within fixed blocks of indices. The refinement is sequential. The
+     * result only depends on the seed, not on the number of threads.
+     */
+    class GraphPartitioner {
+    public:
+        /**
+         * @brief Constructs a GraphPartitioner object for the vertices of a graph.
+         * @param graph The graph whose vertices are partitioned.
+         * @param jobs If set, the bisections and the coarsening run in parallel on this JobSystem.
+         */
+        explicit GraphPartitioner(Graph &graph, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Constructs a GraphPartitioner object for the vertices or faces of a mesh.
+         * @param mesh The mesh whose vertices or faces are partitioned.
+         * @param jobs If set, the bisections and the coarsening run in parallel on this JobSystem.
+         */
+        explicit GraphPartitioner(Mesh &mesh, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Partitions the vertices connected by edges into partition_ids.
+         * @param n_parts The number of parts.
+         */
+        void compute(size_t n_parts);
+
+        /**
+         * @brief Partitions the faces of the mesh connected by interior edges into face_partition_ids.
+         * @param n_parts The number of parts.
+         */
+        void compute_faces(size_t n_parts);
+
+        VertexProperty<int> partition_ids; /**< The part of each vertex, -1 for deleted vertices. */
+        FaceProperty<int> face_partition_ids; /**< The part of each face, -1 for deleted faces. */
+        std::vector<size_t> part_sizes; /**< The number of elements in each part after the last compute. */
+        size_t n_cut_edges = 0; /**< The number of adjacencies between elements of different parts. */
+        Real imbalance = 0; /**< The size of the largest part divided by the average part size. */
+
+        Real imbalance_tolerance = 0.03f; /**< The allowed excess of a part over the average part size. */
+        size_t coarsest_size = 128; /**< Coarsening stops once a graph has at most this many vertices. */
+        size_t refinement_passes = 4; /**< The maximal number of refinement passes per level. */
+        unsigned int seed = 1; /**< The seed of the random matching order and the initial regions. */
+
+    private:
+        Graph *graph = nullptr; /**< The graph whose vertices are partitioned. */
+        Mesh *mesh = nullptr; /**< The mesh whose vertices or faces are partitioned. */
+        JobSystem *jobs; /**< The optional JobSystem used for the bisections. */
+    };
+}
+
+#endif //GRAPHPARTITIONER_H
@@ -3,6 +3,7 @@
 //
 
 #include "GraphPrim.h"
+#include "Mesh.h"
 #include "GraphUtils.h"
 
 namespace Bcg {
@@ -17,11 +18,14 @@ namespace Bcg {
         }
     };
 
-    Prim::Prim(Graph &graph) : graph(graph) {
+    template<HalfedgeGraph GraphType>
+    Prim<GraphType>::Prim(GraphType &graph) : graph(graph) {
 
     }
 
-    void Prim::compute(const Vertex &source) {
+    template<HalfedgeGraph GraphType>
+    void Prim<GraphType>::compute(const Vertex &source) {
+        if (!IsCompatibleCsr(graph, csr, "Prim::compute")) return;
         clear();
 
         const int n = static_cast<int>(graph.n_vertices());
@@ -49,14 +53,11 @@ namespace Bcg {
             in_tree[vidx] = true;
 
             // Examine all outgoing halfedges of v.
-            for (const auto &h: graph.get_halfedges(v)) {
+            ForEachNeighbor(graph, csr, edge_weights, v, [&](const Halfedge &h, const Vertex &u, Real weight) {
                 // h is a halfedge from v to its neighbor u.
-                Vertex u = graph.get_vertex(h);
                 int uidx = u.idx();
                 // Only consider vertices not yet in the MST.
                 if (!in_tree[uidx]) {
-                    Edge e = graph.get_edge(h);
-                    Real weight = edge_weights[e];
                     // If the weight of this edge is less than the current key for u,
                     // update key and store the connecting edge.
                     if (weight < key[uidx]) {
@@ -67,28 +68,44 @@ namespace Bcg {
                         queue.push({u, key[uidx]});
                     }
                 }
-            }
+            });
         }
     }
 
-    void Prim::set_custom_edge_weights(const EdgeProperty<Real> &weights) {
+    template<HalfedgeGraph GraphType>
+    void Prim<GraphType>::set_custom_edge_weights(const EdgeProperty<Real> &weights) {
         edge_weights = weights;
     }
 
-    void Prim::clear_custom_edge_weights() {
-        edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+    template<HalfedgeGraph GraphType>
+    void Prim<GraphType>::clear_custom_edge_weights() {
+        edge_weights = EdgeLengths(graph, graph.template get_vertex_property<Vector<Real, 3> >("v:position"));
     }
 
-    void Prim::clear() {
-        if (!edge_weights) {
-            edge_weights = EdgeLengths(graph, graph.get_vertex_property<Vector<Real, 3> >("v:position"));
+    template<HalfedgeGraph GraphType>
+    void Prim<GraphType>::set_csr(const GraphCsr *csr) {
+        this->csr = csr;
+    }
+
+    template<HalfedgeGraph GraphType>
+    void Prim<GraphType>::clear_csr() {
+        csr = nullptr;
+    }
+
+    template<HalfedgeGraph GraphType>
+    void Prim<GraphType>::clear() {
+        if (!edge_weights && !csr) {
+            edge_weights = EdgeLengths(graph, graph.template get_vertex_property<Vector<Real, 3> >("v:position"));
         }
 
         // Initialize or reset the predecessor property.
         if (!vertex_predecessors) {
-            vertex_predecessors = graph.vertex_property<Halfedge>("v:prim:predecessors");
+            vertex_predecessors = graph.template vertex_property<Halfedge>("v:prim:predecessors");
         } else {
             std::ranges::fill(vertex_predecessors.vector(), Halfedge());
         }
     }
+
+    template class Prim<Graph>;
+    template class Prim<Mesh>;
 }
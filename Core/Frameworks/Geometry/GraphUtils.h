@@ -6,6 +6,8 @@
 #define GRAPHUTILS_H
 
 #include "Graph.h"
+#include <bit>
+#include <iostream>
 
 namespace Bcg {
     //------------------------------------------------------------------------------------------------------------------
@@ -114,13 +116,13 @@ namespace Bcg {
 
     /**
      * @brief Computes the lengths of the edges in the graph.
-     * @param graph The graph containing the edges.
+     * @param graph The graph or mesh containing the edges.
      * @param positions The positions of the vertices in the graph.
      * @return An EdgeProperty containing the lengths of the edges.
      */
-     template<typename T, int N>
-    EdgeProperty<Real> EdgeLengths(Graph &graph, const VertexProperty<Vector<T, N> > &positions) {
-        auto lengths = graph.edge_property<Real>("e:length");
+    template<HalfedgeGraph GraphType, typename T, int N>
+    EdgeProperty<Real> EdgeLengths(GraphType &graph, const VertexProperty<Vector<T, N> > &positions) {
+        auto lengths = graph.template edge_property<Real>("e:length");
         for (const Edge &e: graph.edges) {
             auto v0 = graph.get_vertex(e, 0);
             auto v1 = graph.get_vertex(e, 1);
@@ -303,6 +305,90 @@ namespace Bcg {
     private:
         Graph &graph;
     };
+
+    //------------------------------------------------------------------------------
+    // Helpers of the Parallel Graph Algorithms
+    //------------------------------------------------------------------------------
+
+    class Mesh;
+
+    /**
+     * @brief Maps a float to an unsigned integer of the same order, so weights and distances can be packed into atomic
+     * words and compared as integers. Negative values flip all bits and non-negative ones set the sign bit.
+     */
+    inline uint32_t OrderedBits(Real value) {
+        const uint32_t bits = std::bit_cast<uint32_t>(value);
+        return bits & 0x80000000u ? ~bits : bits | 0x80000000u;
+    }
+
+    /**
+     * @brief The float of the ordered integer, the inverse of OrderedBits.
+     */
+    inline Real FromOrderedBits(uint32_t ordered) {
+        return std::bit_cast<Real>(ordered & 0x80000000u ? ordered & 0x7fffffffu : ~ordered);
+    }
+
+    /**
+     * @brief Calls func with the graph if it is set and with the mesh otherwise, for the algorithms which can be
+     * constructed from either of them.
+     */
+    template<typename Func>
+    decltype(auto) VisitGraphOrMesh(Graph *graph, Mesh *mesh, Func &&func) {
+        if (graph) return func(*graph);
+        return func(*mesh);
+    }
+
+    /**
+     * @brief Checks that the faces of an algorithm can be processed and reports an error otherwise.
+     * @return True if the algorithm was constructed from a mesh.
+     */
+    inline bool HasFaces(const Mesh *mesh, const std::string &caller) {
+        if (!mesh) {
+            std::cerr << "Error: " << caller << ": Only meshes have faces." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief The neighbors of the vertices of a graph or a mesh, skipping deleted halfedges.
+     * @return A function which calls func(j) for the neighbor vertices j of vertex i. If func returns a bool, the
+     * iteration stops at the first false.
+     */
+    template<typename GraphType>
+    auto VertexNeighbors(const GraphType &graph) {
+        const bool skip_deleted = graph.has_garbage();
+        return [&graph, skip_deleted](size_t i, auto &&func) {
+            for (const auto &h: graph.get_halfedges(Vertex(i))) {
+                if (skip_deleted && graph.is_deleted(h)) continue;
+                if constexpr (std::is_same_v<decltype(func(graph.get_vertex(h).idx())), bool>) {
+                    if (!func(graph.get_vertex(h).idx())) return;
+                } else {
+                    func(graph.get_vertex(h).idx());
+                }
+            }
+        };
+    }
+
+    /**
+     * @brief The neighbors of the faces of a mesh, faces are neighbors if they share an edge.
+     * @return A function which calls func(j) for the neighbor faces j of face i. If func returns a bool, the iteration
+     * stops at the first false.
+     */
+    template<typename MeshType>
+    auto FaceNeighbors(const MeshType &mesh) {
+        return [&mesh](size_t i, auto &&func) {
+            for (const auto &h: mesh.get_halfedges(Face(i))) {
+                const Face f = mesh.get_face(mesh.get_opposite(h));
+                if (!f.is_valid()) continue;
+                if constexpr (std::is_same_v<decltype(func(f.idx())), bool>) {
+                    if (!func(f.idx())) return;
+                } else {
+                    func(f.idx());
+                }
+            }
+        };
+    }
 }
 
 #endif //GRAPHUTILS_H
@@ -1260,6 +1260,11 @@ namespace Bcg {
         }
     }
 
+    size_t Mesh::get_valence(const Vertex &v) const {
+        auto vv = get_vertices(v);
+        return std::distance(vv.begin(), vv.end());
+    }
+
     size_t Mesh::get_valence(const Face &f) const {
         auto vv = get_vertices(f);
         return std::distance(vv.begin(), vv.end());
@@ -0,0 +1,453 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "MeshBvh.h"
+#include "AABBUtils.h"
+#include "JobSystem.h"
+#include "TriangleUtils.h"
+#include "Eigen/Geometry"
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+
+namespace Bcg {
+    static_assert(sizeof(MeshBvh::Node) == 32, "MeshBvh::Node should fill half a cache line.");
+
+    // A node waiting to be split with its range of triangles.
+    struct BvhBuildTask {
+        uint32_t node;
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    // The bounds and the number of the triangles whose centroids fall into a bin.
+    struct BvhBin {
+        AABB<Real, 3> aabb;
+        uint32_t count = 0;
+    };
+
+    // Deeper nodes are split at the median, so the depth and the stacks of the traversals stay bounded.
+    static constexpr size_t max_sah_depth = 64;
+    static constexpr size_t max_stack_size = 128;
+
+    // The entry parameter of the ray into the box, or max if it misses the box within [t_min, t_max].
+    static Real RayBoxEntry(const AABB<Real, 3> &aabb, const Vector<Real, 3> &origin, const Vector<Real, 3> &inv_dir,
+                            Real t_min, Real t_max) {
+        for (int a = 0; a < 3; ++a) {
+            Real t0 = (aabb.min()[a] - origin[a]) * inv_dir[a];
+            Real t1 = (aabb.max()[a] - origin[a]) * inv_dir[a];
+            if (t0 > t1) std::swap(t0, t1);
+            t_min = std::max(t_min, t0);
+            t_max = std::min(t_max, t1);
+            if (t_min > t_max) return std::numeric_limits<Real>::max();
+        }
+        return t_min;
+    }
+
+    // Intersects the ray with the triangle abc after Moeller and Trumbore, returns t and the weights u, v of b and c.
+    static bool RayTriangle(const MeshBvh::Ray &ray, const Vector<Real, 3> &a, const Vector<Real, 3> &b,
+                            const Vector<Real, 3> &c, Real &t, Real &u, Real &v) {
+        const Vector<Real, 3> ab = b - a, ac = c - a;
+        const Vector<Real, 3> p = ray.direction.cross(ac);
+        const Real determinant = ab.dot(p);
+        if (std::abs(determinant) <= std::numeric_limits<Real>::min()) return false;
+        const Real inv_determinant = 1 / determinant;
+        const Vector<Real, 3> s = ray.origin - a;
+        u = s.dot(p) * inv_determinant;
+        if (u < 0 || u > 1) return false;
+        const Vector<Real, 3> q = s.cross(ab);
+        v = ray.direction.dot(q) * inv_determinant;
+        if (v < 0 || u + v > 1) return false;
+        t = ac.dot(q) * inv_determinant;
+        return true;
+    }
+
+    // The closest point to p on the triangle abc, by the Voronoi regions of its corners and edges after Ericson.
+    static Vector<Real, 3> ClosestPointOnTriangle(const Vector<Real, 3> &p, const Vector<Real, 3> &a,
+                                                  const Vector<Real, 3> &b, const Vector<Real, 3> &c) {
+        const Vector<Real, 3> ab = b - a, ac = c - a, ap = p - a;
+        const Real d1 = ab.dot(ap), d2 = ac.dot(ap);
+        if (d1 <= 0 && d2 <= 0) return a;
+        const Vector<Real, 3> bp = p - b;
+        const Real d3 = ab.dot(bp), d4 = ac.dot(bp);
+        if (d3 >= 0 && d4 <= d3) return b;
+        const Real vc = d1 * d4 - d3 * d2;
+        if (vc <= 0 && d1 >= 0 && d3 <= 0) return a + d1 / (d1 - d3) * ab;
+        const Vector<Real, 3> cp = p - c;
+        const Real d5 = ab.dot(cp), d6 = ac.dot(cp);
+        if (d6 >= 0 && d5 <= d6) return c;
+        const Real vb = d5 * d2 - d1 * d6;
+        if (vb <= 0 && d2 >= 0 && d6 <= 0) return a + d2 / (d2 - d6) * ac;
+        const Real va = d3 * d6 - d5 * d4;
+        if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0) return b + (d4 - d3) / (d4 - d3 + d5 - d6) * (c - b);
+        const Real denominator = 1 / (va + vb + vc);
+        return a + ab * (vb * denominator) + ac * (vc * denominator);
+    }
+
+    MeshBvh::MeshBvh(const Mesh &mesh, JobSystem *jobs) : mesh(mesh), jobs(jobs) {
+    }
+
+    bool MeshBvh::build() {
+        nodes.clear();
+        faces.clear();
+        triangles.clear();
+        std::vector<Face> all_faces;
+        all_faces.reserve(mesh.n_faces());
+        for (const Face &f: mesh.faces) {
+            if (mesh.get_valence(f) != 3) {
+                std::cerr << "Error: MeshBvh::build: The mesh has non triangular faces." << std::endl;
+                return false;
+            }
+            all_faces.push_back(f);
+        }
+        const size_t m = all_faces.size();
+        if (m == 0) return true;
+        constexpr size_t grain_size = 4096;
+        const auto positions = mesh.get_vertex_property<Vector<Real, 3> >("v:position");
+
+        std::vector<AABB<Real, 3> > bounds(m);
+        std::vector<Vector<Real, 3> > centroids(m);
+        std::vector<uint32_t> order(m);
+        ParallelFor(jobs, 0, m, grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                AABB<Real, 3> aabb;
+                for (const Vertex &v: mesh.get_vertices(all_faces[i])) {
+                    aabb.grow(positions[v]);
+                }
+                bounds[i] = aabb;
+                centroids[i] = aabb.center();
+                order[i] = static_cast<uint32_t>(i);
+            }
+        });
+
+        // The bounds of the triangles and of their centroids in a range, chunked in parallel for large ranges.
+        auto range_bounds = [&](size_t begin, size_t end, AABB<Real, 3> &aabb, AABB<Real, 3> &centroid_aabb) {
+            std::mutex mutex;
+            ParallelFor(end - begin > 16 * grain_size ? jobs : nullptr, begin, end, 4 * grain_size,
+                        [&](size_t chunk_begin, size_t chunk_end) {
+                            AABB<Real, 3> local, local_centroids;
+                            for (size_t i = chunk_begin; i < chunk_end; ++i) {
+                                local = Merge(local, bounds[order[i]]);
+                                local_centroids.grow(centroids[order[i]]);
+                            }
+                            std::scoped_lock lock(mutex);
+                            aabb = Merge(aabb, local);
+                            centroid_aabb = Merge(centroid_aabb, local_centroids);
+                        });
+        };
+
+        // Splits the range of a node and returns the start of the right child, or end for a leaf.
+        auto split = [&](const BvhBuildTask &task, size_t depth) -> uint32_t {
+            const size_t begin = task.begin, end = task.end, n = end - begin;
+            AABB<Real, 3> aabb, centroid_aabb;
+            range_bounds(begin, end, aabb, centroid_aabb);
+            nodes[task.node].aabb = aabb;
+            if (n <= max_leaf_size) return task.end;
+
+            const Vector<Real, 3> extent = centroid_aabb.extents();
+            int axis = 0;
+            for (int a = 1; a < 3; ++a) {
+                if (extent[a] > extent[axis]) axis = a;
+            }
+            if (extent[axis] <= 0) {
+                // All centroids coincide, any split is as good as another.
+                return static_cast<uint32_t>(begin + n / 2);
+            }
+            if (depth >= max_sah_depth) {
+                // Median splits halve the remaining depth, which bounds the stacks of the traversals.
+                const size_t middle = begin + n / 2;
+                std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+                                 [&](uint32_t i, uint32_t j) { return centroids[i][axis] < centroids[j][axis]; });
+                return static_cast<uint32_t>(middle);
+            }
+
+            auto get_bin = [&](int a, uint32_t i) {
+                const Real scale = static_cast<Real>(n_bins) / extent[a];
+                const auto bin = static_cast<int64_t>((centroids[i][a] - centroid_aabb.min()[a]) * scale);
+                return static_cast<size_t>(std::clamp<int64_t>(bin, 0, static_cast<int64_t>(n_bins) - 1));
+            };
+            std::vector<BvhBin> bins(3 * n_bins);
+            std::mutex mutex;
+            ParallelFor(n > 16 * grain_size ? jobs : nullptr, begin, end, 4 * grain_size,
+                        [&](size_t chunk_begin, size_t chunk_end) {
+                            std::vector<BvhBin> local(3 * n_bins);
+                            for (size_t k = chunk_begin; k < chunk_end; ++k) {
+                                for (int a = 0; a < 3; ++a) {
+                                    if (extent[a] <= 0) continue;
+                                    BvhBin &bin = local[a * n_bins + get_bin(a, order[k])];
+                                    bin.aabb = Merge(bin.aabb, bounds[order[k]]);
+                                    ++bin.count;
+                                }
+                            }
+                            std::scoped_lock lock(mutex);
+                            for (size_t b = 0; b < bins.size(); ++b) {
+                                bins[b].aabb = Merge(bins[b].aabb, local[b].aabb);
+                                bins[b].count += local[b].count;
+                            }
+                        });
+
+            // Sweep the bins from the right for the suffix costs and from the left for the splits.
+            double best_cost = std::numeric_limits<double>::max();
+            int best_axis = -1;
+            size_t best_bin = 0;
+            std::vector<double> right_costs(n_bins);
+            for (int a = 0; a < 3; ++a) {
+                if (extent[a] <= 0) continue;
+                const BvhBin *axis_bins = &bins[a * n_bins];
+                AABB<Real, 3> right;
+                size_t right_count = 0;
+                for (size_t b = n_bins - 1; b > 0; --b) {
+                    right = Merge(right, axis_bins[b].aabb);
+                    right_count += axis_bins[b].count;
+                    right_costs[b] = right_count > 0 ? right_count * static_cast<double>(right.surface_area()) : 0;
+                }
+                AABB<Real, 3> left;
+                size_t left_count = 0;
+                for (size_t b = 0; b + 1 < n_bins; ++b) {
+                    left = Merge(left, axis_bins[b].aabb);
+                    left_count += axis_bins[b].count;
+                    if (left_count == 0 || left_count == n) continue;
+                    const double cost = left_count * static_cast<double>(left.surface_area()) + right_costs[b + 1];
+                    if (cost < best_cost) {
+                        best_cost = cost;
+                        best_axis = a;
+                        best_bin = b;
+                    }
+                }
+            }
+            if (best_axis < 0) return static_cast<uint32_t>(begin + n / 2);
+            // The cost of a leaf against one traversal step and the children, in units of triangle tests.
+            const double area = aabb.surface_area();
+            if (n <= 4 * max_leaf_size && area > 0 && 1 + best_cost / area >= static_cast<double>(n)) {
+                return task.end;
+            }
+            const auto middle = std::partition(order.begin() + begin, order.begin() + end, [&](uint32_t i) {
+                return get_bin(best_axis, i) <= best_bin;
+            });
+            return static_cast<uint32_t>(middle - order.begin());
+        };
+
+        // The nodes of one level are split in parallel, their children are numbered in order afterwards, so the
+        // layout does not depend on the scheduling.
+        nodes.reserve(2 * m);
+        nodes.emplace_back();
+        std::vector<BvhBuildTask> tasks = {{0, 0, static_cast<uint32_t>(m)}};
+        std::vector<uint32_t> middles;
+        for (size_t depth = 0; !tasks.empty(); ++depth) {
+            middles.assign(tasks.size(), 0);
+            ParallelFor(jobs, 0, tasks.size(), 1, [&](size_t begin, size_t end) {
+                for (size_t t = begin; t < end; ++t) {
+                    middles[t] = split(tasks[t], depth);
+                }
+            });
+            std::vector<BvhBuildTask> next;
+            for (size_t t = 0; t < tasks.size(); ++t) {
+                const BvhBuildTask &task = tasks[t];
+                Node &node = nodes[task.node];
+                if (middles[t] == task.end) {
+                    node.offset = task.begin;
+                    node.count = task.end - task.begin;
+                    continue;
+                }
+                const auto children = static_cast<uint32_t>(nodes.size());
+                node.offset = children;
+                node.count = 0;
+                nodes.emplace_back();
+                nodes.emplace_back();
+                next.push_back({children, task.begin, middles[t]});
+                next.push_back({children + 1, middles[t], task.end});
+            }
+            tasks = std::move(next);
+        }
+
+        faces.resize(m);
+        triangles.resize(3 * m);
+        ParallelFor(jobs, 0, m, grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                faces[i] = all_faces[order[i]];
+                size_t corner = 0;
+                for (const Vertex &v: mesh.get_vertices(faces[i])) {
+                    triangles[3 * i + corner++] = positions[v];
+                }
+            }
+        });
+        return true;
+    }
+
+    MeshBvh::Hit MeshBvh::intersect(const Ray &ray) const {
+        Hit hit;
+        if (nodes.empty()) return hit;
+        Vector<Real, 3> inv_dir;
+        for (int a = 0; a < 3; ++a) {
+            // A zero component would give 0 * inf for origins on a slab, a tiny one keeps the slabs consistent.
+            const Real d = ray.direction[a];
+            inv_dir[a] = 1 / (d != 0 ? d : std::numeric_limits<Real>::min());
+        }
+        Real t_max = ray.t_max;
+        uint32_t stack[max_stack_size];
+        size_t size = 0;
+        if (RayBoxEntry(nodes[0].aabb, ray.origin, inv_dir, ray.t_min, t_max) == std::numeric_limits<Real>::max()) {
+            return hit;
+        }
+        uint32_t current = 0;
+        while (true) {
+            const Node &node = nodes[current];
+            if (node.count > 0) {
+                for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                    Real t, u, v;
+                    if (!RayTriangle(ray, triangles[3 * i], triangles[3 * i + 1], triangles[3 * i + 2], t, u, v)) {
+                        continue;
+                    }
+                    if (t < ray.t_min || t > t_max) continue;
+                    t_max = t;
+                    hit.f = faces[i];
+                    hit.t = t;
+                    hit.barycentric = Vector<Real, 3>(1 - u - v, u, v);
+                }
+            } else {
+                // Visit the nearer child first and keep the other one for later.
+                const uint32_t left = node.offset, right = node.offset + 1;
+                const Real t_left = RayBoxEntry(nodes[left].aabb, ray.origin, inv_dir, ray.t_min, t_max);
+                const Real t_right = RayBoxEntry(nodes[right].aabb, ray.origin, inv_dir, ray.t_min, t_max);
+                const bool hit_left = t_left != std::numeric_limits<Real>::max();
+                const bool hit_right = t_right != std::numeric_limits<Real>::max();
+                if (hit_left && hit_right) {
+                    const bool left_first = t_left <= t_right;
+                    stack[size++] = left_first ? right : left;
+                    current = left_first ? left : right;
+                    continue;
+                }
+                if (hit_left || hit_right) {
+                    current = hit_left ? left : right;
+                    continue;
+                }
+            }
+            // Skip the deferred nodes which lie beyond the closest hit found since.
+            bool found = false;
+            while (size > 0 && !found) {
+                current = stack[--size];
+                found = RayBoxEntry(nodes[current].aabb, ray.origin, inv_dir, ray.t_min, t_max) !=
+                        std::numeric_limits<Real>::max();
+            }
+            if (!found) break;
+        }
+        return hit;
+    }
+
+    bool MeshBvh::occluded(const Ray &ray) const {
+        if (nodes.empty()) return false;
+        Vector<Real, 3> inv_dir;
+        for (int a = 0; a < 3; ++a) {
+            const Real d = ray.direction[a];
+            inv_dir[a] = 1 / (d != 0 ? d : std::numeric_limits<Real>::min());
+        }
+        uint32_t stack[max_stack_size];
+        size_t size = 0;
+        stack[size++] = 0;
+        while (size > 0) {
+            const Node &node = nodes[stack[--size]];
+            if (RayBoxEntry(node.aabb, ray.origin, inv_dir, ray.t_min, ray.t_max) == std::numeric_limits<Real>::max()) {
+                continue;
+            }
+            if (node.count > 0) {
+                for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                    Real t, u, v;
+                    if (RayTriangle(ray, triangles[3 * i], triangles[3 * i + 1], triangles[3 * i + 2], t, u, v) &&
+                        t >= ray.t_min && t <= ray.t_max) {
+                        return true;
+                    }
+                }
+            } else {
+                stack[size++] = node.offset + 1;
+                stack[size++] = node.offset;
+            }
+        }
+        return false;
+    }
+
+    MeshBvh::ClosestPoint MeshBvh::closest_point(const Vector<Real, 3> &point, Real max_distance) const {
+        ClosestPoint result;
+        if (nodes.empty()) return result;
+        Real best = max_distance < std::sqrt(std::numeric_limits<Real>::max())
+                        ? max_distance * max_distance
+                        : std::numeric_limits<Real>::max();
+        uint32_t stack[max_stack_size];
+        size_t size = 0;
+        if (MinSqDist(nodes[0].aabb, point) > best) return result;
+        uint32_t current = 0;
+        size_t best_index = std::numeric_limits<size_t>::max();
+        while (true) {
+            const Node &node = nodes[current];
+            if (node.count > 0) {
+                for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                    const Vector<Real, 3> q = ClosestPointOnTriangle(point, triangles[3 * i], triangles[3 * i + 1],
+                                                                     triangles[3 * i + 2]);
+                    const Real sq_distance = (q - point).squaredNorm();
+                    if (sq_distance < best) {
+                        best = sq_distance;
+                        best_index = i;
+                        result.point = q;
+                    }
+                }
+            } else {
+                // Descend into the child whose box is closer first, the other one is pruned later if possible.
+                const uint32_t left = node.offset, right = node.offset + 1;
+                const Real d_left = MinSqDist(nodes[left].aabb, point);
+                const Real d_right = MinSqDist(nodes[right].aabb, point);
+                if (d_left <= best && d_right <= best) {
+                    const bool left_first = d_left <= d_right;
+                    stack[size++] = left_first ? right : left;
+                    current = left_first ? left : right;
+                    continue;
+                }
+                if (d_left <= best || d_right <= best) {
+                    current = d_left <= best ? left : right;
+                    continue;
+                }
+            }
+            bool found = false;
+            while (size > 0 && !found) {
+                current = stack[--size];
+                found = MinSqDist(nodes[current].aabb, point) <= best;
+            }
+            if (!found) break;
+        }
+        if (best_index != std::numeric_limits<size_t>::max()) {
+            result.f = faces[best_index];
+            result.sq_distance = best;
+            result.barycentric = ToBarycentricCoordinates(result.point, triangles[3 * best_index],
+                                                          triangles[3 * best_index + 1],
+                                                          triangles[3 * best_index + 2]);
+        }
+        return result;
+    }
+
+    void MeshBvh::intersect(const std::vector<Ray> &rays, std::vector<Hit> &hits) const {
+        hits.resize(rays.size());
+        ParallelFor(jobs, 0, rays.size(), 256, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                hits[i] = intersect(rays[i]);
+            }
+        });
+    }
+
+    void MeshBvh::occluded(const std::vector<Ray> &rays, std::vector<uint8_t> &occluded) const {
+        occluded.resize(rays.size());
+        ParallelFor(jobs, 0, rays.size(), 256, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                occluded[i] = this->occluded(rays[i]) ? 1 : 0;
+            }
+        });
+    }
+
+    void MeshBvh::closest_points(const std::vector<Vector<Real, 3> > &points,
+                                 std::vector<ClosestPoint> &closest) const {
+        closest.resize(points.size());
+        ParallelFor(jobs, 0, points.size(), 256, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                closest[i] = closest_point(points[i]);
+            }
+        });
+    }
+}
@@ -0,0 +1,136 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef MESHBVH_H
+#define MESHBVH_H
+
+#include "AABB.h"
+#include "Mesh.h"
+
+namespace Bcg {
+    class JobSystem;
+
+    /**
+     * @brief MeshBvh: A bounding volume hierarchy over the triangles of a mesh for ray casting and closest point
+     * queries.
+     *
+     * The hierarchy is built top down with the surface area heuristic evaluated on bins of the triangle centroids.
+     * The nodes of one level are split in parallel and large nodes also bin in parallel, if a JobSystem is given. The
+     * children of a node are stored next to each other in 32 byte nodes, and the leaves keep copies of their triangles
+     * in the same order, so a traversal reads memory mostly forwards. The result does not depend on the number of
+     * threads.
+     *
+     * The hierarchy has to be rebuilt with build() after the positions or the faces of the mesh changed.
+     */
+    class MeshBvh {
+    public:
+        /**
+         * @brief A node of the hierarchy. Inner nodes have count 0 and their children at offset and offset + 1, leaves
+         * hold count triangles starting at offset.
+         */
+        struct Node {
+            AABB<Real, 3> aabb; /**< The bounds of the triangles below the node. */
+            uint32_t offset = 0; /**< The first child of an inner node or the first triangle of a leaf. */
+            uint32_t count = 0; /**< The number of triangles of a leaf, 0 for inner nodes. */
+        };
+
+        /**
+         * @brief A ray with the origin, the direction and the interval of the ray parameter t in which hits count.
+         */
+        struct Ray {
+            Vector<Real, 3> origin = Vector<Real, 3>::Zero();
+            Vector<Real, 3> direction = Vector<Real, 3>::UnitZ();
+            Real t_min = 0;
+            Real t_max = std::numeric_limits<Real>::max();
+        };
+
+        /**
+         * @brief The closest hit of a ray, the face is invalid if the ray missed.
+         */
+        struct Hit {
+            Face f; /**< The face which was hit. */
+            Real t = std::numeric_limits<Real>::max(); /**< The ray parameter of the hit point. */
+            Vector<Real, 3> barycentric = Vector<Real, 3>::Zero(); /**< The hit point in the corners of the face. */
+        };
+
+        /**
+         * @brief The closest point on the mesh to a query point, the face is invalid if none was found in range.
+         */
+        struct ClosestPoint {
+            Face f; /**< The face of the closest point. */
+            Vector<Real, 3> point = Vector<Real, 3>::Zero(); /**< The closest point. */
+            Vector<Real, 3> barycentric = Vector<Real, 3>::Zero(); /**< The closest point in the corners of the face. */
+            Real sq_distance = std::numeric_limits<Real>::max(); /**< The squared distance to the query point. */
+        };
+
+        /**
+         * @brief Constructs a MeshBvh object for the given mesh, the hierarchy is built by build().
+         * @param mesh The triangle mesh.
+         * @param jobs If set, the hierarchy is built and batches of queries run in parallel on this JobSystem.
+         */
+        explicit MeshBvh(const Mesh &mesh, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Builds the hierarchy over the faces of the mesh.
+         * @return True if successful, false if the mesh has non triangular faces.
+         */
+        bool build();
+
+        /**
+         * @brief Finds the closest hit of the ray.
+         * @param ray The ray, the direction does not have to be normalized.
+         * @return The hit with the smallest t in [t_min, t_max].
+         */
+        [[nodiscard]] Hit intersect(const Ray &ray) const;
+
+        /**
+         * @brief Checks whether the ray hits any face, which stops at the first hit found.
+         * @param ray The ray, e.g. a shadow ray with t_max at the light.
+         * @return True if any face is hit for t in [t_min, t_max].
+         */
+        [[nodiscard]] bool occluded(const Ray &ray) const;
+
+        /**
+         * @brief Finds the closest point on the mesh to a point.
+         * @param point The query point.
+         * @param max_distance Only points closer than this are found.
+         * @return The closest point.
+         */
+        [[nodiscard]] ClosestPoint closest_point(const Vector<Real, 3> &point,
+                                                 Real max_distance = std::numeric_limits<Real>::max()) const;
+
+        /**
+         * @brief Finds the closest hits of a batch of rays, in parallel if a JobSystem is given.
+         * @param rays The rays.
+         * @param hits The hits, resized to the number of rays.
+         */
+        void intersect(const std::vector<Ray> &rays, std::vector<Hit> &hits) const;
+
+        /**
+         * @brief Checks a batch of rays for any hit, in parallel if a JobSystem is given.
+         * @param rays The rays.
+         * @param occluded For every ray 1 if it hits a face and 0 otherwise, resized to the number of rays.
+         */
+        void occluded(const std::vector<Ray> &rays, std::vector<uint8_t> &occluded) const;
+
+        /**
+         * @brief Finds the closest points on the mesh to a batch of points, in parallel if a JobSystem is given.
+         * @param points The query points.
+         * @param closest The closest points, resized to the number of query points.
+         */
+        void closest_points(const std::vector<Vector<Real, 3> > &points, std::vector<ClosestPoint> &closest) const;
+
+        std::vector<Node> nodes; /**< The nodes, the root comes first. */
+        std::vector<Face> faces; /**< The faces of the leaves in leaf order. */
+        std::vector<Vector<Real, 3> > triangles; /**< The three corners of every face in leaf order. */
+        size_t max_leaf_size = 4; /**< Nodes with at most this many triangles become leaves. */
+        size_t n_bins = 16; /**< The number of bins per axis for the surface area heuristic. */
+
+    private:
+        const Mesh &mesh; /**< The mesh whose triangles are indexed. */
+        JobSystem *jobs; /**< The optional JobSystem used for the build and the batches. */
+    };
+}
+
+#endif //MESHBVH_H
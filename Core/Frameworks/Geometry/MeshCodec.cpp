@@ -0,0 +1,827 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "MeshCodec.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace Bcg {
+    namespace {
+        constexpr uint8_t BcmMagic[4] = {'B', 'C', 'M', '1'};
+        constexpr uint8_t BcmVersion = 1;
+
+        enum BcmFlags : uint8_t {
+            BcmAllTriangles = 1 << 0,
+            BcmNormals = 1 << 1,
+            BcmVertexTexCoords = 1 << 2,
+            BcmHalfedgeTexCoords = 1 << 3,
+        };
+
+        constexpr uint32_t RansScaleBits = 12;
+        constexpr uint32_t RansScale = 1u << RansScaleBits;
+        constexpr uint32_t RansLower = 1u << 23;
+        constexpr uint32_t NoPredictor = std::numeric_limits<uint32_t>::max();
+        // The quantized components and their residuals have to fit into 32 bit codes.
+        constexpr int MaxQuantizationBits = 30;
+
+        void PutVarint(std::vector<uint8_t> &out, uint64_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<uint8_t>(value) | 0x80);
+                value >>= 7;
+            }
+            out.push_back(static_cast<uint8_t>(value));
+        }
+
+        struct ByteReader {
+            const uint8_t *ptr;
+            const uint8_t *end;
+
+            bool get_varint(uint64_t &value) {
+                value = 0;
+                for (int shift = 0; shift < 64; shift += 7) {
+                    if (ptr >= end) return false;
+                    const uint8_t byte = *ptr++;
+                    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                    if (!(byte & 0x80)) return true;
+                }
+                return false;
+            }
+
+            bool get_bytes(void *dst, size_t size) {
+                if (static_cast<size_t>(end - ptr) < size) return false;
+                std::memcpy(dst, ptr, size);
+                ptr += size;
+                return true;
+            }
+        };
+
+        uint64_t ZigZag(int64_t value) {
+            return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+        }
+
+        int64_t UnZigZag(uint64_t value) {
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+        }
+
+        //--------------------------------------------------------------------------------------------------------------
+        // Order-0 rANS byte coder
+        //--------------------------------------------------------------------------------------------------------------
+
+        void NormalizeFrequencies(const std::array<uint64_t, 256> &counts, uint64_t total,
+                                  std::array<uint32_t, 256> &freqs) {
+            uint32_t sum = 0;
+            for (int s = 0; s < 256; ++s) {
+                freqs[s] = counts[s] ? std::max<uint32_t>(1, static_cast<uint32_t>(counts[s] * RansScale / total)) : 0;
+                sum += freqs[s];
+            }
+            // hand out or take away the rounding error, preferring frequent symbols
+            while (sum != RansScale) {
+                int best = -1;
+                for (int s = 0; s < 256; ++s) {
+                    if (freqs[s] > (sum > RansScale ? 1u : 0u) && (best < 0 || freqs[s] > freqs[best])) best = s;
+                }
+                if (sum > RansScale) {
+                    const uint32_t delta = std::min(sum - RansScale, freqs[best] - 1);
+                    freqs[best] -= delta;
+                    sum -= delta;
+                } else {
+                    freqs[best] += RansScale - sum;
+                    sum = RansScale;
+                }
+            }
+        }
+
+        void PutStream(std::vector<uint8_t> &out, const std::vector<uint8_t> &data) {
+            PutVarint(out, data.size());
+
+            std::array<uint64_t, 256> counts{};
+            for (uint8_t byte: data) ++counts[byte];
+            std::array<uint32_t, 256> freqs{};
+            std::array<uint32_t, 256> cums{};
+            std::vector<uint8_t> coded;
+            if (!data.empty()) {
+                NormalizeFrequencies(counts, data.size(), freqs);
+                for (int s = 1; s < 256; ++s) cums[s] = cums[s - 1] + freqs[s - 1];
+
+                // Two interleaved states (even and odd symbols) share one byte stream, which halves the dependency
+                // chain of the decoder.
+                uint32_t states[2] = {RansLower, RansLower};
+                coded.reserve(data.size() / 2 + 16);
+                for (size_t i = data.size(); i-- > 0;) {
+                    uint32_t &x = states[i & 1];
+                    const uint32_t f = freqs[data[i]];
+                    const uint32_t x_max = ((RansLower >> RansScaleBits) << 8) * f;
+                    while (x >= x_max) {
+                        coded.push_back(static_cast<uint8_t>(x));
+                        x >>= 8;
+                    }
+                    x = ((x / f) << RansScaleBits) + (x % f) + cums[data[i]];
+                }
+                for (int state = 1; state >= 0; --state) {
+                    for (int shift = 24; shift >= 0; shift -= 8) {
+                        coded.push_back(static_cast<uint8_t>(states[state] >> shift));
+                    }
+                }
+                std::reverse(coded.begin(), coded.end());
+            }
+
+            std::vector<uint8_t> table;
+            uint64_t n_symbols = 0;
+            for (int s = 0; s < 256; ++s) {
+                if (freqs[s]) {
+                    ++n_symbols;
+                    table.push_back(static_cast<uint8_t>(s));
+                    PutVarint(table, freqs[s]);
+                }
+            }
+
+            // Small or incompressible streams are stored as they are.
+            const bool use_rans = !data.empty() && table.size() + coded.size() + 2 < data.size();
+            out.push_back(use_rans ? 1 : 0);
+            if (use_rans) {
+                PutVarint(out, n_symbols);
+                out.insert(out.end(), table.begin(), table.end());
+                PutVarint(out, coded.size());
+                out.insert(out.end(), coded.begin(), coded.end());
+            } else {
+                out.insert(out.end(), data.begin(), data.end());
+            }
+        }
+
+        bool GetStream(ByteReader &reader, std::vector<uint8_t> &data) {
+            uint64_t size;
+            if (!reader.get_varint(size) || reader.ptr >= reader.end) return false;
+            const uint8_t mode = *reader.ptr++;
+            if (mode == 0) {
+                if (static_cast<uint64_t>(reader.end - reader.ptr) < size) return false;
+                data.assign(reader.ptr, reader.ptr + size);
+                reader.ptr += size;
+                return true;
+            }
+
+            uint64_t n_symbols;
+            if (mode != 1 || !reader.get_varint(n_symbols) || n_symbols == 0 || n_symbols > 256) return false;
+            std::array<uint32_t, 256> freqs{};
+            std::array<uint32_t, 256> cums{};
+            uint32_t sum = 0;
+            for (uint64_t i = 0; i < n_symbols; ++i) {
+                uint64_t freq;
+                if (reader.ptr >= reader.end) return false;
+                const uint8_t symbol = *reader.ptr++;
+                if (!reader.get_varint(freq) || freq == 0 || freq > RansScale - sum) return false;
+                freqs[symbol] = static_cast<uint32_t>(freq);
+                sum += freqs[symbol];
+            }
+            if (sum != RansScale) return false;
+            std::vector<uint8_t> lookup(RansScale);
+            for (int s = 0, cum = 0; s < 256; ++s) {
+                cums[s] = cum;
+                std::fill(lookup.begin() + cum, lookup.begin() + cum + freqs[s], static_cast<uint8_t>(s));
+                cum += freqs[s];
+            }
+
+            uint64_t coded_size;
+            if (!reader.get_varint(coded_size) || coded_size < 8 ||
+                static_cast<uint64_t>(reader.end - reader.ptr) < coded_size) {
+                return false;
+            }
+            const uint8_t *ptr = reader.ptr;
+            const uint8_t *end = reader.ptr + coded_size;
+            reader.ptr = end;
+
+            auto get_state = [&ptr]() {
+                const uint32_t x = ptr[0] | (ptr[1] << 8) | (ptr[2] << 16) | (static_cast<uint32_t>(ptr[3]) << 24);
+                ptr += 4;
+                return x;
+            };
+            uint32_t x0 = get_state();
+            uint32_t x1 = get_state();
+            auto decode_symbol = [&](uint32_t &x, uint8_t &byte) {
+                const uint32_t cf = x & (RansScale - 1);
+                const uint8_t s = lookup[cf];
+                byte = s;
+                x = freqs[s] * (x >> RansScaleBits) + cf - cums[s];
+                while (x < RansLower) {
+                    if (ptr >= end) return false;
+                    x = (x << 8) | *ptr++;
+                }
+                return true;
+            };
+            data.resize(size);
+            size_t i = 0;
+            for (; i + 1 < size; i += 2) {
+                if (!decode_symbol(x0, data[i]) || !decode_symbol(x1, data[i + 1])) return false;
+            }
+            return i == size || decode_symbol(x0, data[i]);
+        }
+
+        //--------------------------------------------------------------------------------------------------------------
+        // Quantization
+        //--------------------------------------------------------------------------------------------------------------
+
+        template<int N>
+        struct Quantizer {
+            Vector<Real, N> min = Vector<Real, N>::Zero();
+            Vector<Real, N> max = Vector<Real, N>::Zero();
+            int bits = 16;
+
+            [[nodiscard]] uint32_t max_code() const { return (1u << bits) - 1; }
+
+            [[nodiscard]] Vector<int64_t, N> quantize(const Vector<Real, N> &p) const {
+                Vector<int64_t, N> q;
+                for (int i = 0; i < N; ++i) {
+                    const double extent = static_cast<double>(max[i]) - min[i];
+                    const double t = extent > 0 ? (static_cast<double>(p[i]) - min[i]) / extent : 0.0;
+                    q[i] = static_cast<int64_t>(std::llround(std::clamp(t, 0.0, 1.0) * max_code()));
+                }
+                return q;
+            }
+
+            [[nodiscard]] Vector<Real, N> dequantize(const Vector<int64_t, N> &q) const {
+                Vector<Real, N> p;
+                for (int i = 0; i < N; ++i) {
+                    const double extent = static_cast<double>(max[i]) - min[i];
+                    p[i] = static_cast<Real>(min[i] + extent * static_cast<double>(q[i]) / max_code());
+                }
+                return p;
+            }
+        };
+
+        Vector<Real, 2> OctahedronEncode(const Vector<Real, 3> &n) {
+            const Real l1 = std::abs(n[0]) + std::abs(n[1]) + std::abs(n[2]);
+            if (l1 <= 0) return Vector<Real, 2>::Zero();
+            Vector<Real, 2> p(n[0] / l1, n[1] / l1);
+            if (n[2] < 0) {
+                p = Vector<Real, 2>((1 - std::abs(p[1])) * (p[0] >= 0 ? 1 : -1),
+                                    (1 - std::abs(p[0])) * (p[1] >= 0 ? 1 : -1));
+            }
+            return p;
+        }
+
+        Vector<Real, 3> OctahedronDecode(const Vector<Real, 2> &p) {
+            Vector<Real, 3> n(p[0], p[1], 1 - std::abs(p[0]) - std::abs(p[1]));
+            if (n[2] < 0) {
+                n[0] = (1 - std::abs(p[1])) * (p[0] >= 0 ? 1 : -1);
+                n[1] = (1 - std::abs(p[0])) * (p[1] >= 0 ? 1 : -1);
+            }
+            return n.normalized();
+        }
+
+        template<int N>
+        void PutResidual(std::vector<uint8_t> &out, const Vector<int64_t, N> &q, const Vector<int64_t, N> &pred) {
+            for (int i = 0; i < N; ++i) PutVarint(out, ZigZag(q[i] - pred[i]));
+        }
+
+        template<int N>
+        bool GetResidual(ByteReader &reader, const Vector<int64_t, N> &pred, Vector<int64_t, N> &q) {
+            for (int i = 0; i < N; ++i) {
+                uint64_t value;
+                if (!reader.get_varint(value)) return false;
+                q[i] = pred[i] + UnZigZag(value);
+            }
+            return true;
+        }
+
+        template<int N>
+        void PutBounds(std::vector<uint8_t> &out, const Quantizer<N> &quantizer) {
+            const auto *min = reinterpret_cast<const uint8_t *>(quantizer.min.data());
+            const auto *max = reinterpret_cast<const uint8_t *>(quantizer.max.data());
+            out.insert(out.end(), min, min + sizeof(Real) * N);
+            out.insert(out.end(), max, max + sizeof(Real) * N);
+        }
+
+        // Reads the number of bits of a quantizer, streams with a number the encoder does not write are rejected.
+        template<int N>
+        bool GetBits(ByteReader &reader, Quantizer<N> &quantizer) {
+            uint8_t bits;
+            if (!reader.get_bytes(&bits, 1) || bits < 1 || bits > MaxQuantizationBits) return false;
+            quantizer.bits = bits;
+            return true;
+        }
+
+        template<int N>
+        bool GetBounds(ByteReader &reader, Quantizer<N> &quantizer) {
+            return reader.get_bytes(quantizer.min.data(), sizeof(Real) * N) &&
+                   reader.get_bytes(quantizer.max.data(), sizeof(Real) * N);
+        }
+
+        template<int N, typename Range, typename Getter>
+        Quantizer<N> ComputeBounds(const Range &range, Getter &&get, int bits) {
+            Quantizer<N> quantizer;
+            quantizer.bits = std::clamp(bits, 1, MaxQuantizationBits);
+            bool first = true;
+            for (const auto &item: range) {
+                const Vector<Real, N> p = get(item);
+                quantizer.min = first ? p : Vector<Real, N>(quantizer.min.cwiseMin(p));
+                quantizer.max = first ? p : Vector<Real, N>(quantizer.max.cwiseMax(p));
+                first = false;
+            }
+            return quantizer;
+        }
+
+        /**
+         * @brief Reference vertices (renumbered ids) used to predict the attributes of a new vertex: the parallelogram
+         * a + b - c if c is valid, otherwise a, otherwise zero.
+         */
+        struct Prediction {
+            uint32_t a = NoPredictor;
+            uint32_t b = NoPredictor;
+            uint32_t c = NoPredictor;
+        };
+
+        template<int N>
+        Vector<int64_t, N> Predict(const std::vector<Vector<int64_t, N> > &q, const Prediction &p, bool parallelogram) {
+            if (p.a == NoPredictor) return Vector<int64_t, N>::Zero();
+            if (!parallelogram || p.c == NoPredictor) return q[p.a];
+            return q[p.a] + q[p.b] - q[p.c];
+        }
+
+        /**
+         * @brief Picks the prediction of a vertex first referenced by corner k of a face, h is the halfedge pointing to
+         * it. For k >= 2 the earlier coded face across the edge between the two preceding corners is used for a
+         * parallelogram prediction. Encoder and decoder evaluate this on identical connectivity.
+         */
+        template<typename IdOf, typename IsEarlier>
+        Prediction MakePrediction(const Mesh &mesh, const Halfedge &h, size_t k, uint32_t last_new, IdOf &&id_of,
+                                  IsEarlier &&is_earlier) {
+            Prediction prediction;
+            if (k == 0) {
+                prediction.a = last_new;
+                return prediction;
+            }
+            const Halfedge prev = mesh.get_prev(h);
+            prediction.a = id_of(mesh.get_vertex(prev));
+            if (k >= 2) {
+                const Halfedge opposite = mesh.get_opposite(prev);
+                const Face g = mesh.get_face(opposite);
+                if (g.is_valid() && is_earlier(g)) {
+                    prediction.b = id_of(mesh.get_vertex(opposite));
+                    prediction.c = id_of(mesh.get_vertex(mesh.get_next(opposite)));
+                }
+            }
+            return prediction;
+        }
+
+        /**
+         * @brief Builds the halfedge connectivity of all faces at once, which is considerably faster than calling
+         * Mesh::add_face per face. corner_halfedges receives the halfedge pointing to each corner vertex.
+         * @return False if the faces do not form a manifold, the caller then falls back to Mesh::add_face.
+         */
+        bool BuildConnectivity(Mesh &mesh, const std::vector<uint32_t> &corner_ids,
+                               const std::vector<uint32_t> &face_offsets, std::vector<Halfedge> &corner_halfedges) {
+            const size_t n_vertices = mesh.vertices.size();
+            const size_t n_corners = corner_ids.size();
+            const size_t n_faces = face_offsets.size() - 1;
+            std::vector<uint32_t> from_ids(n_corners);
+            for (size_t f = 0; f < n_faces; ++f) {
+                for (uint32_t c = face_offsets[f]; c < face_offsets[f + 1]; ++c) {
+                    from_ids[c] = corner_ids[c == face_offsets[f] ? face_offsets[f + 1] - 1 : c - 1];
+                }
+            }
+
+            // (target vertex, corner) pairs bucketed by the vertex the incoming face halfedge of the corner starts at.
+            std::vector<uint32_t> bucket_offsets(n_vertices + 1, 0);
+            std::vector<std::pair<uint32_t, uint32_t> > buckets(n_corners);
+            for (size_t c = 0; c < n_corners; ++c) ++bucket_offsets[from_ids[c] + 1];
+            for (size_t v = 0; v < n_vertices; ++v) bucket_offsets[v + 1] += bucket_offsets[v];
+            {
+                std::vector<uint32_t> fill(bucket_offsets.begin(), bucket_offsets.end() - 1);
+                for (size_t c = 0; c < n_corners; ++c) {
+                    buckets[fill[from_ids[c]]++] = {corner_ids[c], static_cast<uint32_t>(c)};
+                }
+            }
+
+            // Each corner owns the halfedge pointing to it. Edges are created from the bucket of their smaller
+            // vertex, so the opposite corner only has to be searched once per edge.
+            corner_halfedges.assign(n_corners, Halfedge());
+            std::vector<uint32_t> boundary_corners;
+            size_t n_edges = 0;
+            for (uint32_t from = 0; from < n_vertices; ++from) {
+                for (uint32_t i = bucket_offsets[from]; i < bucket_offsets[from + 1]; ++i) {
+                    const auto [to, c] = buckets[i];
+                    if (corner_halfedges[c].is_valid()) continue;
+                    uint32_t opposite = NoPredictor;
+                    for (uint32_t j = bucket_offsets[to]; from < to && j < bucket_offsets[to + 1]; ++j) {
+                        if (buckets[j].first != from) continue;
+                        if (opposite != NoPredictor) return false;
+                        opposite = buckets[j].second;
+                    }
+                    corner_halfedges[c] = Halfedge(2 * n_edges++);
+                    if (opposite == NoPredictor) {
+                        boundary_corners.push_back(c);
+                    } else {
+                        if (corner_halfedges[opposite].is_valid()) return false;
+                        corner_halfedges[opposite] = mesh.get_opposite(corner_halfedges[c]);
+                    }
+                }
+            }
+
+            mesh.edges.resize(n_edges);
+            mesh.halfedges.resize(2 * n_edges);
+            mesh.faces.resize(n_faces);
+            for (size_t f = 0; f < n_faces; ++f) {
+                const uint32_t begin = face_offsets[f], end = face_offsets[f + 1];
+                const Face face(f);
+                for (uint32_t c = begin; c < end; ++c) {
+                    const Halfedge h = corner_halfedges[c];
+                    if (mesh.get_face(h).is_valid()) return false;
+                    mesh.set_face(h, face);
+                    mesh.set_vertex(h, Vertex(corner_ids[c]));
+                    mesh.set_vertex(mesh.get_opposite(h), Vertex(from_ids[c]));
+                    mesh.set_next(h, corner_halfedges[c + 1 == end ? begin : c + 1]);
+                }
+                mesh.set_halfedge(face, corner_halfedges[begin]);
+            }
+
+            // The opposites of corners without opposite corner are the boundary halfedges. They are linked to the
+            // unique boundary halfedge leaving their target vertex, vertices point to their outgoing boundary
+            // halfedge if they have one.
+            std::vector<Halfedge> boundary_out(n_vertices);
+            std::vector<uint32_t> valences(n_vertices);
+            for (size_t v = 0; v < n_vertices; ++v) {
+                valences[v] = bucket_offsets[v + 1] - bucket_offsets[v];
+                if (valences[v]) mesh.set_halfedge(Vertex(v), corner_halfedges[buckets[bucket_offsets[v]].second]);
+            }
+            for (const uint32_t c: boundary_corners) {
+                const uint32_t from = corner_ids[c];
+                if (boundary_out[from].is_valid()) return false;
+                boundary_out[from] = mesh.get_opposite(corner_halfedges[c]);
+                mesh.set_halfedge(Vertex(from), boundary_out[from]);
+                ++valences[from];
+            }
+            for (const uint32_t c: boundary_corners) {
+                const Halfedge next = boundary_out[from_ids[c]];
+                if (!next.is_valid()) return false;
+                mesh.set_next(mesh.get_opposite(corner_halfedges[c]), next);
+            }
+
+            // A vertex whose one-ring does not reach all outgoing halfedges joins several fans.
+            for (size_t i = 0; i < n_vertices; ++i) {
+                const Vertex v(i);
+                const Halfedge start = mesh.get_halfedge(v);
+                if (!start.is_valid()) continue;
+                uint32_t n = 0;
+                Halfedge h = start;
+                do {
+                    h = mesh.rotate_cw(h);
+                } while (++n <= valences[v.idx()] && h != start);
+                if (n != valences[v.idx()]) return false;
+            }
+            return true;
+        }
+    }
+
+    std::vector<uint8_t> EncodeMesh(const Mesh &mesh, const MeshCodecOptions &options) {
+        auto positions = mesh.get_vertex_property<Vector<Real, 3> >("v:position");
+        VertexProperty<Vector<Real, 3> > normals;
+        VertexProperty<Vector<Real, 2> > v_tex;
+        HalfedgeProperty<Vector<Real, 2> > h_tex;
+        if (options.with_normals) normals = mesh.get_vertex_property<Vector<Real, 3> >("v:normal");
+        if (options.with_tex_coords) v_tex = mesh.get_vertex_property<Vector<Real, 2> >("v:tex");
+        if (options.with_tex_coords && !v_tex) h_tex = mesh.get_halfedge_property<Vector<Real, 2> >("h:tex");
+
+        // Connectivity: faces are visited breadth first, each entered through the edge shared with its parent, so
+        // the first two corners are known and the remaining ones are mostly new vertices.
+        std::vector<uint32_t> new_ids(mesh.vertices.size(), NoPredictor);
+        std::vector<Vertex> order;
+        std::vector<Prediction> predictions;
+        order.reserve(mesh.n_vertices());
+        predictions.reserve(mesh.n_vertices());
+
+        std::vector<uint8_t> corners, valences;
+        std::vector<Halfedge> corner_halfedges;
+        std::vector<bool> queued(mesh.faces.size(), false), done(mesh.faces.size(), false);
+        std::vector<std::pair<Face, Halfedge> > queue;
+        std::vector<uint32_t> face_ids;
+        auto id_of = [&](const Vertex &v) { return new_ids[v.idx()]; };
+        auto is_done = [&](const Face &f) { return done[f.idx()]; };
+        bool all_triangles = true;
+        size_t n_faces = 0;
+        uint32_t last_new = NoPredictor;
+
+        for (const auto &root: mesh.faces) {
+            if (queued[root.idx()]) continue;
+            queued[root.idx()] = true;
+            queue.assign(1, {root, mesh.get_halfedge(root)});
+            for (size_t head = 0; head < queue.size(); ++head, ++n_faces) {
+                const Halfedge start = queue[head].second;
+                face_ids.clear();
+                Halfedge h = start;
+                do {
+                    const Vertex v = mesh.get_vertex(h);
+                    const size_t k = face_ids.size();
+                    uint32_t &id = new_ids[v.idx()];
+                    if (id == NoPredictor) {
+                        predictions.push_back(MakePrediction(mesh, h, k, last_new, id_of, is_done));
+                        id = last_new = static_cast<uint32_t>(order.size());
+                        order.push_back(v);
+                        PutVarint(corners, 0);
+                    } else if (k == 0) {
+                        PutVarint(corners, order.size() - id);
+                    } else {
+                        PutVarint(corners, ZigZag(static_cast<int64_t>(id) - face_ids[k - 1]) + 1);
+                    }
+                    face_ids.push_back(id);
+                    corner_halfedges.push_back(h);
+
+                    const Halfedge opposite = mesh.get_opposite(h);
+                    const Face g = mesh.get_face(opposite);
+                    if (g.is_valid() && !queued[g.idx()]) {
+                        queued[g.idx()] = true;
+                        queue.emplace_back(g, mesh.get_prev(opposite));
+                    }
+                    h = mesh.get_next(h);
+                } while (h != start);
+                all_triangles &= face_ids.size() == 3;
+                PutVarint(valences, face_ids.size());
+                done[queue[head].first.idx()] = true;
+            }
+        }
+        for (const auto &v: mesh.vertices) {
+            if (new_ids[v.idx()] == NoPredictor) {
+                predictions.push_back({last_new, NoPredictor, NoPredictor});
+                new_ids[v.idx()] = last_new = static_cast<uint32_t>(order.size());
+                order.push_back(v);
+            }
+        }
+
+        uint8_t flags = 0;
+        if (all_triangles) flags |= BcmAllTriangles;
+        if (normals) flags |= BcmNormals;
+        if (v_tex) flags |= BcmVertexTexCoords;
+        if (h_tex) flags |= BcmHalfedgeTexCoords;
+
+        std::vector<uint8_t> out(std::begin(BcmMagic), std::end(BcmMagic));
+        out.push_back(BcmVersion);
+        out.push_back(flags);
+        PutVarint(out, order.size());
+        PutVarint(out, n_faces);
+        PutVarint(out, corner_halfedges.size());
+
+        auto position_quantizer = ComputeBounds<3>(order, [&](const Vertex &v) { return positions[v]; },
+                                                   options.position_bits);
+        out.push_back(static_cast<uint8_t>(position_quantizer.bits));
+        PutBounds(out, position_quantizer);
+        std::vector<Vector<int64_t, 3> > q_positions(order.size());
+        std::vector<uint8_t> position_stream;
+        for (size_t i = 0; i < order.size(); ++i) {
+            q_positions[i] = position_quantizer.quantize(positions[order[i]]);
+            PutResidual<3>(position_stream, q_positions[i], Predict(q_positions, predictions[i], true));
+        }
+
+        std::vector<uint8_t> normal_stream;
+        if (normals) {
+            Quantizer<2> quantizer;
+            quantizer.min = Vector<Real, 2>::Constant(-1);
+            quantizer.max = Vector<Real, 2>::Constant(1);
+            quantizer.bits = std::clamp(options.normal_bits, 1, MaxQuantizationBits);
+            out.push_back(static_cast<uint8_t>(quantizer.bits));
+            std::vector<Vector<int64_t, 2> > q_normals(order.size());
+            for (size_t i = 0; i < order.size(); ++i) {
+                q_normals[i] = quantizer.quantize(OctahedronEncode(normals[order[i]]));
+                PutResidual<2>(normal_stream, q_normals[i], Predict(q_normals, predictions[i], false));
+            }
+        }
+
+        std::vector<uint8_t> tex_stream;
+        if (v_tex) {
+            auto quantizer = ComputeBounds<2>(order, [&](const Vertex &v) { return v_tex[v]; },
+                                              options.tex_coord_bits);
+            out.push_back(static_cast<uint8_t>(quantizer.bits));
+            PutBounds(out, quantizer);
+            std::vector<Vector<int64_t, 2> > q_tex(order.size());
+            for (size_t i = 0; i < order.size(); ++i) {
+                q_tex[i] = quantizer.quantize(v_tex[order[i]]);
+                PutResidual<2>(tex_stream, q_tex[i], Predict(q_tex, predictions[i], true));
+            }
+        } else if (h_tex) {
+            auto quantizer = ComputeBounds<2>(corner_halfedges, [&](const Halfedge &h) { return h_tex[h]; },
+                                              options.tex_coord_bits);
+            out.push_back(static_cast<uint8_t>(quantizer.bits));
+            PutBounds(out, quantizer);
+            Vector<int64_t, 2> previous_tex = Vector<int64_t, 2>::Zero();
+            for (const auto &h: corner_halfedges) {
+                const auto q = quantizer.quantize(h_tex[h]);
+                PutResidual<2>(tex_stream, q, previous_tex);
+                previous_tex = q;
+            }
+        }
+
+        PutStream(out, corners);
+        if (!all_triangles) PutStream(out, valences);
+        PutStream(out, position_stream);
+        if (normals) PutStream(out, normal_stream);
+        if (v_tex || h_tex) PutStream(out, tex_stream);
+        return out;
+    }
+
+    bool DecodeMesh(const uint8_t *data, size_t size, Mesh &mesh) {
+        ByteReader reader{data, data + size};
+        uint8_t magic[4], header[2];
+        if (!reader.get_bytes(magic, 4) || std::memcmp(magic, BcmMagic, 4) != 0 || !reader.get_bytes(header, 2) ||
+            header[0] != BcmVersion) {
+            std::cerr << "Error: DecodeMesh: Not a BCM stream or unsupported version." << std::endl;
+            return false;
+        }
+        const uint8_t flags = header[1];
+
+        uint64_t n_vertices = 0, n_faces = 0, n_corners = 0;
+        Quantizer<3> position_quantizer;
+        Quantizer<2> normal_quantizer, tex_quantizer;
+        normal_quantizer.min = Vector<Real, 2>::Constant(-1);
+        normal_quantizer.max = Vector<Real, 2>::Constant(1);
+        bool ok = reader.get_varint(n_vertices) && reader.get_varint(n_faces) && reader.get_varint(n_corners) &&
+                  n_vertices < NoPredictor && n_corners <= size * 8 && 3 * n_faces <= n_corners;
+        ok = ok && GetBits(reader, position_quantizer) && GetBounds(reader, position_quantizer);
+        if (ok && (flags & BcmNormals)) ok = GetBits(reader, normal_quantizer);
+        if (ok && (flags & (BcmVertexTexCoords | BcmHalfedgeTexCoords))) {
+            ok = GetBits(reader, tex_quantizer) && GetBounds(reader, tex_quantizer);
+        }
+
+        std::vector<uint8_t> corner_stream, valence_stream, position_stream, normal_stream, tex_stream;
+        ok = ok && GetStream(reader, corner_stream);
+        if (ok && !(flags & BcmAllTriangles)) ok = GetStream(reader, valence_stream);
+        ok = ok && GetStream(reader, position_stream);
+        if (ok && (flags & BcmNormals)) ok = GetStream(reader, normal_stream);
+        if (ok && (flags & (BcmVertexTexCoords | BcmHalfedgeTexCoords))) ok = GetStream(reader, tex_stream);
+
+        // Connectivity: corner vertex ids, vertices are numbered in order of appearance.
+        std::vector<uint32_t> corner_ids, face_offsets{0}, new_vertex_corners;
+        if (ok) {
+            corner_ids.resize(n_corners);
+            face_offsets.reserve(n_faces + 1);
+            new_vertex_corners.reserve(std::min(n_vertices, n_corners));
+        }
+        ByteReader corner_reader{corner_stream.data(), corner_stream.data() + corner_stream.size()};
+        ByteReader valence_reader{valence_stream.data(), valence_stream.data() + valence_stream.size()};
+        size_t corner = 0;
+        for (size_t f = 0; ok && f < n_faces; ++f) {
+            uint64_t valence = 3;
+            if (!(flags & BcmAllTriangles)) ok = valence_reader.get_varint(valence);
+            ok = ok && valence >= 3 && valence <= n_corners - corner;
+            const size_t begin = corner;
+            for (const size_t end = begin + valence; ok && corner < end; ++corner) {
+                uint64_t symbol;
+                ok = corner_reader.get_varint(symbol);
+                const int64_t n_seen = static_cast<int64_t>(new_vertex_corners.size());
+                int64_t id;
+                if (symbol == 0) {
+                    new_vertex_corners.push_back(static_cast<uint32_t>(corner));
+                    id = n_seen;
+                } else if (corner == begin) {
+                    id = n_seen - static_cast<int64_t>(symbol);
+                } else {
+                    id = corner_ids[corner - 1] + UnZigZag(symbol - 1);
+                }
+                const auto n_known = static_cast<int64_t>(std::min<uint64_t>(new_vertex_corners.size(), n_vertices));
+                ok = ok && id >= 0 && id < n_known;
+                corner_ids[corner] = static_cast<uint32_t>(id);
+                for (size_t other = begin; ok && other < corner; ++other) ok = corner_ids[other] != corner_ids[corner];
+            }
+            face_offsets.push_back(static_cast<uint32_t>(corner));
+        }
+        if (!ok || corner != n_corners) {
+            std::cerr << "Error: DecodeMesh: Truncated or corrupt data." << std::endl;
+            return false;
+        }
+
+        mesh.clear();
+        mesh.vertices.resize(n_vertices);
+        std::vector<Halfedge> corner_halfedges;
+        if (!BuildConnectivity(mesh, corner_ids, face_offsets, corner_halfedges)) {
+            // Non-manifold input is resolved by the incremental construction.
+            mesh.clear();
+            mesh.vertices.resize(n_vertices);
+            corner_halfedges.assign(n_corners, Halfedge());
+            std::vector<Vertex> face_vertices;
+            for (size_t f = 0; f < n_faces; ++f) {
+                face_vertices.clear();
+                for (uint32_t c = face_offsets[f]; c < face_offsets[f + 1]; ++c) {
+                    face_vertices.emplace_back(corner_ids[c]);
+                }
+                Face face;
+                try {
+                    face = mesh.add_face(face_vertices);
+                } catch (const std::exception &e) {
+                    std::cerr << "Error: DecodeMesh: " << e.what() << std::endl;
+                    return false;
+                }
+                for (uint32_t c = face_offsets[f]; c < face_offsets[f + 1]; ++c) {
+                    if (!face.is_valid()) continue;
+                    for (const auto &h: mesh.get_halfedges(face)) {
+                        if (mesh.get_vertex(h).idx() == corner_ids[c]) corner_halfedges[c] = h;
+                    }
+                }
+            }
+        }
+
+        // Faces are numbered in coding order, so the faces coded before face f are exactly those with smaller index.
+        std::vector<Prediction> predictions;
+        predictions.reserve(n_vertices);
+        auto id_of = [](const Vertex &v) { return static_cast<uint32_t>(v.idx()); };
+        for (size_t f = 0, i = 0; f < n_faces && i < new_vertex_corners.size(); ++f) {
+            auto is_earlier = [f](const Face &g) { return g.idx() < f; };
+            for (; i < new_vertex_corners.size() && new_vertex_corners[i] < face_offsets[f + 1]; ++i) {
+                const uint32_t c = new_vertex_corners[i];
+                const uint32_t last_new = i == 0 ? NoPredictor : static_cast<uint32_t>(i - 1);
+                if (!corner_halfedges[c].is_valid()) return false;
+                predictions.push_back(MakePrediction(mesh, corner_halfedges[c], c - face_offsets[f], last_new, id_of,
+                                                     is_earlier));
+            }
+        }
+        while (predictions.size() < n_vertices) {
+            predictions.push_back({predictions.empty() ? NoPredictor : static_cast<uint32_t>(predictions.size() - 1),
+                                   NoPredictor, NoPredictor});
+        }
+
+        auto positions = mesh.vertex_property<Vector<Real, 3> >("v:position", Vector<Real, 3>::Zero());
+        ByteReader position_reader{position_stream.data(), position_stream.data() + position_stream.size()};
+        std::vector<Vector<int64_t, 3> > q_positions(n_vertices);
+        for (size_t i = 0; i < n_vertices; ++i) {
+            if (!GetResidual<3>(position_reader, Predict(q_positions, predictions[i], true), q_positions[i])) {
+                return false;
+            }
+            positions[Vertex(i)] = position_quantizer.dequantize(q_positions[i]);
+        }
+
+        if (flags & BcmNormals) {
+            auto normals = mesh.vertex_property<Vector<Real, 3> >("v:normal", Vector<Real, 3>::Zero());
+            ByteReader normal_reader{normal_stream.data(), normal_stream.data() + normal_stream.size()};
+            std::vector<Vector<int64_t, 2> > q_normals(n_vertices);
+            for (size_t i = 0; i < n_vertices; ++i) {
+                if (!GetResidual<2>(normal_reader, Predict(q_normals, predictions[i], false), q_normals[i])) {
+                    return false;
+                }
+                normals[Vertex(i)] = OctahedronDecode(normal_quantizer.dequantize(q_normals[i]));
+            }
+        }
+
+        ByteReader tex_reader{tex_stream.data(), tex_stream.data() + tex_stream.size()};
+        if (flags & BcmVertexTexCoords) {
+            auto tex = mesh.vertex_property<Vector<Real, 2> >("v:tex", Vector<Real, 2>::Zero());
+            std::vector<Vector<int64_t, 2> > q_tex(n_vertices);
+            for (size_t i = 0; i < n_vertices; ++i) {
+                if (!GetResidual<2>(tex_reader, Predict(q_tex, predictions[i], true), q_tex[i])) {
+                    return false;
+                }
+                tex[Vertex(i)] = tex_quantizer.dequantize(q_tex[i]);
+            }
+        } else if (flags & BcmHalfedgeTexCoords) {
+            auto tex = mesh.halfedge_property<Vector<Real, 2> >("h:tex", Vector<Real, 2>::Zero());
+            Vector<int64_t, 2> q_tex = Vector<int64_t, 2>::Zero();
+            for (const auto &h: corner_halfedges) {
+                if (!GetResidual<2>(tex_reader, q_tex, q_tex)) return false;
+                if (h.is_valid()) tex[h] = tex_quantizer.dequantize(q_tex);
+            }
+        }
+        return true;
+    }
+
+    bool MeshIoBCM::read(Mesh &mesh) {
+        if (!is_valid_filename(m_filename) || !can_load_file()) {
+            std::cerr << "Error: MeshIoBCM::read: Invalid filename." << std::endl;
+            return false;
+        }
+
+        std::ifstream file(m_filename, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: MeshIoBCM::read: Could not open file for reading." << std::endl;
+            return false;
+        }
+
+        std::vector<uint8_t> data(std::filesystem::file_size(m_filename));
+        file.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            std::cerr << "Error: MeshIoBCM::read: Could not read file." << std::endl;
+            return false;
+        }
+        return DecodeMesh(data.data(), data.size(), mesh);
+    }
+
+    bool MeshIoBCM::write(const Mesh &mesh, const WriteFlags &/*flags*/) {
+        if (!is_valid_filename(m_filename) || !can_load_file()) {
+            std::cerr << "Error: MeshIoBCM::write: Invalid filename." << std::endl;
+            return false;
+        }
+
+        std::ofstream file(m_filename, std::ios::out | std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: MeshIoBCM::write: Could not open file for writing." << std::endl;
+            return false;
+        }
+
+        const auto data = EncodeMesh(mesh, m_options);
+        file.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+        return file.good();
+    }
+
+    bool MeshIoBCM::can_load_file() {
+        return std::filesystem::path(m_filename).extension() == ".bcm";
+    }
+}
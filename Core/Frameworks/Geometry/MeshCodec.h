@@ -0,0 +1,73 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef ENGINE25_MESHCODEC_H
+#define ENGINE25_MESHCODEC_H
+
+#include "MeshIo.h"
+#include <cstdint>
+
+namespace Bcg {
+    /**
+     * @brief Options of the engine native compressed mesh format (.bcm).
+     *
+     * Attributes are quantized to the given number of bits per component (1 to 30). Positions and texture coordinates
+     * are quantized relative to their bounding box, normals are octahedron mapped to two components.
+     */
+    struct MeshCodecOptions {
+        int position_bits = 16;
+        int normal_bits = 12;
+        int tex_coord_bits = 12;
+        bool with_normals = true;       /**< encode "v:normal" if present. */
+        bool with_tex_coords = true;    /**< encode "v:tex" or "h:tex" if present. */
+    };
+
+    /**
+     * @brief Compresses a polygon mesh.
+     *
+     * Faces are traversed breadth first over their adjacency and vertices are renumbered in the order in which the
+     * traversal first references them, so the decoded mesh has the same geometry but a different element order.
+     * Every face corner is coded as "new vertex" or as a small delta to the previous corner. Attributes of new vertices
+     * are predicted with the parallelogram rule from the neighbouring face where possible. All streams are finally
+     * entropy coded with an order-0 rANS coder.
+     * @param mesh The mesh to encode.
+     * @param options Quantization and attribute options.
+     * @return The encoded bytes.
+     */
+    [[nodiscard]] std::vector<uint8_t> EncodeMesh(const Mesh &mesh, const MeshCodecOptions &options = MeshCodecOptions());
+
+    /**
+     * @brief Decodes a mesh encoded with EncodeMesh. The mesh is cleared first.
+     * @param data The encoded bytes.
+     * @param size The number of encoded bytes.
+     * @param mesh The mesh to populate.
+     * @return True if the data was decoded successfully, false otherwise.
+     */
+    bool DecodeMesh(const uint8_t *data, size_t size, Mesh &mesh);
+
+    /**
+     * @brief Class for reading and writing the compressed .bcm format.
+     */
+    class MeshIoBCM : public MeshIo {
+    public:
+        explicit MeshIoBCM(std::string filename, MeshCodecOptions options = MeshCodecOptions()) :
+            MeshIo(std::move(filename)), m_options(options) {
+        }
+
+        bool read(Mesh &mesh) override;
+
+        /**
+         * @brief Writes the mesh compressed with the options passed at construction. The format is always binary,
+         * so the flags are ignored.
+         */
+        bool write(const Mesh &mesh, const WriteFlags &flags) override;
+
+        bool can_load_file() override;
+
+    private:
+        MeshCodecOptions m_options;
+    };
+}
+
+#endif //ENGINE25_MESHCODEC_H
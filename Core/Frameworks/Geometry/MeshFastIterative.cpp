@@ -0,0 +1,247 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "MeshFastIterative.h"
+#include "JobSystem.h"
+#include "MeshUtils.h"
+#include <atomic>
+#include <iostream>
+#include <mutex>
+
+namespace Bcg {
+    // The arrival time at the corner from the arrival times ta and tb at the other two corners.
+    static Real TriangleUpdate(const FastIterativeCorner &corner, Real ta, Real tb) {
+        constexpr Real unreached = std::numeric_limits<Real>::max();
+        // Along the edges first, this also covers fronts arriving from outside the triangle.
+        double best = unreached;
+        if (ta < unreached) best = std::min<double>(best, ta + corner.length_a * corner.slowness);
+        if (tb < unreached) best = std::min<double>(best, tb + corner.length_b * corner.slowness);
+        if (ta == unreached || tb == unreached) return static_cast<Real>(best);
+
+        // The planar front through (a, ta) and (b, tb) with |grad T| = slowness satisfies
+        // (t - p 1)^T Q (t - p 1) = slowness^2 for the arrival time p at the corner. Shifting by the smaller time
+        // keeps the quadratic well conditioned.
+        const double shift = std::min(ta, tb);
+        const double t0 = ta - shift, t1 = tb - shift;
+        const double q00 = corner.q00, q01 = corner.q01, q11 = corner.q11;
+        const double qt0 = q00 * t0 + q01 * t1, qt1 = q01 * t0 + q11 * t1;
+        const double sum_q = q00 + 2 * q01 + q11;
+        const double sum_qt = qt0 + qt1;
+        const double slowness = corner.slowness;
+        const double discriminant = sum_qt * sum_qt - sum_q * (t0 * qt0 + t1 * qt1 - slowness * slowness);
+        if (sum_q <= 0 || discriminant < 0) return static_cast<Real>(best);
+        const double p = (sum_qt + std::sqrt(discriminant)) / sum_q;
+        // The front has to arrive from inside the triangle, i.e. Q (t - p 1) <= 0 componentwise.
+        if (qt0 - p * (q00 + q01) > 0 || qt1 - p * (q01 + q11) > 0) return static_cast<Real>(best);
+        return static_cast<Real>(std::min(best, p + shift));
+    }
+
+    static void AtomicMin(Real &target, Real value) {
+        std::atomic_ref<Real> atomic(target);
+        Real current = atomic.load(std::memory_order_relaxed);
+        while (value < current && !atomic.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    FastIterativeMethod::FastIterativeMethod(Mesh &mesh, JobSystem *jobs) : mesh(mesh), jobs(jobs) {
+    }
+
+    bool FastIterativeMethod::build_corners() {
+        clear_corners();
+        for (const Face &f: mesh.faces) {
+            if (mesh.get_valence(f) != 3) {
+                std::cerr << "Error: FastIterativeMethod::build_corners: The mesh has non triangular faces."
+                          << std::endl;
+                return false;
+            }
+        }
+        constexpr size_t grain_size = 4096;
+        const auto positions = mesh.get_vertex_property<Vector<Real, 3> >("v:position");
+        const size_t n = mesh.vertices.size();
+        auto has_corner = [&](const Halfedge &h) {
+            const Face f = mesh.get_face(h);
+            return f.is_valid() && !mesh.is_deleted(f);
+        };
+
+        // Every outgoing halfedge with a face is a corner of its vertex, the corners of a vertex are stored together.
+        corner_offsets.assign(n + 1, 0);
+        ParallelFor(jobs, 0, n, grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (mesh.is_deleted(Vertex(i))) continue;
+                for (const Halfedge &h: mesh.get_halfedges(Vertex(i))) {
+                    corner_offsets[i + 1] += has_corner(h);
+                }
+            }
+        });
+        for (size_t i = 0; i < n; ++i) {
+            corner_offsets[i + 1] += corner_offsets[i];
+        }
+        corners.resize(corner_offsets[n]);
+        ParallelFor(jobs, 0, n, grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (mesh.is_deleted(Vertex(i))) continue;
+                uint32_t k = corner_offsets[i];
+                const Vector<double, 3> c = positions[Vertex(i)].cast<double>();
+                for (const Halfedge &h: mesh.get_halfedges(Vertex(i))) {
+                    if (!has_corner(h)) continue;
+                    const Halfedge next = mesh.get_next(h);
+                    const Vector<double, 3> ea = positions[mesh.get_vertex(h)].cast<double>() - c;
+                    const Vector<double, 3> eb = positions[mesh.get_vertex(next)].cast<double>() - c;
+                    const double g00 = ea.squaredNorm(), g01 = ea.dot(eb), g11 = eb.squaredNorm();
+                    const double determinant = g00 * g11 - g01 * g01;
+                    FastIterativeCorner &corner = corners[k++];
+                    corner.a = static_cast<uint32_t>(mesh.get_vertex(h).idx());
+                    corner.b = static_cast<uint32_t>(mesh.get_vertex(next).idx());
+                    corner.length_a = static_cast<Real>(std::sqrt(g00));
+                    corner.length_b = static_cast<Real>(std::sqrt(g11));
+                    corner.slowness = face_speeds ? 1 / face_speeds[mesh.get_face(h)] : 1;
+                    // Degenerate triangles keep Q = 0 and only update along their edges.
+                    if (determinant > std::numeric_limits<double>::epsilon() * g00 * g11) {
+                        corner.q00 = static_cast<Real>(g11 / determinant);
+                        corner.q01 = static_cast<Real>(-g01 / determinant);
+                        corner.q11 = static_cast<Real>(g00 / determinant);
+                    }
+                }
+            }
+        });
+
+        double sum_length = 0;
+        size_t n_edges = 0;
+        for (const Edge &e: mesh.edges) {
+            sum_length += EdgeLength(mesh, positions, e);
+            ++n_edges;
+        }
+        mean_edge_length = static_cast<Real>(n_edges > 0 ? sum_length / n_edges : 1);
+        return true;
+    }
+
+    void FastIterativeMethod::clear_corners() {
+        corner_offsets.clear();
+        corners.clear();
+        mean_edge_length = 0;
+    }
+
+    bool FastIterativeMethod::compute(const Vertex &source) {
+        return compute(std::vector<Vertex>{source});
+    }
+
+    bool FastIterativeMethod::compute(const std::vector<Vertex> &sources) {
+        if (sources.empty()) {
+            std::cerr << "Error: FastIterativeMethod::compute: No source vertices." << std::endl;
+            return false;
+        }
+        for (const Vertex &source: sources) {
+            if (!mesh.is_valid(source) || mesh.is_deleted(source)) {
+                std::cerr << "Error: FastIterativeMethod::compute: Invalid source vertex." << std::endl;
+                return false;
+            }
+        }
+        if (corner_offsets.size() != mesh.vertices.size() + 1 && !build_corners()) return false;
+        if (!vertex_distances) {
+            vertex_distances = mesh.vertex_property<Real>("v:fim:distances", std::numeric_limits<Real>::max());
+        }
+        n_iterations = 0;
+        n_updates = 0;
+        constexpr Real unreached = std::numeric_limits<Real>::max();
+        const Real epsilon = tolerance * mean_edge_length;
+
+        std::vector<Real> &values = vertex_distances.vector();
+        std::fill(values.begin(), values.end(), unreached);
+        for (const Vertex &source: sources) {
+            values[source.idx()] = 0;
+        }
+        // The smallest arrival time at v over its triangles, from the current values of their other corners.
+        auto update = [&](const Vertex &v) {
+            Real best = unreached;
+            for (uint32_t i = corner_offsets[v.idx()]; i < corner_offsets[v.idx() + 1]; ++i) {
+                const FastIterativeCorner &corner = corners[i];
+                const Real ta = std::atomic_ref(values[corner.a]).load(std::memory_order_relaxed);
+                const Real tb = std::atomic_ref(values[corner.b]).load(std::memory_order_relaxed);
+                best = std::min(best, TriangleUpdate(corner, ta, tb));
+            }
+            return best;
+        };
+
+        // in_list marks the vertices of the active list, so every vertex is added once.
+        std::vector<uint8_t> in_list(mesh.vertices.size(), 0);
+        std::vector<uint32_t> active;
+        for (const Vertex &source: sources) {
+            for (const Vertex &u: mesh.get_vertices(source)) {
+                if (values[u.idx()] == 0 || in_list[u.idx()]) continue;
+                in_list[u.idx()] = 1;
+                active.push_back(static_cast<uint32_t>(u.idx()));
+            }
+        }
+
+        std::mutex mutex;
+        std::vector<uint32_t> next, converged;
+        while (!active.empty()) {
+            ++n_iterations;
+            n_updates += active.size();
+            // Update the active vertices, the converged ones leave the list.
+            next.clear();
+            converged.clear();
+            ParallelFor(jobs, 0, active.size(), 256, [&](size_t begin, size_t end) {
+                std::vector<uint32_t> local_next, local_converged;
+                for (size_t k = begin; k < end; ++k) {
+                    const uint32_t v = active[k];
+                    const Real old_value = std::atomic_ref(values[v]).load(std::memory_order_relaxed);
+                    const Real value = update(Vertex(v));
+                    AtomicMin(values[v], value);
+                    if (value < old_value - epsilon) {
+                        local_next.push_back(v);
+                    } else {
+                        std::atomic_ref(in_list[v]).store(0, std::memory_order_relaxed);
+                        local_converged.push_back(v);
+                    }
+                }
+                std::scoped_lock lock(mutex);
+                next.insert(next.end(), local_next.begin(), local_next.end());
+                converged.insert(converged.end(), local_converged.begin(), local_converged.end());
+            });
+
+            // The neighbors of converged vertices whose values they lower join the list.
+            ParallelFor(jobs, 0, converged.size(), 256, [&](size_t begin, size_t end) {
+                std::vector<uint32_t> local;
+                auto visit = [&](uint32_t u, Real value_v) {
+                    if (std::atomic_ref(in_list[u]).load(std::memory_order_relaxed)) return;
+                    // Every update through v arrives later than v, so upwind neighbors cannot improve.
+                    const Real old_value = std::atomic_ref(values[u]).load(std::memory_order_relaxed);
+                    if (old_value <= value_v) return;
+                    const Real value = update(Vertex(u));
+                    if (!(value < old_value - epsilon)) return;
+                    AtomicMin(values[u], value);
+                    if (std::atomic_ref(in_list[u]).exchange(1, std::memory_order_relaxed) == 0) {
+                        local.push_back(u);
+                    }
+                };
+                for (size_t k = begin; k < end; ++k) {
+                    const uint32_t v = converged[k];
+                    const Real value_v = std::atomic_ref(values[v]).load(std::memory_order_relaxed);
+                    // The next corners reach all neighbors of interior vertices, on the boundary the previous
+                    // corners add the neighbor across the boundary edge.
+                    const bool boundary = mesh.is_boundary(Vertex(v));
+                    for (uint32_t i = corner_offsets[v]; i < corner_offsets[v + 1]; ++i) {
+                        visit(corners[i].a, value_v);
+                        if (boundary) visit(corners[i].b, value_v);
+                    }
+                }
+                std::scoped_lock lock(mutex);
+                next.insert(next.end(), local.begin(), local.end());
+            });
+            active.swap(next);
+        }
+        return true;
+    }
+
+    void FastIterativeMethod::set_custom_face_speeds(const FaceProperty<Real> &speeds) {
+        face_speeds = speeds;
+        clear_corners();
+    }
+
+    void FastIterativeMethod::clear_custom_face_speeds() {
+        face_speeds = FaceProperty<Real>();
+        clear_corners();
+    }
+}
@@ -0,0 +1,102 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef MESHFASTITERATIVE_H
+#define MESHFASTITERATIVE_H
+
+#include "Mesh.h"
+
+namespace Bcg {
+    class JobSystem;
+
+    /**
+     * @brief FastIterativeCorner: The geometry of the triangle of a halfedge h, seen from its corner c = from(h).
+     *
+     * The other corners are a = to(h) and b = to(next(h)), the inverse Gram matrix Q of the edges ca and cb solves for
+     * the gradient of the arrival times in the triangle.
+     */
+    struct FastIterativeCorner {
+        uint32_t a = 0; /**< The next corner. */
+        uint32_t b = 0; /**< The previous corner. */
+        Real q00 = 0, q01 = 0, q11 = 0; /**< The inverse Gram matrix of the edges, zero if degenerate. */
+        Real length_a = 0, length_b = 0; /**< The lengths of the edges ca and cb. */
+        Real slowness = 1; /**< The inverse speed of the front in the triangle. */
+    };
+
+    /**
+     * @brief FastIterativeMethod: Solves the eikonal equation |grad T| = 1 / F on a triangle mesh for the first
+     * arrival times T of a front starting at the sources, the geodesic distances for unit speed F.
+     *
+     * Every vertex is updated from its incident triangles by the planar wavefront which passes through the values of
+     * the two other corners, if it arrives from inside the triangle, and along the edges otherwise. Following Jeong and
+     * Whitaker, only the vertices of an active list are updated. A vertex whose value no longer changes leaves the
+     * list and adds its neighbors whose values it lowers. All vertices of the active list are updated at once, in
+     * parallel chunks if a JobSystem is given, and the values only decrease, so the order of the updates does not
+     * matter for the converged result. Unlike Dijkstra on edge lengths, the fronts cross the triangles.
+     *
+     * The corners of every vertex only depend on the mesh and the face speeds, so they are built once and shared by
+     * all further computes. They have to be rebuilt with build_corners() after the positions or the connectivity of
+     * the mesh or the values of the face speeds changed.
+     */
+    class FastIterativeMethod {
+    public:
+        /**
+         * @brief Constructs a FastIterativeMethod object for the given mesh.
+         * @param mesh The triangle mesh on which to compute the arrival times.
+         * @param jobs If set, the active list is updated in parallel on this JobSystem.
+         */
+        explicit FastIterativeMethod(Mesh &mesh, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Builds the corners of all vertices. Called by compute if there are none.
+         * @return True if successful, false if the mesh has non triangular faces.
+         */
+        bool build_corners();
+
+        /**
+         * @brief Drops the corners, e.g. to free their memory.
+         */
+        void clear_corners();
+
+        /**
+         * @brief Computes the arrival times from the source into vertex_distances.
+         * @param source The source vertex.
+         * @return True if the computation was successful.
+         */
+        bool compute(const Vertex &source);
+
+        /**
+         * @brief Computes the arrival times from the nearest of the sources into vertex_distances.
+         * @param sources The source vertices.
+         * @return True if the computation was successful.
+         */
+        bool compute(const std::vector<Vertex> &sources);
+
+        /**
+         * @brief Sets custom speeds of the front in every face, the default speed is one.
+         * @param speeds The positive speeds.
+         */
+        void set_custom_face_speeds(const FaceProperty<Real> &speeds);
+
+        /**
+         * @brief Clears any custom speeds, the front moves with unit speed.
+         */
+        void clear_custom_face_speeds();
+
+        VertexProperty<Real> vertex_distances; /**< The arrival times of the last compute, max if unreachable. */
+        FaceProperty<Real> face_speeds; /**< The optional speeds of the front in every face. */
+        Real tolerance = 1e-5f; /**< A value has converged if it changes less than this times the mean edge length. */
+        size_t n_iterations = 0; /**< The number of active list iterations of the last compute. */
+        size_t n_updates = 0; /**< The number of vertex updates of the last compute. */
+
+    private:
+        Mesh &mesh; /**< The mesh on which to compute the arrival times. */
+        JobSystem *jobs; /**< The optional JobSystem used for the updates. */
+        std::vector<uint32_t> corner_offsets; /**< The corners of vertex v are corner_offsets[v, v + 1). */
+        std::vector<FastIterativeCorner> corners; /**< The corners of the triangles, grouped by vertex. */
+        Real mean_edge_length = 0; /**< The mean edge length, which scales the tolerance. */
+    };
+}
+
+#endif //MESHFASTITERATIVE_H
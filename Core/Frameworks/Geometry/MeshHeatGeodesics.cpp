@@ -0,0 +1,260 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "MeshHeatGeodesics.h"
+#include "JobSystem.h"
+#include "MeshUtils.h"
+#include "Eigen/Geometry"
+#include "Eigen/SparseCholesky"
+#include <iostream>
+#include <queue>
+
+namespace Bcg {
+    using SparseMatrix = Eigen::SparseMatrix<double>;
+
+    // Both factorizations and the per halfedge operators of the gradient and the divergence. For a halfedge h from
+    // corner c of its triangle, gradients[h] is the gradient of the hat function of c and divergences[h] maps the
+    // vector field of the triangle to its contribution to the integrated divergence at c.
+    struct HeatGeodesics::Factorization {
+        Eigen::SimplicialLDLT<SparseMatrix> heat;
+        Eigen::SimplicialLDLT<SparseMatrix> poisson;
+        std::vector<Vector<Real, 3> > gradients;
+        std::vector<Vector<Real, 3> > divergences;
+        std::vector<uint32_t> components; /**< The connected component of every vertex, max if deleted. */
+    };
+
+    HeatGeodesics::HeatGeodesics(Mesh &mesh, JobSystem *jobs) : mesh(mesh), jobs(jobs) {
+    }
+
+    HeatGeodesics::~HeatGeodesics() = default;
+
+    bool HeatGeodesics::factor() {
+        factorization.reset();
+        for (const Face &f: mesh.faces) {
+            if (mesh.get_valence(f) != 3) {
+                std::cerr << "Error: HeatGeodesics::factor: The mesh has non triangular faces." << std::endl;
+                return false;
+            }
+        }
+        constexpr size_t grain_size = 4096;
+        const auto positions = mesh.get_vertex_property<Vector<Real, 3> >("v:position");
+        auto result = std::make_unique<Factorization>();
+        result->gradients.assign(mesh.halfedges.size(), Vector<Real, 3>::Zero());
+        result->divergences.assign(mesh.halfedges.size(), Vector<Real, 3>::Zero());
+        // The cotan weight of the edge of every halfedge from the angle opposite to it in its triangle.
+        std::vector<double> weights(mesh.halfedges.size(), 0);
+        ParallelFor(jobs, 0, mesh.faces.size(), grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const Face f(i);
+                if (mesh.is_deleted(f)) continue;
+                // The corners c, a, b in order, h0 goes from c to a.
+                const Halfedge h0 = mesh.get_halfedge(f);
+                const Halfedge h1 = mesh.get_next(h0);
+                const Halfedge h2 = mesh.get_next(h1);
+                const Vector<double, 3> pc = positions[mesh.get_vertex(h2)].cast<double>();
+                const Vector<double, 3> pa = positions[mesh.get_vertex(h0)].cast<double>();
+                const Vector<double, 3> pb = positions[mesh.get_vertex(h1)].cast<double>();
+                const Vector<double, 3> cross = (pa - pc).cross(pb - pc);
+                const double twice_area = cross.norm();
+                if (twice_area <= std::numeric_limits<double>::min()) continue;
+                const Vector<double, 3> normal = cross / twice_area;
+
+                const Halfedge corners[3] = {h0, h1, h2};
+                const Vector<double, 3> points[3] = {pc, pa, pb};
+                for (int k = 0; k < 3; ++k) {
+                    // The corner p with the next corner q and the previous corner r.
+                    const Vector<double, 3> &p = points[k], &q = points[(k + 1) % 3], &r = points[(k + 2) % 3];
+                    const double cot_q = ClampCotan((p - q).dot(r - q) / twice_area);
+                    const double cot_r = ClampCotan((p - r).dot(q - r) / twice_area);
+                    result->gradients[corners[k].idx()] = (normal.cross(r - q) / twice_area).cast<Real>();
+                    result->divergences[corners[k].idx()] = (0.5 * (cot_q * (r - p) + cot_r * (q - p))).cast<Real>();
+                    // The halfedge from q to r lies opposite to p.
+                    const double cot_p = ClampCotan((q - p).dot(r - p) / twice_area);
+                    weights[corners[(k + 1) % 3].idx()] = 0.5 * cot_p;
+                }
+            }
+        });
+
+        double mean_length = 0;
+        size_t n_edges = 0;
+        for (const Edge &e: mesh.edges) {
+            mean_length += EdgeLength(mesh, positions, e);
+            ++n_edges;
+        }
+        mean_length = n_edges > 0 ? mean_length / n_edges : 1;
+        const double time = time_factor * mean_length * mean_length;
+        // A tiny mass term makes the Poisson matrix definite without changing the solution noticeably.
+        const double regularization = 1e-8 / (mean_length * mean_length);
+
+        const size_t n = mesh.vertices.size();
+        std::vector<double> areas(n, 0);
+        ParallelFor(jobs, 0, n, grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const Vertex v(i);
+                if (!mesh.is_deleted(v)) areas[i] = VertexVoronoiMixedArea(mesh, positions, v);
+            }
+        });
+
+        std::vector<Eigen::Triplet<double> > heat_entries, poisson_entries;
+        heat_entries.reserve(n + 4 * mesh.halfedges.size());
+        poisson_entries.reserve(n + 4 * mesh.halfedges.size());
+        auto add = [&](size_t row, size_t col, double weight) {
+            heat_entries.emplace_back(row, col, time * weight);
+            poisson_entries.emplace_back(row, col, weight);
+        };
+        for (const Halfedge &h: mesh.halfedges) {
+            if (weights[h.idx()] == 0) continue;
+            const size_t from = mesh.get_vertex(mesh.get_opposite(h)).idx(), to = mesh.get_vertex(h).idx();
+            add(from, to, -weights[h.idx()]);
+            add(to, from, -weights[h.idx()]);
+            add(from, from, weights[h.idx()]);
+            add(to, to, weights[h.idx()]);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            // Deleted and isolated vertices get identity rows, they never receive heat.
+            const double area = areas[i] > 0 ? areas[i] : 1;
+            heat_entries.emplace_back(i, i, area);
+            poisson_entries.emplace_back(i, i, areas[i] > 0 ? regularization * area : 1);
+        }
+        SparseMatrix heat(n, n), poisson(n, n);
+        heat.setFromTriplets(heat_entries.begin(), heat_entries.end());
+        poisson.setFromTriplets(poisson_entries.begin(), poisson_entries.end());
+        result->heat.compute(heat);
+        result->poisson.compute(poisson);
+        if (result->heat.info() != Eigen::Success || result->poisson.info() != Eigen::Success) {
+            std::cerr << "Error: HeatGeodesics::factor: The factorization failed." << std::endl;
+            return false;
+        }
+
+        // Label the connected components, vertices in components without a source are unreachable.
+        result->components.assign(n, std::numeric_limits<uint32_t>::max());
+        uint32_t n_components = 0;
+        for (const Vertex &v: mesh.vertices) {
+            if (result->components[v.idx()] != std::numeric_limits<uint32_t>::max()) continue;
+            std::queue<Vertex> queue;
+            result->components[v.idx()] = n_components;
+            queue.push(v);
+            while (!queue.empty()) {
+                const Vertex current = queue.front();
+                queue.pop();
+                for (const Halfedge &h: mesh.get_halfedges(current)) {
+                    const Vertex next = mesh.get_vertex(h);
+                    if (result->components[next.idx()] != std::numeric_limits<uint32_t>::max()) continue;
+                    result->components[next.idx()] = n_components;
+                    queue.push(next);
+                }
+            }
+            ++n_components;
+        }
+        factorization = std::move(result);
+        return true;
+    }
+
+    void HeatGeodesics::clear_factorization() {
+        factorization.reset();
+    }
+
+    bool HeatGeodesics::compute(const Vertex &source) {
+        return compute(std::vector<Vertex>{source});
+    }
+
+    bool HeatGeodesics::compute(const std::vector<Vertex> &sources) {
+        if (!prepare(sources)) return false;
+        if (!vertex_distances) {
+            vertex_distances = mesh.vertex_property<Real>("v:heat_geodesics:distances",
+                                                          std::numeric_limits<Real>::max());
+        }
+        solve(sources, vertex_distances.vector(), jobs);
+        return true;
+    }
+
+    bool HeatGeodesics::compute(const std::vector<Vertex> &sources, const RowCallback &callback) {
+        if (!prepare(sources)) return false;
+        ParallelFor(jobs, 0, sources.size(), 1, [&](size_t begin, size_t end) {
+            std::vector<Real> row;
+            for (size_t i = begin; i < end; ++i) {
+                // Every source solves on its own thread, so the solve itself runs serially.
+                solve({sources[i]}, row, nullptr);
+                callback(sources[i], row);
+            }
+        });
+        return true;
+    }
+
+    bool HeatGeodesics::prepare(const std::vector<Vertex> &sources) {
+        if (sources.empty()) {
+            std::cerr << "Error: HeatGeodesics::compute: No source vertices." << std::endl;
+            return false;
+        }
+        for (const Vertex &source: sources) {
+            if (!mesh.is_valid(source) || mesh.is_deleted(source)) {
+                std::cerr << "Error: HeatGeodesics::compute: Invalid source vertex." << std::endl;
+                return false;
+            }
+        }
+        return factorization || factor();
+    }
+
+    void HeatGeodesics::solve(const std::vector<Vertex> &sources, std::vector<Real> &distances,
+                              JobSystem *solve_jobs) const {
+        constexpr size_t grain_size = 4096;
+        const size_t n = mesh.vertices.size();
+        Eigen::VectorXd delta = Eigen::VectorXd::Zero(n);
+        for (const Vertex &source: sources) {
+            delta[source.idx()] = 1;
+        }
+        const Eigen::VectorXd heat = factorization->heat.solve(delta);
+
+        // The normalized negative gradient of the heat in every face points away from the sources.
+        std::vector<Vector<double, 3> > field(mesh.faces.size(), Vector<double, 3>::Zero());
+        ParallelFor(solve_jobs, 0, mesh.faces.size(), grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const Face f(i);
+                if (mesh.is_deleted(f)) continue;
+                Vector<double, 3> gradient = Vector<double, 3>::Zero();
+                for (const Halfedge &h: mesh.get_halfedges(f)) {
+                    const size_t corner = mesh.get_vertex(mesh.get_opposite(h)).idx();
+                    gradient += heat[corner] * factorization->gradients[h.idx()].cast<double>();
+                }
+                const double norm = gradient.norm();
+                if (norm > 0) field[i] = -gradient / norm;
+            }
+        });
+
+        // The distance solves L phi = -div X, the divergence is gathered from the faces around every vertex.
+        Eigen::VectorXd divergence = Eigen::VectorXd::Zero(n);
+        const bool skip_deleted = mesh.has_garbage();
+        ParallelFor(solve_jobs, 0, n, grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const Vertex v(i);
+                if (mesh.is_deleted(v)) continue;
+                double sum = 0;
+                for (const Halfedge &h: mesh.get_halfedges(v)) {
+                    if (skip_deleted && mesh.is_deleted(h)) continue;
+                    const Face f = mesh.get_face(h);
+                    if (f.is_valid()) sum += factorization->divergences[h.idx()].cast<double>().dot(field[f.idx()]);
+                }
+                divergence[i] = -sum;
+            }
+        });
+        const Eigen::VectorXd phi = factorization->poisson.solve(divergence);
+
+        // Shift every component to zero at its closest source.
+        const auto &components = factorization->components;
+        std::vector<double> shifts(n, std::numeric_limits<double>::max());
+        for (const Vertex &source: sources) {
+            shifts[components[source.idx()]] = std::min(shifts[components[source.idx()]], phi[source.idx()]);
+        }
+        distances.resize(n);
+        ParallelFor(solve_jobs, 0, n, grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const uint32_t component = components[i];
+                distances[i] = component == std::numeric_limits<uint32_t>::max() ||
+                               shifts[component] == std::numeric_limits<double>::max()
+                                   ? std::numeric_limits<Real>::max()
+                                   : static_cast<Real>(std::max(0.0, phi[i] - shifts[component]));
+            }
+        });
+    }
+}
@@ -0,0 +1,99 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef MESHHEATGEODESICS_H
+#define MESHHEATGEODESICS_H
+
+#include "Mesh.h"
+#include <functional>
+#include <memory>
+
+namespace Bcg {
+    class JobSystem;
+
+    /**
+     * @brief HeatGeodesics: Approximates geodesic distances on a triangle mesh with the heat method of Crane et al.
+     *
+     * Heat is diffused from the sources for a short time t by one backward Euler step (M + t L) u = delta, with the
+     * mixed Voronoi areas M and the clamped cotan Laplacian L. The normalized negative gradient of u points along the
+     * geodesics, and the Poisson equation L phi = -div X recovers the distance phi from it, shifted to zero at the
+     * sources. Both matrices only depend on the mesh, so they are factored once and every further query costs two
+     * back substitutions. Unlike Dijkstra on edge lengths, the distances are not restricted to paths along edges.
+     *
+     * The factorization has to be rebuilt with factor() after the positions or the connectivity of the mesh changed.
+     */
+    class HeatGeodesics {
+    public:
+        /**
+         * @brief Receives the distances from a source to all vertices, indexed by vertex, max if unreachable.
+         * It is called concurrently from the workers of the JobSystem and the row is only valid during the call.
+         */
+        using RowCallback = std::function<void(const Vertex &source, const std::vector<Real> &row)>;
+
+        /**
+         * @brief Constructs a HeatGeodesics object for the given mesh.
+         * @param mesh The triangle mesh on which to compute the distances.
+         * @param jobs If set, the assembly, single queries and batches of sources run in parallel on this JobSystem.
+         */
+        explicit HeatGeodesics(Mesh &mesh, JobSystem *jobs = nullptr);
+
+        ~HeatGeodesics();
+
+        /**
+         * @brief Assembles and factors the heat and Poisson matrices. Called by compute if there is no factorization.
+         * @return True if successful, false if the mesh has non triangular faces or a factorization failed.
+         */
+        bool factor();
+
+        /**
+         * @brief Drops the factorization, e.g. to free its memory.
+         */
+        void clear_factorization();
+
+        /**
+         * @brief Computes the distances from the source to all vertices into vertex_distances.
+         * @param source The source vertex.
+         * @return True if the computation was successful.
+         */
+        bool compute(const Vertex &source);
+
+        /**
+         * @brief Computes the distances to the nearest of the sources into vertex_distances.
+         * @param sources The source vertices.
+         * @return True if the computation was successful.
+         */
+        bool compute(const std::vector<Vertex> &sources);
+
+        /**
+         * @brief Computes the distances from every source separately and passes every row to the callback. The
+         * sources are distributed over the JobSystem and share the factorization.
+         * @param sources The source vertices.
+         * @param callback The receiver of the rows.
+         * @return True if the computation was successful.
+         */
+        bool compute(const std::vector<Vertex> &sources, const RowCallback &callback);
+
+        VertexProperty<Real> vertex_distances; /**< The distances of the last compute to the sources. */
+        Real time_factor = 1; /**< The diffusion time in multiples of the squared mean edge length. */
+
+    private:
+        struct Factorization;
+
+        /**
+         * @brief Solves for the distances to the nearest of the sources.
+         */
+        void solve(const std::vector<Vertex> &sources, std::vector<Real> &distances, JobSystem *solve_jobs) const;
+
+        /**
+         * @brief Checks the sources and factors the matrices if needed.
+         */
+        bool prepare(const std::vector<Vertex> &sources);
+
+        Mesh &mesh; /**< The mesh on which to compute the distances. */
+        JobSystem *jobs; /**< The optional JobSystem used for the assembly and the queries. */
+        std::unique_ptr<Factorization> factorization; /**< The factored matrices and per halfedge operators. */
+    };
+}
+
+#endif //MESHHEATGEODESICS_H
@@ -3,6 +3,8 @@
 //
 
 #include "MeshIo.h"
+#include "MeshCodec.h"
+#include "JobSystem.h"
 #include <regex>
 #include <fstream>
 #include <array>
@@ -15,7 +17,7 @@
 #include <iostream>
 #include <filesystem>
 #include <memory>
-#include <fmt/core.h>
+#include <fmt/format.h>
 
 // Define a custom hash function for Vector<Real, 3>
 namespace std {
@@ -37,6 +39,38 @@ namespace Bcg {
         return std::regex_match(filename, valid_filename_regex);
     }
 
+    /**
+     * @brief Formats the elements [0, n) chunk by chunk into text buffers and writes the buffers in order.
+     *
+     * format(begin, end, buffer) appends the text of the elements [begin, end) to buffer. If a JobSystem is given, a
+     * wave of chunks is formatted in parallel before it is written, otherwise chunks are formatted one by one.
+     */
+    template<typename Format>
+    void WriteFormattedChunks(std::ofstream &out, size_t n, JobSystem *jobs, Format &&format) {
+        constexpr size_t chunk_size = 8192;
+        const size_t n_buffers = jobs ? std::max<size_t>(2 * jobs->num_threads(), 1) : 1;
+        std::vector<std::string> buffers(n_buffers);
+        for (size_t wave_begin = 0; wave_begin < n; wave_begin += n_buffers * chunk_size) {
+            const size_t wave_end = std::min(n, wave_begin + n_buffers * chunk_size);
+            const size_t n_chunks = (wave_end - wave_begin + chunk_size - 1) / chunk_size;
+            auto format_chunks = [&](size_t first, size_t last) {
+                for (size_t c = first; c < last; ++c) {
+                    const size_t begin = wave_begin + c * chunk_size;
+                    buffers[c].clear();
+                    format(begin, std::min(wave_end, begin + chunk_size), buffers[c]);
+                }
+            };
+            if (jobs && n_chunks > 1) {
+                jobs->parallel_for(0, n_chunks, 1, format_chunks);
+            } else {
+                format_chunks(0, n_chunks);
+            }
+            for (size_t c = 0; c < n_chunks; ++c) {
+                out.write(buffers[c].data(), static_cast<std::streamsize>(buffers[c].size()));
+            }
+        }
+    }
+
     bool MeshIoOFF::can_load_file() {
         return std::filesystem::path(m_filename).extension() == ".off";
     }
@@ -273,44 +307,49 @@ namespace Bcg {
         out << "OFF" << std::endl;
         out << mesh.vertices.size() << " " << mesh.faces.size() << " 0" << std::endl;
 
-        // Write vertex data
-        for (const auto &v: mesh.vertices) {
-            const Vector<Real, 3> &pos = positions[v];
-            out << std::fixed << std::setprecision(6) << pos.x() << " " << pos.y() << " " << pos.z();
-
-            if (normals) {
-                const Vector<Real, 3> &normal = normals[v];
-                out << " " << normal.x() << " " << normal.y() << " " << normal.z();
-            }
-            if (colors) {
-                const Vector<Real, 3> &color = colors[v];
-                out << " " << color.x() << " " << color.y() << " " << color.z();
-            }
-            if (texcoords) {
-                const Vector<Real, 2> &texcoord = texcoords[v];
-                out << " " << texcoord.x() << " " << texcoord.y();
+        // Write vertex data, "{:.6f}" matches std::fixed with std::setprecision(6)
+        WriteFormattedChunks(out, mesh.vertices.size(), flags.jobs, [&](size_t begin, size_t end, std::string &buffer) {
+            auto it = std::back_inserter(buffer);
+            for (size_t i = begin; i < end; ++i) {
+                const Vertex v(i);
+                if (mesh.has_garbage() && mesh.is_deleted(v)) continue;
+                const Vector<Real, 3> &pos = positions[v];
+                it = fmt::format_to(it, "{:.6f} {:.6f} {:.6f}", pos.x(), pos.y(), pos.z());
+                if (normals) {
+                    const Vector<Real, 3> &normal = normals[v];
+                    it = fmt::format_to(it, " {:.6f} {:.6f} {:.6f}", normal.x(), normal.y(), normal.z());
+                }
+                if (colors) {
+                    const Vector<Real, 3> &color = colors[v];
+                    it = fmt::format_to(it, " {:.6f} {:.6f} {:.6f}", color.x(), color.y(), color.z());
+                }
+                if (texcoords) {
+                    const Vector<Real, 2> &texcoord = texcoords[v];
+                    it = fmt::format_to(it, " {:.6f} {:.6f}", texcoord.x(), texcoord.y());
+                }
+                buffer.push_back('\n');
             }
-            out << std::endl;
-        }
+        });
 
         // Write face data
         FaceProperty<Vector<unsigned int, 3> > tris = mesh.get_face_property<Vector<unsigned int, 3> >("f:triangles");
-        if (tris) {
-            for (const auto &f: mesh.faces) {
-                const Vector<unsigned int, 3> &tri = tris[f];
-                out << "3 " << tri.x() << " " << tri.y() << " " << tri.z() << std::endl;
-            }
-        } else {
-            for (const auto &f: mesh.faces) {
-                auto valence = mesh.get_valence(f);
-                out << valence;
-
+        WriteFormattedChunks(out, mesh.faces.size(), flags.jobs, [&](size_t begin, size_t end, std::string &buffer) {
+            auto it = std::back_inserter(buffer);
+            for (size_t i = begin; i < end; ++i) {
+                const Face f(i);
+                if (mesh.has_garbage() && mesh.is_deleted(f)) continue;
+                if (tris) {
+                    const Vector<unsigned int, 3> &tri = tris[f];
+                    it = fmt::format_to(it, "3 {} {} {}\n", tri.x(), tri.y(), tri.z());
+                    continue;
+                }
+                it = fmt::format_to(it, "{}", mesh.get_valence(f));
                 for (const auto &v: mesh.get_vertices(f)) {
-                    out << " " << v.idx();
+                    it = fmt::format_to(it, " {}", v.idx());
                 }
-                out << std::endl;
+                buffer.push_back('\n');
             }
-        }
+        });
 
         out.close();
 
@@ -451,38 +490,60 @@ namespace Bcg {
         out << "# OBJ export from BCG\n";
 
         auto positions = mesh.get_vertex_property<Vector<Real, 3>>("v:position");
-        for (const auto &v: mesh.vertices) {
-            out << fmt::format("v {:.10f} {:.10f} {:.10f}\n", positions[v][0], positions[v][1], positions[v][2]);
-        }
+        WriteFormattedChunks(out, mesh.vertices.size(), flags.jobs, [&](size_t begin, size_t end, std::string &buffer) {
+            auto it = std::back_inserter(buffer);
+            for (size_t i = begin; i < end; ++i) {
+                if (mesh.has_garbage() && mesh.is_deleted(Vertex(i))) continue;
+                const Vector<Real, 3> &p = positions[Vertex(i)];
+                it = fmt::format_to(it, "v {:.10f} {:.10f} {:.10f}\n", p[0], p[1], p[2]);
+            }
+        });
 
         auto normals = mesh.get_vertex_property<Vector<Real, 3> >("v:normal");
         if (normals) {
-            for (const auto &v: mesh.vertices) {
-                out << fmt::format("vn {:.10f} {:.10f} {:.10f}\n", normals[v][0], normals[v][1], normals[v][2]);
-            }
+            WriteFormattedChunks(out, mesh.vertices.size(), flags.jobs,
+                                 [&](size_t begin, size_t end, std::string &buffer) {
+                                     auto it = std::back_inserter(buffer);
+                                     for (size_t i = begin; i < end; ++i) {
+                                         if (mesh.has_garbage() && mesh.is_deleted(Vertex(i))) continue;
+                                         const Vector<Real, 3> &n = normals[Vertex(i)];
+                                         it = fmt::format_to(it, "vn {:.10f} {:.10f} {:.10f}\n", n[0], n[1], n[2]);
+                                     }
+                                 });
         }
 
         auto tex_coord = mesh.get_halfedge_property<Vector<Real, 2> >("h:tex");
         if (tex_coord) {
-            for (const auto &h: mesh.halfedges) {
-                out << fmt::format("vt {:.10f} {:.10f}\n", tex_coord[h][0], tex_coord[h][1]);
-            }
+            WriteFormattedChunks(out, mesh.halfedges.size(), flags.jobs,
+                                 [&](size_t begin, size_t end, std::string &buffer) {
+                                     auto it = std::back_inserter(buffer);
+                                     for (size_t i = begin; i < end; ++i) {
+                                         if (mesh.has_garbage() && mesh.is_deleted(Halfedge(i))) continue;
+                                         const Vector<Real, 2> &t = tex_coord[Halfedge(i)];
+                                         it = fmt::format_to(it, "vt {:.10f} {:.10f}\n", t[0], t[1]);
+                                     }
+                                 });
         }
 
-        for (const auto &f: mesh.faces) {
-            out << "f";
-            auto fvit = mesh.get_vertices(f);
-            auto fhit = mesh.get_halfedges(f);
-            do {
-                if (tex_coord) {
-                    out << fmt::format(" {}/{}/{}", (*fvit).idx() + 1, (*fhit).idx() + 1, (*fvit).idx() + 1);
-                    ++fhit;
-                } else {
-                    out << fmt::format(" {}/{}", (*fvit).idx() + 1, (*fvit).idx() + 1);
-                }
-            } while (++fvit != mesh.get_vertices(f));
-            out << "\n";
-        }
+        WriteFormattedChunks(out, mesh.faces.size(), flags.jobs, [&](size_t begin, size_t end, std::string &buffer) {
+            auto it = std::back_inserter(buffer);
+            for (size_t i = begin; i < end; ++i) {
+                const Face f(i);
+                if (mesh.has_garbage() && mesh.is_deleted(f)) continue;
+                buffer.push_back('f');
+                auto fvit = mesh.get_vertices(f);
+                auto fhit = mesh.get_halfedges(f);
+                do {
+                    if (tex_coord) {
+                        it = fmt::format_to(it, " {}/{}/{}", (*fvit).idx() + 1, (*fhit).idx() + 1, (*fvit).idx() + 1);
+                        ++fhit;
+                    } else {
+                        it = fmt::format_to(it, " {}/{}", (*fvit).idx() + 1, (*fvit).idx() + 1);
+                    }
+                } while (++fvit != mesh.get_vertices(f));
+                buffer.push_back('\n');
+            }
+        });
 
         return true;
     }
@@ -846,67 +907,81 @@ namespace Bcg {
 
         auto positions = mesh.get_vertex_property<Vector<Real, 3> >("v:position");
 
+        if (!isBinary) {
+            WriteFormattedChunks(file, mesh.vertices.size(), flags.jobs,
+                                 [&](size_t begin, size_t end, std::string &buffer) {
+                                     auto it = std::back_inserter(buffer);
+                                     for (size_t i = begin; i < end; ++i) {
+                                         const auto &pos = positions[Vertex(i)];
+                                         it = fmt::format_to(it, "{:g} {:g} {:g}", pos[0], pos[1], pos[2]);
+                                         if (with_normals) {
+                                             const auto &normal = normals[Vertex(i)];
+                                             it = fmt::format_to(it, " {:g} {:g} {:g}", normal[0], normal[1],
+                                                                 normal[2]);
+                                         }
+                                         if (with_colors) {
+                                             const auto &color = colors[Vertex(i)];
+                                             it = fmt::format_to(it, " {} {} {} {}",
+                                                                 static_cast<int>(color[0] * 255),
+                                                                 static_cast<int>(color[1] * 255),
+                                                                 static_cast<int>(color[2] * 255),
+                                                                 static_cast<int>(color[3] * 255));
+                                         }
+                                         buffer.push_back('\n');
+                                     }
+                                 });
+            WriteFormattedChunks(file, mesh.faces.size(), flags.jobs,
+                                 [&](size_t begin, size_t end, std::string &buffer) {
+                                     auto it = std::back_inserter(buffer);
+                                     for (size_t i = begin; i < end; ++i) {
+                                         const Face f(i);
+                                         if (mesh.has_garbage() && mesh.is_deleted(f)) continue;
+                                         it = fmt::format_to(it, "{}", static_cast<int>(
+                                                                 static_cast<unsigned char>(mesh.get_valence(f))));
+                                         for (const auto &v: mesh.get_vertices(f)) {
+                                             it = fmt::format_to(it, " {}", v.idx());
+                                         }
+                                         buffer.push_back('\n');
+                                     }
+                                 });
+            file.close();
+            return true;
+        }
+
         // Write vertex data
         for (size_t i = 0; i < mesh.vertices.size(); ++i) {
             const auto &pos = positions[Vertex(i)];
-            if (isBinary) {
-                file.write(reinterpret_cast<const char *>(&pos[0]), sizeof(float));
-                file.write(reinterpret_cast<const char *>(&pos[1]), sizeof(float));
-                file.write(reinterpret_cast<const char *>(&pos[2]), sizeof(float));
-            } else {
-                file << pos[0] << " " << pos[1] << " " << pos[2];
-            }
+            file.write(reinterpret_cast<const char *>(&pos[0]), sizeof(float));
+            file.write(reinterpret_cast<const char *>(&pos[1]), sizeof(float));
+            file.write(reinterpret_cast<const char *>(&pos[2]), sizeof(float));
 
             if (with_normals) {
                 const auto &normal = normals[Vertex(i)];
-                if (isBinary) {
-                    file.write(reinterpret_cast<const char *>(&normal[0]), sizeof(float));
-                    file.write(reinterpret_cast<const char *>(&normal[1]), sizeof(float));
-                    file.write(reinterpret_cast<const char *>(&normal[2]), sizeof(float));
-                } else {
-                    file << " " << normal[0] << " " << normal[1] << " " << normal[2];
-                }
+                file.write(reinterpret_cast<const char *>(&normal[0]), sizeof(float));
+                file.write(reinterpret_cast<const char *>(&normal[1]), sizeof(float));
+                file.write(reinterpret_cast<const char *>(&normal[2]), sizeof(float));
             }
 
             if (with_colors) {
                 const auto &color = colors[Vertex(i)];
-                if (isBinary) {
-                    unsigned char r = static_cast<unsigned char>(color[0] * 255);
-                    unsigned char g = static_cast<unsigned char>(color[1] * 255);
-                    unsigned char b = static_cast<unsigned char>(color[2] * 255);
-                    unsigned char a = static_cast<unsigned char>(color[3] * 255);
-                    file.write(reinterpret_cast<const char *>(&r), sizeof(unsigned char));
-                    file.write(reinterpret_cast<const char *>(&g), sizeof(unsigned char));
-                    file.write(reinterpret_cast<const char *>(&b), sizeof(unsigned char));
-                    file.write(reinterpret_cast<const char *>(&a), sizeof(unsigned char));
-                } else {
-                    file << " " << static_cast<int>(color[0] * 255) << " "
-                         << static_cast<int>(color[1] * 255) << " "
-                         << static_cast<int>(color[2] * 255) << " "
-                         << static_cast<int>(color[3] * 255);
-                }
-            }
-
-            if (!isBinary) {
-                file << "\n";
+                unsigned char r = static_cast<unsigned char>(color[0] * 255);
+                unsigned char g = static_cast<unsigned char>(color[1] * 255);
+                unsigned char b = static_cast<unsigned char>(color[2] * 255);
+                unsigned char a = static_cast<unsigned char>(color[3] * 255);
+                file.write(reinterpret_cast<const char *>(&r), sizeof(unsigned char));
+                file.write(reinterpret_cast<const char *>(&g), sizeof(unsigned char));
+                file.write(reinterpret_cast<const char *>(&b), sizeof(unsigned char));
+                file.write(reinterpret_cast<const char *>(&a), sizeof(unsigned char));
             }
         }
 
         // Write face data
         for (const auto &f: mesh.faces) {
             unsigned char faceSize = static_cast<unsigned char>(mesh.get_valence(f));
-            if (isBinary) {
-                file.write(reinterpret_cast<const char *>(&faceSize), sizeof(unsigned char));
-                for (const auto &v: mesh.get_vertices(f)) {
-                    int vertexIndex = v.idx();
-                    file.write(reinterpret_cast<const char *>(&vertexIndex), sizeof(int));
-                }
-            } else {
-                file << static_cast<int>(faceSize);
-                for (const auto &v: mesh.get_vertices(f)) {
-                    file << " " << v.idx();
-                }
-                file << "\n";
+            file.write(reinterpret_cast<const char *>(&faceSize), sizeof(unsigned char));
+            for (const auto &v: mesh.get_vertices(f)) {
+                int vertexIndex = v.idx();
+                file.write(reinterpret_cast<const char *>(&vertexIndex), sizeof(int));
             }
         }
 
@@ -923,6 +998,7 @@ namespace Bcg {
         add_io(std::make_shared<MeshIoOBJ>(filename));
         add_io(std::make_shared<MeshIoSTL>(filename));
         add_io(std::make_shared<MeshIoPLY>(filename));
+        add_io(std::make_shared<MeshIoBCM>(filename));
     }
 
 
@@ -11,6 +11,13 @@
 #include <utility>
 
 namespace Bcg {
+    class JobSystem;
+
+    /**
+     * @brief Checks that a filename only consists of alphanumeric characters, underscores, hyphens, dots and slashes.
+     */
+    bool is_valid_filename(const std::string &filename);
+
     /**
      * @brief Abstract base class for mesh input/output operations.
      */
@@ -23,6 +30,7 @@ namespace Bcg {
             bool with_normals = false;
             bool with_colors = false;
             bool with_tex_coords = false;
+            JobSystem *jobs = nullptr;  /**< if set, text formats are formatted in parallel on this JobSystem. */
         };
 
         /**
@@ -0,0 +1,566 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "MeshIoStream.h"
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+namespace Bcg {
+    static std::string Extension(const std::string &filename) {
+        return std::filesystem::path(filename).extension().string();
+    }
+
+    MeshStreamReader::MeshStreamReader(std::string filename, size_t batch_size) : AssetIo(std::move(filename)),
+                                                                                  m_batch_size(std::max<size_t>(batch_size, 1)) {
+    }
+
+    bool MeshStreamReader::can_load_file() {
+        const auto extension = Extension(m_filename);
+        return extension == ".off" || extension == ".ply" || extension == ".obj";
+    }
+
+    bool MeshStreamReader::read(const VertexCallback &on_vertices, const FaceCallback &on_faces) {
+        if (!is_valid_filename(m_filename) || !can_load_file()) {
+            std::cerr << "Error: MeshStreamReader::read: Invalid filename." << std::endl;
+            return false;
+        }
+
+        std::ifstream file(m_filename, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: MeshStreamReader::read: Could not open file for reading." << std::endl;
+            return false;
+        }
+
+        file.seekg(0, std::ios::end);
+        m_file_size = static_cast<size_t>(file.tellg());
+        file.seekg(0, std::ios::beg);
+
+        m_n_vertices = 0;
+        m_n_faces = 0;
+        m_n_bytes_read = 0;
+        m_stopped = false;
+        m_vertices.clear();
+        m_faces.clear();
+        m_vertices.positions.reserve(m_batch_size);
+        m_on_vertices = &on_vertices;
+        m_on_faces = &on_faces;
+        m_file = &file;
+
+        const auto extension = Extension(m_filename);
+        bool ok;
+        if (extension == ".off") {
+            ok = read_off(file);
+        } else if (extension == ".ply") {
+            ok = read_ply(file);
+        } else {
+            ok = read_obj(file);
+        }
+        if (ok && !m_stopped) {
+            flush_faces();
+        }
+        if (ok && !m_stopped) {
+            m_n_bytes_read = m_file_size;
+        }
+
+        m_on_vertices = nullptr;
+        m_on_faces = nullptr;
+        m_file = nullptr;
+        m_vertices.clear();
+        m_faces.clear();
+        return ok;
+    }
+
+    bool MeshStreamReader::push_vertex(const Vector<Real, 3> &position) {
+        if (m_vertices.positions.empty()) {
+            m_vertices.first_index = m_n_vertices;
+        }
+        m_vertices.positions.push_back(position);
+        ++m_n_vertices;
+        return m_vertices.size() < m_batch_size || flush_vertices();
+    }
+
+    bool MeshStreamReader::push_face(const unsigned int *face, unsigned int valence) {
+        if (m_faces.size() == 0) {
+            m_faces.first_index = m_n_faces;
+        }
+        m_faces.add_face(face, valence);
+        ++m_n_faces;
+        return m_faces.size() < m_batch_size || flush_faces();
+    }
+
+    void MeshStreamReader::update_bytes_read() {
+        // tellg fails once the stream hit the end of the file, which was then consumed completely.
+        const std::streampos position = m_file->tellg();
+        m_n_bytes_read = position >= 0 ? static_cast<size_t>(position) : m_file_size;
+    }
+
+    bool MeshStreamReader::flush_vertices() {
+        if (m_stopped) return false;
+        update_bytes_read();
+        if (m_vertices.size() > 0 && *m_on_vertices && !(*m_on_vertices)(m_vertices)) {
+            m_stopped = true;
+        }
+        m_vertices.clear();
+        return !m_stopped;
+    }
+
+    bool MeshStreamReader::flush_faces() {
+        // faces may only reference vertices that were already delivered
+        if (!flush_vertices()) return false;
+        update_bytes_read();
+        if (m_faces.size() > 0 && *m_on_faces && !(*m_on_faces)(m_faces)) {
+            m_stopped = true;
+        }
+        m_faces.clear();
+        return !m_stopped;
+    }
+
+    bool MeshStreamReader::read_off(std::ifstream &file) {
+        std::string line;
+        std::getline(file, line);
+        std::istringstream header_stream(line);
+
+        size_t n_extra_floats = 0;
+        bool is_binary = false;
+        std::string token;
+        while (header_stream >> token) {
+            if (token == "ST") {
+                n_extra_floats += 2;
+            } else if (token == "C" || token == "N") {
+                n_extra_floats += 3;
+            } else if (token == "BINARY") {
+                is_binary = true;
+            } else if (token != "OFF") {
+                std::cerr << "Error: MeshStreamReader::read_off: Unsupported token in header: " << token << std::endl;
+                return false;
+            }
+        }
+
+        size_t n_vertices = 0, n_faces = 0, n_edges = 0;
+        if (is_binary) {
+            file.read(reinterpret_cast<char *>(&n_vertices), sizeof(size_t));
+            file.read(reinterpret_cast<char *>(&n_faces), sizeof(size_t));
+            file.read(reinterpret_cast<char *>(&n_edges), sizeof(size_t));
+        } else {
+            file >> n_vertices >> n_faces >> n_edges;
+        }
+        if (!file) {
+            std::cerr << "Error: MeshStreamReader::read_off: Could not read element counts." << std::endl;
+            return false;
+        }
+
+        Vector<Real, 3> position;
+        Real extra;
+        for (size_t i = 0; i < n_vertices; ++i) {
+            if (is_binary) {
+                file.read(reinterpret_cast<char *>(position.data()), sizeof(Vector<Real, 3>));
+                file.seekg(n_extra_floats * sizeof(Real), std::ios::cur);
+            } else {
+                file >> position[0] >> position[1] >> position[2];
+                for (size_t j = 0; j < n_extra_floats; ++j) file >> extra;
+            }
+            if (!file) {
+                std::cerr << "Error: MeshStreamReader::read_off: Unexpected end of vertex data." << std::endl;
+                return false;
+            }
+            if (!push_vertex(position)) return true;
+        }
+
+        std::vector<unsigned int> face;
+        for (size_t i = 0; i < n_faces; ++i) {
+            size_t valence = 0;
+            if (is_binary) {
+                file.read(reinterpret_cast<char *>(&valence), sizeof(size_t));
+                std::vector<size_t> indices(valence);
+                file.read(reinterpret_cast<char *>(indices.data()), valence * sizeof(size_t));
+                face.assign(indices.begin(), indices.end());
+            } else {
+                file >> valence;
+                face.resize(valence);
+                for (auto &index: face) file >> index;
+            }
+            if (!file) {
+                std::cerr << "Error: MeshStreamReader::read_off: Unexpected end of face data." << std::endl;
+                return false;
+            }
+            if (!is_binary) {
+                // skip optional per face colors
+                std::getline(file, line);
+            }
+            if (!push_face(face.data(), static_cast<unsigned int>(face.size()))) return true;
+        }
+        return true;
+    }
+
+    struct PlyProperty {
+        std::string name;
+        std::string type;
+        std::string list_count_type; /**< empty for scalar properties. */
+    };
+
+    struct PlyElement {
+        std::string name;
+        size_t count = 0;
+        std::vector<PlyProperty> properties;
+    };
+
+    static size_t PlyTypeSize(const std::string &type) {
+        if (type == "char" || type == "uchar" || type == "int8" || type == "uint8") return 1;
+        if (type == "short" || type == "ushort" || type == "int16" || type == "uint16") return 2;
+        if (type == "int" || type == "uint" || type == "float" || type == "int32" || type == "uint32" ||
+            type == "float32") return 4;
+        if (type == "double" || type == "float64") return 8;
+        return 0;
+    }
+
+    template<typename T>
+    static double PlyReadAs(std::ifstream &file) {
+        T value;
+        file.read(reinterpret_cast<char *>(&value), sizeof(T));
+        return static_cast<double>(value);
+    }
+
+    static double PlyReadBinary(std::ifstream &file, const std::string &type) {
+        if (type == "char" || type == "int8") return PlyReadAs<int8_t>(file);
+        if (type == "uchar" || type == "uint8") return PlyReadAs<uint8_t>(file);
+        if (type == "short" || type == "int16") return PlyReadAs<int16_t>(file);
+        if (type == "ushort" || type == "uint16") return PlyReadAs<uint16_t>(file);
+        if (type == "int" || type == "int32") return PlyReadAs<int32_t>(file);
+        if (type == "uint" || type == "uint32") return PlyReadAs<uint32_t>(file);
+        if (type == "float" || type == "float32") return PlyReadAs<float>(file);
+        return PlyReadAs<double>(file);
+    }
+
+    bool MeshStreamReader::read_ply(std::ifstream &file) {
+        std::string line;
+        bool is_binary = false;
+        std::vector<PlyElement> elements;
+
+        while (std::getline(file, line)) {
+            std::istringstream iss(line);
+            std::string token;
+            iss >> token;
+            if (token == "format") {
+                std::string format;
+                iss >> format;
+                if (format == "binary_little_endian") {
+                    is_binary = true;
+                } else if (format != "ascii") {
+                    std::cerr << "Error: MeshStreamReader::read_ply: Unsupported PLY format." << std::endl;
+                    return false;
+                }
+            } else if (token == "element") {
+                PlyElement element;
+                iss >> element.name >> element.count;
+                elements.push_back(element);
+            } else if (token == "property" && !elements.empty()) {
+                PlyProperty property;
+                iss >> property.type;
+                if (property.type == "list") {
+                    iss >> property.list_count_type >> property.type;
+                }
+                iss >> property.name;
+                if (PlyTypeSize(property.type) == 0 ||
+                    (!property.list_count_type.empty() && PlyTypeSize(property.list_count_type) == 0)) {
+                    std::cerr << "Error: MeshStreamReader::read_ply: Unsupported property type." << std::endl;
+                    return false;
+                }
+                elements.back().properties.push_back(property);
+            } else if (token == "end_header") {
+                break;
+            }
+        }
+
+        auto read_value = [&](const std::string &type) {
+            if (is_binary) {
+                return PlyReadBinary(file, type);
+            }
+            double value = 0;
+            file >> value;
+            return value;
+        };
+
+        std::vector<unsigned int> face;
+        for (const auto &element: elements) {
+            const bool is_vertex = element.name == "vertex";
+            const bool is_face = element.name == "face";
+            for (size_t i = 0; i < element.count; ++i) {
+                Vector<Real, 3> position = Vector<Real, 3>::Zero();
+                bool has_face = false;
+                for (const auto &property: element.properties) {
+                    if (property.list_count_type.empty()) {
+                        double value = read_value(property.type);
+                        if (is_vertex) {
+                            if (property.name == "x") position[0] = value;
+                            else if (property.name == "y") position[1] = value;
+                            else if (property.name == "z") position[2] = value;
+                        }
+                    } else {
+                        auto count = static_cast<size_t>(read_value(property.list_count_type));
+                        const bool is_indices = is_face && (property.name == "vertex_indices" ||
+                                                            property.name == "vertex_index");
+                        if (is_indices) face.resize(count);
+                        for (size_t j = 0; j < count; ++j) {
+                            double value = read_value(property.type);
+                            if (is_indices) face[j] = static_cast<unsigned int>(value);
+                        }
+                        has_face |= is_indices;
+                    }
+                }
+                if (!file) {
+                    std::cerr << "Error: MeshStreamReader::read_ply: Unexpected end of " << element.name
+                              << " data." << std::endl;
+                    return false;
+                }
+                if (is_vertex && !push_vertex(position)) return true;
+                if (has_face && !push_face(face.data(), static_cast<unsigned int>(face.size()))) return true;
+            }
+        }
+        return true;
+    }
+
+    static bool ParseObjIndex(const std::string &token, size_t n_vertices, unsigned int &index) {
+        const auto end = token.find('/');
+        const long value = std::strtol(token.substr(0, end).c_str(), nullptr, 10);
+        if (value > 0) {
+            index = static_cast<unsigned int>(value - 1);
+        } else if (value < 0 && static_cast<size_t>(-value) <= n_vertices) {
+            index = static_cast<unsigned int>(n_vertices + value);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    bool MeshStreamReader::read_obj(std::ifstream &file) {
+        std::string line, prefix, token;
+        std::vector<unsigned int> face;
+        Vector<Real, 3> position;
+
+        while (std::getline(file, line)) {
+            if (line.size() < 2 || (line[0] != 'v' && line[0] != 'f') || !std::isspace(line[1])) {
+                continue; // comments, normals, texture coordinates, groups, materials
+            }
+            std::istringstream iss(line);
+            iss >> prefix;
+            if (prefix == "v") {
+                if (!(iss >> position[0] >> position[1] >> position[2])) {
+                    std::cerr << "Error: MeshStreamReader::read_obj: Invalid vertex: " << line << std::endl;
+                    return false;
+                }
+                if (!push_vertex(position)) return true;
+            } else {
+                face.clear();
+                while (iss >> token) {
+                    unsigned int index;
+                    if (!ParseObjIndex(token, m_n_vertices, index)) {
+                        std::cerr << "Error: MeshStreamReader::read_obj: Invalid face: " << line << std::endl;
+                        return false;
+                    }
+                    face.push_back(index);
+                }
+                if (!push_face(face.data(), static_cast<unsigned int>(face.size()))) return true;
+            }
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------------------------------------------------------------
+
+    static constexpr int CountFieldWidth = 20;
+
+    MeshStreamWriter::MeshStreamWriter(std::string filename, MeshIo::WriteFlags flags) : AssetIo(std::move(filename)),
+        m_flags(flags) {
+        const auto extension = Extension(m_filename);
+        if (extension == ".off") {
+            m_format = Format::OFF;
+        } else if (extension == ".ply") {
+            m_format = Format::PLY;
+        } else if (extension == ".obj") {
+            m_format = Format::OBJ;
+        }
+    }
+
+    MeshStreamWriter::~MeshStreamWriter() {
+        if (m_file.is_open()) {
+            close();
+        }
+    }
+
+    bool MeshStreamWriter::can_load_file() {
+        return m_format != Format::Unknown;
+    }
+
+    bool MeshStreamWriter::open() {
+        if (!is_valid_filename(m_filename) || !can_load_file()) {
+            std::cerr << "Error: MeshStreamWriter::open: Invalid filename." << std::endl;
+            return false;
+        }
+
+        const bool is_binary = m_flags.as_binary && m_format != Format::OBJ;
+        m_file.open(m_filename, is_binary ? (std::ios::out | std::ios::binary) : std::ios::out);
+        if (!m_file.is_open()) {
+            std::cerr << "Error: MeshStreamWriter::open: Could not open file for writing." << std::endl;
+            return false;
+        }
+
+        m_n_vertices = 0;
+        m_n_faces = 0;
+        const std::string placeholder(CountFieldWidth, ' ');
+        if (m_format == Format::OFF) {
+            if (is_binary) {
+                m_file << "OFF BINARY\n";
+                m_vertex_count_pos = m_file.tellp();
+                const size_t zero = 0;
+                for (int i = 0; i < 3; ++i) {
+                    m_file.write(reinterpret_cast<const char *>(&zero), sizeof(size_t));
+                }
+            } else {
+                m_file << "OFF\n";
+                m_vertex_count_pos = m_file.tellp();
+                m_file << placeholder << " ";
+                m_face_count_pos = m_file.tellp();
+                m_file << placeholder << " 0\n";
+            }
+        } else if (m_format == Format::PLY) {
+            m_file << "ply\n";
+            m_file << (is_binary ? "format binary_little_endian 1.0\n" : "format ascii 1.0\n");
+            m_file << "element vertex ";
+            m_vertex_count_pos = m_file.tellp();
+            m_file << placeholder << "\n";
+            m_file << "property float x\n";
+            m_file << "property float y\n";
+            m_file << "property float z\n";
+            m_file << "element face ";
+            m_face_count_pos = m_file.tellp();
+            m_file << placeholder << "\n";
+            m_file << "property list uchar int vertex_indices\n";
+            m_file << "end_header\n";
+        } else {
+            m_file << "# OBJ export from BCG\n";
+        }
+        return m_file.good();
+    }
+
+    bool MeshStreamWriter::write_vertices(const MeshStreamVertexBatch &batch) {
+        if (!m_file.is_open()) {
+            std::cerr << "Error: MeshStreamWriter::write_vertices: File is not open." << std::endl;
+            return false;
+        }
+        if (m_format != Format::OBJ && m_n_faces > 0) {
+            std::cerr << "Error: MeshStreamWriter::write_vertices: OFF and PLY require vertices before faces."
+                      << std::endl;
+            return false;
+        }
+
+        m_buffer.clear();
+        auto out = std::back_inserter(m_buffer);
+        const bool is_binary = m_flags.as_binary && m_format != Format::OBJ;
+        for (const auto &p: batch.positions) {
+            if (is_binary) {
+                m_buffer.append(reinterpret_cast<const char *>(p.data()), sizeof(Vector<Real, 3>));
+            } else if (m_format == Format::OFF) {
+                fmt::format_to(out, "{:.6f} {:.6f} {:.6f}\n", p[0], p[1], p[2]);
+            } else if (m_format == Format::PLY) {
+                fmt::format_to(out, "{:g} {:g} {:g}\n", p[0], p[1], p[2]);
+            } else {
+                fmt::format_to(out, "v {:.10f} {:.10f} {:.10f}\n", p[0], p[1], p[2]);
+            }
+        }
+        m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+        m_n_vertices += batch.size();
+        return m_file.good();
+    }
+
+    bool MeshStreamWriter::write_faces(const MeshStreamFaceBatch &batch) {
+        if (!m_file.is_open()) {
+            std::cerr << "Error: MeshStreamWriter::write_faces: File is not open." << std::endl;
+            return false;
+        }
+
+        m_buffer.clear();
+        auto out = std::back_inserter(m_buffer);
+        const bool is_binary = m_flags.as_binary && m_format != Format::OBJ;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const unsigned int valence = batch.get_valence(i);
+            const unsigned int *face = batch.get_indices(i);
+            if (is_binary && m_format == Format::OFF) {
+                const size_t size = valence;
+                m_buffer.append(reinterpret_cast<const char *>(&size), sizeof(size_t));
+                for (unsigned int j = 0; j < valence; ++j) {
+                    const size_t index = face[j];
+                    m_buffer.append(reinterpret_cast<const char *>(&index), sizeof(size_t));
+                }
+            } else if (is_binary) {
+                const auto size = static_cast<unsigned char>(valence);
+                m_buffer.push_back(static_cast<char>(size));
+                for (unsigned int j = 0; j < valence; ++j) {
+                    const int index = static_cast<int>(face[j]);
+                    m_buffer.append(reinterpret_cast<const char *>(&index), sizeof(int));
+                }
+            } else if (m_format == Format::OBJ) {
+                m_buffer.push_back('f');
+                for (unsigned int j = 0; j < valence; ++j) {
+                    fmt::format_to(out, " {}", face[j] + 1);
+                }
+                m_buffer.push_back('\n');
+            } else {
+                fmt::format_to(out, "{}", valence);
+                for (unsigned int j = 0; j < valence; ++j) {
+                    fmt::format_to(out, " {}", face[j]);
+                }
+                m_buffer.push_back('\n');
+            }
+        }
+        m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+        m_n_faces += batch.size();
+        return m_file.good();
+    }
+
+    bool MeshStreamWriter::close() {
+        if (!m_file.is_open()) {
+            return false;
+        }
+
+        if (m_format == Format::OFF && m_flags.as_binary) {
+            m_file.seekp(m_vertex_count_pos);
+            m_file.write(reinterpret_cast<const char *>(&m_n_vertices), sizeof(size_t));
+            m_file.write(reinterpret_cast<const char *>(&m_n_faces), sizeof(size_t));
+        } else if (m_format != Format::OBJ) {
+            m_file.seekp(m_vertex_count_pos);
+            m_file << fmt::format("{:<{}}", m_n_vertices, CountFieldWidth);
+            m_file.seekp(m_face_count_pos);
+            m_file << fmt::format("{:<{}}", m_n_faces, CountFieldWidth);
+        }
+
+        const bool ok = m_file.good();
+        m_file.close();
+        return ok;
+    }
+
+    bool PipeMeshStream(MeshStreamReader &reader, MeshStreamWriter &writer,
+                        const std::function<void(MeshStreamVertexBatch &)> &vertex_filter,
+                        const std::function<void(MeshStreamFaceBatch &)> &face_filter) {
+        if (!writer.open()) {
+            return false;
+        }
+
+        bool write_ok = true;
+        const bool read_ok = reader.read([&](MeshStreamVertexBatch &batch) {
+            if (vertex_filter) vertex_filter(batch);
+            write_ok = writer.write_vertices(batch);
+            return write_ok;
+        }, [&](MeshStreamFaceBatch &batch) {
+            if (face_filter) face_filter(batch);
+            write_ok = writer.write_faces(batch);
+            return write_ok;
+        });
+
+        return writer.close() && read_ok && write_ok;
+    }
+}
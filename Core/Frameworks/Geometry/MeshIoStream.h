@@ -0,0 +1,193 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef ENGINE25_MESHIOSTREAM_H
+#define ENGINE25_MESHIOSTREAM_H
+
+#include "MeshIo.h"
+#include <fstream>
+#include <functional>
+
+namespace Bcg {
+    /**
+     * @brief A batch of consecutive vertices of a streamed mesh.
+     */
+    struct MeshStreamVertexBatch {
+        size_t first_index = 0;                     /**< global index of positions[0] in the file. */
+        std::vector<Vector<Real, 3> > positions;
+
+        [[nodiscard]] size_t size() const { return positions.size(); }
+
+        void clear() { positions.clear(); }
+    };
+
+    /**
+     * @brief A batch of consecutive faces of a streamed mesh, stored as flat index lists.
+     *
+     * Face i of the batch references the global vertex indices indices[offsets[i]] ... indices[offsets[i + 1] - 1].
+     */
+    struct MeshStreamFaceBatch {
+        size_t first_index = 0;                     /**< global index of the first face of the batch in the file. */
+        std::vector<unsigned int> offsets{0};
+        std::vector<unsigned int> indices;
+
+        [[nodiscard]] size_t size() const { return offsets.size() - 1; }
+
+        [[nodiscard]] unsigned int get_valence(size_t i) const { return offsets[i + 1] - offsets[i]; }
+
+        [[nodiscard]] const unsigned int *get_indices(size_t i) const { return indices.data() + offsets[i]; }
+
+        void add_face(const unsigned int *face, unsigned int valence) {
+            indices.insert(indices.end(), face, face + valence);
+            offsets.push_back(static_cast<unsigned int>(indices.size()));
+        }
+
+        void clear() {
+            offsets.assign(1, 0);
+            indices.clear();
+        }
+    };
+
+    /**
+     * @brief Reads OFF, PLY or OBJ files in fixed-size batches without building a Mesh.
+     *
+     * Only one vertex batch and one face batch are held in memory at any time, so files larger than the available
+     * memory can be processed. Vertices are always delivered before the faces that reference them. The batches are
+     * reused between callbacks and may be modified in place, which allows filters to forward them to a
+     * MeshStreamWriter.
+     */
+    class MeshStreamReader : public AssetIo {
+    public:
+        /**
+         * @brief Callback receiving a batch. Returning false stops the stream.
+         */
+        using VertexCallback = std::function<bool(MeshStreamVertexBatch &)>;
+        using FaceCallback = std::function<bool(MeshStreamFaceBatch &)>;
+
+        /**
+         * @brief Constructs a MeshStreamReader.
+         * @param filename The OFF, PLY or OBJ file to stream.
+         * @param batch_size The maximum number of vertices or faces per batch.
+         */
+        explicit MeshStreamReader(std::string filename, size_t batch_size = 65536);
+
+        /**
+         * @brief Streams the whole file through the callbacks.
+         * @param on_vertices Called for every vertex batch, may be empty.
+         * @param on_faces Called for every face batch, may be empty.
+         * @return True if the file was read completely or a callback stopped the stream, false on errors.
+         */
+        bool read(const VertexCallback &on_vertices, const FaceCallback &on_faces);
+
+        bool can_load_file() override;
+
+        [[nodiscard]] size_t get_batch_size() const { return m_batch_size; }
+
+        [[nodiscard]] size_t n_vertices_read() const { return m_n_vertices; }
+
+        [[nodiscard]] size_t n_faces_read() const { return m_n_faces; }
+
+        /**
+         * @brief The number of bytes consumed when the current batch was delivered, for progress reports from the
+         * callbacks. Equals file_size() after a complete read.
+         */
+        [[nodiscard]] size_t n_bytes_read() const { return m_n_bytes_read; }
+
+        /**
+         * @brief The size of the file in bytes, known once read() has opened it.
+         */
+        [[nodiscard]] size_t file_size() const { return m_file_size; }
+
+    private:
+        bool read_off(std::ifstream &file);
+
+        bool read_ply(std::ifstream &file);
+
+        bool read_obj(std::ifstream &file);
+
+        bool push_vertex(const Vector<Real, 3> &position);
+
+        bool push_face(const unsigned int *face, unsigned int valence);
+
+        bool flush_vertices();
+
+        bool flush_faces();
+
+        void update_bytes_read();
+
+        size_t m_batch_size;
+        size_t m_n_vertices = 0;
+        size_t m_n_faces = 0;
+        size_t m_n_bytes_read = 0;
+        size_t m_file_size = 0;
+        bool m_stopped = false;
+        std::ifstream *m_file = nullptr;
+        MeshStreamVertexBatch m_vertices;
+        MeshStreamFaceBatch m_faces;
+        const VertexCallback *m_on_vertices = nullptr;
+        const FaceCallback *m_on_faces = nullptr;
+    };
+
+    /**
+     * @brief Writes OFF, PLY or OBJ files batch by batch.
+     *
+     * Element counts do not need to be known in advance: OFF and PLY headers are written with fixed width
+     * placeholders and patched in close(). OFF and PLY require all vertices to be written before the first face.
+     * Binary output (WriteFlags::as_binary) is supported for OFF and PLY in the layout of MeshIoOFF and MeshIoPLY.
+     */
+    class MeshStreamWriter : public AssetIo {
+    public:
+        explicit MeshStreamWriter(std::string filename, MeshIo::WriteFlags flags = MeshIo::WriteFlags());
+
+        ~MeshStreamWriter() override;
+
+        /**
+         * @brief Opens the file and writes the header.
+         */
+        bool open();
+
+        bool write_vertices(const MeshStreamVertexBatch &batch);
+
+        bool write_faces(const MeshStreamFaceBatch &batch);
+
+        /**
+         * @brief Patches the element counts into the header and closes the file.
+         */
+        bool close();
+
+        bool can_load_file() override;
+
+        [[nodiscard]] size_t n_vertices_written() const { return m_n_vertices; }
+
+        [[nodiscard]] size_t n_faces_written() const { return m_n_faces; }
+
+    private:
+        enum class Format {
+            OFF, PLY, OBJ, Unknown
+        };
+
+        Format m_format = Format::Unknown;
+        MeshIo::WriteFlags m_flags;
+        std::ofstream m_file;
+        std::streampos m_vertex_count_pos = -1;
+        std::streampos m_face_count_pos = -1;
+        size_t m_n_vertices = 0;
+        size_t m_n_faces = 0;
+        std::string m_buffer;
+    };
+
+    /**
+     * @brief Streams a mesh file-to-file, applying optional in-place filters to each batch.
+     * @param reader The source stream.
+     * @param writer The destination stream, opened and closed by this function.
+     * @param vertex_filter Called on every vertex batch before it is written, may be empty.
+     * @param face_filter Called on every face batch before it is written, may be empty.
+     * @return True if the whole file was streamed and written.
+     */
+    bool PipeMeshStream(MeshStreamReader &reader, MeshStreamWriter &writer,
+                        const std::function<void(MeshStreamVertexBatch &)> &vertex_filter = {},
+                        const std::function<void(MeshStreamFaceBatch &)> &face_filter = {});
+}
+
+#endif //ENGINE25_MESHIOSTREAM_H
@@ -0,0 +1,255 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "PointCloudKdTree.h"
+#include "AABBUtils.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+
+namespace Bcg {
+    // A node waiting to be visited with its range of points and its squared distance to the query point.
+    struct KdTreeTask {
+        uint32_t node;
+        uint32_t begin;
+        uint32_t end;
+        Real sq_distance;
+    };
+
+    // The tree has at most 33 levels for 32 bit indices, a traversal defers at most one node per level.
+    static constexpr size_t max_stack_size = 64;
+
+    // The range of points of the j-th node on a level, the left child of a node gets the smaller half.
+    static void NodeRange(size_t n, size_t level, size_t j, size_t &begin, size_t &end) {
+        begin = 0;
+        end = n;
+        for (size_t bit = level; bit-- > 0;) {
+            const size_t middle = begin + (end - begin) / 2;
+            if ((j >> bit) & 1) {
+                begin = middle;
+            } else {
+                end = middle;
+            }
+        }
+    }
+
+    // Orders neighbors by distance and ties by index, the top of a max heap is the farthest of the k found so far.
+    static bool CloserThan(const KdTree::Neighbor &lhs, const KdTree::Neighbor &rhs) {
+        return lhs.sq_distance < rhs.sq_distance || (lhs.sq_distance == rhs.sq_distance && lhs.v.idx() < rhs.v.idx());
+    }
+
+    // Whether the box contains the other box, so all of its points are inside without testing them.
+    static bool Contains(const AABB<Real, 3> &box, const AABB<Real, 3> &other) {
+        return (box.min().array() <= other.min().array()).all() && (other.max().array() <= box.max().array()).all();
+    }
+
+    KdTree::KdTree(const PointCloud &cloud, JobSystem *jobs) : cloud(cloud), jobs(jobs) {
+    }
+
+    bool KdTree::build() {
+        nodes.clear();
+        indices.clear();
+        depth = 0;
+        positions = cloud.get_vertex_property<Vector<Real, 3> >("v:position");
+        if (!positions) {
+            std::cerr << "Error: KdTree::build: The point cloud has no \"v:position\"." << std::endl;
+            return false;
+        }
+        indices.reserve(cloud.n_vertices());
+        for (const Vertex &v: cloud.vertices) {
+            if (!cloud.is_deleted(v)) indices.push_back(static_cast<uint32_t>(v.idx()));
+        }
+        const size_t n = indices.size();
+        if (n == 0) return true;
+        constexpr size_t grain_size = 4096;
+        const size_t leaf_size = std::max<size_t>(1, max_leaf_size);
+        // The largest leaf of a level holds the rounded up share of the points.
+        while (((n - 1) >> depth) + 1 > leaf_size) ++depth;
+        nodes.assign((size_t(2) << depth) - 1, AABB<Real, 3>());
+
+        // Every level bounds its nodes and splits them at the median, ranges of the upper levels are bounded in
+        // parallel chunks. The median is unique with the ties broken by index, so the order of the points only
+        // depends on the input.
+        for (size_t level = 0; level <= depth; ++level) {
+            const size_t first = (size_t(1) << level) - 1, count = size_t(1) << level;
+            ParallelFor(jobs, 0, count, 1, [&](size_t job_begin, size_t job_end) {
+                for (size_t j = job_begin; j < job_end; ++j) {
+                    size_t begin, end;
+                    NodeRange(n, level, j, begin, end);
+                    AABB<Real, 3> aabb;
+                    std::mutex mutex;
+                    ParallelFor(end - begin > 16 * grain_size ? jobs : nullptr, begin, end, 4 * grain_size,
+                                [&](size_t chunk_begin, size_t chunk_end) {
+                                    AABB<Real, 3> local;
+                                    for (size_t i = chunk_begin; i < chunk_end; ++i) {
+                                        local.grow(positions[Vertex(indices[i])]);
+                                    }
+                                    std::scoped_lock lock(mutex);
+                                    aabb = Merge(aabb, local);
+                                });
+                    nodes[first + j] = aabb;
+                    if (level == depth || end - begin < 2) continue;
+
+                    const Vector<Real, 3> extent = aabb.max() - aabb.min();
+                    int axis = 0;
+                    for (int a = 1; a < 3; ++a) {
+                        if (extent[a] > extent[axis]) axis = a;
+                    }
+                    std::nth_element(indices.begin() + begin, indices.begin() + begin + (end - begin) / 2,
+                                     indices.begin() + end, [&](uint32_t lhs, uint32_t rhs) {
+                                         const Real l = positions[Vertex(lhs)][axis];
+                                         const Real r = positions[Vertex(rhs)][axis];
+                                         return l < r || (l == r && lhs < rhs);
+                                     });
+                }
+            });
+        }
+        return true;
+    }
+
+    void KdTree::knn_query(const Vector<Real, 3> &point, size_t k, std::vector<Neighbor> &neighbors) const {
+        neighbors.clear();
+        if (nodes.empty() || k == 0) return;
+        const size_t first_leaf = (size_t(1) << depth) - 1;
+        // The k closest points so far in a max heap, the farthest one bounds the search.
+        auto bound = [&]() {
+            return neighbors.size() < k ? std::numeric_limits<Real>::max() : neighbors.front().sq_distance;
+        };
+        KdTreeTask stack[max_stack_size];
+        size_t size = 0;
+        KdTreeTask current = {0, 0, static_cast<uint32_t>(indices.size()), MinSqDist(nodes[0], point)};
+        while (true) {
+            if (current.node >= first_leaf) {
+                for (uint32_t i = current.begin; i < current.end; ++i) {
+                    const Vertex v(indices[i]);
+                    const Neighbor candidate = {v, (positions[v] - point).squaredNorm()};
+                    if (neighbors.size() < k) {
+                        neighbors.push_back(candidate);
+                        std::push_heap(neighbors.begin(), neighbors.end(), CloserThan);
+                    } else if (CloserThan(candidate, neighbors.front())) {
+                        std::pop_heap(neighbors.begin(), neighbors.end(), CloserThan);
+                        neighbors.back() = candidate;
+                        std::push_heap(neighbors.begin(), neighbors.end(), CloserThan);
+                    }
+                }
+            } else {
+                // Descend into the child whose box is closer first, the other one is pruned later if possible. Boxes
+                // at exactly the bound are visited, they may hold a tie with a smaller index.
+                const uint32_t middle = current.begin + (current.end - current.begin) / 2;
+                const KdTreeTask left = {2 * current.node + 1, current.begin, middle,
+                                         MinSqDist(nodes[2 * current.node + 1], point)};
+                const KdTreeTask right = {2 * current.node + 2, middle, current.end,
+                                          MinSqDist(nodes[2 * current.node + 2], point)};
+                const Real best = bound();
+                if (left.sq_distance <= best && right.sq_distance <= best) {
+                    const bool left_first = left.sq_distance <= right.sq_distance;
+                    stack[size++] = left_first ? right : left;
+                    current = left_first ? left : right;
+                    continue;
+                }
+                if (left.sq_distance <= best || right.sq_distance <= best) {
+                    current = left.sq_distance <= best ? left : right;
+                    continue;
+                }
+            }
+            bool found = false;
+            while (size > 0 && !found) {
+                current = stack[--size];
+                found = current.sq_distance <= bound();
+            }
+            if (!found) break;
+        }
+        std::sort_heap(neighbors.begin(), neighbors.end(), CloserThan);
+    }
+
+    void KdTree::radius_query(const Vector<Real, 3> &point, Real radius, std::vector<Neighbor> &neighbors) const {
+        neighbors.clear();
+        if (nodes.empty() || radius < 0) return;
+        const size_t first_leaf = (size_t(1) << depth) - 1;
+        const Real sq_radius = radius * radius;
+        KdTreeTask stack[max_stack_size];
+        size_t size = 0;
+        stack[size++] = {0, 0, static_cast<uint32_t>(indices.size()), 0};
+        while (size > 0) {
+            const KdTreeTask task = stack[--size];
+            if (MinSqDist(nodes[task.node], point) > sq_radius) continue;
+            if (task.node >= first_leaf) {
+                for (uint32_t i = task.begin; i < task.end; ++i) {
+                    const Vertex v(indices[i]);
+                    const Real sq_distance = (positions[v] - point).squaredNorm();
+                    if (sq_distance <= sq_radius) neighbors.push_back({v, sq_distance});
+                }
+            } else {
+                const uint32_t middle = task.begin + (task.end - task.begin) / 2;
+                stack[size++] = {2 * task.node + 2, middle, task.end, 0};
+                stack[size++] = {2 * task.node + 1, task.begin, middle, 0};
+            }
+        }
+    }
+
+    void KdTree::box_query(const AABB<Real, 3> &box, std::vector<Vertex> &vertices) const {
+        vertices.clear();
+        if (nodes.empty()) return;
+        const size_t first_leaf = (size_t(1) << depth) - 1;
+        KdTreeTask stack[max_stack_size];
+        size_t size = 0;
+        stack[size++] = {0, 0, static_cast<uint32_t>(indices.size()), 0};
+        while (size > 0) {
+            const KdTreeTask task = stack[--size];
+            const AABB<Real, 3> &aabb = nodes[task.node];
+            if (task.begin == task.end || !Intersects(box, aabb)) continue;
+            if (Contains(box, aabb)) {
+                for (uint32_t i = task.begin; i < task.end; ++i) {
+                    vertices.emplace_back(indices[i]);
+                }
+            } else if (task.node >= first_leaf) {
+                for (uint32_t i = task.begin; i < task.end; ++i) {
+                    const Vertex v(indices[i]);
+                    const Vector<Real, 3> &p = positions[v];
+                    if ((box.min().array() <= p.array()).all() && (p.array() <= box.max().array()).all()) {
+                        vertices.push_back(v);
+                    }
+                }
+            } else {
+                const uint32_t middle = task.begin + (task.end - task.begin) / 2;
+                stack[size++] = {2 * task.node + 2, middle, task.end, 0};
+                stack[size++] = {2 * task.node + 1, task.begin, middle, 0};
+            }
+        }
+    }
+
+    void KdTree::knn_query(const std::vector<Vector<Real, 3> > &points, size_t k,
+                           std::vector<Neighbor> &neighbors) const {
+        neighbors.assign(points.size() * k, Neighbor());
+        ParallelFor(jobs, 0, points.size(), 256, [&](size_t begin, size_t end) {
+            std::vector<Neighbor> found;
+            found.reserve(k);
+            for (size_t i = begin; i < end; ++i) {
+                knn_query(points[i], k, found);
+                std::copy(found.begin(), found.end(), neighbors.begin() + i * k);
+            }
+        });
+    }
+
+    void KdTree::radius_query(const std::vector<Vector<Real, 3> > &points, Real radius,
+                              std::vector<std::vector<Neighbor> > &neighbors) const {
+        neighbors.resize(points.size());
+        ParallelFor(jobs, 0, points.size(), 256, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                radius_query(points[i], radius, neighbors[i]);
+            }
+        });
+    }
+
+    void KdTree::box_query(const std::vector<AABB<Real, 3> > &boxes,
+                           std::vector<std::vector<Vertex> > &vertices) const {
+        vertices.resize(boxes.size());
+        ParallelFor(jobs, 0, boxes.size(), 256, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                box_query(boxes[i], vertices[i]);
+            }
+        });
+    }
+}
@@ -0,0 +1,107 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef POINTCLOUDKDTREE_H
+#define POINTCLOUDKDTREE_H
+
+#include "AABB.h"
+#include "PointCloud.h"
+
+namespace Bcg {
+    class JobSystem;
+
+    /**
+     * @brief KdTree: A kd-tree over the points of a point cloud for k nearest neighbor, radius and box queries.
+     *
+     * The tree indexes "v:position" in place, it only keeps a permutation of the point indices and the bounds of its
+     * nodes. It is balanced by median splits along the largest extent of a node, so its shape only depends on the
+     * number of points: the nodes are stored level by level with the children of node i at 2i + 1 and 2i + 2, and the
+     * range of points of a node follows from its position. The nodes of one level are split in parallel if a
+     * JobSystem is given, and the result does not depend on the number of threads.
+     *
+     * The tree has to be rebuilt with build() after points were added, moved or deleted.
+     */
+    class KdTree {
+    public:
+        /**
+         * @brief A point found by a query and its squared distance to the query point.
+         */
+        struct Neighbor {
+            Vertex v; /**< The point, invalid if fewer than k points were found. */
+            Real sq_distance = std::numeric_limits<Real>::max(); /**< The squared distance to the query point. */
+        };
+
+        /**
+         * @brief Constructs a KdTree object for the given point cloud, the tree is built by build().
+         * @param cloud The point cloud, its points are read from "v:position".
+         * @param jobs If set, the tree is built and batches of queries run in parallel on this JobSystem.
+         */
+        explicit KdTree(const PointCloud &cloud, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Builds the tree over the points of the cloud which are not deleted.
+         * @return True if successful, false if the cloud has no "v:position".
+         */
+        bool build();
+
+        /**
+         * @brief Finds the k nearest points to a point, a point of the cloud finds itself first.
+         * @param point The query point.
+         * @param k The number of neighbors.
+         * @param neighbors The min(k, number of points) nearest points by increasing distance, ties by index.
+         */
+        void knn_query(const Vector<Real, 3> &point, size_t k, std::vector<Neighbor> &neighbors) const;
+
+        /**
+         * @brief Finds all points within a distance of a point.
+         * @param point The query point.
+         * @param radius The distance, points at exactly this distance are included.
+         * @param neighbors The points in no particular order.
+         */
+        void radius_query(const Vector<Real, 3> &point, Real radius, std::vector<Neighbor> &neighbors) const;
+
+        /**
+         * @brief Finds all points inside a box, including its boundary.
+         * @param box The box.
+         * @param vertices The points in no particular order.
+         */
+        void box_query(const AABB<Real, 3> &box, std::vector<Vertex> &vertices) const;
+
+        /**
+         * @brief Finds the k nearest points to a batch of points, in parallel if a JobSystem is given.
+         * @param points The query points.
+         * @param k The number of neighbors per query point.
+         * @param neighbors The k neighbors of every query point row major, missing neighbors are invalid.
+         */
+        void knn_query(const std::vector<Vector<Real, 3> > &points, size_t k, std::vector<Neighbor> &neighbors) const;
+
+        /**
+         * @brief Finds the points within a distance of a batch of points, in parallel if a JobSystem is given.
+         * @param points The query points.
+         * @param radius The distance.
+         * @param neighbors The points found for every query point, resized to the number of query points.
+         */
+        void radius_query(const std::vector<Vector<Real, 3> > &points, Real radius,
+                          std::vector<std::vector<Neighbor> > &neighbors) const;
+
+        /**
+         * @brief Finds the points inside a batch of boxes, in parallel if a JobSystem is given.
+         * @param boxes The boxes.
+         * @param vertices The points found for every box, resized to the number of boxes.
+         */
+        void box_query(const std::vector<AABB<Real, 3> > &boxes, std::vector<std::vector<Vertex> > &vertices) const;
+
+        std::vector<AABB<Real, 3> > nodes; /**< The bounds of the nodes level by level, the root comes first. */
+        std::vector<uint32_t> indices; /**< The indices of the points in leaf order. */
+        size_t depth = 0; /**< The level of the leaves, the tree has 2^(depth + 1) - 1 nodes. */
+        size_t max_leaf_size = 8; /**< The tree is split until no leaf holds more points than this. */
+
+    private:
+        const PointCloud &cloud; /**< The point cloud whose points are indexed. */
+        JobSystem *jobs; /**< The optional JobSystem used for the build and the batches. */
+        VertexProperty<Vector<Real, 3> > positions; /**< The positions of the last build, read in place. */
+    };
+}
+
+#endif //POINTCLOUDKDTREE_H
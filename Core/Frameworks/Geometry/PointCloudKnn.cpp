@@ -0,0 +1,391 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "PointCloudKnn.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <mutex>
+#include <random>
+
+namespace Bcg {
+    // A candidate neighbor, the candidates are ordered by distance and then by index.
+    struct KnnCandidate {
+        Real sq_distance;
+        uint32_t index;
+
+        bool operator<(const KnnCandidate &other) const {
+            return sq_distance < other.sq_distance || (sq_distance == other.sq_distance && index < other.index);
+        }
+    };
+
+    // A uniform grid over the points of which only the occupied cells are stored. The points are sorted by their
+    // cells and an open addressing hash table maps the key of a cell to its range in the sorted points.
+    struct KnnGrid {
+        struct Slot {
+            uint64_t key = std::numeric_limits<uint64_t>::max();
+            uint32_t begin = 0;
+            uint32_t end = 0;
+        };
+
+        static constexpr int64_t max_cells = (int64_t(1) << 21) - 1; /**< The number of cells per axis fits 21 bits. */
+
+        Vector<Real, 3> origin;
+        Real cell_size = 1;
+        std::array<int64_t, 3> dims{1, 1, 1};
+        std::vector<uint32_t> order; /**< The indices of the points sorted by their cells. */
+        std::vector<Vector<Real, 3> > points; /**< The positions of the points in the same order. */
+        std::vector<Slot> table;
+        uint64_t mask = 0;
+        size_t n_cells = 0;
+
+        std::array<int64_t, 3> get_cell(const Vector<Real, 3> &p) const {
+            std::array<int64_t, 3> cell;
+            for (int a = 0; a < 3; ++a) {
+                const auto c = static_cast<int64_t>((p[a] - origin[a]) / cell_size);
+                cell[a] = std::clamp<int64_t>(c, 0, dims[a] - 1);
+            }
+            return cell;
+        }
+
+        static uint64_t get_key(int64_t x, int64_t y, int64_t z) {
+            return static_cast<uint64_t>(x) | static_cast<uint64_t>(y) << 21 | static_cast<uint64_t>(z) << 42;
+        }
+
+        static uint64_t hash(uint64_t key) {
+            key ^= key >> 33;
+            key *= 0xFF51AFD7ED558CCDull;
+            return key ^ key >> 33;
+        }
+
+        // Returns the slot of the cell, its range is empty if the cell holds no points.
+        const Slot *find(uint64_t key) const {
+            for (uint64_t i = hash(key) & mask;; i = (i + 1) & mask) {
+                const Slot &slot = table[i];
+                if (slot.key == key || slot.key == std::numeric_limits<uint64_t>::max()) return &slot;
+            }
+        }
+    };
+
+    // Sorts chunks in parallel and merges them pairwise in rounds.
+    template<typename T>
+    static void ParallelSort(JobSystem *jobs, std::vector<T> &items) {
+        constexpr size_t chunk_size = 1 << 16;
+        const size_t n = items.size();
+        const size_t n_chunks = (n + chunk_size - 1) / chunk_size;
+        ParallelFor(jobs, 0, n_chunks, 1, [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                std::sort(items.begin() + c * chunk_size, items.begin() + std::min(n, (c + 1) * chunk_size));
+            }
+        });
+        for (size_t width = chunk_size; width < n; width *= 2) {
+            const size_t n_merges = (n + 2 * width - 1) / (2 * width);
+            ParallelFor(jobs, 0, n_merges, 1, [&](size_t begin, size_t end) {
+                for (size_t m = begin; m < end; ++m) {
+                    const size_t first = m * 2 * width;
+                    const size_t middle = std::min(n, first + width), last = std::min(n, first + 2 * width);
+                    std::inplace_merge(items.begin() + first, items.begin() + middle, items.begin() + last);
+                }
+            });
+        }
+    }
+
+    // Builds the grid over the valid points. The cell size starts from the volume of the bounding box and is rescaled
+    // until a random sample of the points reports about target points per own cell, which adapts it to samples of
+    // curves and surfaces as well.
+    static void BuildGrid(KnnGrid &grid, const std::vector<Vector<Real, 3> > &positions,
+                          const std::vector<uint32_t> &valid, Real target, JobSystem *jobs) {
+        constexpr size_t grain_size = 4096;
+        const size_t m = valid.size();
+        Vector<Real, 3> lower = Vector<Real, 3>::Constant(std::numeric_limits<Real>::max());
+        Vector<Real, 3> upper = Vector<Real, 3>::Constant(std::numeric_limits<Real>::lowest());
+        std::mutex mutex;
+        ParallelFor(jobs, 0, m, grain_size, [&](size_t begin, size_t end) {
+            Vector<Real, 3> local_lower = Vector<Real, 3>::Constant(std::numeric_limits<Real>::max());
+            Vector<Real, 3> local_upper = Vector<Real, 3>::Constant(std::numeric_limits<Real>::lowest());
+            for (size_t i = begin; i < end; ++i) {
+                local_lower = local_lower.cwiseMin(positions[valid[i]]);
+                local_upper = local_upper.cwiseMax(positions[valid[i]]);
+            }
+            std::scoped_lock lock(mutex);
+            lower = lower.cwiseMin(local_lower);
+            upper = upper.cwiseMax(local_upper);
+        });
+        const Vector<double, 3> extent = (upper - lower).cast<double>();
+        const double max_extent = extent.maxCoeff();
+        // The smallest cell size which keeps the number of cells per axis in range.
+        const double min_size = max_extent > 0 ? max_extent / (KnnGrid::max_cells - 1) : 1;
+        const Vector<double, 3> padded = extent.cwiseMax(max_extent * 1e-3);
+        double cell_size = max_extent > 0 ? std::cbrt(padded.prod() * target / static_cast<double>(m)) : 1;
+        cell_size = std::max(cell_size, min_size);
+
+        auto setup = [&](double size) {
+            grid.origin = lower;
+            grid.cell_size = static_cast<Real>(size);
+            for (int a = 0; a < 3; ++a) {
+                grid.dims[a] = std::min<int64_t>(KnnGrid::max_cells, static_cast<int64_t>(extent[a] / size) + 1);
+            }
+        };
+
+        // The expected number of points in the cell of a point is 1 + (m - 1) times the probability that two random
+        // points share a cell, which the sample estimates from its pairs.
+        const size_t n_samples = std::min<size_t>(m, 1 << 16);
+        if (n_samples >= 2) {
+            std::vector<uint32_t> samples(n_samples);
+            std::sample(valid.begin(), valid.end(), samples.begin(), n_samples, std::mt19937(0));
+            std::vector<uint64_t> keys(n_samples);
+            for (int iteration = 0; iteration < 8; ++iteration) {
+                setup(cell_size);
+                for (size_t i = 0; i < n_samples; ++i) {
+                    const auto cell = grid.get_cell(positions[samples[i]]);
+                    keys[i] = KnnGrid::get_key(cell[0], cell[1], cell[2]);
+                }
+                std::sort(keys.begin(), keys.end());
+                double pairs = 0;
+                for (size_t i = 0; i < n_samples;) {
+                    size_t j = i;
+                    while (j < n_samples && keys[j] == keys[i]) ++j;
+                    pairs += static_cast<double>(j - i) * static_cast<double>(j - i - 1);
+                    i = j;
+                }
+                const double occupancy = 1 + pairs / (static_cast<double>(n_samples) * (n_samples - 1)) * (m - 1);
+                if (occupancy > 0.5 * target && occupancy < 2 * target) break;
+                const double scale = std::clamp(std::sqrt(target / occupancy), 0.25, 4.0);
+                if (scale < 1 && cell_size <= min_size) break;
+                cell_size = std::max(cell_size * scale, min_size);
+            }
+        }
+        setup(cell_size);
+
+        std::vector<std::pair<uint64_t, uint32_t> > items(m);
+        ParallelFor(jobs, 0, m, grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const auto cell = grid.get_cell(positions[valid[i]]);
+                items[i] = {KnnGrid::get_key(cell[0], cell[1], cell[2]), valid[i]};
+            }
+        });
+        ParallelSort(jobs, items);
+        grid.order.resize(m);
+        grid.points.resize(m);
+        ParallelFor(jobs, 0, m, grain_size, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                grid.order[i] = items[i].second;
+                grid.points[i] = positions[items[i].second];
+            }
+        });
+
+        grid.n_cells = 0;
+        for (size_t i = 0; i < m; ++i) {
+            if (i == 0 || items[i].first != items[i - 1].first) ++grid.n_cells;
+        }
+        const size_t table_size = std::bit_ceil(std::max<size_t>(2 * grid.n_cells, 2));
+        grid.table.assign(table_size, KnnGrid::Slot());
+        grid.mask = table_size - 1;
+        for (size_t i = 0; i < m;) {
+            size_t j = i;
+            while (j < m && items[j].first == items[i].first) ++j;
+            uint64_t slot = KnnGrid::hash(items[i].first) & grid.mask;
+            while (grid.table[slot].key != std::numeric_limits<uint64_t>::max()) slot = (slot + 1) & grid.mask;
+            grid.table[slot] = {items[i].first, static_cast<uint32_t>(i), static_cast<uint32_t>(j)};
+            i = j;
+        }
+    }
+
+    // Adds the candidate to the best candidates, which are kept sorted, if it is closer than the last of them.
+    static void Insert(KnnCandidate *best, size_t k, size_t &count, const KnnCandidate &candidate) {
+        if (count == k && !(candidate < best[k - 1])) return;
+        size_t i = count < k ? count++ : k - 1;
+        while (i > 0 && candidate < best[i - 1]) {
+            best[i] = best[i - 1];
+            --i;
+        }
+        best[i] = candidate;
+    }
+
+    // Finds the k nearest neighbors of the s-th sorted point. The cells are visited in shells of growing Chebyshev
+    // distance r around its cell, until the k-th candidate is closer than any point outside the visited block.
+    static size_t Query(const KnnGrid &grid, size_t s, size_t k, KnnCandidate *best) {
+        const Vector<Real, 3> p = grid.points[s];
+        const auto center = grid.get_cell(p);
+        const Real h = grid.cell_size;
+        // The distance of the point to the boundary of its cell.
+        Real boundary = std::numeric_limits<Real>::max();
+        for (int a = 0; a < 3; ++a) {
+            const Real lo = grid.origin[a] + static_cast<Real>(center[a]) * h;
+            boundary = std::min({boundary, p[a] - lo, lo + h - p[a]});
+        }
+        boundary = std::max<Real>(boundary, 0);
+
+        size_t count = 0;
+        auto axis_distance = [&](int a, int64_t c) -> Real {
+            if (c < center[a]) return std::max<Real>(0, p[a] - (grid.origin[a] + static_cast<Real>(c + 1) * h));
+            if (c > center[a]) return std::max<Real>(0, grid.origin[a] + static_cast<Real>(c) * h - p[a]);
+            return 0;
+        };
+        auto visit = [&](int64_t x, int64_t y, int64_t z) {
+            if (count == k) {
+                const Real dx = axis_distance(0, x), dy = axis_distance(1, y), dz = axis_distance(2, z);
+                if (dx * dx + dy * dy + dz * dz > best[k - 1].sq_distance) return;
+            }
+            const KnnGrid::Slot *slot = grid.find(KnnGrid::get_key(x, y, z));
+            for (uint32_t j = slot->begin; j < slot->end; ++j) {
+                if (j == s) continue;
+                Insert(best, k, count, {(grid.points[j] - p).squaredNorm(), grid.order[j]});
+            }
+        };
+
+        size_t n_visited = 0;
+        for (int64_t r = 0;; ++r) {
+            std::array<int64_t, 3> lo, hi;
+            int64_t n_shell = 1, n_inner = r > 0 ? 1 : 0;
+            for (int a = 0; a < 3; ++a) {
+                lo[a] = std::max<int64_t>(center[a] - r, 0);
+                hi[a] = std::min<int64_t>(center[a] + r, grid.dims[a] - 1);
+                n_shell *= hi[a] - lo[a] + 1;
+                if (r > 0) {
+                    n_inner *= std::min(center[a] + r - 1, grid.dims[a] - 1) -
+                            std::max<int64_t>(center[a] - r + 1, 0) + 1;
+                }
+            }
+            n_shell -= n_inner;
+            if (n_shell == 0) break;
+            n_visited += n_shell;
+            if (n_visited > grid.n_cells) {
+                // Searching the empty space between far apart clusters costs more than scanning all points.
+                count = 0;
+                for (size_t j = 0; j < grid.points.size(); ++j) {
+                    if (j != s) Insert(best, k, count, {(grid.points[j] - p).squaredNorm(), grid.order[j]});
+                }
+                break;
+            }
+            for (int64_t x = lo[0]; x <= hi[0]; ++x) {
+                for (int64_t y = lo[1]; y <= hi[1]; ++y) {
+                    if (std::abs(x - center[0]) == r || std::abs(y - center[1]) == r) {
+                        for (int64_t z = lo[2]; z <= hi[2]; ++z) visit(x, y, z);
+                    } else {
+                        if (center[2] - r >= 0) visit(x, y, center[2] - r);
+                        if (center[2] + r < grid.dims[2]) visit(x, y, center[2] + r);
+                    }
+                }
+            }
+            const Real bound = static_cast<Real>(r) * h + boundary;
+            if (count == k && best[k - 1].sq_distance < bound * bound) break;
+        }
+        return count;
+    }
+
+    KnnGraphBuilder::KnnGraphBuilder(const PointCloud &cloud, JobSystem *jobs) : cloud(cloud), jobs(jobs) {
+    }
+
+    void KnnGraphBuilder::compute(size_t k) {
+        this->k = k;
+        const size_t n = cloud.vertices.size();
+        neighbors.assign(n * k, std::numeric_limits<uint32_t>::max());
+        distances.assign(n * k, std::numeric_limits<Real>::max());
+        if (k == 0) return;
+        const auto positions = cloud.get_vertex_property<Vector<Real, 3> >("v:position");
+        std::vector<uint32_t> valid;
+        valid.reserve(cloud.n_vertices());
+        for (const Vertex &v: cloud.vertices) {
+            if (!cloud.is_deleted(v)) valid.push_back(static_cast<uint32_t>(v.idx()));
+        }
+        if (valid.size() < 2) return;
+
+        KnnGrid grid;
+        BuildGrid(grid, positions.vector(), valid, std::max<Real>(2, static_cast<Real>(k) / 2), jobs);
+        cell_size = grid.cell_size;
+
+        // Consecutive sorted points lie in the same or nearby cells, so every chunk reuses the cells it has cached.
+        ParallelFor(jobs, 0, grid.order.size(), 1024, [&](size_t begin, size_t end) {
+            std::vector<KnnCandidate> best(k);
+            for (size_t s = begin; s < end; ++s) {
+                const size_t count = Query(grid, s, k, best.data());
+                const size_t row = grid.order[s] * k;
+                for (size_t i = 0; i < count; ++i) {
+                    neighbors[row + i] = best[i].index;
+                    distances[row + i] = std::sqrt(best[i].sq_distance);
+                }
+            }
+        });
+    }
+
+    Graph KnnGraphBuilder::build_graph() const {
+        const size_t n = k > 0 ? neighbors.size() / k : cloud.vertices.size();
+        // Every edge once as (smaller index << 32 | larger index).
+        std::vector<uint64_t> pairs;
+        std::mutex mutex;
+        ParallelFor(jobs, 0, n, 4096, [&](size_t begin, size_t end) {
+            std::vector<uint64_t> local;
+            for (size_t i = begin; i < end; ++i) {
+                for (size_t a = 0; a < k; ++a) {
+                    const uint32_t j = neighbors[i * k + a];
+                    if (j == std::numeric_limits<uint32_t>::max()) break;
+                    if (mutual) {
+                        if (j < i) continue;
+                        bool found = false;
+                        for (size_t b = 0; b < k && !found; ++b) found = neighbors[j * k + b] == i;
+                        if (!found) continue;
+                    }
+                    const uint64_t lo = std::min<uint64_t>(i, j), hi = std::max<uint64_t>(i, j);
+                    local.push_back(lo << 32 | hi);
+                }
+            }
+            std::scoped_lock lock(mutex);
+            pairs.insert(pairs.end(), local.begin(), local.end());
+        });
+        ParallelSort(jobs, pairs);
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+        // The edges are unique, so the connectivity is linked directly instead of through add_edge. Edge e has the
+        // halfedge 2e from the smaller to the larger index and the opposite halfedge 2e + 1.
+        Graph graph;
+        const size_t m = pairs.size();
+        graph.vertices.resize(n);
+        graph.halfedges.resize(2 * m);
+        graph.edges.resize(m);
+        std::vector<uint32_t> offsets(n + 1, 0);
+        for (const uint64_t pair: pairs) {
+            ++offsets[(pair >> 32) + 1];
+            ++offsets[(pair & 0xFFFFFFFFu) + 1];
+        }
+        for (size_t i = 0; i < n; ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+        std::vector<uint32_t> outgoing(2 * m);
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (size_t e = 0; e < m; ++e) {
+            outgoing[fill[pairs[e] >> 32]++] = static_cast<uint32_t>(2 * e);
+            outgoing[fill[pairs[e] & 0xFFFFFFFFu]++] = static_cast<uint32_t>(2 * e + 1);
+        }
+        ParallelFor(jobs, 0, m, 4096, [&](size_t begin, size_t end) {
+            for (size_t e = begin; e < end; ++e) {
+                graph.set_vertex(Halfedge(2 * e), Vertex(pairs[e] & 0xFFFFFFFFu));
+                graph.set_vertex(Halfedge(2 * e + 1), Vertex(pairs[e] >> 32));
+                graph.e_direction[Edge(e)] = Halfedge(2 * e);
+            }
+        });
+        // The outgoing halfedges of every vertex form its ring, the opposite of one leads to the next.
+        ParallelFor(jobs, 0, n, 4096, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const uint32_t first = offsets[i], last = offsets[i + 1];
+                if (first == last) continue;
+                for (uint32_t a = first; a < last; ++a) {
+                    const Halfedge h(outgoing[a]);
+                    graph.set_next(graph.get_opposite(h), Halfedge(outgoing[a + 1 < last ? a + 1 : first]));
+                }
+                graph.set_halfedge(Vertex(i), Halfedge(outgoing[first]));
+            }
+        });
+        const auto cloud_positions = cloud.get_vertex_property<Vector<Real, 3> >("v:position");
+        auto positions = graph.vertex_property<Vector<Real, 3> >("v:position");
+        positions.vector() = cloud_positions.vector();
+        for (size_t i = 0; i < n; ++i) {
+            if (cloud.is_deleted(Vertex(i))) graph.delete_vertex(Vertex(i));
+        }
+        EdgeLengths(graph, positions);
+        return graph;
+    }
+}
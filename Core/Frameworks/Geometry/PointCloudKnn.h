@@ -0,0 +1,69 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#ifndef POINTCLOUDKNN_H
+#define POINTCLOUDKNN_H
+
+#include "Graph.h"
+#include "PointCloud.h"
+
+namespace Bcg {
+    class JobSystem;
+
+    /**
+     * @brief KnnGraphBuilder: Finds the exact k nearest neighbors of every point of a point cloud and connects them
+     * in a Graph.
+     *
+     * The points are sorted into a uniform grid whose occupied cells are found by hashing, with the cell size chosen
+     * so that an occupied cell holds about k / 2 points, for volumes as well as for samples of surfaces. Every query
+     * visits the cells in growing shells around its own cell until no unvisited cell can hold a closer point. The
+     * queries run in chunks of consecutive cells, in parallel if a JobSystem is given, so neighboring queries share
+     * the cached cells. Ties are broken by the point index, so the result does not depend on the number of threads.
+     */
+    class KnnGraphBuilder {
+    public:
+        /**
+         * @brief Constructs a KnnGraphBuilder object for the given point cloud.
+         * @param cloud The point cloud, its points are read from "v:position".
+         * @param jobs If set, the index is built and queried in parallel on this JobSystem.
+         */
+        explicit KnnGraphBuilder(const PointCloud &cloud, JobSystem *jobs = nullptr);
+
+        /**
+         * @brief Finds the k nearest neighbors of every point into neighbors and distances.
+         * @param k The number of neighbors per point, excluding the point itself.
+         */
+        void compute(size_t k);
+
+        /**
+         * @brief Builds a graph on the points of the cloud from the neighbors of the last compute. The graph has the
+         * vertices and positions of the cloud and the lengths of its edges in "e:length". Deleted points of the cloud
+         * are deleted vertices of the graph.
+         * @return The kNN graph.
+         */
+        [[nodiscard]] Graph build_graph() const;
+
+        /**
+         * @brief Returns the index of the i-th nearest neighbor of a point, or max if the cloud has too few points.
+         */
+        [[nodiscard]] uint32_t get_neighbor(const Vertex &v, size_t i) const { return neighbors[v.idx() * k + i]; }
+
+        /**
+         * @brief Returns the distance to the i-th nearest neighbor of a point, or max if there is none.
+         */
+        [[nodiscard]] Real get_distance(const Vertex &v, size_t i) const { return distances[v.idx() * k + i]; }
+
+        std::vector<uint32_t> neighbors; /**< The k neighbors of every point by increasing distance, row major. */
+        std::vector<Real> distances; /**< The distances to the neighbors, row major. */
+        size_t k = 0; /**< The number of neighbors per point of the last compute. */
+        bool mutual = false; /**< Only connect points which are among the neighbors of each other in build_graph. */
+        Real cell_size = 0; /**< The edge length of the grid cells of the last compute. */
+
+    private:
+        const PointCloud &cloud; /**< The point cloud whose points are connected. */
+        JobSystem *jobs; /**< The optional JobSystem used for the queries. */
+    };
+}
+
+#endif //POINTCLOUDKNN_H
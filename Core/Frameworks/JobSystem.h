@@ -14,6 +14,8 @@
 #include <future>
 #include <atomic>
 #include <stdexcept>
+#include <algorithm>
+#include <exception>
 
 namespace Bcg {
     class JobSystem {
@@ -51,6 +53,66 @@ namespace Bcg {
         // Enqueue a job that does not return a result
         void enqueue(std::function<void()> job);
 
+        // Splits [begin, end) into chunks of at most grain_size indices and calls func(chunk_begin, chunk_end) for every
+        // chunk. Chunks are claimed dynamically by the workers and by the calling thread, which blocks until all chunks
+        // are done. Because the caller makes progress on its own it is safe to call this from inside a job. The first
+        // exception thrown by func is rethrown.
+        template<typename F>
+        void parallel_for(size_t begin, size_t end, size_t grain_size, F &&func) {
+            if (begin >= end) {
+                return;
+            }
+            grain_size = std::max<size_t>(grain_size, 1);
+            const size_t n_chunks = (end - begin + grain_size - 1) / grain_size;
+
+            struct State {
+                std::atomic<size_t> next{0};
+                std::atomic<size_t> done{0};
+                std::mutex mutex;
+                std::condition_variable cv;
+                std::exception_ptr error;
+            };
+            auto state = std::make_shared<State>();
+            auto run = [state, begin, end, grain_size, n_chunks, &func]() {
+                for (size_t chunk; (chunk = state->next.fetch_add(1)) < n_chunks;) {
+                    const size_t chunk_begin = begin + chunk * grain_size;
+                    try {
+                        func(chunk_begin, std::min(end, chunk_begin + grain_size));
+                    } catch (...) {
+                        std::scoped_lock lock(state->mutex);
+                        if (!state->error) {
+                            state->error = std::current_exception();
+                        }
+                    }
+                    if (state->done.fetch_add(1) + 1 == n_chunks) {
+                        std::scoped_lock lock(state->mutex);
+                        state->cv.notify_all();
+                    }
+                }
+            };
+
+            const size_t n_helpers = std::min(n_chunks - 1, workers_.size());
+            if (n_helpers > 0) {
+                std::scoped_lock lock(mutex_);
+                if (!stop_flag_) {
+                    for (size_t i = 0; i < n_helpers; ++i) {
+                        tasks_.push(run);
+                    }
+                }
+            }
+            cv_.notify_all();
+            run();
+
+            std::unique_lock lock(state->mutex);
+            state->cv.wait(lock, [&state, n_chunks]() { return state->done.load() == n_chunks; });
+            if (state->error) {
+                std::rethrow_exception(state->error);
+            }
+        }
+
+        // Number of worker threads
+        [[nodiscard]] size_t num_threads() const { return workers_.size(); }
+
         // Wait until all currently queued tasks are completed
         void wait();
 
@@ -65,5 +127,15 @@ namespace Bcg {
         std::atomic<bool> stop_flag_;
         size_t active_tasks_ = 0;
     };
+
+    // Calls jobs->parallel_for if a JobSystem is given, otherwise calls func(begin, end) once on the calling thread.
+    template<typename F>
+    void ParallelFor(JobSystem *jobs, size_t begin, size_t end, size_t grain_size, F &&func) {
+        if (jobs) {
+            jobs->parallel_for(begin, end, grain_size, func);
+        } else if (begin < end) {
+            func(begin, end);
+        }
+    }
 } // namespace Bcg
 #endif //ENGINE25_JOBSYSTEM_H
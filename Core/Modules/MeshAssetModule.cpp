@@ -5,11 +5,16 @@
 #include "MeshAssetModule.h"
 
 #include <MeshIo.h>
+#include <MeshIoStream.h>
+#include <algorithm>
+#include <atomic>
 
 #include "Engine.h"
 #include "Pool.h"
 #include "PoolHandle.h"
 #include "MainLoop.h"
+#include "JobSystem.h"
+#include "ConfigFile.h"
 #include "GuiModule.h"
 #include "GuiMesh.h"
 #include "imgui.h"
@@ -20,7 +25,70 @@ namespace Bcg {
     using MeshAssetCache = std::unordered_map<std::string, PoolHandle<Mesh>>;
     static CommandBuffer active_gui;
 
-    MeshAssetModule::MeshAssetModule() : Module("MeshAssetModule", "0.1") {
+    struct MeshLoadRequest {
+        enum class State {
+            Queued, Loading, Parsed, Done, Cancelled, Failed
+        };
+
+        explicit MeshLoadRequest(std::string filepath) : filepath(std::move(filepath)) {}
+
+        const std::string filepath;
+        std::atomic<State> state{State::Queued};
+        std::atomic<bool> cancel_requested{false};
+        std::atomic<size_t> bytes_read{0};     /**< progress of a streamed load, updated after every batch. */
+        std::atomic<size_t> bytes_total{0};    /**< file size of a streamed load, zero for other formats. */
+        Mesh mesh;                             /**< only touched by the worker until state is Parsed. */
+    };
+
+    // Builds the mesh batch by batch, publishing the bytes read and stopping at the next batch once cancelled.
+    // The stream only carries positions and faces, formats it cannot read go through MeshIoManager in one piece.
+    static bool ReadMesh(MeshLoadRequest &request) {
+        MeshStreamReader reader(request.filepath);
+        if (!reader.can_load_file()) {
+            MeshIoManager mesh_io(request.filepath);
+            return mesh_io.read(request.mesh);
+        }
+
+        auto positions = request.mesh.vertex_property<Vector<Real, 3>>("v:position");
+        std::vector<Vertex> face;
+        auto report = [&request, &reader]() {
+            request.bytes_total = reader.file_size();
+            request.bytes_read = reader.n_bytes_read();
+            return !request.cancel_requested;
+        };
+        const bool success = reader.read([&](MeshStreamVertexBatch &batch) {
+            for (const auto &position : batch.positions) {
+                add_vertex(request.mesh.vertices, positions, position);
+            }
+            return report();
+        }, [&](MeshStreamFaceBatch &batch) {
+            for (size_t i = 0; i < batch.size(); ++i) {
+                face.clear();
+                for (unsigned int j = 0; j < batch.get_valence(i); ++j) {
+                    face.emplace_back(batch.get_indices(i)[j]);
+                }
+                request.mesh.add_face(face);
+            }
+            return report();
+        });
+        request.bytes_read = reader.n_bytes_read();
+        return success;
+    }
+
+    static const char *ToString(MeshLoadRequest::State state) {
+        switch (state) {
+            case MeshLoadRequest::State::Queued: return "queued";
+            case MeshLoadRequest::State::Loading: return "loading";
+            case MeshLoadRequest::State::Parsed: return "publishing";
+            case MeshLoadRequest::State::Done: return "done";
+            case MeshLoadRequest::State::Cancelled: return "cancelled";
+            case MeshLoadRequest::State::Failed: return "failed";
+        }
+        return "unknown";
+    }
+
+    MeshAssetModule::MeshAssetModule() : Module("MeshAssetModule", "0.1"),
+                                         completed_loads(std::make_shared<MeshLoadCompletionQueue>()) {
 
     }
 
@@ -36,6 +104,7 @@ namespace Bcg {
         Engine::get_dispatcher().sink<Events::Initialize>().disconnect<&MeshAssetModule::on_initialize>(this);
         Engine::get_dispatcher().sink<Events::Shutdown>().disconnect<&MeshAssetModule::on_shutdown>(this);
         Engine::get_dispatcher().sink<Events::Drop>().disconnect<&MeshAssetModule::on_drop_file>(this);
+        Engine::get_dispatcher().sink<Events::Synchronize>().disconnect<&MeshAssetModule::on_synchronize>(this);
         Module::disconnect_events();
     }
 
@@ -43,6 +112,7 @@ namespace Bcg {
         Engine::get_context().emplace<MeshAssetPool>("MeshAssetPool");
         Engine::get_context().emplace<MeshAssetInstancePool>("MeshAssetInstancePool");
         Engine::get_context().emplace<MeshAssetCache>();
+        set_max_concurrent_loads(Config::get_int("mesh_assets.max_concurrent_loads"));
         Module::on_initialize(event);
     }
 
@@ -52,9 +122,41 @@ namespace Bcg {
 
     void MeshAssetModule::on_synchronize(const Events::Synchronize &event) {
         Module::on_synchronize(event);
+        collect_completed_loads();
+        dispatch_loads();
+
         auto &loop = Engine::get_context().get<MainLoop>();
-        auto menu_entry = std::make_shared<Graphics::AddGuiMenuEntry>([](){
+        std::vector<std::shared_ptr<MeshLoadRequest>> pending(queued_loads.begin(), queued_loads.end());
+        pending.insert(pending.end(), active_loads.begin(), active_loads.end());
+        auto menu_entry = std::make_shared<Graphics::AddGuiMenuEntry>([this, pending](){
             if (ImGui::BeginMenu("Meshes")) {
+                if (!pending.empty() && ImGui::BeginMenu("Loading")) {
+                    for (auto &request : pending) {
+                        // Streamed loads report the bytes read, other formats show an indeterminate bar, which ImGui
+                        // draws for a negative fraction.
+                        const auto state = request->state.load();
+                        const size_t bytes_total = request->bytes_total.load();
+                        float fraction = 0.0f;
+                        if (bytes_total > 0) {
+                            fraction = static_cast<float>(request->bytes_read.load()) / static_cast<float>(bytes_total);
+                        } else if (state != MeshLoadRequest::State::Queued) {
+                            fraction = -static_cast<float>(ImGui::GetTime());
+                        }
+                        ImGui::ProgressBar(fraction, ImVec2(200.0f, 0.0f), ToString(state));
+                        ImGui::SameLine();
+                        ImGui::TextUnformatted(request->filepath.c_str());
+                        ImGui::PushID(request.get());
+                        if (ImGui::MenuItem("Cancel")) {
+                            request->cancel_requested = true;
+                        }
+                        ImGui::PopID();
+                    }
+                    ImGui::Separator();
+                    if (ImGui::MenuItem("Cancel all")) {
+                        cancel_all_loads();
+                    }
+                    ImGui::EndMenu();
+                }
                 if(ImGui::BeginMenu("Cache")){
                     auto &mesh_asset_cache = Engine::get_context().get<MeshAssetCache>();
                     for (auto &item : mesh_asset_cache) {
@@ -89,24 +191,130 @@ namespace Bcg {
     }
 
     void MeshAssetModule::on_shutdown(const Events::Shutdown &event) {
+        cancel_all_loads();
+        if (auto *jobs = Engine::get_context().find<JobSystem>()) {
+            jobs->wait();
+        }
         Module::on_shutdown(event);
     }
 
     void MeshAssetModule::on_drop_file(const Events::Drop &event) {
-        auto &mesh_asset_cache = Engine::get_context().get<MeshAssetCache>();
-        auto &mesh_asset_pool = Engine::get_context().get<MeshAssetPool>();
         for (int i = 0; i < event.count; ++i) {
-            std::string filepath = event.paths[i];
-            MeshIoManager mesh_io(filepath);
-            if (!mesh_io.can_load_file()) continue;
-            if (mesh_asset_cache.find(filepath) == mesh_asset_cache.end()) {
-                auto mesh_handle = mesh_asset_pool.create_handle();
-                Mesh &mesh = mesh_handle;
-                mesh_io.read(mesh);
-                LOG_INFO(fmt::format("{}::on_drop_file: New mesh {} to pool", name, filepath));
-                assert(mesh_handle.GetIndex() < mesh_asset_pool.get_objects().size());
-                mesh_asset_cache[filepath] = mesh_handle;
+            load_async(event.paths[i]);
+        }
+    }
+
+    bool MeshAssetModule::load_async(const std::string &filepath) {
+        MeshIoManager mesh_io(filepath);
+        if (!mesh_io.can_load_file()) return false;
+        auto &mesh_asset_cache = Engine::get_context().get<MeshAssetCache>();
+        if (mesh_asset_cache.find(filepath) != mesh_asset_cache.end() || is_pending(filepath)) return false;
+
+        queued_loads.push_back(std::make_shared<MeshLoadRequest>(filepath));
+        dispatch_loads();
+        return true;
+    }
+
+    void MeshAssetModule::cancel_load(const std::string &filepath) {
+        for (auto &request : queued_loads) {
+            if (request->filepath == filepath) request->cancel_requested = true;
+        }
+        for (auto &request : active_loads) {
+            if (request->filepath == filepath) request->cancel_requested = true;
+        }
+    }
+
+    void MeshAssetModule::cancel_all_loads() {
+        for (auto &request : queued_loads) {
+            request->cancel_requested = true;
+        }
+        for (auto &request : active_loads) {
+            request->cancel_requested = true;
+        }
+    }
+
+    void MeshAssetModule::set_max_concurrent_loads(size_t max_loads) {
+        max_concurrent_loads = std::max<size_t>(max_loads, 1);
+    }
+
+    bool MeshAssetModule::is_pending(const std::string &filepath) const {
+        auto matches = [&filepath](const std::shared_ptr<MeshLoadRequest> &request) {
+            return request->filepath == filepath && !request->cancel_requested;
+        };
+        return std::any_of(queued_loads.begin(), queued_loads.end(), matches) ||
+               std::any_of(active_loads.begin(), active_loads.end(), matches);
+    }
+
+    void MeshAssetModule::dispatch_loads() {
+        queued_loads.erase(std::remove_if(queued_loads.begin(), queued_loads.end(), [](const auto &request) {
+            if (!request->cancel_requested) return false;
+            request->state = MeshLoadRequest::State::Cancelled;
+            return true;
+        }), queued_loads.end());
+
+        auto &jobs = Engine::get_context().get<JobSystem>();
+        while (active_loads.size() < max_concurrent_loads && !queued_loads.empty()) {
+            auto request = queued_loads.front();
+            queued_loads.pop_front();
+
+            request->state = MeshLoadRequest::State::Loading;
+            active_loads.push_back(request);
+
+            // The worker only owns the request and the completion queue, never the module.
+            jobs.enqueue([request, completed = completed_loads]() {
+                if (!request->cancel_requested) {
+                    bool success = ReadMesh(*request);
+                    if (request->cancel_requested) {
+                        request->state = MeshLoadRequest::State::Cancelled;
+                    } else if (!success) {
+                        request->state = MeshLoadRequest::State::Failed;
+                    } else {
+                        request->state = MeshLoadRequest::State::Parsed;
+                    }
+                } else {
+                    request->state = MeshLoadRequest::State::Cancelled;
+                }
+                std::scoped_lock lock(completed->mutex);
+                completed->requests.push_back(request);
+            });
+        }
+    }
+
+    void MeshAssetModule::collect_completed_loads() {
+        std::vector<std::shared_ptr<MeshLoadRequest>> finished;
+        {
+            std::scoped_lock lock(completed_loads->mutex);
+            finished.swap(completed_loads->requests);
+        }
+        if (finished.empty()) return;
+
+        auto &loop = Engine::get_context().get<MainLoop>();
+        for (auto &request : finished) {
+            active_loads.erase(std::remove(active_loads.begin(), active_loads.end(), request), active_loads.end());
+            if (request->state == MeshLoadRequest::State::Failed) {
+                LOG_WARN(fmt::format("{}::load_async: Failed to load mesh {}", name, request->filepath));
+                continue;
+            }
+            if (request->state != MeshLoadRequest::State::Parsed) {
+                LOG_INFO(fmt::format("{}::load_async: Cancelled loading mesh {}", name, request->filepath));
+                continue;
             }
+
+            // Pool and cache are not thread safe, so publishing happens in a main thread command.
+            loop.begin.Next().AddCommand(std::make_shared<Task>([request, module_name = name]() {
+                auto &mesh_asset_cache = Engine::get_context().get<MeshAssetCache>();
+                if (request->cancel_requested || mesh_asset_cache.find(request->filepath) != mesh_asset_cache.end()) {
+                    request->state = MeshLoadRequest::State::Cancelled;
+                    return;
+                }
+                auto &mesh_asset_pool = Engine::get_context().get<MeshAssetPool>();
+                auto mesh_handle = mesh_asset_pool.create_handle(std::move(request->mesh));
+                LOG_INFO(fmt::format("{}::load_async: New mesh {} to pool", module_name, request->filepath));
+                assert(mesh_handle.GetIndex() < mesh_asset_pool.get_objects().size());
+                mesh_asset_cache[request->filepath] = mesh_handle;
+                request->mesh = Mesh();
+                request->state = MeshLoadRequest::State::Done;
+            }));
         }
     }
-}
\ No newline at end of file
+}
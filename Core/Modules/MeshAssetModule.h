@@ -6,8 +6,20 @@
 #define ENGINE25_MESHASSETMODULE_H
 
 #include "Module.h"
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace Bcg {
+    struct MeshLoadRequest;
+
+    struct MeshLoadCompletionQueue {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<MeshLoadRequest>> requests;
+    };
+
     class MeshAssetModule : public Module {
     public:
         MeshAssetModule();
@@ -27,6 +39,43 @@ namespace Bcg {
         void on_shutdown(const Events::Shutdown &event) override;
 
         void on_drop_file(const Events::Drop &event);
+
+        /**
+         * @brief Queues an asynchronous load of the mesh at filepath. Parsing runs on the JobSystem, the result is
+         * published to the MeshAssetPool and MeshAssetCache on the main thread. OFF, PLY and OBJ files are streamed
+         * in batches of positions and faces and report the bytes read to the loading menu.
+         * @return false if the file cannot be loaded or is already cached or pending.
+         */
+        bool load_async(const std::string &filepath);
+
+        /**
+         * @brief Requests cancellation of a queued or running load. OFF, PLY and OBJ files are streamed and stop at the
+         * next batch, other formats finish parsing. The result is discarded instead of being published.
+         */
+        void cancel_load(const std::string &filepath);
+
+        void cancel_all_loads();
+
+        /**
+         * @brief Sets how many meshes are parsed concurrently on the JobSystem (at least one).
+         */
+        void set_max_concurrent_loads(size_t max_loads);
+
+        [[nodiscard]] size_t get_max_concurrent_loads() const { return max_concurrent_loads; }
+
+        [[nodiscard]] size_t num_pending_loads() const { return queued_loads.size() + active_loads.size(); }
+
+    private:
+        void dispatch_loads();
+
+        void collect_completed_loads();
+
+        [[nodiscard]] bool is_pending(const std::string &filepath) const;
+
+        size_t max_concurrent_loads = 1;
+        std::deque<std::shared_ptr<MeshLoadRequest>> queued_loads;        /**< waiting for a free load slot. */
+        std::vector<std::shared_ptr<MeshLoadRequest>> active_loads;       /**< parsing on the JobSystem or publishing. */
+        std::shared_ptr<MeshLoadCompletionQueue> completed_loads;         /**< filled by workers, drained on the main thread. */
     };
 }
 
@@ -134,4 +134,9 @@ namespace Bcg {
         EXPECT_FLOAT_EQ(min_max_dist, 21.0f); // Minimum max distance calculation
         EXPECT_FLOAT_EQ(min_max_dist, min_max_distRef3D); // Minimum max distance calculation
     }
+
+    TEST(AABBTest, SurfaceArea) {
+        AABB<float, 3> aabb(Vector<float, 3>(1.0f, 2.0f, 3.0f), Vector<float, 3>(2.0f, 4.0f, 6.0f));
+        EXPECT_FLOAT_EQ(aabb.surface_area(), 2.0f * (1.0f * 2.0f + 2.0f * 3.0f + 1.0f * 3.0f));
+    }
 }
@@ -0,0 +1,146 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphBFS.h"
+#include "MeshShapes.h"
+#include "JobSystem.h"
+#include <queue>
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+// Serial reference hop distances, walking the halfedge circulators.
+template<typename GraphType>
+static std::vector<int> ReferenceDistances(const GraphType &graph, const Vertex &source) {
+    std::vector<int> distances(graph.vertices.size(), -1);
+    std::queue<Vertex> queue;
+    distances[source.idx()] = 0;
+    queue.push(source);
+    while (!queue.empty()) {
+        const Vertex v = queue.front();
+        queue.pop();
+        for (const auto &h: graph.get_halfedges(v)) {
+            const Vertex u = graph.get_vertex(h);
+            if (distances[u.idx()] < 0) {
+                distances[u.idx()] = distances[v.idx()] + 1;
+                queue.push(u);
+            }
+        }
+    }
+    return distances;
+}
+
+template<typename GraphType>
+static void ExpectValidTree(const GraphType &graph, const DirectionOptimizingBFS &bfs) {
+    for (const auto &v: graph.vertices) {
+        const Vertex parent = bfs.vertex_parents[v];
+        if (bfs.vertex_distances[v] <= 0) {
+            EXPECT_FALSE(parent.is_valid());
+            continue;
+        }
+        ASSERT_TRUE(parent.is_valid());
+        EXPECT_EQ(bfs.vertex_distances[parent], bfs.vertex_distances[v] - 1);
+        bool adjacent = false;
+        for (const auto &u: graph.get_vertices(v)) {
+            adjacent |= u == parent;
+        }
+        EXPECT_TRUE(adjacent);
+    }
+}
+
+class DirectionOptimizingBFSTest : public ::testing::Test {
+protected:
+    Graph graph;
+    static constexpr size_t n = 40;
+
+    // n x n grid plus one isolated vertex.
+    void SetUp() override {
+        for (size_t i = 0; i < n * n + 1; ++i) {
+            graph.new_vertex();
+        }
+        for (size_t y = 0; y < n; ++y) {
+            for (size_t x = 0; x < n; ++x) {
+                const Vertex v(y * n + x);
+                if (x + 1 < n) graph.add_edge(v, Vertex(y * n + x + 1));
+                if (y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x));
+            }
+        }
+    }
+};
+
+TEST_F(DirectionOptimizingBFSTest, MatchesSerialBFS) {
+    const auto expected = ReferenceDistances(graph, Vertex(0));
+    DirectionOptimizingBFS bfs(graph);
+    bfs.compute(Vertex(0));
+    EXPECT_EQ(bfs.vertex_distances.vector(), expected);
+    EXPECT_EQ(bfs.vertex_distances[Vertex(n * n)], -1);
+    EXPECT_EQ(bfs.n_levels, 2 * n - 1);
+    ExpectValidTree(graph, bfs);
+}
+
+TEST_F(DirectionOptimizingBFSTest, BottomUpAndParallelMatchSerialBFS) {
+    const auto expected = ReferenceDistances(graph, Vertex(n * n / 2));
+    JobSystem jobs(3);
+    for (JobSystem *job_system: {static_cast<JobSystem *>(nullptr), &jobs}) {
+        DirectionOptimizingBFS bfs(graph, job_system);
+        // Force the switch to bottom-up on the second level and stay there.
+        bfs.alpha = 1e6;
+        bfs.beta = 1e6;
+        bfs.compute(Vertex(n * n / 2));
+        EXPECT_GT(bfs.n_bottom_up_levels, 0);
+        EXPECT_EQ(bfs.vertex_distances.vector(), expected);
+        ExpectValidTree(graph, bfs);
+
+        bfs.alpha = 0.5;
+        bfs.beta = 1;
+        bfs.compute(Vertex(n * n / 2));
+        EXPECT_EQ(bfs.vertex_distances.vector(), expected);
+        ExpectValidTree(graph, bfs);
+    }
+}
+
+TEST_F(DirectionOptimizingBFSTest, MultipleSourcesGiveDistanceToClosest) {
+    DirectionOptimizingBFS bfs(graph);
+    bfs.compute({Vertex(0), Vertex(n * n - 1)});
+    for (size_t y = 0; y < n; ++y) {
+        for (size_t x = 0; x < n; ++x) {
+            const int expected = static_cast<int>(std::min(x + y, 2 * (n - 1) - x - y));
+            EXPECT_EQ(bfs.vertex_distances[Vertex(y * n + x)], expected);
+        }
+    }
+}
+
+TEST_F(DirectionOptimizingBFSTest, FollowsEditsBetweenComputes) {
+    DirectionOptimizingBFS bfs(graph);
+    bfs.compute(Vertex(0));
+    EXPECT_EQ(bfs.vertex_distances[Vertex(n * n)], -1);
+
+    // The own snapshot is rebuilt, so an added edge is seen by the next compute.
+    graph.add_edge(Vertex(n - 1), Vertex(n * n));
+    bfs.compute(Vertex(0));
+    EXPECT_EQ(bfs.vertex_distances[Vertex(n * n)], static_cast<int>(n));
+    EXPECT_EQ(bfs.vertex_parents[Vertex(n * n)], Vertex(n - 1));
+
+    // A snapshot set by the user is not rebuilt, once it is stale the compute fails instead of searching it.
+    GraphCsr csr(graph);
+    bfs.set_csr(&csr);
+    bfs.compute(Vertex(0));
+    EXPECT_EQ(bfs.vertex_distances[Vertex(n * n)], static_cast<int>(n));
+    graph.add_edge(Vertex(0), Vertex(n * n));
+    bfs.compute(Vertex(0));
+    EXPECT_EQ(bfs.vertex_distances[Vertex(n * n)], -1);
+    bfs.clear_csr();
+    bfs.compute(Vertex(0));
+    EXPECT_EQ(bfs.vertex_distances[Vertex(n * n)], 1);
+}
+
+TEST(DirectionOptimizingBFSMesh, MatchesSerialBFSOnMeshVertices) {
+    Mesh mesh = Icosphere(4);
+    JobSystem jobs(2);
+    DirectionOptimizingBFS bfs(mesh, &jobs);
+    bfs.compute(Vertex(0));
+    EXPECT_EQ(bfs.vertex_distances.vector(), ReferenceDistances(mesh, Vertex(0)));
+    EXPECT_GT(bfs.n_bottom_up_levels, 0);
+    ExpectValidTree(mesh, bfs);
+}
@@ -0,0 +1,147 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphBellmanFord.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+class GraphBellmanFordTest : public ::testing::Test {
+protected:
+    Graph graph;
+    EdgeProperty<Real> weights;
+    static constexpr size_t n = 10;
+
+    // n x n grid with diagonals and jittered positions, plus a separate triangle.
+    void SetUp() override {
+        auto positions = graph.vertex_property<Vector<Real, 3> >("v:position");
+        for (size_t i = 0; i < n * n + 3; ++i) {
+            const Vertex v = graph.new_vertex();
+            positions[v] = Vector<Real, 3>(i % n + 0.01f * (i * 7 % 5), i / n + 0.01f * (i * 3 % 7), 0);
+        }
+        for (size_t y = 0; y < n; ++y) {
+            for (size_t x = 0; x < n; ++x) {
+                const Vertex v(y * n + x);
+                if (x + 1 < n) graph.add_edge(v, Vertex(y * n + x + 1));
+                if (y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x));
+                if (x + 1 < n && y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x + 1));
+            }
+        }
+        graph.add_edge(Vertex(n * n), Vertex(n * n + 1));
+        graph.add_edge(Vertex(n * n + 1), Vertex(n * n + 2));
+        graph.add_edge(Vertex(n * n + 2), Vertex(n * n));
+        weights = EdgeLengths(graph, positions);
+    }
+};
+
+TEST_F(GraphBellmanFordTest, ModesMatchOnDirectedNegativeWeights) {
+    // Shifting every entry u -> v by p(u) - p(v) makes some entries negative without creating a negative cycle.
+    GraphCsr csr(graph, weights);
+    auto potential = [](size_t v) { return static_cast<Real>(v % 7) * 0.8f; };
+    for (const Vertex &v: graph.vertices) {
+        for (size_t i = csr.begin(v); i < csr.end(v); ++i) {
+            csr.weights[i] += potential(v.idx()) - potential(csr.neighbors[i]);
+        }
+    }
+
+    JobSystem jobs(3);
+    BellmanFord bellman_ford(graph, &jobs);
+    bellman_ford.set_csr(&csr);
+    ASSERT_TRUE(bellman_ford.compute(Vertex(3)));
+    const std::vector<Real> expected = bellman_ford.vertex_distances.vector();
+    EXPECT_EQ(expected[n * n], std::numeric_limits<Real>::max());
+
+    for (const BellmanFordMode mode: {BellmanFordMode::Queue, BellmanFordMode::ParallelSweep}) {
+        bellman_ford.mode = mode;
+        ASSERT_TRUE(bellman_ford.compute(Vertex(3)));
+        EXPECT_GT(bellman_ford.n_relaxations, 0);
+        for (const Vertex &v: graph.vertices) {
+            if (expected[v.idx()] == std::numeric_limits<Real>::max()) {
+                EXPECT_EQ(bellman_ford.vertex_distances[v], expected[v.idx()]);
+                EXPECT_FALSE(bellman_ford.vertex_predecessors[v].is_valid());
+            } else {
+                EXPECT_NEAR(bellman_ford.vertex_distances[v], expected[v.idx()], 1e-4);
+                EXPECT_EQ(bellman_ford.vertex_predecessors[v].is_valid(), v.idx() != 3);
+            }
+        }
+    }
+}
+
+TEST_F(GraphBellmanFordTest, MultipleSourcesMatchSweep) {
+    std::vector<Vertex> sources = {Vertex(0), Vertex(n * n - 1), Vertex(n * n + 2)};
+    BellmanFord bellman_ford(graph);
+    bellman_ford.set_custom_edge_weights(weights);
+    ASSERT_TRUE(bellman_ford.compute(sources));
+    const std::vector<Real> expected = bellman_ford.vertex_distances.vector();
+
+    bellman_ford.mode = BellmanFordMode::Queue;
+    ASSERT_TRUE(bellman_ford.compute(sources));
+    for (const Vertex &v: graph.vertices) {
+        EXPECT_NEAR(bellman_ford.vertex_distances[v], expected[v.idx()], 1e-4);
+    }
+
+    // Without a JobSystem the parallel sweep runs serially.
+    bellman_ford.mode = BellmanFordMode::ParallelSweep;
+    ASSERT_TRUE(bellman_ford.compute(sources));
+    for (const Vertex &v: graph.vertices) {
+        EXPECT_NEAR(bellman_ford.vertex_distances[v], expected[v.idx()], 1e-4);
+    }
+}
+
+TEST_F(GraphBellmanFordTest, AllModesDetectNegativeCycle) {
+    weights[graph.find_edge(Vertex(n * n), Vertex(n * n + 1))] = -0.5f;
+    JobSystem jobs(2);
+    BellmanFord bellman_ford(graph, &jobs);
+    bellman_ford.set_custom_edge_weights(weights);
+    for (const BellmanFordMode mode: {
+             BellmanFordMode::Sweep, BellmanFordMode::Queue, BellmanFordMode::ParallelSweep
+         }) {
+        bellman_ford.mode = mode;
+        // The grid does not reach the cycle.
+        EXPECT_TRUE(bellman_ford.compute(Vertex(0)));
+        EXPECT_FALSE(bellman_ford.has_negative_cycle());
+        EXPECT_FALSE(bellman_ford.compute(Vertex(n * n + 2)));
+        EXPECT_TRUE(bellman_ford.has_negative_cycle());
+    }
+}
+
+TEST_F(GraphBellmanFordTest, ZeroWeightEdgesGiveAcyclicPredecessors) {
+    // Every third edge has zero weight, so many vertices are equally far from the sources, among them a zero weight
+    // path 0 - 1 - 2 along the first row.
+    for (const auto &e: graph.edges) {
+        if (e.idx() % 3 == 0) weights[e] = 0;
+    }
+    weights[graph.find_edge(Vertex(0), Vertex(1))] = 0;
+    weights[graph.find_edge(Vertex(1), Vertex(2))] = 0;
+    const std::vector<Vertex> sources = {Vertex(0), Vertex(n * n / 2)};
+    JobSystem jobs(3);
+    for (JobSystem *job_system: {static_cast<JobSystem *>(nullptr), &jobs}) {
+        for (const BellmanFordMode mode: {
+                 BellmanFordMode::Sweep, BellmanFordMode::Queue, BellmanFordMode::ParallelSweep
+             }) {
+            BellmanFord bellman_ford(graph, job_system);
+            bellman_ford.set_custom_edge_weights(weights);
+            bellman_ford.mode = mode;
+            ASSERT_TRUE(bellman_ford.compute(sources));
+            EXPECT_EQ(bellman_ford.vertex_distances[Vertex(2)], 0);
+            for (const Vertex &source: sources) {
+                EXPECT_FALSE(bellman_ford.vertex_predecessors[source].is_valid());
+            }
+            // Walk the predecessors of every reached vertex back to a source, the chains must not loop.
+            for (const Vertex &v: graph.vertices) {
+                if (bellman_ford.vertex_distances[v] == std::numeric_limits<Real>::max()) continue;
+                Vertex u = v;
+                size_t steps = 0;
+                while (bellman_ford.vertex_predecessors[u].is_valid() && steps <= graph.vertices.size()) {
+                    u = graph.get_vertex(bellman_ford.vertex_predecessors[u]);
+                    ++steps;
+                }
+                ASSERT_LE(steps, graph.vertices.size()) << "predecessor cycle at vertex " << v.idx();
+                EXPECT_NE(std::find(sources.begin(), sources.end(), u), sources.end());
+            }
+        }
+    }
+}
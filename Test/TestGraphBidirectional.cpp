@@ -0,0 +1,108 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphBidirectional.h"
+#include "GraphDijkstra.h"
+#include "GraphUtils.h"
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+class GraphBidirectionalTest : public ::testing::Test {
+protected:
+    Graph graph;
+    EdgeProperty<Real> weights;
+    VertexProperty<Vector<Real, 3> > positions;
+    static constexpr size_t n = 24;
+
+    // n x n grid with diagonals and jittered positions.
+    void SetUp() override {
+        positions = graph.vertex_property<Vector<Real, 3> >("v:position");
+        for (size_t i = 0; i < n * n; ++i) {
+            const Vertex v = graph.new_vertex();
+            positions[v] = Vector<Real, 3>(i % n + 0.01f * (i * 7 % 5), i / n + 0.01f * (i * 3 % 7), 0);
+        }
+        for (size_t y = 0; y < n; ++y) {
+            for (size_t x = 0; x < n; ++x) {
+                const Vertex v(y * n + x);
+                if (x + 1 < n) graph.add_edge(v, Vertex(y * n + x + 1));
+                if (y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x));
+                if (x + 1 < n && y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x + 1));
+            }
+        }
+        weights = EdgeLengths(graph, positions);
+    }
+
+    // Checks that the backtraced path connects source and sink and has the given length.
+    void ExpectPath(const VertexProperty<Halfedge> &predecessors, const Vertex &source, const Vertex &sink,
+                    Real length) {
+        const std::vector<Halfedge> path = BacktracePathSinkToSource(graph, predecessors, sink, true);
+        Vertex current = source;
+        Real sum = 0;
+        for (const Halfedge &h: path) {
+            EXPECT_EQ(graph.get_vertex(h), current);
+            current = graph.get_vertex(graph.get_opposite(h));
+            sum += weights[graph.get_edge(h)];
+        }
+        EXPECT_EQ(current, sink);
+        EXPECT_NEAR(sum, length, 1e-4);
+    }
+};
+
+TEST_F(GraphBidirectionalTest, MatchesDijkstra) {
+    Dijkstra dijkstra(graph);
+    dijkstra.set_custom_edge_weights(weights);
+    BidirectionalDijkstra bidirectional_dijkstra(graph);
+    bidirectional_dijkstra.set_custom_edge_weights(weights);
+    BidirectionalAStar bidirectional_astar(graph);
+    bidirectional_astar.set_custom_edge_weights(weights);
+    bidirectional_astar.set_heuristic([&](const Vertex &u, const Vertex &v) {
+        return (positions[u] - positions[v]).norm();
+    });
+
+    for (size_t i = 0; i < 40; ++i) {
+        const Vertex source(i * 53 % (n * n)), sink(i * 97 % (n * n));
+        dijkstra.compute(source);
+        const Real expected = dijkstra.vertex_distances[sink];
+
+        EXPECT_NEAR(bidirectional_dijkstra.compute(source, sink), expected, 1e-4);
+        ExpectPath(bidirectional_dijkstra.vertex_predecessors, source, sink, expected);
+
+        EXPECT_NEAR(bidirectional_astar.compute(source, sink), expected, 1e-4);
+        ExpectPath(bidirectional_astar.vertex_predecessors, source, sink, expected);
+        EXPECT_LE(bidirectional_astar.n_settled, bidirectional_dijkstra.n_settled);
+    }
+}
+
+TEST_F(GraphBidirectionalTest, SettlesFewerVerticesThanOneSidedSearch) {
+    const Vertex source(n * (n / 2) + 4), sink(n * (n / 2) + n - 5);
+    // A one sided search settles all vertices closer to the source than the sink.
+    Dijkstra dijkstra(graph);
+    dijkstra.compute(source);
+    const size_t n_one_sided = std::ranges::count_if(dijkstra.vertex_distances.vector(), [&](Real distance) {
+        return distance < dijkstra.vertex_distances[sink];
+    });
+
+    BidirectionalDijkstra bidirectional_dijkstra(graph);
+    bidirectional_dijkstra.compute(source, sink);
+    EXPECT_LT(bidirectional_dijkstra.n_settled, n_one_sided * 3 / 4);
+
+    BidirectionalAStar bidirectional_astar(graph);
+    bidirectional_astar.set_heuristic([&](const Vertex &u, const Vertex &v) {
+        return (positions[u] - positions[v]).norm();
+    });
+    bidirectional_astar.compute(source, sink);
+    EXPECT_LT(bidirectional_astar.n_settled, bidirectional_dijkstra.n_settled / 2);
+}
+
+TEST_F(GraphBidirectionalTest, UnreachableAndTrivialQueries) {
+    const Vertex isolated = graph.new_vertex();
+    BidirectionalDijkstra bidirectional_dijkstra(graph);
+    EXPECT_EQ(bidirectional_dijkstra.compute(Vertex(0), isolated), std::numeric_limits<Real>::max());
+    EXPECT_FALSE(bidirectional_dijkstra.meeting_vertex.is_valid());
+    EXPECT_TRUE(BacktracePathSinkToSource(graph, bidirectional_dijkstra.vertex_predecessors, isolated).empty());
+
+    EXPECT_EQ(bidirectional_dijkstra.compute(Vertex(5), Vertex(5)), 0);
+    EXPECT_TRUE(BacktracePathSinkToSource(graph, bidirectional_dijkstra.vertex_predecessors, Vertex(5)).empty());
+}
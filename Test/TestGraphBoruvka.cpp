@@ -0,0 +1,99 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphBoruvka.h"
+#include "GraphKruskal.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+class GraphBoruvkaTest : public ::testing::Test {
+protected:
+    Graph graph;
+    EdgeProperty<Real> weights;
+    static constexpr size_t n = 12;
+
+    // n x n grid with diagonals and jittered positions, plus a separate triangle.
+    void SetUp() override {
+        auto positions = graph.vertex_property<Vector<Real, 3> >("v:position");
+        for (size_t i = 0; i < n * n + 3; ++i) {
+            const Vertex v = graph.new_vertex();
+            positions[v] = Vector<Real, 3>(i % n + 0.01f * (i * 7 % 5), i / n + 0.01f * (i * 3 % 7), 0);
+        }
+        for (size_t y = 0; y < n; ++y) {
+            for (size_t x = 0; x < n; ++x) {
+                const Vertex v(y * n + x);
+                if (x + 1 < n) graph.add_edge(v, Vertex(y * n + x + 1));
+                if (y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x));
+                if (x + 1 < n && y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x + 1));
+            }
+        }
+        graph.add_edge(Vertex(n * n), Vertex(n * n + 1));
+        graph.add_edge(Vertex(n * n + 1), Vertex(n * n + 2));
+        graph.add_edge(Vertex(n * n + 2), Vertex(n * n));
+        weights = EdgeLengths(graph, positions);
+    }
+
+    // The weight of the tree given by the predecessors, summed in vertex order.
+    Real TreeWeight(const VertexProperty<Halfedge> &predecessors) const {
+        Real weight = 0;
+        for (const Vertex &v: graph.vertices) {
+            if (predecessors[v].is_valid()) weight += weights[graph.get_edge(predecessors[v])];
+        }
+        return weight;
+    }
+};
+
+TEST_F(GraphBoruvkaTest, MatchesKruskal) {
+    Kruskal kruskal(graph);
+    kruskal.set_custom_edge_weights(weights);
+    kruskal.compute(Vertex(0));
+    const Real grid_weight = TreeWeight(kruskal.vertex_predecessors);
+
+    Boruvka boruvka(graph);
+    boruvka.set_custom_edge_weights(weights);
+    boruvka.compute(Vertex(0));
+    EXPECT_NEAR(TreeWeight(boruvka.vertex_predecessors), grid_weight, 1e-4);
+    EXPECT_GT(boruvka.n_rounds, 1);
+
+    // The forest also spans the triangle with its two lightest edges.
+    Real triangle_weight = 0, heaviest = 0;
+    for (const auto &[i, j]: {std::pair{0, 1}, {1, 2}, {2, 0}}) {
+        const Real weight = weights[graph.find_edge(Vertex(n * n + i), Vertex(n * n + j))];
+        triangle_weight += weight;
+        heaviest = std::max(heaviest, weight);
+    }
+    EXPECT_NEAR(boruvka.forest_weight, grid_weight + triangle_weight - heaviest, 1e-4);
+    size_t n_forest_edges = 0;
+    for (const Edge &e: graph.edges) {
+        n_forest_edges += boruvka.edges_in_forest[e];
+    }
+    EXPECT_EQ(n_forest_edges, graph.n_vertices() - 2);
+
+    // Only the tree of the source is rooted.
+    for (const Vertex &v: graph.vertices) {
+        EXPECT_EQ(boruvka.vertex_predecessors[v].is_valid(), v.idx() != 0 && v.idx() < n * n);
+    }
+}
+
+TEST_F(GraphBoruvkaTest, ParallelAndCsrMatchSerial) {
+    Boruvka serial(graph);
+    serial.set_custom_edge_weights(weights);
+    serial.compute(Vertex(5));
+    const std::vector<bool> expected = serial.edges_in_forest.vector();
+    const Real expected_weight = serial.forest_weight;
+
+    JobSystem jobs(3);
+    const GraphCsr csr(graph, weights);
+    for (const bool use_csr: {false, true}) {
+        Boruvka parallel(graph, &jobs);
+        parallel.set_custom_edge_weights(weights);
+        if (use_csr) parallel.set_csr(&csr);
+        parallel.compute(Vertex(5));
+        EXPECT_EQ(parallel.edges_in_forest.vector(), expected);
+        EXPECT_EQ(parallel.forest_weight, expected_weight);
+    }
+}
@@ -0,0 +1,129 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphColoring.h"
+#include "MeshShapes.h"
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+// A side x side grid of vertices with diagonals, and an isolated vertex at the end.
+static Graph MakeGrid(size_t side) {
+    Graph graph;
+    for (size_t i = 0; i <= side * side; ++i) {
+        graph.new_vertex();
+    }
+    for (size_t y = 0; y < side; ++y) {
+        for (size_t x = 0; x < side; ++x) {
+            const Vertex v(y * side + x);
+            if (x + 1 < side) graph.add_edge(v, Vertex(v.idx() + 1));
+            if (y + 1 < side) graph.add_edge(v, Vertex(v.idx() + side));
+            if (x + 1 < side && y + 1 < side) graph.add_edge(v, Vertex(v.idx() + side + 1));
+        }
+    }
+    return graph;
+}
+
+// Checks that the classes hold every colored element once, with its color.
+static void ExpectConsistentClasses(const GraphColoring &coloring, const std::vector<int> &colors) {
+    ASSERT_EQ(coloring.class_offsets.size(), coloring.n_colors + 1);
+    std::vector<int> seen(colors.size(), 0);
+    for (size_t color = 0; color < coloring.n_colors; ++color) {
+        EXPECT_FALSE(coloring.get_class(color).empty());
+        for (const uint32_t i: coloring.get_class(color)) {
+            EXPECT_EQ(colors[i], static_cast<int>(color));
+            ++seen[i];
+        }
+    }
+    for (size_t i = 0; i < colors.size(); ++i) {
+        EXPECT_EQ(seen[i], colors[i] >= 0 ? 1 : 0);
+    }
+}
+
+TEST(GraphColoringTest, GridVerticesAndEdges) {
+    Graph graph = MakeGrid(30);
+    GraphColoring coloring(graph);
+    coloring.compute();
+    // The grid with diagonals has maximal degree 6, so greedy coloring needs at most 7 colors.
+    EXPECT_GE(coloring.n_colors, 3);
+    EXPECT_LE(coloring.n_colors, 7);
+    for (const Edge &e: graph.edges) {
+        EXPECT_NE(coloring.vertex_colors[graph.get_vertex(e, 0)], coloring.vertex_colors[graph.get_vertex(e, 1)]);
+    }
+    ExpectConsistentClasses(coloring, coloring.vertex_colors.vector());
+
+    coloring.compute_edges();
+    for (const Vertex &v: graph.vertices) {
+        std::vector<int> around;
+        for (const Halfedge &h: graph.get_halfedges(v)) {
+            around.push_back(coloring.edge_colors[graph.get_edge(h)]);
+        }
+        std::ranges::sort(around);
+        EXPECT_EQ(std::ranges::adjacent_find(around), around.end());
+    }
+    ExpectConsistentClasses(coloring, coloring.edge_colors.vector());
+
+    coloring.compute_faces();
+    EXPECT_FALSE(coloring.face_colors);
+}
+
+TEST(GraphColoringTest, ParallelMatchesSerial) {
+    Graph graph = MakeGrid(60);
+    GraphColoring serial(graph);
+    serial.compute();
+
+    Graph copy = MakeGrid(60);
+    JobSystem jobs(3);
+    GraphColoring parallel(copy, &jobs);
+    parallel.compute();
+    EXPECT_EQ(parallel.vertex_colors.vector(), serial.vertex_colors.vector());
+    EXPECT_EQ(parallel.class_elements, serial.class_elements);
+    EXPECT_EQ(parallel.n_rounds, serial.n_rounds);
+}
+
+TEST(GraphColoringTest, DeletedVerticesKeepNoColor) {
+    Graph graph = MakeGrid(10);
+    const Vertex isolated(100);
+    graph.delete_vertex(isolated);
+    GraphColoring coloring(graph);
+    coloring.compute();
+    EXPECT_EQ(coloring.vertex_colors[isolated], -1);
+    EXPECT_EQ(coloring.class_elements.size(), 100);
+    ExpectConsistentClasses(coloring, coloring.vertex_colors.vector());
+}
+
+TEST(GraphColoringTest, MeshFacesAndSweep) {
+    Mesh sphere = Icosphere(3);
+    JobSystem jobs(2);
+    GraphColoring coloring(sphere, &jobs);
+    coloring.compute_faces();
+    for (const Vertex &v: sphere.vertices) {
+        std::vector<int> around;
+        for (const Halfedge &h: sphere.get_halfedges(v)) {
+            around.push_back(coloring.face_colors[sphere.get_face(h)]);
+        }
+        std::ranges::sort(around);
+        EXPECT_EQ(std::ranges::adjacent_find(around), around.end());
+    }
+    ExpectConsistentClasses(coloring, coloring.face_colors.vector());
+
+    // A Gauss-Seidel style sweep over the vertices: every vertex takes the maximum of its own and its neighbors'
+    // values plus one, which is only well defined if no two neighbors are updated at the same time.
+    coloring.compute();
+    auto values = sphere.vertex_property<int>("v:values", 0);
+    std::vector<int> visits(sphere.vertices.size(), 0);
+    coloring.sweep(16, [&](size_t i) {
+        const Vertex v(i);
+        int value = values[v];
+        for (const Halfedge &h: sphere.get_halfedges(v)) {
+            value = std::max(value, values[sphere.get_vertex(h)]);
+        }
+        values[v] = value + 1;
+        ++visits[i];
+    });
+    for (const Vertex &v: sphere.vertices) {
+        EXPECT_EQ(visits[v.idx()], 1);
+        EXPECT_EQ(values[v], coloring.vertex_colors[v] + 1);
+    }
+}
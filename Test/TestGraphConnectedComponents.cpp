@@ -0,0 +1,103 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphConnectedComponents.h"
+#include "JobSystem.h"
+#include "MeshShapes.h"
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+// Strips of width x 2 vertices with their vertices interleaved, so the smallest index of every strip is not its
+// first vertex in traversal order. Every strip is one component and vertex n_strips * 2 * width is isolated.
+static Graph MakeStrips(size_t n_strips, size_t width) {
+    Graph graph;
+    const size_t n = n_strips * 2 * width;
+    for (size_t i = 0; i <= n; ++i) {
+        graph.new_vertex();
+    }
+    auto index = [&](size_t strip, size_t j) { return Vertex(j * n_strips + strip); };
+    for (size_t strip = 0; strip < n_strips; ++strip) {
+        for (size_t x = 0; x < width; ++x) {
+            graph.add_edge(index(strip, 2 * x), index(strip, 2 * x + 1));
+            if (x + 1 < width) {
+                graph.add_edge(index(strip, 2 * x + 1), index(strip, 2 * x + 2));
+                graph.add_edge(index(strip, 2 * x + 3), index(strip, 2 * x));
+            }
+        }
+    }
+    return graph;
+}
+
+TEST(GraphConnectedComponentsTest, ParallelMatchesSerial) {
+    Graph graph = MakeStrips(7, 40);
+    ConnectedComponents serial(graph);
+    serial.compute();
+
+    JobSystem jobs(3);
+    for (const size_t neighbor_rounds: {0, 1, 2, 8}) {
+        ParallelConnectedComponents parallel(graph, &jobs);
+        parallel.neighbor_rounds = neighbor_rounds;
+        parallel.compute();
+        EXPECT_EQ(parallel.n_components, 8);
+        EXPECT_EQ(parallel.component_ids.vector(), serial.component_ids.vector());
+    }
+}
+
+TEST(GraphConnectedComponentsTest, DeletedVerticesKeepNoComponent) {
+    Graph graph = MakeStrips(3, 10);
+    const Vertex isolated(3 * 2 * 10);
+    graph.delete_vertex(isolated);
+    graph.delete_edge(graph.find_edge(Vertex(0), Vertex(3)));
+    ParallelConnectedComponents parallel(graph);
+    parallel.compute();
+    EXPECT_EQ(parallel.component_ids[isolated], -1);
+    EXPECT_EQ(parallel.n_components, 3);
+
+    ConnectedComponents serial(graph);
+    serial.compute();
+    for (const Vertex &v: graph.vertices) {
+        EXPECT_EQ(parallel.component_ids[v], serial.component_ids[v]);
+    }
+}
+
+TEST(GraphConnectedComponentsTest, MeshVerticesAndFaces) {
+    // Patches of triangles which do not share vertices, and an isolated vertex at the end.
+    Mesh mesh;
+    const size_t n_patches = 4;
+    for (size_t p = 0; p < n_patches; ++p) {
+        const size_t side = p + 2;
+        const size_t first = mesh.vertices.size();
+        for (size_t i = 0; i < side * side; ++i) {
+            mesh.new_vertex();
+        }
+        for (size_t y = 0; y + 1 < side; ++y) {
+            for (size_t x = 0; x + 1 < side; ++x) {
+                const Vertex v(first + y * side + x);
+                mesh.add_triangle(v, Vertex(v.idx() + 1), Vertex(v.idx() + side + 1));
+                mesh.add_triangle(v, Vertex(v.idx() + side + 1), Vertex(v.idx() + side));
+            }
+        }
+    }
+    mesh.new_vertex();
+
+    JobSystem jobs(2);
+    ParallelConnectedComponents components(mesh, &jobs);
+    components.compute();
+    EXPECT_EQ(components.n_components, n_patches + 1);
+    components.compute_faces();
+    EXPECT_EQ(components.n_components, n_patches);
+
+    for (const Face &f: mesh.faces) {
+        for (const Vertex &v: mesh.get_vertices(f)) {
+            EXPECT_EQ(components.component_ids[v], components.face_component_ids[f]);
+        }
+    }
+    EXPECT_EQ(components.component_ids[Vertex(mesh.vertices.size() - 1)], n_patches);
+
+    Mesh sphere = Icosphere(3);
+    ParallelConnectedComponents sphere_components(sphere, &jobs);
+    sphere_components.compute_faces();
+    EXPECT_EQ(sphere_components.n_components, 1);
+}
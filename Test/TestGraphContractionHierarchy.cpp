@@ -0,0 +1,188 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphContractionHierarchy.h"
+#include "GraphDijkstra.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+class GraphContractionHierarchyTest : public ::testing::Test {
+protected:
+    Graph graph;
+    EdgeProperty<Real> weights;
+    static constexpr size_t n = 20;
+
+    // n x n grid with diagonals and jittered positions, plus a separate triangle.
+    void SetUp() override {
+        auto positions = graph.vertex_property<Vector<Real, 3> >("v:position");
+        for (size_t i = 0; i < n * n + 3; ++i) {
+            const Vertex v = graph.new_vertex();
+            positions[v] = Vector<Real, 3>(i % n + 0.01f * (i * 7 % 5), i / n + 0.01f * (i * 3 % 7), 0);
+        }
+        for (size_t y = 0; y < n; ++y) {
+            for (size_t x = 0; x < n; ++x) {
+                const Vertex v(y * n + x);
+                if (x + 1 < n) graph.add_edge(v, Vertex(y * n + x + 1));
+                if (y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x));
+                if (x + 1 < n && y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x + 1));
+            }
+        }
+        graph.add_edge(Vertex(n * n), Vertex(n * n + 1));
+        graph.add_edge(Vertex(n * n + 1), Vertex(n * n + 2));
+        graph.add_edge(Vertex(n * n + 2), Vertex(n * n));
+        weights = EdgeLengths(graph, positions);
+    }
+
+    // Checks distances and unpacked paths of the hierarchy against Dijkstra for a set of queries.
+    void ExpectMatchesDijkstra(ContractionHierarchy &hierarchy) {
+        Dijkstra dijkstra(graph);
+        dijkstra.set_custom_edge_weights(weights);
+        for (size_t i = 0; i < 30; ++i) {
+            const Vertex source(i * 37 % (n * n)), sink(i * 101 % (n * n));
+            dijkstra.compute(source);
+            EXPECT_NEAR(hierarchy.compute(source, sink), dijkstra.vertex_distances[sink], 1e-4);
+
+            const std::vector<Halfedge> path = hierarchy.get_path();
+            Vertex current = sink;
+            Real length = 0;
+            for (const Halfedge &h: path) {
+                EXPECT_EQ(graph.get_vertex(graph.get_opposite(h)), current);
+                current = graph.get_vertex(h);
+                length += weights[graph.get_edge(h)];
+            }
+            EXPECT_EQ(current, source);
+            EXPECT_NEAR(length, dijkstra.vertex_distances[sink], 1e-4);
+            EXPECT_EQ(path.size(), BacktracePathSinkToSource(graph, dijkstra.vertex_predecessors, sink).size());
+        }
+    }
+};
+
+TEST_F(GraphContractionHierarchyTest, MatchesDijkstra) {
+    ContractionHierarchy hierarchy(graph);
+    hierarchy.build();
+    EXPECT_TRUE(hierarchy.is_built());
+    EXPECT_GT(hierarchy.n_shortcuts, 0);
+    ExpectMatchesDijkstra(hierarchy);
+    // The upward searches settle far fewer vertices than a full search.
+    hierarchy.compute(Vertex(0), Vertex(n * n - 1));
+    EXPECT_LT(hierarchy.n_settled, n * n / 2);
+}
+
+TEST_F(GraphContractionHierarchyTest, ParallelBuildMatchesDijkstra) {
+    JobSystem jobs(3);
+    ContractionHierarchy hierarchy(graph, &jobs);
+    hierarchy.set_custom_edge_weights(weights);
+    hierarchy.build();
+    ExpectMatchesDijkstra(hierarchy);
+}
+
+TEST_F(GraphContractionHierarchyTest, ReversedPathAndTrivialQueries) {
+    ContractionHierarchy hierarchy(graph);
+    EXPECT_EQ(hierarchy.compute(Vertex(0), Vertex(1)), std::numeric_limits<Real>::max());
+    hierarchy.build();
+
+    hierarchy.compute(Vertex(3), Vertex(n * 5 + 7));
+    std::vector<Halfedge> reversed = hierarchy.get_path(true);
+    std::ranges::reverse(reversed);
+    EXPECT_EQ(reversed, hierarchy.get_path());
+
+    EXPECT_EQ(hierarchy.compute(Vertex(5), Vertex(5)), 0);
+    EXPECT_TRUE(hierarchy.get_path().empty());
+    EXPECT_EQ(hierarchy.compute(Vertex(0), Vertex(n * n + 1)), std::numeric_limits<Real>::max());
+    EXPECT_TRUE(hierarchy.get_path().empty());
+    EXPECT_GT(hierarchy.compute(Vertex(n * n), Vertex(n * n + 2)), 0);
+}
+
+TEST_F(GraphContractionHierarchyTest, SaveAndLoad) {
+    const std::string filename = (std::filesystem::temp_directory_path() / "TestGraphContractionHierarchy.ch").string();
+    ContractionHierarchy hierarchy(graph);
+    hierarchy.build();
+    ASSERT_TRUE(hierarchy.save(filename));
+
+    ContractionHierarchy loaded(graph);
+    ASSERT_TRUE(loaded.load(filename));
+    EXPECT_EQ(loaded.n_shortcuts, hierarchy.n_shortcuts);
+    ExpectMatchesDijkstra(loaded);
+
+    graph.add_edge(Vertex(0), Vertex(n * n));
+    ContractionHierarchy stale(graph);
+    EXPECT_FALSE(stale.load(filename));
+    EXPECT_FALSE(stale.is_built());
+    std::filesystem::remove(filename);
+}
+
+TEST_F(GraphContractionHierarchyTest, RejectsCorruptFiles) {
+    const std::string filename = (std::filesystem::temp_directory_path() / "TestGraphContractionHierarchy.ch").string();
+    const std::string corrupt = (std::filesystem::temp_directory_path() / "TestGraphContractionHierarchyBad.ch").string();
+    ContractionHierarchy hierarchy(graph);
+    hierarchy.build();
+    ASSERT_TRUE(hierarchy.save(filename));
+    std::ifstream in(filename, std::ios::binary);
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    // The layout of save: magic, halfedge count, then every vector as its size followed by its values.
+    const size_t n_vertices = graph.vertices.size();
+    const size_t ranks_at = 16 + 8;
+    const size_t offsets_at = ranks_at + 4 * n_vertices + 8;
+    const size_t targets_at = offsets_at + 8 * (n_vertices + 1) + 8;
+    uint64_t n_up = 0;
+    std::memcpy(&n_up, bytes.data() + offsets_at + 8 * n_vertices, sizeof(n_up));
+    const size_t middles_at = targets_at + 2 * (4 * n_up + 8);
+    const size_t halfedges_at = middles_at + 4 * n_up + 8;
+    ASSERT_EQ(bytes.size(), halfedges_at + 4 * n_up);
+    // The first upward edge which is an edge of the graph and the first which is a shortcut.
+    size_t edge = n_up, shortcut = n_up;
+    for (size_t i = n_up; i-- > 0;) {
+        uint32_t middle = 0;
+        std::memcpy(&middle, bytes.data() + middles_at + 4 * i, sizeof(middle));
+        (middle == std::numeric_limits<uint32_t>::max() ? edge : shortcut) = i;
+    }
+    ASSERT_LT(edge, n_up);
+    ASSERT_LT(shortcut, n_up);
+    uint32_t halfedge = 0;
+    std::memcpy(&halfedge, bytes.data() + halfedges_at + 4 * edge, sizeof(halfedge));
+    const Vertex lower = graph.get_vertex(graph.get_opposite(Halfedge(halfedge)));
+
+    auto expect_rejected = [&](size_t at, auto value, size_t size = std::numeric_limits<size_t>::max()) {
+        std::vector<char> changed(bytes.begin(), bytes.begin() + std::min(size, bytes.size()));
+        if (at + sizeof(value) <= changed.size()) std::memcpy(changed.data() + at, &value, sizeof(value));
+        std::ofstream(corrupt, std::ios::binary).write(changed.data(), static_cast<std::streamsize>(changed.size()));
+        // A failed load clears a previous hierarchy as well.
+        ContractionHierarchy loaded(graph);
+        ASSERT_TRUE(loaded.load(filename));
+        EXPECT_FALSE(loaded.load(corrupt));
+        EXPECT_FALSE(loaded.is_built());
+        EXPECT_EQ(loaded.n_shortcuts, 0u);
+    };
+    // A huge number of upward edges is rejected before it is allocated, as is a truncated file.
+    expect_rejected(offsets_at + 8 * n_vertices, uint64_t(1) << 60);
+    expect_rejected(offsets_at + 8 * n_vertices, n_up + 1);
+    expect_rejected(0, char('B'), bytes.size() - 1);
+    // Offsets which decrease, and ranks which repeat or are out of range.
+    expect_rejected(offsets_at + 8, n_up);
+    expect_rejected(ranks_at, uint32_t(n_vertices));
+    uint32_t second_rank = 0;
+    std::memcpy(&second_rank, bytes.data() + ranks_at + 4, sizeof(second_rank));
+    expect_rejected(ranks_at, second_rank);
+    // Targets, middles and halfedges out of range or not matching the graph, and negative weights.
+    expect_rejected(targets_at + 4 * edge, uint32_t(n_vertices));
+    expect_rejected(targets_at + 4 * edge, static_cast<uint32_t>(lower.idx()));
+    expect_rejected(targets_at + 4 * n_up + 8 + 4 * edge, Real(-1));
+    expect_rejected(middles_at + 4 * shortcut, uint32_t(n_vertices + 5));
+    expect_rejected(halfedges_at + 4 * edge, uint32_t(graph.halfedges.size()));
+    expect_rejected(halfedges_at + 4 * edge, static_cast<uint32_t>(graph.get_opposite(Halfedge(halfedge)).idx()));
+
+    ContractionHierarchy loaded(graph);
+    EXPECT_TRUE(loaded.load(filename));
+    ExpectMatchesDijkstra(loaded);
+    std::filesystem::remove(filename);
+    std::filesystem::remove(corrupt);
+}
@@ -0,0 +1,195 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphCsr.h"
+#include "GraphDijkstra.h"
+#include "GraphAStar.h"
+#include "GraphBellmanFord.h"
+#include "GraphPrim.h"
+#include "GraphKruskal.h"
+#include "GraphFloydWarshall.h"
+#include "GraphConnectedComponents.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include "MeshShapes.h"
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+class GraphCsrTest : public ::testing::Test {
+protected:
+    Graph graph;
+    EdgeProperty<Real> weights;
+    static constexpr size_t n = 12;
+
+    // n x n grid with diagonals and jittered positions, so that shortest paths are unique.
+    void SetUp() override {
+        auto positions = graph.vertex_property<Vector<Real, 3> >("v:position");
+        for (size_t i = 0; i < n * n; ++i) {
+            const Vertex v = graph.new_vertex();
+            positions[v] = Vector<Real, 3>(i % n + 0.01f * (i * 7 % 5), i / n + 0.01f * (i * 3 % 7), 0);
+        }
+        for (size_t y = 0; y < n; ++y) {
+            for (size_t x = 0; x < n; ++x) {
+                const Vertex v(y * n + x);
+                if (x + 1 < n) graph.add_edge(v, Vertex(y * n + x + 1));
+                if (y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x));
+                if (x + 1 < n && y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x + 1));
+            }
+        }
+        weights = EdgeLengths(graph, positions);
+    }
+};
+
+TEST_F(GraphCsrTest, MatchesHalfedgeCirculation) {
+    GraphCsr csr(graph, weights);
+    ASSERT_EQ(csr.n_vertices(), graph.n_vertices());
+    EXPECT_EQ(csr.n_entries(), graph.n_halfedges());
+    for (const auto &v: graph.vertices) {
+        size_t i = csr.begin(v);
+        for (const auto &h: graph.get_halfedges(v)) {
+            ASSERT_LT(i, csr.end(v));
+            EXPECT_EQ(csr.get_halfedge(i), h);
+            EXPECT_EQ(csr.get_vertex(i), graph.get_vertex(h));
+            EXPECT_EQ(csr.get_edge(i), graph.get_edge(h));
+            EXPECT_EQ(csr.get_weight(i), weights[graph.get_edge(h)]);
+            ++i;
+        }
+        EXPECT_EQ(i, csr.end(v));
+        EXPECT_EQ(csr.get_valence(v), graph.get_valence(v));
+    }
+}
+
+TEST_F(GraphCsrTest, ParallelBuildMatchesSerialBuild) {
+    JobSystem jobs(3);
+    GraphCsr serial(graph, weights);
+    GraphCsr parallel(graph, weights, &jobs);
+    EXPECT_EQ(serial.offsets, parallel.offsets);
+    EXPECT_EQ(serial.neighbors, parallel.neighbors);
+    EXPECT_EQ(serial.halfedges, parallel.halfedges);
+    EXPECT_EQ(serial.weights, parallel.weights);
+}
+
+TEST_F(GraphCsrTest, ShortestPathsMatchGraph) {
+    GraphCsr csr(graph, weights);
+    const Vertex source(0), sink(n * n - 1);
+
+    Dijkstra dijkstra(graph);
+    dijkstra.set_custom_edge_weights(weights);
+    dijkstra.compute(source);
+    const std::vector<Real> expected_distances = dijkstra.vertex_distances.vector();
+    const std::vector<Halfedge> expected_path = BacktracePathSinkToSource(graph, dijkstra.vertex_predecessors, sink);
+    ASSERT_FALSE(expected_path.empty());
+
+    dijkstra.set_csr(&csr);
+    dijkstra.compute(source);
+    EXPECT_EQ(dijkstra.vertex_distances.vector(), expected_distances);
+    EXPECT_EQ(BacktracePathSinkToSource(graph, dijkstra.vertex_predecessors, sink), expected_path);
+
+    AStar astar(graph);
+    astar.set_csr(&csr);
+    astar.compute(source, sink);
+    EXPECT_EQ(BacktracePathSinkToSource(graph, astar.vertex_predecessors, sink), expected_path);
+
+    BellmanFord bellman_ford(graph);
+    bellman_ford.set_csr(&csr);
+    EXPECT_TRUE(bellman_ford.compute(source));
+    for (const auto &v: graph.vertices) {
+        EXPECT_NEAR(bellman_ford.vertex_distances[v], expected_distances[v.idx()], 1e-4);
+    }
+
+    FloydWarshall floyd_warshall(graph);
+    floyd_warshall.set_csr(&csr);
+    floyd_warshall.compute();
+    for (const auto &v: graph.vertices) {
+        EXPECT_NEAR(floyd_warshall.vertex_vertex_distances(source.idx(), v.idx()), expected_distances[v.idx()], 1e-4);
+    }
+}
+
+TEST_F(GraphCsrTest, SpanningTreesMatchGraph) {
+    GraphCsr csr(graph, weights);
+    auto tree_weight = [&](const VertexProperty<Halfedge> &predecessors) {
+        Real sum = 0;
+        size_t n_tree_edges = 0;
+        for (const auto &v: graph.vertices) {
+            if (predecessors[v].is_valid()) {
+                sum += weights[graph.get_edge(predecessors[v])];
+                ++n_tree_edges;
+            }
+        }
+        EXPECT_EQ(n_tree_edges, graph.n_vertices() - 1);
+        return sum;
+    };
+
+    Prim prim(graph);
+    prim.set_custom_edge_weights(weights);
+    prim.compute(Vertex(0));
+    const Real expected = tree_weight(prim.vertex_predecessors);
+    prim.set_csr(&csr);
+    prim.compute(Vertex(0));
+    EXPECT_NEAR(tree_weight(prim.vertex_predecessors), expected, 1e-4);
+
+    Kruskal kruskal(graph);
+    kruskal.set_csr(&csr);
+    kruskal.compute(Vertex(0));
+    EXPECT_NEAR(tree_weight(kruskal.vertex_predecessors), expected, 1e-4);
+}
+
+TEST_F(GraphCsrTest, StaleSnapshotIsRejected) {
+    GraphCsr csr(graph, weights);
+    graph.new_vertex();
+    Dijkstra dijkstra(graph);
+    dijkstra.set_csr(&csr);
+    dijkstra.compute(Vertex(0));
+    EXPECT_FALSE(dijkstra.vertex_distances);
+}
+
+TEST(GraphCsrMeshTest, AlgorithmsRunOnMesh) {
+    Mesh mesh = Icosphere(2);
+    const EdgeProperty<Real> weights = EdgeLengths(mesh, mesh.get_vertex_property<Vector<Real, 3> >("v:position"));
+    const GraphCsr csr(mesh, weights);
+    const Vertex source(0), sink(mesh.vertices.size() - 1);
+
+    Dijkstra dijkstra(mesh);
+    dijkstra.set_custom_edge_weights(weights);
+    dijkstra.compute(source);
+    const std::vector<Real> expected_distances = dijkstra.vertex_distances.vector();
+    // The predecessors are halfedges of the mesh, which point back towards the source.
+    for (const auto &v: mesh.vertices) {
+        if (v == source) continue;
+        const Halfedge h = dijkstra.vertex_predecessors[v];
+        ASSERT_TRUE(h.is_valid());
+        EXPECT_NEAR(expected_distances[mesh.get_vertex(h).idx()] + weights[mesh.get_edge(h)],
+                    expected_distances[v.idx()], 1e-4);
+    }
+    dijkstra.set_csr(&csr);
+    dijkstra.compute(source);
+    EXPECT_EQ(dijkstra.vertex_distances.vector(), expected_distances);
+
+    AStar astar(mesh);
+    astar.set_custom_edge_weights(weights);
+    astar.compute(source, sink);
+    EXPECT_NEAR(astar.vertex_distances[sink], expected_distances[sink.idx()], 1e-4);
+
+    auto tree_weight = [&](const VertexProperty<Halfedge> &predecessors) {
+        Real sum = 0;
+        for (const auto &v: mesh.vertices) {
+            if (predecessors[v].is_valid()) sum += weights[mesh.get_edge(predecessors[v])];
+        }
+        return sum;
+    };
+    Prim prim(mesh);
+    prim.set_custom_edge_weights(weights);
+    prim.compute(source);
+    Kruskal kruskal(mesh);
+    kruskal.set_csr(&csr);
+    kruskal.compute(source);
+    EXPECT_NEAR(tree_weight(kruskal.vertex_predecessors), tree_weight(prim.vertex_predecessors), 1e-4);
+
+    ConnectedComponents components(mesh);
+    components.compute();
+    for (const auto &v: mesh.vertices) {
+        EXPECT_EQ(components.component_ids[v], 0);
+    }
+}
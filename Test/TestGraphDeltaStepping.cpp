@@ -0,0 +1,163 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphDeltaStepping.h"
+#include "GraphDijkstra.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+class GraphDeltaSteppingTest : public ::testing::Test {
+protected:
+    Graph graph;
+    EdgeProperty<Real> weights;
+    Dijkstra<> dijkstra{graph};
+    static constexpr size_t n = 30;
+
+    // n x n grid with diagonals and jittered positions.
+    void SetUp() override {
+        auto positions = graph.vertex_property<Vector<Real, 3> >("v:position");
+        for (size_t i = 0; i < n * n; ++i) {
+            const Vertex v = graph.new_vertex();
+            positions[v] = Vector<Real, 3>(i % n + 0.01f * (i * 7 % 5), i / n + 0.01f * (i * 3 % 7), 0);
+        }
+        for (size_t y = 0; y < n; ++y) {
+            for (size_t x = 0; x < n; ++x) {
+                const Vertex v(y * n + x);
+                if (x + 1 < n) graph.add_edge(v, Vertex(y * n + x + 1));
+                if (y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x));
+                if (x + 1 < n && y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x + 1));
+            }
+        }
+        weights = EdgeLengths(graph, positions);
+        dijkstra.set_custom_edge_weights(weights);
+    }
+
+    // The grid has equally short paths, so the predecessors only have to lie on a shortest path.
+    void ExpectMatchesDijkstra(const DeltaStepping &delta_stepping) {
+        for (const auto &v: graph.vertices) {
+            EXPECT_EQ(delta_stepping.vertex_distances[v], dijkstra.vertex_distances[v]);
+            const Halfedge h = delta_stepping.vertex_predecessors[v];
+            ASSERT_EQ(h.is_valid(), dijkstra.vertex_predecessors[v].is_valid());
+            if (h.is_valid()) {
+                EXPECT_EQ(graph.get_vertex(graph.get_opposite(h)), v);
+                EXPECT_EQ(dijkstra.vertex_distances[graph.get_vertex(h)] + weights[graph.get_edge(h)],
+                          dijkstra.vertex_distances[v]);
+            }
+        }
+    }
+};
+
+TEST_F(GraphDeltaSteppingTest, MatchesDijkstraForBucketWidths) {
+    dijkstra.compute(Vertex(0));
+    for (const Real delta: {0.0f, 0.3f, 1.0f, 2.5f, 100.0f}) {
+        DeltaStepping delta_stepping(graph);
+        delta_stepping.set_custom_edge_weights(weights);
+        delta_stepping.delta = delta;
+        delta_stepping.compute(Vertex(0));
+        ExpectMatchesDijkstra(delta_stepping);
+    }
+}
+
+TEST(GraphDeltaSteppingPath, SmallDeltaOnLongPath) {
+    // The distances span 750000 bucket widths, the cyclic bucket array only needs the largest weight over delta.
+    Graph path;
+    const size_t n = 10000;
+    for (size_t i = 0; i < n; ++i) {
+        path.new_vertex();
+    }
+    for (size_t i = 0; i + 1 < n; ++i) {
+        path.add_edge(Vertex(i), Vertex(i + 1));
+    }
+    auto weights = path.edge_property<Real>("e:weight", 0);
+    for (const auto &e: path.edges) {
+        weights[e] = e.idx() % 2 == 0 ? 1.0f : 0.5f;
+    }
+    JobSystem jobs(2);
+    for (JobSystem *job_system: {static_cast<JobSystem *>(nullptr), &jobs}) {
+        DeltaStepping delta_stepping(path, job_system);
+        delta_stepping.set_custom_edge_weights(weights);
+        delta_stepping.delta = 0.01f;
+        delta_stepping.compute(Vertex(0));
+        EXPECT_EQ(delta_stepping.n_slots, 102u);
+        EXPECT_EQ(delta_stepping.n_buckets, n);
+        Real expected = 0;
+        for (size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(delta_stepping.vertex_distances[Vertex(i)], expected);
+            if (i + 1 < n) expected += weights[Edge(i)];
+        }
+    }
+}
+
+TEST_F(GraphDeltaSteppingTest, ParallelMatchesDijkstra) {
+    JobSystem jobs(3);
+    GraphCsr csr(graph, weights);
+    const std::vector<Vertex> sources = {Vertex(n / 2), Vertex(n * n - 1)};
+    dijkstra.compute(sources);
+    DeltaStepping delta_stepping(graph, &jobs);
+    delta_stepping.compute(sources);
+    ExpectMatchesDijkstra(delta_stepping);
+    delta_stepping.set_csr(&csr);
+    delta_stepping.delta = 0.5f;
+    delta_stepping.compute(sources);
+    ExpectMatchesDijkstra(delta_stepping);
+}
+
+TEST_F(GraphDeltaSteppingTest, UnreachableVertices) {
+    const Vertex isolated = graph.new_vertex();
+    DeltaStepping delta_stepping(graph);
+    delta_stepping.compute(Vertex(0));
+    EXPECT_EQ(delta_stepping.vertex_distances[isolated], std::numeric_limits<Real>::max());
+    EXPECT_FALSE(delta_stepping.vertex_predecessors[isolated].is_valid());
+    EXPECT_EQ(delta_stepping.vertex_distances[Vertex(0)], 0);
+    EXPECT_FALSE(delta_stepping.vertex_predecessors[Vertex(0)].is_valid());
+}
+
+// Walks the predecessors of every reached vertex back to a source, the chains must not loop.
+static void ExpectPredecessorChainsReachSources(const Graph &graph, const DeltaStepping &delta_stepping,
+                                                const std::vector<Vertex> &sources) {
+    for (const Vertex &source: sources) {
+        EXPECT_FALSE(delta_stepping.vertex_predecessors[source].is_valid());
+    }
+    for (const auto &v: graph.vertices) {
+        if (delta_stepping.vertex_distances[v] == std::numeric_limits<Real>::max()) continue;
+        Vertex u = v;
+        size_t steps = 0;
+        while (delta_stepping.vertex_predecessors[u].is_valid() && steps <= graph.vertices.size()) {
+            u = graph.get_vertex(delta_stepping.vertex_predecessors[u]);
+            ++steps;
+        }
+        ASSERT_LE(steps, graph.vertices.size()) << "predecessor cycle at vertex " << v.idx();
+        EXPECT_NE(std::find(sources.begin(), sources.end(), u), sources.end());
+    }
+}
+
+TEST_F(GraphDeltaSteppingTest, ZeroWeightEdgesGiveAcyclicPredecessors) {
+    // A path 0 - 1 - 2 of zero weight edges.
+    Graph path;
+    const Vertex a = path.new_vertex(), b = path.new_vertex(), c = path.new_vertex();
+    path.add_edge(a, b);
+    path.add_edge(b, c);
+    EdgeProperty<Real> zero = path.edge_property<Real>("e:zero", 0);
+    DeltaStepping path_stepping(path);
+    path_stepping.set_custom_edge_weights(zero);
+    path_stepping.compute(a);
+    EXPECT_EQ(path_stepping.vertex_distances[c], 0);
+    ExpectPredecessorChainsReachSources(path, path_stepping, {a});
+
+    // Every third edge of the grid has zero weight, so many vertices are equally far from the sources.
+    for (const auto &e: graph.edges) {
+        if (e.idx() % 3 == 0) weights[e] = 0;
+    }
+    JobSystem jobs(3);
+    const std::vector<Vertex> sources = {Vertex(0), Vertex(n * n / 2)};
+    for (JobSystem *job_system: {static_cast<JobSystem *>(nullptr), &jobs}) {
+        DeltaStepping delta_stepping(graph, job_system);
+        delta_stepping.set_custom_edge_weights(weights);
+        delta_stepping.compute(sources);
+        ExpectPredecessorChainsReachSources(graph, delta_stepping, sources);
+    }
+}
@@ -0,0 +1,134 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphDijkstraQuery.h"
+#include "GraphDijkstra.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+class GraphDijkstraQueryTest : public ::testing::Test {
+protected:
+    Graph graph;
+    EdgeProperty<Real> weights;
+    static constexpr size_t n = 16;
+
+    // n x n grid with diagonals and jittered positions, so that shortest paths are unique.
+    void SetUp() override {
+        auto positions = graph.vertex_property<Vector<Real, 3> >("v:position");
+        for (size_t i = 0; i < n * n; ++i) {
+            const Vertex v = graph.new_vertex();
+            positions[v] = Vector<Real, 3>(i % n + 0.01f * (i * 7 % 5), i / n + 0.01f * (i * 3 % 7), 0);
+        }
+        for (size_t y = 0; y < n; ++y) {
+            for (size_t x = 0; x < n; ++x) {
+                const Vertex v(y * n + x);
+                if (x + 1 < n) graph.add_edge(v, Vertex(y * n + x + 1));
+                if (y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x));
+                if (x + 1 < n && y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x + 1));
+            }
+        }
+        weights = EdgeLengths(graph, positions);
+    }
+};
+
+TEST_F(GraphDijkstraQueryTest, MatchesDijkstraWithReusedWorkspace) {
+    GraphCsr csr(graph, weights);
+    DijkstraQuery query(csr);
+    DijkstraWorkspace workspace;
+    Dijkstra dijkstra(graph);
+    dijkstra.set_custom_edge_weights(weights);
+
+    for (size_t s = 0; s < n * n; s += 37) {
+        const Vertex source(s);
+        dijkstra.compute(source);
+        query.compute(workspace, source);
+        EXPECT_EQ(workspace.n_settled, graph.n_vertices());
+        for (const auto &v: graph.vertices) {
+            EXPECT_EQ(workspace.get_distance(v), dijkstra.vertex_distances[v]);
+            EXPECT_EQ(workspace.get_predecessor(v), dijkstra.vertex_predecessors[v]);
+        }
+        const Vertex sink(n * n - 1 - s);
+        EXPECT_EQ(workspace.get_path(sink), BacktracePathSinkToSource(graph, dijkstra.vertex_predecessors, sink));
+        EXPECT_EQ(workspace.get_path(sink, true),
+                  BacktracePathSinkToSource(graph, dijkstra.vertex_predecessors, sink, true));
+    }
+}
+
+TEST_F(GraphDijkstraQueryTest, StopsAtSink) {
+    GraphCsr csr(graph, weights);
+    DijkstraQuery query(csr);
+    DijkstraWorkspace workspace;
+    Dijkstra dijkstra(graph);
+    dijkstra.set_custom_edge_weights(weights);
+    dijkstra.compute(Vertex(0));
+
+    const Vertex sink(n + 1);
+    EXPECT_EQ(query.compute(workspace, Vertex(0), sink), dijkstra.vertex_distances[sink]);
+    EXPECT_LT(workspace.n_settled, graph.n_vertices() / 4);
+    EXPECT_EQ(workspace.get_path(sink), BacktracePathSinkToSource(graph, dijkstra.vertex_predecessors, sink));
+    EXPECT_FALSE(workspace.is_reached(Vertex(n * n - 1)));
+
+    // A source is its own sink with an empty path.
+    EXPECT_EQ(query.compute(workspace, sink, sink), 0);
+    EXPECT_TRUE(workspace.get_path(sink).empty());
+}
+
+TEST_F(GraphDijkstraQueryTest, UnreachableSink) {
+    const Vertex isolated = graph.new_vertex();
+    GraphCsr csr(graph, weights);
+    DijkstraQuery query(csr);
+    DijkstraWorkspace workspace;
+    EXPECT_EQ(query.compute(workspace, Vertex(0), isolated), std::numeric_limits<Real>::max());
+    EXPECT_FALSE(workspace.get_predecessor(isolated).is_valid());
+    EXPECT_TRUE(workspace.get_path(isolated).empty());
+}
+
+TEST_F(GraphDijkstraQueryTest, MultipleSources) {
+    GraphCsr csr(graph, weights);
+    DijkstraQuery query(csr);
+    DijkstraWorkspace workspace;
+    const std::vector<Vertex> sources = {Vertex(0), Vertex(n * n - 1)};
+    Dijkstra dijkstra(graph);
+    dijkstra.set_custom_edge_weights(weights);
+    dijkstra.compute(sources);
+    query.compute(workspace, sources);
+    for (const auto &v: graph.vertices) {
+        EXPECT_EQ(workspace.get_distance(v), dijkstra.vertex_distances[v]);
+    }
+}
+
+TEST_F(GraphDijkstraQueryTest, BatchMatchesSingleQueries) {
+    GraphCsr csr(graph, weights);
+    DijkstraQuery query(csr);
+    std::vector<std::pair<Vertex, Vertex> > queries;
+    for (size_t i = 0; i < 200; ++i) {
+        queries.emplace_back(Vertex(i * 13 % (n * n)), Vertex(i * 29 % (n * n)));
+    }
+
+    DijkstraWorkspace workspace;
+    std::vector<Real> expected;
+    std::vector<std::vector<Halfedge> > expected_paths;
+    for (const auto &[source, sink]: queries) {
+        expected.push_back(query.compute(workspace, source, sink));
+        expected_paths.push_back(workspace.get_path(sink));
+    }
+
+    JobSystem jobs(3);
+    std::vector<std::vector<Halfedge> > paths;
+    EXPECT_EQ(query.compute_batch(queries), expected);
+    EXPECT_EQ(query.compute_batch(queries, &jobs, &paths), expected);
+    EXPECT_EQ(paths, expected_paths);
+
+    // The workspaces are kept across batches, at most one per worker and the calling thread.
+    EXPECT_GE(query.n_workspaces(), 1u);
+    EXPECT_LE(query.n_workspaces(), jobs.num_threads() + 1);
+    for (int repeat = 0; repeat < 3; ++repeat) {
+        EXPECT_EQ(query.compute_batch(queries, &jobs, &paths), expected);
+        EXPECT_EQ(paths, expected_paths);
+    }
+    EXPECT_LE(query.n_workspaces(), jobs.num_threads() + 1);
+}
@@ -0,0 +1,105 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphFloydWarshall.h"
+#include "GraphDijkstra.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+class GraphFloydWarshallTest : public ::testing::Test {
+protected:
+    Graph graph;
+    EdgeProperty<Real> weights;
+    std::vector<std::vector<Real> > expected_distances;
+    static constexpr size_t n = 12;
+
+    // n x n grid with diagonals and jittered positions, plus a separate triangle.
+    void SetUp() override {
+        auto positions = graph.vertex_property<Vector<Real, 3> >("v:position");
+        for (size_t i = 0; i < n * n + 3; ++i) {
+            const Vertex v = graph.new_vertex();
+            positions[v] = Vector<Real, 3>(i % n + 0.01f * (i * 7 % 5), i / n + 0.01f * (i * 3 % 7), 0);
+        }
+        for (size_t y = 0; y < n; ++y) {
+            for (size_t x = 0; x < n; ++x) {
+                const Vertex v(y * n + x);
+                if (x + 1 < n) graph.add_edge(v, Vertex(y * n + x + 1));
+                if (y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x));
+                if (x + 1 < n && y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x + 1));
+            }
+        }
+        graph.add_edge(Vertex(n * n), Vertex(n * n + 1));
+        graph.add_edge(Vertex(n * n + 1), Vertex(n * n + 2));
+        graph.add_edge(Vertex(n * n + 2), Vertex(n * n));
+        weights = EdgeLengths(graph, positions);
+
+        Dijkstra dijkstra(graph);
+        dijkstra.set_custom_edge_weights(weights);
+        for (const Vertex &source: graph.vertices) {
+            dijkstra.compute(source);
+            expected_distances.push_back(dijkstra.vertex_distances.vector());
+        }
+    }
+
+    // Checks all distances against Dijkstra and, if computed, that the predecessors form paths of that length.
+    void ExpectMatchesDijkstra(const FloydWarshall &floyd_warshall) {
+        for (const Vertex &source: graph.vertices) {
+            for (const Vertex &sink: graph.vertices) {
+                const Real expected = expected_distances[source.idx()][sink.idx()];
+                const Real distance = floyd_warshall.vertex_vertex_distances(source.idx(), sink.idx());
+                if (expected == std::numeric_limits<Real>::max()) {
+                    EXPECT_EQ(distance, expected);
+                    continue;
+                }
+                EXPECT_NEAR(distance, expected, 1e-4);
+                if (floyd_warshall.vertex_vertex_predecessors.size() == 0) continue;
+
+                Vertex current = sink;
+                Real length = 0;
+                for (size_t steps = 0; current != source && steps < graph.n_vertices(); ++steps) {
+                    const Halfedge h = floyd_warshall.vertex_vertex_predecessors(source.idx(), current.idx());
+                    ASSERT_TRUE(h.is_valid());
+                    length += weights[graph.get_edge(h)];
+                    current = graph.get_vertex(h);
+                }
+                EXPECT_EQ(current, source);
+                EXPECT_NEAR(length, expected, 1e-4);
+            }
+        }
+    }
+};
+
+TEST_F(GraphFloydWarshallTest, BlockedMatchesDijkstra) {
+    for (const size_t block_size: {1, 5, 16, 64, 1000}) {
+        FloydWarshall floyd_warshall(graph);
+        floyd_warshall.set_custom_edge_weights(weights);
+        floyd_warshall.block_size = block_size;
+        floyd_warshall.compute();
+        ExpectMatchesDijkstra(floyd_warshall);
+    }
+}
+
+TEST_F(GraphFloydWarshallTest, ParallelWithoutPredecessorsMatchesSerial) {
+    FloydWarshall serial(graph);
+    serial.set_custom_edge_weights(weights);
+    serial.block_size = 16;
+    serial.compute();
+
+    JobSystem jobs(3);
+    FloydWarshall parallel(graph, &jobs);
+    parallel.set_custom_edge_weights(weights);
+    parallel.block_size = 16;
+    parallel.compute_predecessors = false;
+    parallel.compute();
+    EXPECT_EQ(parallel.vertex_vertex_predecessors.size(), 0);
+    EXPECT_EQ(parallel.vertex_vertex_distances, serial.vertex_vertex_distances);
+    ExpectMatchesDijkstra(parallel);
+
+    parallel.compute_predecessors = true;
+    parallel.compute();
+    ExpectMatchesDijkstra(parallel);
+}
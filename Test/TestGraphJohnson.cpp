@@ -0,0 +1,125 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphJohnson.h"
+#include "GraphFloydWarshall.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <mutex>
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+class GraphJohnsonTest : public ::testing::Test {
+protected:
+    Graph graph;
+    EdgeProperty<Real> weights;
+    static constexpr size_t n = 10;
+
+    // n x n grid with diagonals and jittered positions, plus a separate triangle.
+    void SetUp() override {
+        auto positions = graph.vertex_property<Vector<Real, 3> >("v:position");
+        for (size_t i = 0; i < n * n + 3; ++i) {
+            const Vertex v = graph.new_vertex();
+            positions[v] = Vector<Real, 3>(i % n + 0.01f * (i * 7 % 5), i / n + 0.01f * (i * 3 % 7), 0);
+        }
+        for (size_t y = 0; y < n; ++y) {
+            for (size_t x = 0; x < n; ++x) {
+                const Vertex v(y * n + x);
+                if (x + 1 < n) graph.add_edge(v, Vertex(y * n + x + 1));
+                if (y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x));
+                if (x + 1 < n && y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x + 1));
+            }
+        }
+        graph.add_edge(Vertex(n * n), Vertex(n * n + 1));
+        graph.add_edge(Vertex(n * n + 1), Vertex(n * n + 2));
+        graph.add_edge(Vertex(n * n + 2), Vertex(n * n));
+        weights = EdgeLengths(graph, positions);
+    }
+};
+
+TEST_F(GraphJohnsonTest, MatchesFloydWarshall) {
+    FloydWarshall floyd_warshall(graph);
+    floyd_warshall.set_custom_edge_weights(weights);
+    floyd_warshall.compute();
+
+    JobSystem jobs(3);
+    Johnson johnson(graph, &jobs);
+    johnson.set_custom_edge_weights(weights);
+    ASSERT_TRUE(johnson.compute());
+    ASSERT_EQ(johnson.n_vertices, graph.n_vertices());
+    for (const Vertex &source: graph.vertices) {
+        for (const Vertex &sink: graph.vertices) {
+            const Real expected = floyd_warshall.vertex_vertex_distances(source.idx(), sink.idx());
+            if (expected == std::numeric_limits<Real>::max()) {
+                EXPECT_EQ(johnson.get_distance(source, sink), expected);
+            } else {
+                EXPECT_NEAR(johnson.get_distance(source, sink), expected, 1e-4);
+            }
+        }
+    }
+}
+
+TEST_F(GraphJohnsonTest, StreamedRowsMatchMatrix) {
+    Johnson johnson(graph);
+    johnson.set_custom_edge_weights(weights);
+    ASSERT_TRUE(johnson.compute());
+
+    JobSystem jobs(3);
+    Johnson streaming(graph, &jobs);
+    streaming.set_custom_edge_weights(weights);
+    const std::vector<Vertex> sources = {Vertex(0), Vertex(17), Vertex(n * n - 1), Vertex(n * n + 1)};
+    std::mutex mutex;
+    size_t n_rows = 0;
+    ASSERT_TRUE(streaming.compute(sources, [&](const Vertex &source, const std::vector<Real> &row) {
+        std::lock_guard lock(mutex);
+        ++n_rows;
+        ASSERT_EQ(row.size(), graph.n_vertices());
+        for (const Vertex &sink: graph.vertices) {
+            EXPECT_EQ(row[sink.idx()], johnson.get_distance(source, sink));
+        }
+    }));
+    EXPECT_EQ(n_rows, sources.size());
+    EXPECT_TRUE(streaming.vertex_vertex_distances.empty());
+}
+
+TEST_F(GraphJohnsonTest, ReweightsDirectedNegativeWeights) {
+    Johnson reference(graph);
+    reference.set_custom_edge_weights(weights);
+    ASSERT_TRUE(reference.compute());
+
+    // Shifting every entry u -> v by p(u) - p(v) keeps all cycle lengths, but makes some entries negative.
+    // The distances change to d(s, t) + p(s) - p(t).
+    GraphCsr csr(graph, weights);
+    auto potential = [](size_t v) { return static_cast<Real>(v % 7) * 0.8f; };
+    for (const Vertex &v: graph.vertices) {
+        for (size_t i = csr.begin(v); i < csr.end(v); ++i) {
+            csr.weights[i] += potential(v.idx()) - potential(csr.neighbors[i]);
+        }
+    }
+    ASSERT_TRUE(std::ranges::any_of(csr.weights, [](Real weight) { return weight < 0; }));
+
+    Johnson johnson(graph);
+    johnson.set_csr(&csr);
+    ASSERT_TRUE(johnson.compute());
+    for (const Vertex &source: graph.vertices) {
+        for (const Vertex &sink: graph.vertices) {
+            const Real expected = reference.get_distance(source, sink);
+            if (expected == std::numeric_limits<Real>::max()) {
+                EXPECT_EQ(johnson.get_distance(source, sink), expected);
+            } else {
+                EXPECT_NEAR(johnson.get_distance(source, sink),
+                            expected + potential(source.idx()) - potential(sink.idx()), 1e-4);
+            }
+        }
+    }
+}
+
+TEST_F(GraphJohnsonTest, DetectsNegativeCycle) {
+    weights[graph.find_edge(Vertex(0), Vertex(1))] = -0.5f;
+    Johnson johnson(graph);
+    johnson.set_custom_edge_weights(weights);
+    EXPECT_FALSE(johnson.compute());
+    EXPECT_TRUE(johnson.negative_cycle_found);
+}
@@ -0,0 +1,114 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphLandmarks.h"
+#include "GraphAStar.h"
+#include "GraphDijkstra.h"
+#include "GraphUtils.h"
+#include "JobSystem.h"
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+class GraphLandmarksTest : public ::testing::Test {
+protected:
+    Graph graph;
+    EdgeProperty<Real> weights;
+    static constexpr size_t n = 24;
+
+    // n x n grid with diagonals and weights unrelated to the positions, plus a separate triangle.
+    void SetUp() override {
+        auto positions = graph.vertex_property<Vector<Real, 3> >("v:position");
+        for (size_t i = 0; i < n * n + 3; ++i) {
+            const Vertex v = graph.new_vertex();
+            positions[v] = Vector<Real, 3>(i % n, i / n, 0);
+        }
+        for (size_t y = 0; y < n; ++y) {
+            for (size_t x = 0; x < n; ++x) {
+                const Vertex v(y * n + x);
+                if (x + 1 < n) graph.add_edge(v, Vertex(y * n + x + 1));
+                if (y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x));
+                if (x + 1 < n && y + 1 < n) graph.add_edge(v, Vertex((y + 1) * n + x + 1));
+            }
+        }
+        graph.add_edge(Vertex(n * n), Vertex(n * n + 1));
+        graph.add_edge(Vertex(n * n + 1), Vertex(n * n + 2));
+        graph.add_edge(Vertex(n * n + 2), Vertex(n * n));
+        weights = graph.edge_property<Real>("e:weights");
+        for (const Edge &e: graph.edges) {
+            weights[e] = 1 + static_cast<Real>(e.idx() * 7 % 11);
+        }
+    }
+
+    // Checks A* with the landmark heuristic and the lower bounds against Dijkstra.
+    void ExpectMatchesDijkstra(const Landmarks &landmarks) {
+        Dijkstra dijkstra(graph);
+        dijkstra.set_custom_edge_weights(weights);
+        AStar astar(graph);
+        astar.set_custom_edge_weights(weights);
+        for (size_t i = 0; i < 20; ++i) {
+            const Vertex source(i * 37 % (n * n)), target(i * 101 % (n * n));
+            dijkstra.compute(source);
+            astar.compute(source, target, landmarks.get_heuristic(target));
+            EXPECT_NEAR(astar.vertex_distances[target], dijkstra.vertex_distances[target], 1e-4);
+            for (const Vertex &v: graph.vertices) {
+                EXPECT_LE(landmarks.lower_bound(v, source), dijkstra.vertex_distances[v] + 1e-4);
+            }
+        }
+    }
+};
+
+TEST_F(GraphLandmarksTest, FarthestMatchesDijkstra) {
+    Landmarks landmarks(graph);
+    landmarks.set_custom_edge_weights(weights);
+    landmarks.select(8);
+    ASSERT_EQ(landmarks.landmarks.size(), 8);
+    // Unreached vertices are taken first, so the triangle gets a landmark.
+    EXPECT_TRUE(std::ranges::any_of(landmarks.landmarks, [](const Vertex &v) { return v.idx() >= n * n; }));
+    ExpectMatchesDijkstra(landmarks);
+}
+
+TEST_F(GraphLandmarksTest, AvoidMatchesDijkstra) {
+    Landmarks landmarks(graph);
+    landmarks.set_custom_edge_weights(weights);
+    landmarks.select(8, LandmarkSelection::Avoid);
+    ASSERT_EQ(landmarks.landmarks.size(), 8);
+    std::vector<Vertex> sorted = landmarks.landmarks;
+    std::ranges::sort(sorted);
+    EXPECT_EQ(std::ranges::unique(sorted).begin(), sorted.end());
+    ExpectMatchesDijkstra(landmarks);
+}
+
+TEST_F(GraphLandmarksTest, SettlesFewerVerticesThanDijkstra) {
+    Landmarks landmarks(graph);
+    landmarks.set_custom_edge_weights(weights);
+    landmarks.select(8);
+
+    AStar astar(graph);
+    astar.set_custom_edge_weights(weights);
+    const Vertex source(n + 1), target(n * n - n - 2);
+    astar.compute(source, target);
+    const size_t n_dijkstra = astar.n_settled;
+    const Real distance = astar.vertex_distances[target];
+    astar.compute(source, target, landmarks.get_heuristic(target));
+    EXPECT_NEAR(astar.vertex_distances[target], distance, 1e-4);
+    EXPECT_LT(astar.n_settled, n_dijkstra / 2);
+}
+
+TEST_F(GraphLandmarksTest, ParallelTablesMatchSelection) {
+    Landmarks selected(graph);
+    selected.set_custom_edge_weights(weights);
+    selected.select(6, LandmarkSelection::Avoid);
+
+    JobSystem jobs(3);
+    Landmarks parallel(graph, &jobs);
+    parallel.set_custom_edge_weights(weights);
+    parallel.set_landmarks(selected.landmarks);
+    ASSERT_EQ(parallel.landmarks, selected.landmarks);
+    for (size_t i = 0; i < selected.landmarks.size(); ++i) {
+        for (const Vertex &v: graph.vertices) {
+            EXPECT_EQ(parallel.get_distance(i, v), selected.get_distance(i, v));
+        }
+    }
+}
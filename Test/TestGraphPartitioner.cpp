@@ -0,0 +1,99 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "GraphPartitioner.h"
+#include "JobSystem.h"
+#include "MeshShapes.h"
+#include <gtest/gtest.h>
+#include <numeric>
+
+using namespace Bcg;
+
+// A side x side grid of vertices connected to their right and upper neighbors, and an isolated vertex at the end.
+static Graph MakeGrid(size_t side) {
+    Graph graph;
+    for (size_t i = 0; i <= side * side; ++i) {
+        graph.new_vertex();
+    }
+    for (size_t y = 0; y < side; ++y) {
+        for (size_t x = 0; x < side; ++x) {
+            const Vertex v(y * side + x);
+            if (x + 1 < side) graph.add_edge(v, Vertex(v.idx() + 1));
+            if (y + 1 < side) graph.add_edge(v, Vertex(v.idx() + side));
+        }
+    }
+    return graph;
+}
+
+TEST(GraphPartitionerTest, GridIsBalancedWithSmallCut) {
+    const size_t side = 60;
+    Graph graph = MakeGrid(side);
+    GraphPartitioner partitioner(graph);
+    partitioner.compute(4);
+
+    ASSERT_EQ(partitioner.part_sizes.size(), 4);
+    EXPECT_EQ(std::reduce(partitioner.part_sizes.begin(), partitioner.part_sizes.end()), side * side + 1);
+    EXPECT_LE(partitioner.imbalance, 1 + partitioner.imbalance_tolerance + 0.01f);
+    // Cutting the grid into quadrants costs 2 * side edges, a random assignment about 3 / 4 of all edges.
+    EXPECT_LE(partitioner.n_cut_edges, 3 * side);
+
+    size_t n_cut_edges = 0;
+    for (const Edge &e: graph.edges) {
+        n_cut_edges += partitioner.partition_ids[graph.get_vertex(e, 0)] !=
+                partitioner.partition_ids[graph.get_vertex(e, 1)];
+    }
+    EXPECT_EQ(n_cut_edges, partitioner.n_cut_edges);
+    for (const Vertex &v: graph.vertices) {
+        EXPECT_GE(partitioner.partition_ids[v], 0);
+        EXPECT_LT(partitioner.partition_ids[v], 4);
+    }
+}
+
+TEST(GraphPartitionerTest, ParallelMatchesSerial) {
+    Graph graph = MakeGrid(50);
+    GraphPartitioner serial(graph);
+    serial.compute(7);
+
+    Graph copy = MakeGrid(50);
+    JobSystem jobs(3);
+    GraphPartitioner parallel(copy, &jobs);
+    parallel.compute(7);
+    EXPECT_EQ(parallel.partition_ids.vector(), serial.partition_ids.vector());
+    EXPECT_EQ(parallel.n_cut_edges, serial.n_cut_edges);
+}
+
+TEST(GraphPartitionerTest, DeletedVerticesKeepNoPart) {
+    const size_t side = 20;
+    Graph graph = MakeGrid(side);
+    const Vertex isolated(side * side);
+    graph.delete_vertex(isolated);
+    GraphPartitioner partitioner(graph);
+    partitioner.compute(2);
+    EXPECT_EQ(partitioner.partition_ids[isolated], -1);
+    EXPECT_EQ(partitioner.part_sizes[0] + partitioner.part_sizes[1], side * side);
+}
+
+TEST(GraphPartitionerTest, MeshVerticesAndFaces) {
+    Mesh sphere = Icosphere(4);
+    JobSystem jobs(2);
+    GraphPartitioner partitioner(sphere, &jobs);
+    partitioner.compute_faces(8);
+    ASSERT_EQ(partitioner.part_sizes.size(), 8);
+    EXPECT_LE(partitioner.imbalance, 1 + partitioner.imbalance_tolerance + 0.01f);
+    // Every part should be a patch, whose boundary is much shorter than its number of faces.
+    EXPECT_LT(partitioner.n_cut_edges, sphere.faces.size() / 8);
+    for (const Face &f: sphere.faces) {
+        EXPECT_GE(partitioner.face_partition_ids[f], 0);
+    }
+
+    partitioner.compute(3);
+    ASSERT_EQ(partitioner.part_sizes.size(), 3);
+    EXPECT_LE(partitioner.imbalance, 1 + partitioner.imbalance_tolerance + 0.01f);
+    EXPECT_LT(partitioner.n_cut_edges, sphere.edges.size() / 8);
+
+    Graph graph = MakeGrid(4);
+    GraphPartitioner graph_partitioner(graph);
+    graph_partitioner.compute_faces(2);
+    EXPECT_FALSE(graph_partitioner.face_partition_ids);
+}
@@ -0,0 +1,192 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "MeshBvh.h"
+#include "JobSystem.h"
+#include "MeshShapes.h"
+#include "Eigen/Geometry"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Bcg;
+
+// The three corners of a triangle face.
+static std::array<Vector<double, 3>, 3> GetCorners(const Mesh &mesh, const Face &f) {
+    const auto positions = mesh.get_vertex_property<Vector<Real, 3> >("v:position");
+    std::array<Vector<double, 3>, 3> corners;
+    size_t i = 0;
+    for (const Vertex &v: mesh.get_vertices(f)) {
+        corners[i++] = positions[v].cast<double>();
+    }
+    return corners;
+}
+
+// The ray parameters of the hits with every face by brute force in double precision, max if a face is missed.
+static std::vector<double> BruteForceHits(const Mesh &mesh, const MeshBvh::Ray &ray) {
+    std::vector<double> result;
+    const Vector<double, 3> o = ray.origin.cast<double>(), d = ray.direction.cast<double>();
+    for (const Face &f: mesh.faces) {
+        const auto [a, b, c] = GetCorners(mesh, f);
+        const Vector<double, 3> ab = b - a, ac = c - a, p = d.cross(ac), s = o - a, q = s.cross(ab);
+        const double determinant = ab.dot(p);
+        const double u = s.dot(p) / determinant, v = d.dot(q) / determinant, t = ac.dot(q) / determinant;
+        const bool hit = determinant != 0 && u >= 0 && v >= 0 && u + v <= 1 && t >= ray.t_min && t <= ray.t_max;
+        result.push_back(hit ? t : std::numeric_limits<double>::max());
+    }
+    return result;
+}
+
+// A torus with its quads split into triangles, which has concave regions and holes unlike the sphere.
+static Mesh MakeTorus() {
+    Mesh torus = Torus(20, 40, 1, 0.3f);
+    torus.triangulate();
+    return torus;
+}
+
+// Rays from random points around the mesh towards random points inside its bounds.
+static std::vector<MeshBvh::Ray> RandomRays(size_t n, Real radius) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<Real> uniform(-1, 1);
+    std::vector<MeshBvh::Ray> rays(n);
+    for (MeshBvh::Ray &ray: rays) {
+        const Vector<Real, 3> origin = 2 * radius * Vector<Real, 3>(uniform(rng), uniform(rng), uniform(rng));
+        const Vector<Real, 3> target = radius * Vector<Real, 3>(uniform(rng), uniform(rng), uniform(rng));
+        ray.origin = origin;
+        ray.direction = target - origin;
+    }
+    return rays;
+}
+
+TEST(MeshBvhTest, ClosestHitMatchesBruteForce) {
+    for (Mesh mesh: {Icosphere(3), MakeTorus()}) {
+        MeshBvh bvh(mesh);
+        ASSERT_TRUE(bvh.build());
+        EXPECT_EQ(bvh.faces.size(), mesh.n_faces());
+        size_t n_hits = 0;
+        for (const MeshBvh::Ray &ray: RandomRays(300, 1.3f)) {
+            const MeshBvh::Hit hit = bvh.intersect(ray);
+            const std::vector<double> hits = BruteForceHits(mesh, ray);
+            const double closest = *std::min_element(hits.begin(), hits.end());
+            if (closest == std::numeric_limits<double>::max()) {
+                EXPECT_FALSE(hit.f.is_valid());
+                continue;
+            }
+            ++n_hits;
+            ASSERT_TRUE(hit.f.is_valid());
+            EXPECT_NEAR(hit.t, closest, 1e-4);
+            EXPECT_NEAR(hits[hit.f.idx()], hit.t, 1e-4);
+            // The barycentric coordinates reproduce the hit point.
+            const auto [a, b, c] = GetCorners(mesh, hit.f);
+            const Vector<double, 3> point = hit.barycentric[0] * a + hit.barycentric[1] * b + hit.barycentric[2] * c;
+            EXPECT_NEAR((point - (ray.origin + hit.t * ray.direction).cast<double>()).norm(), 0, 1e-4);
+        }
+        EXPECT_GT(n_hits, 50u);
+    }
+}
+
+TEST(MeshBvhTest, AnyHitMatchesBruteForce) {
+    Mesh mesh = MakeTorus();
+    JobSystem jobs(4);
+    MeshBvh bvh(mesh, &jobs);
+    ASSERT_TRUE(bvh.build());
+    std::vector<MeshBvh::Ray> rays = RandomRays(500, 1.3f);
+    for (size_t i = 0; i < rays.size(); ++i) {
+        // Shadow rays which end halfway to their targets.
+        rays[i].t_max = i % 2 == 0 ? 0.5f : 1;
+    }
+    std::vector<uint8_t> occluded;
+    bvh.occluded(rays, occluded);
+    ASSERT_EQ(occluded.size(), rays.size());
+    size_t n_occluded = 0;
+    for (size_t i = 0; i < rays.size(); ++i) {
+        const std::vector<double> hits = BruteForceHits(mesh, rays[i]);
+        const double closest = *std::min_element(hits.begin(), hits.end());
+        // Skip grazing hits at the end of the interval, where float and double may disagree.
+        if (std::abs(closest - rays[i].t_max) < 1e-4) continue;
+        EXPECT_EQ(occluded[i] == 1, closest != std::numeric_limits<double>::max());
+        n_occluded += occluded[i];
+    }
+    EXPECT_GT(n_occluded, 50u);
+
+    std::vector<MeshBvh::Hit> hits;
+    bvh.intersect(rays, hits);
+    for (size_t i = 0; i < rays.size(); ++i) {
+        EXPECT_EQ(hits[i].f.is_valid(), occluded[i] == 1);
+    }
+}
+
+TEST(MeshBvhTest, ClosestPointMatchesBruteForce) {
+    Mesh mesh = Icosphere(3);
+    MeshBvh bvh(mesh);
+    ASSERT_TRUE(bvh.build());
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<Real> uniform(-2, 2);
+    std::vector<Vector<Real, 3> > points(300);
+    for (Vector<Real, 3> &point: points) {
+        point = Vector<Real, 3>(uniform(rng), uniform(rng), uniform(rng));
+    }
+    std::vector<MeshBvh::ClosestPoint> closest;
+    bvh.closest_points(points, closest);
+    ASSERT_EQ(closest.size(), points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        // The distance to the mesh by brute force over dense samples of every face, an upper bound.
+        double best = std::numeric_limits<double>::max();
+        for (const Face &f: mesh.faces) {
+            const auto [a, b, c] = GetCorners(mesh, f);
+            Vector<double, 3> q = a;
+            // Sample the triangle densely enough to bound the distance from above.
+            for (int s = 0; s <= 20; ++s) {
+                for (int t = 0; s + t <= 20; ++t) {
+                    const Vector<double, 3> sample = a + (b - a) * (s / 20.0) + (c - a) * (t / 20.0);
+                    if ((sample - points[i].cast<double>()).squaredNorm() <
+                        (q - points[i].cast<double>()).squaredNorm()) {
+                        q = sample;
+                    }
+                }
+            }
+            best = std::min(best, (q - points[i].cast<double>()).squaredNorm());
+        }
+        ASSERT_TRUE(closest[i].f.is_valid());
+        EXPECT_LE(closest[i].sq_distance, best + 1e-6);
+        EXPECT_NEAR(std::sqrt(closest[i].sq_distance), std::sqrt(best), 1e-2);
+        EXPECT_NEAR(closest[i].sq_distance, (closest[i].point - points[i]).squaredNorm(), 1e-5);
+        const auto [a, b, c] = GetCorners(mesh, closest[i].f);
+        const Vector<double, 3> point = closest[i].barycentric[0] * a + closest[i].barycentric[1] * b +
+                                        closest[i].barycentric[2] * c;
+        EXPECT_NEAR((point - closest[i].point.cast<double>()).norm(), 0, 1e-5);
+        EXPECT_GE(closest[i].barycentric.minCoeff(), -1e-4);
+    }
+    // Points further away than max_distance find nothing.
+    EXPECT_FALSE(bvh.closest_point(Vector<Real, 3>(3, 0, 0), 1.5f).f.is_valid());
+    EXPECT_TRUE(bvh.closest_point(Vector<Real, 3>(3, 0, 0), 2.5f).f.is_valid());
+}
+
+TEST(MeshBvhTest, ParallelBuildMatchesSerial) {
+    Mesh mesh = Icosphere(6);
+    MeshBvh serial(mesh);
+    ASSERT_TRUE(serial.build());
+    JobSystem jobs(4);
+    MeshBvh parallel(mesh, &jobs);
+    ASSERT_TRUE(parallel.build());
+    ASSERT_EQ(serial.nodes.size(), parallel.nodes.size());
+    for (size_t i = 0; i < serial.nodes.size(); ++i) {
+        EXPECT_EQ(serial.nodes[i].offset, parallel.nodes[i].offset);
+        EXPECT_EQ(serial.nodes[i].count, parallel.nodes[i].count);
+        EXPECT_EQ(serial.nodes[i].aabb.min(), parallel.nodes[i].aabb.min());
+    }
+    EXPECT_EQ(serial.faces, parallel.faces);
+    // Every face is in exactly one leaf, and the leaves are small.
+    std::vector<int> seen(mesh.faces.size(), 0);
+    for (const MeshBvh::Node &node: serial.nodes) {
+        EXPECT_LE(node.count, 4 * serial.max_leaf_size);
+        for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+            ++seen[serial.faces[i].idx()];
+        }
+    }
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), 1), static_cast<long>(mesh.n_faces()));
+
+    Mesh quads = Hexahedron();
+    MeshBvh invalid(quads);
+    EXPECT_FALSE(invalid.build());
+}
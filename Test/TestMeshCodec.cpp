@@ -0,0 +1,136 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "MeshCodec.h"
+#include "MeshShapes.h"
+#include "MeshUtils.h"
+#include <filesystem>
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+class MeshCodecTest : public ::testing::Test {
+protected:
+    Mesh mesh;
+
+    void SetUp() override {
+        mesh = Icosphere(3);
+    }
+
+    // The codec reorders vertices and faces, so every decoded face is matched to the closest expected face.
+    static void ExpectSameGeometry(const Mesh &expected, const Mesh &decoded, Real tolerance) {
+        ASSERT_EQ(decoded.n_vertices(), expected.n_vertices());
+        ASSERT_EQ(decoded.n_faces(), expected.n_faces());
+        auto expected_positions = expected.get_vertex_property<Vector<Real, 3> >("v:position");
+        auto decoded_positions = decoded.get_vertex_property<Vector<Real, 3> >("v:position");
+        for (const auto &f: decoded.faces) {
+            const Vector<Real, 3> center = FaceCenter(decoded, decoded_positions, f);
+            Face closest;
+            Real min_distance = std::numeric_limits<Real>::max();
+            for (const auto &g: expected.faces) {
+                const Real distance = (FaceCenter(expected, expected_positions, g) - center).norm();
+                if (distance < min_distance) {
+                    min_distance = distance;
+                    closest = g;
+                }
+            }
+            EXPECT_LT(min_distance, tolerance);
+            EXPECT_EQ(decoded.get_valence(f), expected.get_valence(closest));
+        }
+    }
+};
+
+TEST_F(MeshCodecTest, RoundTripPreservesConnectivityAndQuantizedPositions) {
+    MeshCodecOptions options;
+    options.position_bits = 16;
+    auto data = EncodeMesh(mesh, options);
+
+    Mesh decoded;
+    ASSERT_TRUE(DecodeMesh(data.data(), data.size(), decoded));
+    ExpectSameGeometry(mesh, decoded, 2.0 / (1 << 16) * 2);
+    EXPECT_EQ(decoded.n_edges(), mesh.n_edges());
+    EXPECT_TRUE(decoded.is_triangle_mesh());
+}
+
+TEST_F(MeshCodecTest, CompressesBetterThanRawBinary) {
+    auto data = EncodeMesh(mesh);
+    const size_t raw_size = mesh.n_vertices() * sizeof(Vector<Real, 3>) + mesh.n_faces() * 3 * sizeof(unsigned int);
+    EXPECT_LT(data.size() * 3, raw_size);
+}
+
+TEST_F(MeshCodecTest, RoundTripsPolygonsNormalsAndTexCoords) {
+    Mesh quads = Plane(8);
+    auto positions = quads.get_vertex_property<Vector<Real, 3> >("v:position");
+    auto normals = quads.vertex_property<Vector<Real, 3> >("v:normal");
+    auto tex = quads.vertex_property<Vector<Real, 2> >("v:tex");
+    for (const auto &v: quads.vertices) {
+        normals[v] = Vector<Real, 3>(positions[v][0], 1, positions[v][1]).normalized();
+        tex[v] = positions[v].head<2>();
+    }
+
+    auto data = EncodeMesh(quads);
+    Mesh decoded;
+    ASSERT_TRUE(DecodeMesh(data.data(), data.size(), decoded));
+    ExpectSameGeometry(quads, decoded, 1e-3);
+
+    auto decoded_positions = decoded.get_vertex_property<Vector<Real, 3> >("v:position");
+    auto decoded_normals = decoded.get_vertex_property<Vector<Real, 3> >("v:normal");
+    auto decoded_tex = decoded.get_vertex_property<Vector<Real, 2> >("v:tex");
+    ASSERT_TRUE(decoded_normals);
+    ASSERT_TRUE(decoded_tex);
+    for (const auto &v: decoded.vertices) {
+        const Vector<Real, 3> p = decoded_positions[v];
+        EXPECT_LT((decoded_normals[v] - Vector<Real, 3>(p[0], 1, p[1]).normalized()).norm(), 1e-2);
+        EXPECT_LT((decoded_tex[v] - p.head<2>()).norm(), 1e-3);
+    }
+}
+
+TEST_F(MeshCodecTest, RoundTripsTrianglesSharingOnlyAVertex) {
+    Mesh bowtie;
+    auto positions = bowtie.vertex_property<Vector<Real, 3> >("v:position");
+    std::vector<Vertex> v;
+    for (const auto &p: {Vector<Real, 3>(0, 0, 0), Vector<Real, 3>(1, 0, 0), Vector<Real, 3>(1, 1, 0),
+                         Vector<Real, 3>(-1, 0, 0), Vector<Real, 3>(-1, -1, 0)}) {
+        v.push_back(bowtie.new_vertex());
+        positions[v.back()] = p;
+    }
+    bowtie.add_face({v[0], v[1], v[2]});
+    bowtie.add_face({v[0], v[3], v[4]});
+
+    auto data = EncodeMesh(bowtie);
+    Mesh decoded;
+    ASSERT_TRUE(DecodeMesh(data.data(), data.size(), decoded));
+    ExpectSameGeometry(bowtie, decoded, 1e-3);
+    EXPECT_EQ(decoded.n_edges(), bowtie.n_edges());
+}
+
+TEST_F(MeshCodecTest, RejectsCorruptData) {
+    auto data = EncodeMesh(mesh);
+    Mesh decoded;
+    EXPECT_FALSE(DecodeMesh(data.data(), data.size() / 2, decoded));
+    data[0] = 'X';
+    EXPECT_FALSE(DecodeMesh(data.data(), data.size(), decoded));
+
+    // The number of position bits follows the magic, the version, the flags and three varint counts.
+    data = EncodeMesh(mesh);
+    size_t offset = 6;
+    for (int count = 0; count < 3; ++count) {
+        while (data[offset] & 0x80) ++offset;
+        ++offset;
+    }
+    ASSERT_EQ(data[offset], 16);
+    for (const uint8_t bits: {0, 31, 32, 255}) {
+        data[offset] = bits;
+        EXPECT_FALSE(DecodeMesh(data.data(), data.size(), decoded)) << static_cast<int>(bits);
+    }
+}
+
+TEST_F(MeshCodecTest, MeshIoManagerReadsAndWritesBcm) {
+    const std::string filename = "test_codec.bcm";
+    ASSERT_TRUE(MeshIoManager(filename).write(mesh, MeshIo::WriteFlags()));
+    Mesh loaded;
+    ASSERT_TRUE(MeshIoManager(filename).read(loaded));
+    ExpectSameGeometry(mesh, loaded, 1e-4);
+    std::filesystem::remove(filename);
+}
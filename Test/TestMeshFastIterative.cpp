@@ -0,0 +1,101 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "MeshFastIterative.h"
+#include "GraphDijkstra.h"
+#include "JobSystem.h"
+#include "MeshShapes.h"
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+// Mean relative error of the distances from the source to the great circle distances on the unit sphere.
+static double MeanRelativeError(const Mesh &sphere, const Vertex &source, const std::vector<Real> &distances) {
+    const auto positions = sphere.get_vertex_property<Vector<Real, 3> >("v:position");
+    const Vector<double, 3> s = positions[source].cast<double>().normalized();
+    double error = 0;
+    size_t count = 0;
+    for (const Vertex &v: sphere.vertices) {
+        const double exact = std::acos(std::clamp(s.dot(positions[v].cast<double>().normalized()), -1.0, 1.0));
+        if (exact < 0.1) continue;
+        error += std::abs(distances[v.idx()] - exact) / exact;
+        ++count;
+    }
+    return error / count;
+}
+
+TEST(MeshFastIterativeTest, SphereDistancesBeatDijkstra) {
+    Mesh sphere = Icosphere(4);
+    const Vertex source(0);
+    FastIterativeMethod fim(sphere);
+    ASSERT_TRUE(fim.compute(source));
+    EXPECT_EQ(fim.vertex_distances[source], 0);
+    const double fim_error = MeanRelativeError(sphere, source, fim.vertex_distances.vector());
+    EXPECT_LT(fim_error, 0.02);
+
+    Dijkstra dijkstra(sphere);
+    dijkstra.compute(source);
+    const double dijkstra_error = MeanRelativeError(sphere, source, dijkstra.vertex_distances.vector());
+    EXPECT_LT(fim_error, 0.5 * dijkstra_error);
+    for (const Vertex &v: sphere.vertices) {
+        // The fronts cross the triangles, so they are never slower than along the edges.
+        EXPECT_LE(fim.vertex_distances[v], dijkstra.vertex_distances[v] * (1 + 1e-5f));
+    }
+}
+
+TEST(MeshFastIterativeTest, ParallelMatchesSerial) {
+    Mesh sphere = Icosphere(4);
+    FastIterativeMethod serial(sphere);
+    ASSERT_TRUE(serial.compute(std::vector<Vertex>{Vertex(0), Vertex(500)}));
+    const std::vector<Real> expected = serial.vertex_distances.vector();
+
+    Mesh copy = Icosphere(4);
+    JobSystem jobs(3);
+    FastIterativeMethod parallel(copy, &jobs);
+    ASSERT_TRUE(parallel.compute(std::vector<Vertex>{Vertex(0), Vertex(500)}));
+    for (const Vertex &v: copy.vertices) {
+        EXPECT_NEAR(parallel.vertex_distances[v], expected[v.idx()], 1e-3f);
+    }
+}
+
+TEST(MeshFastIterativeTest, PlaneDistancesAreEuclidean) {
+    Mesh plane = Plane(16);
+    plane.triangulate();
+    const auto positions = plane.get_vertex_property<Vector<Real, 3> >("v:position");
+    // The source lies on the boundary, so the front also spreads along the boundary edges. The first order scheme is
+    // exact for planar fronts, the curved front of a point source stays within an edge length.
+    const Vertex source(8);
+    const Real edge_length = 1.0f / 16;
+    FastIterativeMethod fim(plane);
+    ASSERT_TRUE(fim.compute(source));
+    for (const Vertex &v: plane.vertices) {
+        EXPECT_NEAR(fim.vertex_distances[v], (positions[v] - positions[source]).norm(), edge_length);
+    }
+
+    // The corners are kept, a second compute from another source only runs the active list.
+    ASSERT_TRUE(fim.compute(Vertex(0)));
+    for (const Vertex &v: plane.vertices) {
+        EXPECT_NEAR(fim.vertex_distances[v], (positions[v] - positions[Vertex(0)]).norm(), edge_length);
+    }
+}
+
+TEST(MeshFastIterativeTest, FaceSpeedsScaleTimes) {
+    Mesh sphere = Icosphere(3);
+    FastIterativeMethod fim(sphere);
+    ASSERT_TRUE(fim.compute(Vertex(0)));
+    const std::vector<Real> unit = fim.vertex_distances.vector();
+
+    auto speeds = sphere.face_property<Real>("f:speeds", 2);
+    fim.set_custom_face_speeds(speeds);
+    ASSERT_TRUE(fim.compute(Vertex(0)));
+    for (const Vertex &v: sphere.vertices) {
+        EXPECT_NEAR(fim.vertex_distances[v], unit[v.idx()] / 2, 1e-4f);
+    }
+
+    const Vertex isolated = sphere.new_vertex();
+    fim.clear_custom_face_speeds();
+    ASSERT_TRUE(fim.compute(Vertex(0)));
+    EXPECT_EQ(fim.vertex_distances[isolated], std::numeric_limits<Real>::max());
+    EXPECT_FALSE(fim.compute(std::vector<Vertex>{}));
+}
@@ -0,0 +1,81 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "MeshHeatGeodesics.h"
+#include "GraphDijkstra.h"
+#include "JobSystem.h"
+#include "MeshShapes.h"
+#include <gtest/gtest.h>
+#include <mutex>
+#include <numbers>
+
+using namespace Bcg;
+
+// Mean relative error of the distances from the source to the great circle distances on the unit sphere.
+static double MeanRelativeError(const Mesh &sphere, const Vertex &source, const std::vector<Real> &distances) {
+    const auto positions = sphere.get_vertex_property<Vector<Real, 3> >("v:position");
+    const Vector<double, 3> s = positions[source].cast<double>().normalized();
+    double error = 0;
+    size_t count = 0;
+    for (const Vertex &v: sphere.vertices) {
+        const double exact = std::acos(std::clamp(s.dot(positions[v].cast<double>().normalized()), -1.0, 1.0));
+        if (exact < 0.1) continue;
+        error += std::abs(distances[v.idx()] - exact) / exact;
+        ++count;
+    }
+    return error / count;
+}
+
+TEST(MeshHeatGeodesicsTest, SphereDistancesAreAccurate) {
+    Mesh sphere = Icosphere(4);
+    const Vertex source(0);
+    HeatGeodesics geodesics(sphere);
+    ASSERT_TRUE(geodesics.compute(source));
+    EXPECT_EQ(geodesics.vertex_distances[source], 0);
+    const double heat_error = MeanRelativeError(sphere, source, geodesics.vertex_distances.vector());
+    EXPECT_LT(heat_error, 0.02);
+
+    // Dijkstra only follows edges and overestimates the distances.
+    Dijkstra dijkstra(sphere);
+    dijkstra.compute(source);
+    const double dijkstra_error = MeanRelativeError(sphere, source, dijkstra.vertex_distances.vector());
+    EXPECT_LT(heat_error, dijkstra_error);
+}
+
+TEST(MeshHeatGeodesicsTest, BatchMatchesSingleSources) {
+    Mesh sphere = Icosphere(3);
+    JobSystem jobs(3);
+    HeatGeodesics geodesics(sphere, &jobs);
+    const std::vector<Vertex> sources = {Vertex(0), Vertex(5), Vertex(17), Vertex(100)};
+    std::vector<std::vector<Real> > rows(sphere.vertices.size());
+    std::mutex mutex;
+    ASSERT_TRUE(geodesics.compute(sources, [&](const Vertex &source, const std::vector<Real> &row) {
+        std::scoped_lock lock(mutex);
+        rows[source.idx()] = row;
+    }));
+
+    for (const Vertex &source: sources) {
+        ASSERT_TRUE(geodesics.compute(source));
+        for (const Vertex &v: sphere.vertices) {
+            EXPECT_NEAR(rows[source.idx()][v.idx()], geodesics.vertex_distances[v], 1e-5f);
+        }
+    }
+
+    // The distances to a set of sources approximate the minimum of the distances to every source.
+    ASSERT_TRUE(geodesics.compute(std::vector<Vertex>{Vertex(0), Vertex(100)}));
+    for (const Vertex &v: sphere.vertices) {
+        const Real nearest = std::min(rows[0][v.idx()], rows[100][v.idx()]);
+        EXPECT_NEAR(geodesics.vertex_distances[v], nearest, 0.1f * std::numbers::pi_v<Real>);
+    }
+}
+
+TEST(MeshHeatGeodesicsTest, UnreachableAndInvalidSources) {
+    Mesh mesh = Icosphere(2);
+    const Vertex isolated = mesh.new_vertex();
+    HeatGeodesics geodesics(mesh);
+    ASSERT_TRUE(geodesics.compute(Vertex(0)));
+    EXPECT_EQ(geodesics.vertex_distances[isolated], std::numeric_limits<Real>::max());
+    EXPECT_FALSE(geodesics.compute(std::vector<Vertex>{}));
+    EXPECT_FALSE(geodesics.compute(Vertex(mesh.vertices.size())));
+}
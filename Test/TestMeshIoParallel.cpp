@@ -0,0 +1,122 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "MeshIo.h"
+#include "MeshShapes.h"
+#include "JobSystem.h"
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+static std::string ReadFile(const std::string &filename) {
+    std::ifstream in(filename, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+TEST(MeshIoParallel, TextOutputMatchesSerialOutput) {
+    // Large enough to be split into several chunks.
+    Mesh mesh = Icosphere(6);
+    auto positions = mesh.get_vertex_property<Vector<Real, 3> >("v:position");
+    auto normals = mesh.vertex_property<Vector<Real, 3> >("v:normal");
+    for (const auto &v: mesh.vertices) {
+        normals[v] = positions[v];
+        positions[v] *= static_cast<Real>(1 + v.idx() % 1000);
+    }
+
+    JobSystem jobs(3);
+    for (const std::string extension: {".off", ".obj", ".ply"}) {
+        const std::string serial = "test_serial" + extension;
+        const std::string parallel = "test_parallel" + extension;
+        MeshIo::WriteFlags flags;
+        flags.with_normals = true;
+        ASSERT_TRUE(MeshIoManager(serial).write(mesh, flags));
+        flags.jobs = &jobs;
+        ASSERT_TRUE(MeshIoManager(parallel).write(mesh, flags));
+        EXPECT_EQ(ReadFile(serial), ReadFile(parallel)) << extension;
+        std::filesystem::remove(serial);
+        std::filesystem::remove(parallel);
+    }
+}
+
+TEST(MeshIoParallel, ParallelTextOutputReadsBack) {
+    Mesh mesh = Icosphere(5);
+    JobSystem jobs(2);
+    MeshIo::WriteFlags flags;
+    flags.jobs = &jobs;
+    for (const std::string filename: {"test_parallel.off", "test_parallel.obj", "test_parallel.ply"}) {
+        ASSERT_TRUE(MeshIoManager(filename).write(mesh, flags));
+        Mesh loaded;
+        ASSERT_TRUE(MeshIoManager(filename).read(loaded));
+        EXPECT_EQ(loaded.n_vertices(), mesh.n_vertices());
+        EXPECT_EQ(loaded.n_faces(), mesh.n_faces());
+        std::filesystem::remove(filename);
+    }
+}
+
+// The OFF output of the serial writer before the chunked rewrite, iterating the containers of the mesh.
+static std::string BaselineOff(const Mesh &mesh) {
+    const auto positions = mesh.get_vertex_property<Vector<Real, 3> >("v:position");
+    std::ostringstream out;
+    out << "OFF" << std::endl;
+    out << mesh.vertices.size() << " " << mesh.faces.size() << " 0" << std::endl;
+    for (const auto &v: mesh.vertices) {
+        const Vector<Real, 3> &pos = positions[v];
+        out << std::fixed << std::setprecision(6) << pos.x() << " " << pos.y() << " " << pos.z() << std::endl;
+    }
+    for (const auto &f: mesh.faces) {
+        out << mesh.get_valence(f);
+        for (const auto &v: mesh.get_vertices(f)) {
+            out << " " << v.idx();
+        }
+        out << std::endl;
+    }
+    return out.str();
+}
+
+// The OBJ output of the serial writer before the chunked rewrite, iterating the containers of the mesh.
+static std::string BaselineObj(const Mesh &mesh) {
+    const auto positions = mesh.get_vertex_property<Vector<Real, 3> >("v:position");
+    std::string out = "# OBJ export from BCG\n";
+    for (const auto &v: mesh.vertices) {
+        out += fmt::format("v {:.10f} {:.10f} {:.10f}\n", positions[v][0], positions[v][1], positions[v][2]);
+    }
+    for (const auto &f: mesh.faces) {
+        out += "f";
+        for (const auto &v: mesh.get_vertices(f)) {
+            out += fmt::format(" {}/{}", v.idx() + 1, v.idx() + 1);
+        }
+        out += "\n";
+    }
+    return out;
+}
+
+TEST(MeshIoParallel, CopiedMeshMatchesBaselineOutput) {
+    // A copy assigned mesh has no garbage, so every element is written like the container iteration did.
+    Mesh mesh;
+    mesh = Icosphere(4);
+    JobSystem jobs(2);
+    MeshIo::WriteFlags flags;
+    for (JobSystem *job_system: {static_cast<JobSystem *>(nullptr), &jobs}) {
+        flags.jobs = job_system;
+        ASSERT_TRUE(MeshIoManager("test_baseline.off").write(mesh, flags));
+        EXPECT_EQ(ReadFile("test_baseline.off"), BaselineOff(mesh));
+        ASSERT_TRUE(MeshIoManager("test_baseline.obj").write(mesh, flags));
+        EXPECT_EQ(ReadFile("test_baseline.obj"), BaselineObj(mesh));
+        ASSERT_TRUE(MeshIoManager("test_baseline.ply").write(mesh, flags));
+        Mesh loaded;
+        ASSERT_TRUE(MeshIoManager("test_baseline.ply").read(loaded));
+        EXPECT_EQ(loaded.n_vertices(), mesh.vertices.size());
+        EXPECT_EQ(loaded.n_faces(), mesh.faces.size());
+    }
+    std::filesystem::remove("test_baseline.off");
+    std::filesystem::remove("test_baseline.obj");
+    std::filesystem::remove("test_baseline.ply");
+}
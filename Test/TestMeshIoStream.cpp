@@ -0,0 +1,149 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "MeshIoStream.h"
+#include "MeshShapes.h"
+#include <filesystem>
+#include <gtest/gtest.h>
+
+using namespace Bcg;
+
+class MeshIoStreamTest : public ::testing::Test {
+protected:
+    Mesh mesh;
+    std::vector<std::string> filenames;
+
+    void SetUp() override {
+        mesh = Icosphere(2);
+    }
+
+    void TearDown() override {
+        for (const auto &filename: filenames) {
+            if (std::filesystem::exists(filename)) {
+                std::filesystem::remove(filename);
+            }
+        }
+    }
+
+    void StreamAndCompare(const std::string &filename, size_t batch_size, Real tolerance) {
+        auto positions = mesh.get_vertex_property<Vector<Real, 3> >("v:position");
+        MeshStreamReader reader(filename, batch_size);
+        size_t n_vertices = 0, n_faces = 0;
+        bool ok = reader.read([&](MeshStreamVertexBatch &batch) {
+            EXPECT_LE(batch.size(), batch_size);
+            EXPECT_EQ(batch.first_index, n_vertices);
+            for (size_t i = 0; i < batch.size(); ++i) {
+                EXPECT_TRUE(batch.positions[i].isApprox(positions[Vertex(batch.first_index + i)], tolerance));
+            }
+            n_vertices += batch.size();
+            return true;
+        }, [&](MeshStreamFaceBatch &batch) {
+            EXPECT_LE(batch.size(), batch_size);
+            EXPECT_EQ(batch.first_index, n_faces);
+            for (size_t i = 0; i < batch.size(); ++i) {
+                size_t j = 0;
+                for (const auto &v: mesh.get_vertices(Face(batch.first_index + i))) {
+                    EXPECT_LT(batch.get_indices(i)[j], n_vertices);
+                    EXPECT_EQ(batch.get_indices(i)[j++], v.idx());
+                }
+                EXPECT_EQ(j, batch.get_valence(i));
+            }
+            n_faces += batch.size();
+            return true;
+        });
+        EXPECT_TRUE(ok);
+        EXPECT_EQ(n_vertices, mesh.n_vertices());
+        EXPECT_EQ(n_faces, mesh.n_faces());
+    }
+};
+
+TEST_F(MeshIoStreamTest, ReadsFilesOfMeshIoInBatches) {
+    for (const std::string filename: {"test_stream.off", "test_stream.obj", "test_stream.ply"}) {
+        for (bool binary: {false, true}) {
+            filenames.push_back(filename);
+            MeshIo::WriteFlags flags;
+            flags.as_binary = binary;
+            ASSERT_TRUE(MeshIoManager(filename).write(mesh, flags));
+            StreamAndCompare(filename, 17, 1e-5);
+        }
+    }
+}
+
+TEST_F(MeshIoStreamTest, PipesFileToFileAndPatchesCounts) {
+    for (const std::string target: {"test_stream_out.off", "test_stream_out.obj", "test_stream_out.ply"}) {
+        for (bool binary: {false, true}) {
+            filenames.push_back("test_stream_in.ply");
+            filenames.push_back(target);
+            ASSERT_TRUE(MeshIoPLY("test_stream_in.ply").write(mesh, MeshIo::WriteFlags()));
+
+            MeshStreamReader reader("test_stream_in.ply", 10);
+            MeshIo::WriteFlags flags;
+            flags.as_binary = binary;
+            MeshStreamWriter writer(target, flags);
+            ASSERT_TRUE(PipeMeshStream(reader, writer));
+            EXPECT_EQ(writer.n_vertices_written(), mesh.n_vertices());
+            EXPECT_EQ(writer.n_faces_written(), mesh.n_faces());
+
+            Mesh loaded;
+            ASSERT_TRUE(MeshIoManager(target).read(loaded));
+            EXPECT_EQ(loaded.n_vertices(), mesh.n_vertices());
+            EXPECT_EQ(loaded.n_faces(), mesh.n_faces());
+        }
+    }
+}
+
+TEST_F(MeshIoStreamTest, FiltersModifyBatchesInPlace) {
+    filenames = {"test_stream_in.off", "test_stream_out.off"};
+    ASSERT_TRUE(MeshIoOFF("test_stream_in.off").write(mesh, MeshIo::WriteFlags()));
+
+    MeshStreamReader reader("test_stream_in.off", 8);
+    MeshStreamWriter writer("test_stream_out.off");
+    ASSERT_TRUE(PipeMeshStream(reader, writer, [](MeshStreamVertexBatch &batch) {
+        for (auto &p: batch.positions) p *= 2;
+    }));
+
+    auto positions = mesh.get_vertex_property<Vector<Real, 3> >("v:position");
+    for (auto v: mesh.vertices) positions[v] *= 2;
+    StreamAndCompare("test_stream_out.off", 8, 1e-5);
+}
+
+TEST_F(MeshIoStreamTest, CallbackStopsStream) {
+    filenames = {"test_stream.obj"};
+    ASSERT_TRUE(MeshIoOBJ("test_stream.obj").write(mesh, MeshIo::WriteFlags()));
+
+    MeshStreamReader reader("test_stream.obj", 4);
+    size_t n_batches = 0;
+    EXPECT_TRUE(reader.read([&](MeshStreamVertexBatch &) { return ++n_batches < 2; }, {}));
+    EXPECT_EQ(n_batches, 2);
+}
+
+TEST_F(MeshIoStreamTest, ReportsBytesReadPerBatch) {
+    for (const std::string filename: {"test_stream.off", "test_stream.obj", "test_stream.ply"}) {
+        for (bool binary: {false, true}) {
+            filenames.push_back(filename);
+            MeshIo::WriteFlags flags;
+            flags.as_binary = binary;
+            ASSERT_TRUE(MeshIoManager(filename).write(mesh, flags));
+            const size_t file_size = std::filesystem::file_size(filename);
+
+            MeshStreamReader reader(filename, 16);
+            size_t last = 0;
+            auto check = [&]() {
+                EXPECT_EQ(reader.file_size(), file_size);
+                EXPECT_GE(reader.n_bytes_read(), last);
+                EXPECT_LE(reader.n_bytes_read(), file_size);
+                last = reader.n_bytes_read();
+                return true;
+            };
+            ASSERT_TRUE(reader.read([&](MeshStreamVertexBatch &) { return check(); },
+                                    [&](MeshStreamFaceBatch &) { return check(); }));
+            EXPECT_GT(last, 0);
+            EXPECT_EQ(reader.n_bytes_read(), file_size);
+
+            // A callback which stops the stream, e.g. on cancellation, leaves the rest of the file unread.
+            ASSERT_TRUE(reader.read([&](MeshStreamVertexBatch &) { return false; }, {}));
+            EXPECT_LT(reader.n_bytes_read(), file_size);
+        }
+    }
+}
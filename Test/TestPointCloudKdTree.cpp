@@ -0,0 +1,210 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "PointCloudKdTree.h"
+#include "JobSystem.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Bcg;
+
+// Random points in a cube or on a saddle, every tenth point repeats an earlier one so that ties occur.
+static PointCloud MakeRandomCloud(size_t n, bool planar) {
+    PointCloud cloud;
+    auto positions = cloud.vertex_property<Vector<Real, 3> >("v:position");
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<Real> uniform(-1, 1);
+    for (size_t i = 0; i < n; ++i) {
+        const Real x = uniform(rng), y = uniform(rng);
+        const Vector<Real, 3> p = i % 10 == 9
+                                      ? positions[Vertex(i / 2)]
+                                      : Vector<Real, 3>(x, y, planar ? Real(0.1) * x * y : uniform(rng));
+        add_vertex(cloud.vertices, positions, p);
+    }
+    return cloud;
+}
+
+// Random query points around the cloud, followed by points of the cloud itself.
+static std::vector<Vector<Real, 3> > MakeQueries(const PointCloud &cloud, size_t n) {
+    const auto positions = cloud.get_vertex_property<Vector<Real, 3> >("v:position");
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<Real> uniform(-1.2f, 1.2f);
+    std::vector<Vector<Real, 3> > points;
+    for (size_t i = 0; i < n; ++i) {
+        points.emplace_back(uniform(rng), uniform(rng), uniform(rng));
+        points.push_back(positions[Vertex(i * 7 % cloud.vertices.size())]);
+    }
+    return points;
+}
+
+// The squared distances and indices of all points which are not deleted, ordered like the neighbors of the tree.
+static std::vector<std::pair<Real, uint32_t> > BruteForceSorted(const PointCloud &cloud, const Vector<Real, 3> &p) {
+    const auto positions = cloud.get_vertex_property<Vector<Real, 3> >("v:position");
+    std::vector<std::pair<Real, uint32_t> > result;
+    for (const Vertex &v: cloud.vertices) {
+        if (cloud.is_deleted(v)) continue;
+        result.emplace_back((positions[v] - p).squaredNorm(), static_cast<uint32_t>(v.idx()));
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+TEST(KdTreeTest, KnnMatchesBruteForce) {
+    for (const bool planar: {false, true}) {
+        PointCloud cloud = MakeRandomCloud(2000, planar);
+        KdTree tree(cloud);
+        ASSERT_TRUE(tree.build());
+        EXPECT_EQ(tree.indices.size(), cloud.n_vertices());
+        EXPECT_EQ(tree.nodes.size(), (size_t(2) << tree.depth) - 1);
+        std::vector<KdTree::Neighbor> neighbors;
+        for (const Vector<Real, 3> &point: MakeQueries(cloud, 100)) {
+            const std::vector<std::pair<Real, uint32_t> > expected = BruteForceSorted(cloud, point);
+            for (const size_t k: {1, 10, 40}) {
+                tree.knn_query(point, k, neighbors);
+                ASSERT_EQ(neighbors.size(), k);
+                for (size_t i = 0; i < k; ++i) {
+                    EXPECT_EQ(neighbors[i].v.idx(), expected[i].second);
+                    EXPECT_EQ(neighbors[i].sq_distance, expected[i].first);
+                }
+            }
+        }
+    }
+    // Asking for more neighbors than points finds all of them.
+    PointCloud small = MakeRandomCloud(5, false);
+    KdTree tree(small);
+    ASSERT_TRUE(tree.build());
+    std::vector<KdTree::Neighbor> neighbors;
+    tree.knn_query(Vector<Real, 3>::Zero(), 8, neighbors);
+    EXPECT_EQ(neighbors.size(), 5u);
+}
+
+TEST(KdTreeTest, RadiusAndBoxMatchBruteForce) {
+    PointCloud cloud = MakeRandomCloud(3000, false);
+    const auto positions = cloud.get_vertex_property<Vector<Real, 3> >("v:position");
+    KdTree tree(cloud);
+    ASSERT_TRUE(tree.build());
+    std::vector<KdTree::Neighbor> neighbors;
+    std::vector<Vertex> vertices;
+    size_t n_found = 0;
+    for (const Vector<Real, 3> &point: MakeQueries(cloud, 50)) {
+        const Real radius = 0.2f;
+        tree.radius_query(point, radius, neighbors);
+        std::vector<uint32_t> found;
+        for (const KdTree::Neighbor &neighbor: neighbors) {
+            EXPECT_EQ(neighbor.sq_distance, (positions[neighbor.v] - point).squaredNorm());
+            found.push_back(static_cast<uint32_t>(neighbor.v.idx()));
+        }
+        std::sort(found.begin(), found.end());
+        std::vector<uint32_t> expected;
+        for (const Vertex &v: cloud.vertices) {
+            if ((positions[v] - point).squaredNorm() <= radius * radius) expected.push_back(v.idx());
+        }
+        EXPECT_EQ(found, expected);
+        n_found += found.size();
+
+        // Boxes of different sizes, the large ones contain whole nodes.
+        for (const Real half: {0.05f, 0.3f, 0.9f}) {
+            const AABB<Real, 3> box(point - Vector<Real, 3>::Constant(half), point + Vector<Real, 3>::Constant(half));
+            tree.box_query(box, vertices);
+            found.clear();
+            for (const Vertex &v: vertices) {
+                found.push_back(static_cast<uint32_t>(v.idx()));
+            }
+            std::sort(found.begin(), found.end());
+            expected.clear();
+            for (const Vertex &v: cloud.vertices) {
+                if ((box.min().array() <= positions[v].array()).all() &&
+                    (positions[v].array() <= box.max().array()).all()) {
+                    expected.push_back(v.idx());
+                }
+            }
+            EXPECT_EQ(found, expected);
+        }
+    }
+    EXPECT_GT(n_found, 500u);
+}
+
+TEST(KdTreeTest, ParallelMatchesSerial) {
+    PointCloud cloud = MakeRandomCloud(200000, true);
+    KdTree serial(cloud);
+    ASSERT_TRUE(serial.build());
+    JobSystem jobs(4);
+    KdTree parallel(cloud, &jobs);
+    ASSERT_TRUE(parallel.build());
+    EXPECT_EQ(serial.indices, parallel.indices);
+    ASSERT_EQ(serial.nodes.size(), parallel.nodes.size());
+    for (size_t i = 0; i < serial.nodes.size(); ++i) {
+        EXPECT_EQ(serial.nodes[i].min(), parallel.nodes[i].min());
+        EXPECT_EQ(serial.nodes[i].max(), parallel.nodes[i].max());
+    }
+    // The leaves are at most max_leaf_size large, and every point is in exactly one of them.
+    EXPECT_LE(((cloud.n_vertices() - 1) >> serial.depth) + 1, serial.max_leaf_size);
+    std::vector<uint32_t> sorted = serial.indices;
+    std::sort(sorted.begin(), sorted.end());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        ASSERT_EQ(sorted[i], i);
+    }
+
+    const std::vector<Vector<Real, 3> > points = MakeQueries(cloud, 1000);
+    std::vector<KdTree::Neighbor> serial_knn, parallel_knn, single;
+    serial.knn_query(points, 6, serial_knn);
+    parallel.knn_query(points, 6, parallel_knn);
+    ASSERT_EQ(serial_knn.size(), points.size() * 6);
+    for (size_t i = 0; i < serial_knn.size(); ++i) {
+        EXPECT_EQ(serial_knn[i].v, parallel_knn[i].v);
+    }
+    parallel.knn_query(points[3], 6, single);
+    for (size_t i = 0; i < 6; ++i) {
+        EXPECT_EQ(single[i].v, parallel_knn[3 * 6 + i].v);
+    }
+
+    std::vector<std::vector<KdTree::Neighbor> > serial_radius, parallel_radius;
+    serial.radius_query(points, 0.01f, serial_radius);
+    parallel.radius_query(points, 0.01f, parallel_radius);
+    ASSERT_EQ(parallel_radius.size(), points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        ASSERT_EQ(serial_radius[i].size(), parallel_radius[i].size());
+    }
+
+    std::vector<AABB<Real, 3> > boxes;
+    for (const Vector<Real, 3> &point: points) {
+        boxes.emplace_back(point - Vector<Real, 3>::Constant(0.01f), point + Vector<Real, 3>::Constant(0.01f));
+    }
+    std::vector<std::vector<Vertex> > serial_boxes, parallel_boxes;
+    serial.box_query(boxes, serial_boxes);
+    parallel.box_query(boxes, parallel_boxes);
+    EXPECT_EQ(serial_boxes, parallel_boxes);
+}
+
+TEST(KdTreeTest, SkipsDeletedPoints) {
+    PointCloud cloud = MakeRandomCloud(500, false);
+    for (size_t i = 0; i < cloud.vertices.size(); i += 3) {
+        cloud.delete_vertex(Vertex(i));
+    }
+    KdTree tree(cloud);
+    ASSERT_TRUE(tree.build());
+    EXPECT_EQ(tree.indices.size(), cloud.n_vertices());
+    std::vector<KdTree::Neighbor> neighbors;
+    for (const Vector<Real, 3> &point: MakeQueries(cloud, 20)) {
+        const std::vector<std::pair<Real, uint32_t> > expected = BruteForceSorted(cloud, point);
+        tree.knn_query(point, 12, neighbors);
+        ASSERT_EQ(neighbors.size(), 12u);
+        for (size_t i = 0; i < 12; ++i) {
+            EXPECT_EQ(neighbors[i].v.idx(), expected[i].second);
+        }
+        tree.radius_query(point, 10, neighbors);
+        EXPECT_EQ(neighbors.size(), cloud.n_vertices());
+    }
+
+    // A cloud without points gives an empty tree, a cloud without positions cannot be indexed.
+    PointCloud empty;
+    empty.vertex_property<Vector<Real, 3> >("v:position");
+    KdTree empty_tree(empty);
+    EXPECT_TRUE(empty_tree.build());
+    empty_tree.knn_query(Vector<Real, 3>::Zero(), 3, neighbors);
+    EXPECT_TRUE(neighbors.empty());
+    PointCloud no_positions;
+    KdTree invalid(no_positions);
+    EXPECT_FALSE(invalid.build());
+}
@@ -0,0 +1,144 @@
+//
+// Created by alex on 18.10.26.
+//
+
+#include "PointCloudKnn.h"
+#include "JobSystem.h"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace Bcg;
+
+// The k nearest neighbors of every point by brute force, ordered by distance and index like the builder.
+static std::vector<uint32_t> BruteForceKnn(const PointCloud &cloud, size_t k) {
+    const size_t n = cloud.vertices.size();
+    const auto positions = cloud.get_vertex_property<Vector<Real, 3> >("v:position");
+    std::vector<uint32_t> result(n * k, std::numeric_limits<uint32_t>::max());
+    for (size_t i = 0; i < n; ++i) {
+        if (cloud.is_deleted(Vertex(i))) continue;
+        std::vector<std::pair<Real, uint32_t> > candidates;
+        for (size_t j = 0; j < n; ++j) {
+            if (j == i || cloud.is_deleted(Vertex(j))) continue;
+            const Real sq_distance = (positions[Vertex(j)] - positions[Vertex(i)]).squaredNorm();
+            candidates.emplace_back(sq_distance, static_cast<uint32_t>(j));
+        }
+        const size_t count = std::min(k, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+        for (size_t a = 0; a < count; ++a) {
+            result[i * k + a] = candidates[a].second;
+        }
+    }
+    return result;
+}
+
+static PointCloud MakeRandomCloud(size_t n, bool planar) {
+    PointCloud cloud;
+    auto positions = cloud.vertex_property<Vector<Real, 3> >("v:position");
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<Real> uniform(-1, 1);
+    for (size_t i = 0; i < n; ++i) {
+        const Real x = uniform(rng), y = uniform(rng);
+        add_vertex(cloud.vertices, positions, Vector<Real, 3>(x, y, planar ? Real(0.1) * x * y : uniform(rng)));
+    }
+    return cloud;
+}
+
+TEST(KnnGraphBuilderTest, MatchesBruteForce) {
+    for (const bool planar: {false, true}) {
+        PointCloud cloud = MakeRandomCloud(3000, planar);
+        const auto positions = cloud.get_vertex_property<Vector<Real, 3> >("v:position");
+        KnnGraphBuilder builder(cloud);
+        builder.compute(8);
+        EXPECT_EQ(builder.neighbors, BruteForceKnn(cloud, 8));
+        EXPECT_GT(builder.cell_size, 0);
+        for (size_t i = 0; i < 8; ++i) {
+            const Vertex v(5);
+            const Vertex u(builder.get_neighbor(v, i));
+            EXPECT_NEAR(builder.get_distance(v, i), (positions[u] - positions[v]).norm(), 1e-6f);
+        }
+    }
+}
+
+TEST(KnnGraphBuilderTest, ClustersAndDuplicates) {
+    // Two far apart clusters with fewer points than k in one of them, and several copies of the same point.
+    PointCloud cloud = MakeRandomCloud(500, false);
+    auto positions = cloud.get_vertex_property<Vector<Real, 3> >("v:position");
+    for (int i = 0; i < 3; ++i) {
+        add_vertex(cloud.vertices, positions, Vector<Real, 3>(1000, 1000, 1000 + Real(0.01) * i));
+    }
+    for (int i = 0; i < 4; ++i) {
+        add_vertex(cloud.vertices, positions, Vector<Real, 3>(0.5, 0.5, 0.5));
+    }
+    KnnGraphBuilder builder(cloud);
+    builder.compute(6);
+    EXPECT_EQ(builder.neighbors, BruteForceKnn(cloud, 6));
+
+    // Fewer points than neighbors leave the rest of the rows at max.
+    PointCloud small = MakeRandomCloud(4, false);
+    KnnGraphBuilder small_builder(small);
+    small_builder.compute(6);
+    EXPECT_EQ(small_builder.neighbors, BruteForceKnn(small, 6));
+    EXPECT_EQ(small_builder.get_distance(Vertex(0), 3), std::numeric_limits<Real>::max());
+}
+
+TEST(KnnGraphBuilderTest, ParallelMatchesSerial) {
+    PointCloud cloud = MakeRandomCloud(200000, false);
+    KnnGraphBuilder serial(cloud);
+    serial.compute(10);
+    JobSystem jobs(4);
+    KnnGraphBuilder parallel(cloud, &jobs);
+    parallel.compute(10);
+    EXPECT_EQ(serial.neighbors, parallel.neighbors);
+    EXPECT_EQ(serial.distances, parallel.distances);
+    EXPECT_EQ(serial.build_graph().n_edges(), parallel.build_graph().n_edges());
+}
+
+TEST(KnnGraphBuilderTest, BuildGraph) {
+    PointCloud cloud = MakeRandomCloud(1000, false);
+    // A deleted point has no neighbors and becomes a deleted, isolated vertex of the graph.
+    const Vertex deleted(3);
+    cloud.delete_vertex(deleted);
+    const auto positions = cloud.get_vertex_property<Vector<Real, 3> >("v:position");
+    const size_t k = 5;
+    KnnGraphBuilder builder(cloud);
+    builder.compute(k);
+    EXPECT_EQ(builder.get_neighbor(deleted, 0), std::numeric_limits<uint32_t>::max());
+
+    auto is_neighbor = [&](size_t i, size_t j) {
+        for (size_t a = 0; a < k; ++a) {
+            if (builder.get_neighbor(Vertex(i), a) == j) return true;
+        }
+        return false;
+    };
+    for (const bool mutual: {false, true}) {
+        builder.mutual = mutual;
+        Graph graph = builder.build_graph();
+        EXPECT_EQ(graph.vertices.size(), cloud.vertices.size());
+        EXPECT_TRUE(graph.is_deleted(deleted));
+        const auto lengths = graph.get_edge_property<Real>("e:length");
+        ASSERT_TRUE(lengths);
+        size_t n_expected = 0;
+        for (size_t i = 0; i < cloud.vertices.size(); ++i) {
+            for (size_t j = i + 1; j < cloud.vertices.size(); ++j) {
+                const bool connected = mutual ? is_neighbor(i, j) && is_neighbor(j, i)
+                                              : is_neighbor(i, j) || is_neighbor(j, i);
+                if (connected) ++n_expected;
+            }
+        }
+        EXPECT_EQ(graph.n_edges(), n_expected);
+        for (const Edge &e: graph.edges) {
+            const Vertex v0 = graph.get_vertex(e, 0), v1 = graph.get_vertex(e, 1);
+            EXPECT_TRUE(mutual ? is_neighbor(v0.idx(), v1.idx()) && is_neighbor(v1.idx(), v0.idx())
+                               : is_neighbor(v0.idx(), v1.idx()) || is_neighbor(v1.idx(), v0.idx()));
+            EXPECT_NEAR(lengths[e], (positions[v1] - positions[v0]).norm(), 1e-6f);
+        }
+        // Every point which is not deleted is connected to at least its nearest neighbor in the union.
+        if (!mutual) {
+            for (size_t i = 0; i < cloud.vertices.size(); ++i) {
+                if (Vertex(i) != deleted) {
+                    EXPECT_GE(graph.get_valence(Vertex(i)), 1u);
+                }
+            }
+        }
+    }
+}